@@ -609,7 +609,8 @@ int NXBread(NXhandle fileId, NXname dataName, char *dimensions)
 	for (i = 0; i < dataRank; i++) {
 		total_size *= dataDimensions[i];
 	}
-	if (NXmalloc((void **)&dataBuffer, dataRank, size, dataType) != NX_OK)
+	if (NXmallocex((void **)&dataBuffer, dataRank, size, dataType,
+		       NXMALLOC_NOINIT) != NX_OK)
 		return NX_ERROR;
 	/* Read in the data with NXgetslab */
 	if (dataType == NX_CHAR) {
@@ -705,7 +706,8 @@ int NXBdump(NXhandle fileId, NXname dataName, char *fileName)
 	}
 
 	/* Allocate data space */
-	if (NXmalloc(&dataBuffer, dataRank, dataDimensions, dataType) != NX_OK)
+	if (NXmallocex(&dataBuffer, dataRank, dataDimensions, dataType,
+		       NXMALLOC_NOINIT) != NX_OK)
 		return NX_ERROR;
 
 	/* Read the lot */
@@ -298,13 +298,13 @@ static int WriteGroup (int is_definition)
 			    dataDimensions[i] = MAX_DEF_ARRAY_ELEMENTS_PER_DIM;
 			}
 		    }
-                    if (NXmalloc (&dataBuffer, dataRank, dataDimensions, dataType) != NX_OK) return NX_ERROR;
+                    if (NXmallocex (&dataBuffer, dataRank, dataDimensions, dataType, NXMALLOC_NOINIT) != NX_OK) return NX_ERROR;
                     if (NXgetslab (inId, dataBuffer, slab_start, dataDimensions)  != NX_OK) return NX_ERROR;
                     if (NXputslab (outId, dataBuffer, slab_start, dataDimensions) != NX_OK) return NX_ERROR;
 		}
 		else
 		{
-                    if (NXmalloc (&dataBuffer, dataRank, dataDimensions, dataType) != NX_OK) return NX_ERROR;
+                    if (NXmallocex (&dataBuffer, dataRank, dataDimensions, dataType, NXMALLOC_NOINIT) != NX_OK) return NX_ERROR;
                     if (NXgetdata (inId, dataBuffer)  != NX_OK) return NX_ERROR;
 		    /* fix potential non-UTF8 character issue */
 		    if (is_definition && dataType == NX_CHAR)
@@ -241,7 +241,7 @@ static string read_data_as_string(NXhandle handle, Path path,
 
   // allocate space for data
   void *data;
-  if(NXmalloc(&data,rank,dims,type)!=NX_OK){
+  if(NXmallocex(&data,rank,dims,type,NXMALLOC_NOINIT)!=NX_OK){
     close_path(handle,path);
     throw "NXmalloc falied";
   }
@@ -207,7 +207,7 @@ static void fill_axis(NXhandle handle, Axis &axis, PathVector &tree,
   }
 
   // allocate space for the data
-  if(NXmalloc(&axis.data,rank,axis.dims,axis.type)!=NX_OK){
+  if(NXmallocex(&axis.data,rank,axis.dims,axis.type,NXMALLOC_NOINIT)!=NX_OK){
     close_path(handle,axis.path);
     throw "NXmalloc failed";
   }
@@ -271,7 +271,7 @@ static void fill_data(NXhandle handle, Data &data, PathVector &data_tree,
   }
 
   // allocate space for the data
-  if(NXmalloc(&data.data,data.rank,data.dims,data.type)!=NX_OK){
+  if(NXmallocex(&data.data,data.rank,data.dims,data.type,NXMALLOC_NOINIT)!=NX_OK){
     close_path(handle,data.path);
     throw "NXmalloc failed";
   }
@@ -511,7 +511,7 @@ extern void dump_data(std::string &filename,NXhandle handle, const Tree &tree,
 
   // allocate space for the data
   void *data;
-  if(NXmalloc(&data,rank,dims,type)!=NX_OK){
+  if(NXmallocex(&data,rank,dims,type,NXMALLOC_NOINIT)!=NX_OK){
     close_path(handle,path);
     throw "NXmalloc failed";
   }
@@ -0,0 +1,72 @@
+/*-----------------------------------------------------------------------------
+ NeXus - Neutron & X-ray Common Data Format
+
+ NeXus Indexer: writes or checks the index beside NeXus files, which lets
+ NXopen with NXACC_SNAPSHOT skip walking them
+
+ This library is free software; you can redistribute it and/or modify it under
+ the terms of the GNU Lesser General Public License as published by the Free
+ Software Foundation; either version 2 of the License, or (at your option) any
+ later version.
+
+ This library is distributed in the hope that it will be useful, but WITHOUT ANY
+ WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+ details.
+
+ You should have received a copy of the GNU Lesser General Public License along
+ with this library; if not, write to the Free Software Foundation, Inc., 59
+ Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+ For further information, see <http://www.nexusformat.org>
+
+!----------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <string.h>
+#include "napi.h"
+
+static void usage(void)
+{
+	fprintf(stderr, "Usage: nxindex [-c] [-q] file ...\n");
+	fprintf(stderr, "  -c  only check that each file has an up to date index\n");
+	fprintf(stderr, "  -q  do not list the files\n");
+}
+
+int main(int argc, char *argv[])
+{
+	int i, check = 0, quiet = 0, failed = 0;
+
+	for (i = 1; i < argc && argv[i][0] == '-'; i++) {
+		if (strcmp(argv[i], "-c") == 0) {
+			check = 1;
+		} else if (strcmp(argv[i], "-q") == 0) {
+			quiet = 1;
+		} else {
+			usage();
+			return 2;
+		}
+	}
+	if (i == argc) {
+		usage();
+		return 2;
+	}
+	for (; i < argc; i++) {
+		if (check) {
+			if (NXcheckindex(argv[i]) == NX_OK) {
+				if (!quiet)
+					printf("%s: up to date\n", argv[i]);
+			} else {
+				failed = 1;
+				if (!quiet)
+					printf("%s: missing or stale\n", argv[i]);
+			}
+		} else if (NXmakeindex(argv[i]) == NX_OK) {
+			if (!quiet)
+				printf("%s: indexed\n", argv[i]);
+		} else {
+			failed = 1;
+		}
+	}
+	return failed;
+}
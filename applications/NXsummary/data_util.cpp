@@ -29,11 +29,17 @@ typedef unsigned __int64        uint64_t;
 using std::ostringstream;
 using std::string;
 using std::runtime_error;
+using NeXus::Extract::Extractor;
+using NeXus::Extract::Result;
+using NeXus::Extract::Value;
 
 // useful strings for printing
 static const string UNITS("units");
 static const string SPACE(" ");
 
+// a double holds every integer up to 2^53 exactly
+static const double EXACT_INTEGER = 9007199254740992.;
+
 // constants for unit conversions
 static const string SECOND("second");
 static const string MINUTE("minute");
@@ -47,6 +53,12 @@ static const string OP_SUM("SUM");
 static const string OP_UNITS("UNITS:");
 static const string OP_DIMS("DIMS");
 static const string OP_COUNT("COUNT");
+static const string OP_MIN("MIN");
+static const string OP_MAX("MAX");
+static const string OP_MEAN("MEAN");
+static const string OP_STDDEV("STDDEV");
+static const string OP_NONZERO("NONZERO");
+static const string OP_HISTOGRAM("HISTOGRAM:");
 
 /*
  * THIS SHOULD BE ABLE TO DO
@@ -55,8 +67,65 @@ static const string OP_COUNT("COUNT");
  * principle investigator ???
  */
 namespace nxsum {
-  bool operationValid(const std::string &operation) {
+  /**
+   * The operations done by the extractor while it reads the field, which
+   * it does in blocks so that fields larger than memory can be summarized.
+   * HISTOGRAM is written as "HISTOGRAM:<bins>:<low>:<high>".
+   */
+  static bool reduction(const string &operation,
+                        NeXus::Extract::Request &request) {
+    request.element = 0;
+    request.low = 0.;
+    request.high = 0.;
     if (operation.compare(OP_SUM) == 0)
+      {
+        request.operation = NeXus::Extract::SUM;
+      }
+    else if (operation.compare(OP_MIN) == 0)
+      {
+        request.operation = NeXus::Extract::MIN;
+      }
+    else if (operation.compare(OP_MAX) == 0)
+      {
+        request.operation = NeXus::Extract::MAX;
+      }
+    else if (operation.compare(OP_MEAN) == 0)
+      {
+        request.operation = NeXus::Extract::MEAN;
+      }
+    else if (operation.compare(OP_STDDEV) == 0)
+      {
+        request.operation = NeXus::Extract::STDDEV;
+      }
+    else if (operation.compare(OP_NONZERO) == 0)
+      {
+        request.operation = NeXus::Extract::NONZERO;
+      }
+    else if (operation.compare(0, OP_HISTOGRAM.size(), OP_HISTOGRAM) == 0)
+      {
+        request.operation = NeXus::Extract::HISTOGRAM;
+        std::istringstream spec(operation.substr(OP_HISTOGRAM.size()));
+        char sep1 = '\0';
+        char sep2 = '\0';
+        long bins = 0;
+        if (!(spec >> bins >> sep1 >> request.low >> sep2 >> request.high)
+            || sep1 != ':' || sep2 != ':' || bins < 1
+            || !(request.low < request.high) || !spec.eof())
+          {
+            return false;
+          }
+        request.element = bins;
+      }
+    else
+      {
+        return false;
+      }
+    return true;
+  }
+
+  bool operationValid(const std::string &operation) {
+    NeXus::Extract::Request request("");
+    if (reduction(operation, request))
       {
         return true;
       }
@@ -136,61 +205,6 @@ namespace nxsum {
     return false;
   }
 
-  string readAttrAsString(NXhandle handle, const string &label) {
-    if (NXinitattrdir(handle)!=NX_OK)
-      {
-        throw runtime_error("NXinitattrdir failed");
-      }
-    int num_attr;
-    if (NXgetattrinfo(handle, &num_attr)!=NX_OK)
-      {
-        throw runtime_error("NXgetattrinfo failed");
-      }
-    char name[GROUP_STRING_LEN];
-    int length;
-    int type;
-    for (int i = 0 ; i < num_attr ; ++i) {
-      if (NXgetnextattr(handle, name, &length, &type)!=NX_OK)
-        {
-          throw runtime_error("NXgetnextattr failed");
-        }
-      if (label == name)
-        {
-          void *data;
-          if (NXmalloc(&data, 1, &length, type)!=NX_OK)
-            {
-              throw runtime_error("NXmalloc failed");
-            }
-          int dims[1]  = {length};
-          if (NXgetattr(handle, name, data, dims, &type)!=NX_OK)
-            {
-            throw runtime_error("NXgetattr failed");
-            }
-          string result = toString(data, length, type);
-          if (NXfree(&data)!=NX_OK)
-            {
-              throw runtime_error("NXfree failed");
-            }
-        return result;
-        }
-    }
-
-    return "";
-  }
-
-  template <typename NumT>
-  NumT sum(const NumT *data, const int dims[], const int rank) {
-    size_t num_ele = 1;
-    for (size_t i = 0; i < rank; ++i) {
-      num_ele *= dims[i];
-    }
-    NumT result = static_cast<NumT>(0.);
-    for (size_t i = 0; i < num_ele; ++i) {
-      result += data[i];
-    }
-    return result;
-  }
-
   template <typename NumT>
   NumT inverse(const NumT data) {
     return static_cast<NumT>(1.) / data;
@@ -275,31 +289,6 @@ namespace nxsum {
         return toString(data, dims, rank, type) + SPACE + units;
       }
 
-    if (operation.compare(OP_SUM) == 0)
-      {
-        string result;
-        if (type == NX_FLOAT32)
-          {
-            result = toString(sum((float *)data, dims, rank));
-          }
-        else if(type == NX_FLOAT64)
-          {
-            result = toString(sum((double *)data, dims, rank));
-          }
-        else if(type == NX_UINT32)
-          {
-            result = toString(sum((uint32_t *)data, dims, rank));
-          }
-        else
-          {
-            ostringstream s;
-            s << "Do not know how to convert units with type="
-              << nxtypeAsString(type);
-            throw runtime_error(s.str());
-          }
-        return result + SPACE + units;
-      }
-
     if (operation.compare(OP_DIMS) == 0)
       {
         return toString(dims, rank, NX_INT32);
@@ -347,71 +336,127 @@ namespace nxsum {
     throw runtime_error(s.str());
   }
 
-  string readAsString(NXhandle handle, const string &path,
-                      const string &operation) {
-    // return empty string if the path is empty
-    if (path.empty())
+  static bool isInteger(const int type) {
+    return (type == NX_INT8 || type == NX_UINT8 || type == NX_INT16
+            || type == NX_UINT16 || type == NX_INT32 || type == NX_UINT32
+            || type == NX_INT64 || type == NX_UINT64);
+  }
+
+  static string reductionAsString(const NeXus::Extract::Request &request,
+                                  const Value &value, const string &units) {
+    switch (request.operation)
       {
-        return string("");
+      case NeXus::Extract::HISTOGRAM:
+        {
+          const int64_t *counts =
+            reinterpret_cast<const int64_t *>(&value.data[0]);
+          ostringstream s;
+          s << '[';
+          for (int64_t i = 0; i < value.dims[0]; ++i) {
+            if (i > 0)
+              {
+                s << ',';
+              }
+            s << counts[i];
+          }
+          s << ']';
+          return s.str();
+        }
+      case NeXus::Extract::NONZERO:
+        return toString(static_cast<int64_t>(value.number));
+      case NeXus::Extract::SUM:
+      case NeXus::Extract::MIN:
+      case NeXus::Extract::MAX:
+        // reductions are doubles, print those beyond EXACT_INTEGER as such
+        if (isInteger(value.type) && value.number >= -EXACT_INTEGER
+            && value.number <= EXACT_INTEGER)
+          {
+            return toString(static_cast<int64_t>(value.number)) + SPACE
+              + units;
+          }
+        break;
+      default:
+        break;
+      }
+    return toString(value.number) + SPACE + units;
+  }
+
+  ItemRequests addRequests(Extractor &extractor, const Item &item) {
+    ItemRequests requests;
+    requests.empty = item.path.empty();
+    requests.value = 0;
+    requests.units = 0;
+    if (requests.empty)
+      {
+        return requests;
       }
 
-    // convert the path to something c-friendly
-    char c_path[GROUP_STRING_LEN];
-    strcpy(c_path, path.c_str());
+    // the dimensions are all the information operations need, and the
+    // reductions never need the whole field in memory
+    NeXus::Extract::Request request(item.path);
+    if (infoOnly(item.operation))
+      {
+        request.operation = NeXus::Extract::DIMS;
+      }
+    else if (!reduction(item.operation, request))
+      {
+        request.operation = NeXus::Extract::VALUE;
+      }
+    requests.value = extractor.add(request);
+    requests.units = extractor.add(item.path, UNITS);
+    return requests;
+  }
 
-    // open the path
-    if(NXopenpath(handle, c_path)!=NX_OK)
+  string valueAsString(const Result &result, const ItemRequests &requests,
+                       const string &operation) {
+    // return empty string if the path is empty
+    if (requests.empty)
       {
-        throw runtime_error("COULD NOT OPEN PATH");
-        return "";
+        return string("");
       }
 
-    // determine rank and dimension
-    int rank = 0;
-    int type = 0;
-    int dims[NX_MAXRANK];
-    if (NXgetinfo(handle, &rank, dims, &type)!=NX_OK)
+    const Value &value = result.values[requests.value][0];
+    if (!value.ok)
       {
-        throw runtime_error("COULD NOT GET NODE INFORMATION");
+        throw runtime_error(value.error);
       }
 
     // confirm dimension isn't too high
+    int rank = static_cast<int>(value.dims.size());
     if (rank > NX_MAXRANK)
       {
         throw runtime_error("DIMENSIONALITY IS TOO HIGH");
       }
+    int dims[NX_MAXRANK];
+    for (int i = 0; i < rank; ++i) {
+      dims[i] = static_cast<int>(value.dims[i]);
+    }
 
     // get the units
-    string units = readAttrAsString(handle, UNITS);
-
-    // check if this doesn't need the data to get result
-    if (infoOnly(operation))
+    string units;
+    const Value &unitsValue = result.values[requests.units][0];
+    if (unitsValue.ok)
       {
-        return operateData(operation, NULL, dims, rank, type, units);
+        units = toString(&unitsValue.data[0],
+                         static_cast<int>(unitsValue.dims[0]),
+                         unitsValue.type);
       }
 
-    // allocate space for data
-    void *data;
-    if(NXmalloc(&data,rank,dims,type)!=NX_OK)
+    // the extractor did the reductions
+    NeXus::Extract::Request request("");
+    if (reduction(operation, request))
       {
-        throw runtime_error("NXmalloc falied");
+        return reductionAsString(request, value, units);
       }
 
-    // retrieve data from the file
-    if(NXgetdata(handle,data)!=NX_OK)
+    // check if this doesn't need the data to get result
+    if (infoOnly(operation))
       {
-        throw runtime_error("NXgetdata failed");
+        return operateData(operation, NULL, dims, rank, value.type, units);
       }
 
     // convert result to string
-    string result = operateData(operation, data, dims, rank, type, units);
-
-    //free up the pointer
-    if(NXfree(&data)!=NX_OK)
-      {
-        throw runtime_error("NXfree failed");
-      }
-
-    return result;
+    return operateData(operation, &value.data[0], dims, rank, value.type,
+                       units);
   }
 }
@@ -6,6 +6,8 @@
  */
 #include <napi.h>
 #include <string>
+#include "NeXusExtract.hpp"
+#include "nxsummary.hpp"
 
 namespace nxsum {
   /**
@@ -16,19 +18,41 @@ namespace nxsum {
   bool operationValid(const std::string &operation);
 
   /**
-   * This will open the file to the supplied path and perform the
-   * requested operation. Note that this leaves the filehandle
-   * pointing at the node specified in the path.
+   * Where the values for one item are found in the results of an
+   * extractor.
+   */
+  struct ItemRequests {
+    bool empty;
+    size_t value;
+    size_t units;
+  };
+
+  /**
+   * This adds what is needed for the item to the requests of the
+   * extractor. Nothing is added for an item with an empty path.
+   *
+   * \param extractor The extractor run over the NeXus files.
+   * \param item The item to look for.
+   *
+   * \return Where the values for the item will be found.
+   */
+  ItemRequests addRequests(NeXus::Extract::Extractor &extractor,
+                           const Item &item);
+
+  /**
+   * This performs the requested operation on what was extracted from
+   * one file for an item.
    *
-   * \param handle Handle for the NeXus files.
-   * \param path Location in the NeXus file to look for the data at.
+   * \param result What was extracted from the NeXus file.
+   * \param requests Where the values for the item are in the result.
    * \param operation Operation to perform on the data. If empty this
    * returns the data itself, unchanged.
    *
    * \return String version of the data after the operation is performed.
    */
-  std::string readAsString(NXhandle handle, const std::string &path,
-                           const std::string &operation);
+  std::string valueAsString(const NeXus::Extract::Result &result,
+                            const ItemRequests &requests,
+                            const std::string &operation);
 
   /**
    * \param The integer type to convert to a string.
@@ -52,77 +52,103 @@ using namespace nxsum;
 static const string NXSUM_VERSION("0.1.1");
 static const string EMPTY("");
 
-static void openFile(const string &file, NXhandle &handle) {
-  char filename[GROUP_STRING_LEN];
-  strcpy(filename, file.c_str());
-  if(NXopen(filename,NXACC_READ,&handle)!=NX_OK)
-    {
-      ostringstream s;
-      s << "Could not open file \"" << file << "\"";
-      throw runtime_error(s.str());
-    }
-}
-
-static void closeFile(const string &file, NXhandle &handle) {
-  if (handle == NULL)
-    {
-      return;
-    }
-  if(NXclose(&handle)!=NX_OK)
-    {
-      ostringstream s;
-      s << "Could not close file \"" << file << "\"";
-      throw runtime_error(s.str());
-    }
-}
-
-static void printInfo(NXhandle handle, const Item &item, const Config &config) {
-  try {
-    string value = readAsString(handle, item.path, item.operation);
-    print(item, value, config);
-  } catch(runtime_error &e) {
-    printError(item, e.what(), config);
+/*
+ * Prints what was extracted from each file, in the order of the files on
+ * the command line.
+ */
+class Printer : public NeXus::Extract::Handler {
+public:
+  Printer(const Config &config, const Item &item, bool getValue) :
+    m_config(config), m_item(item), m_getValue(getValue)
+  {
+    if (getValue)
+      {
+        m_requests.push_back(addRequests(m_extractor, item));
+      }
+    else
+      {
+        size_t length = config.preferences.size();
+        for (size_t i = 0 ; i < length ; ++i ) {
+          m_requests.push_back(addRequests(m_extractor,
+                                           config.preferences[i]));
+        }
+      }
   }
-}
 
-static void printSummary(const string &file, const Config &config) {
-  NXhandle handle = NULL;
-  openFile(file, handle);
+  void run(const vector<string> &files, int threads) {
+    m_extractor.setThreads(threads);
+    m_extractor.run(files, *this);
+  }
 
-  vector<string> values;
-  vector<bool> isError;
+  void process(const NeXus::Extract::Result &result) {
+    const string &file = result.filename;
+    if (!canRead(file))
+      {
+        if (m_config.verbose)
+          {
+            cout << "Cannot open \"" << file << "\"" << endl;
+          }
+        return;
+      }
+    if (!result.ok)
+      {
+        if ((!m_config.multifile) || (m_config.verbose))
+          {
+            std::cerr << "RUNTIME ERROR:Could not open file \"" << file
+                      << "\"" << endl;
+          }
+        return;
+      }
+    if (m_getValue)
+      {
+        printValue(result);
+      }
+    else
+      {
+        printSummary(result);
+      }
+  }
 
-  size_t length = config.preferences.size();
-  for (size_t i = 0 ; i < length ; ++i ) {
+private:
+  void printValue(const NeXus::Extract::Result &result) {
+    if (m_config.multifile)
+      {
+        cout << result.filename << ";";
+      }
     try {
-      string value = readAsString(handle, config.preferences[i].path,
-                                  config.preferences[i].operation);
-      values.push_back(value);
-      isError.push_back(false);
+      string value = valueAsString(result, m_requests[0], m_item.operation);
+      print(m_item, value, m_config);
     } catch(runtime_error &e) {
-      values.push_back(e.what());
-      isError.push_back(true);
+      printError(m_item, e.what(), m_config);
     }
   }
 
-  print(file, config.preferences, values, isError, config);
-
-  closeFile(file, handle);
-}
-
-static void printValue(const string &file, const Item &item,
-                       const Config &config) {
-  NXhandle handle = NULL;
-  openFile(file, handle);
+  void printSummary(const NeXus::Extract::Result &result) {
+    vector<string> values;
+    vector<bool> isError;
 
-  if (config.multifile)
-    {
-      cout << file << ";";
+    size_t length = m_config.preferences.size();
+    for (size_t i = 0 ; i < length ; ++i ) {
+      try {
+        string value = valueAsString(result, m_requests[i],
+                                     m_config.preferences[i].operation);
+        values.push_back(value);
+        isError.push_back(false);
+      } catch(runtime_error &e) {
+        values.push_back(e.what());
+        isError.push_back(true);
+      }
     }
-  printInfo(handle, item, config);
 
-  closeFile(file, handle);
-}
+    print(result.filename, m_config.preferences, values, isError, m_config);
+  }
+
+  const Config &m_config;
+  Item m_item;
+  bool m_getValue;
+  NeXus::Extract::Extractor m_extractor;
+  vector<ItemRequests> m_requests;
+};
 
 int main(int argc, char *argv[]) {
   try
@@ -140,6 +166,14 @@ int main(int argc, char *argv[]) {
       descr << "\n";
       descr << "\"SUM\" - Add together all of the array elements and print the result.";
       descr << "\n";
+      descr << "\"MIN\", \"MAX\", \"MEAN\", \"STDDEV\" - The smallest and largest element, the mean and the standard deviation of the array.";
+      descr << "\n";
+      descr << "\"NONZERO\" - The number of elements which are not zero.";
+      descr << "\n";
+      descr << "\"HISTOGRAM:<bins>:<low>:<high>\" - The number of elements in each of <bins> equal bins from <low> to <high>.";
+      descr << "\n";
+      descr << "These are worked out while the field is read in blocks, so they work on fields larger than memory.";
+      descr << "\n";
       descr << "\"UNITS:<new units>\" - Specify the units to print the result in.";
 
       // set up the parser
@@ -161,6 +195,9 @@ int main(int argc, char *argv[]) {
                                 false, "", "label", cmd);
       SwitchArg printXmlArg("", "xml", "Print results as xml",
                             cmd, false);
+      ValueArg<int> threadsArg("", "threads",
+                               "Number of files read at the same time",
+                               false, 2, "threads", cmd);
 
       // parse the arguments
       cmd.parse(argc, argv);
@@ -205,36 +242,8 @@ int main(int argc, char *argv[]) {
         }
 
       // go through the list of files
-      for (vector<string>::const_iterator file = files.begin() ;
-           file != files.end() ; file++ )
-        {
-          if (!canRead(*file))
-            {
-              if (config.verbose)
-                {
-                  cout << "Cannot open \"" << *file << "\"" << endl;
-                }
-              continue;
-            }
-          try
-            {
-              if (getValue)
-                {
-                  printValue(*file, item, config);
-                }
-              else
-                {
-                  printSummary(*file, config);
-                }
-            }
-          catch(runtime_error &e)
-            {
-              if ((!config.multifile) || (config.verbose))
-                {
-                  std::cerr << "RUNTIME ERROR:" << e.what() <<endl;
-                }
-            }
-        }
+      Printer printer(config, item, getValue);
+      printer.run(files, threadsArg.getValue());
     }
   catch(ArgException &e)
     {
@@ -70,6 +70,7 @@ namespace nxsum {
 
   // explicit instantiations so they get compiled in
   template string toString<uint32_t>(const uint32_t thing);
+  template string toString<int64_t>(const int64_t thing);
   template string toString<int>(const int thing);
   template string toString<double>(const double thing);
   template string toString<float>(const float thing);
@@ -296,7 +296,7 @@ static void reset_file(ifstream &file) {
 }
 
 static string read_line(ifstream &file) {
-	static char buffer[BUFFER_SIZE];
+	char buffer[BUFFER_SIZE];
 	file.get(buffer,BUFFER_SIZE);
 	file.get();
 	int state = file.rdstate();
@@ -322,25 +322,21 @@ static char read_char(ifstream &file){
   return file.get();
 }
 
-static void skip_to_line(ifstream &file,int &cur_line, int new_line){
+static void skip_to_line(ifstream &file, const vector<std::streampos> &offsets, int &cur_line, int new_line){
    file.seekg(0,std::ios::beg);
   if(new_line==cur_line){ // skip out early if possible
     return;
-  }else if(new_line<cur_line){  // go to the beginning if necessary
-    file.seekg(0,std::ios::beg);
+  }else if(new_line<0){  // stay at the beginning
     cur_line=0;
+    return;
   }
 
-  // scan down to the right place
-  while( (file.good()) && (cur_line<new_line) ){
-    string text=read_line(file);
-    //cout << "LINE" << cur_line << "[" << file.tellg() << "]:" << text << endl;
-    cur_line++;
-  }
-
-  if(!(file.good()))
+  // seek to where read_line() found the line when indexing the file
+  if(static_cast<unsigned int>(new_line)>=offsets.size())
     throw invalid_argument("Could not reach line "
                            +string_util::int_to_str(new_line));
+  file.seekg(offsets[new_line]);
+  cur_line=new_line;
 }
 
 
@@ -348,7 +344,7 @@ static void skip_to_line(ifstream &file,int &cur_line, int new_line){
 
 std::string Frm2Retriever::parse_method(std::string location){
 	unsigned int pos = 0;
-	static std::string sub_str;
+	std::string sub_str;
 	
 	pos = location.find_first_of(Frm2Retriever::METHOD_OPEN_BRACKET);
 	if (pos != std::string::npos) {
@@ -420,7 +416,7 @@ std::vector<unsigned int> Frm2Retriever::parse_type_dims(std::string location, s
 
 std::string Frm2Retriever::parse_type(std::string location){
 	unsigned int pos = 0;
-	static std::string sub_str;
+	std::string sub_str;
 	
 	pos = location.find_last_of(Frm2Retriever::TYPE_OPEN_BRACKET);
 	if (pos != std::string::npos) {
@@ -439,8 +435,8 @@ std::vector<std::string> Frm2Retriever::parse_arg(std::string location){
 	// check if column
 	unsigned int start_pos = 0;
 	unsigned int end_pos = 0;
-	static std::string arg_str;
-	static std::string item_str;
+	std::string arg_str;
+	std::string item_str;
 	std::vector<std::string> result;
 	
 	start_pos = location.find_first_of(Frm2Retriever::METHOD_OPEN_BRACKET);
@@ -495,7 +491,7 @@ std::vector<std::string> Frm2Retriever::parse_arg(std::string location){
 
 void Frm2Retriever::parse_range(std::string location, int &x, int &y){
 	unsigned int pos = 0;
-	static std::string sub_str;
+	std::string sub_str;
 	
 	x = -1;
 	y = -1;
@@ -758,10 +754,9 @@ void Frm2Retriever::extract_toflogheaders(std::ifstream &file) {
 	std::string value="";
 	std::map<int, std::string> key_pairs; 
 	
-	reset_file(file);
-	while (file.good() && (cur_line++)<=data_section) {
+	for (unsigned int n=0; n<lines.size() && (cur_line++)<=data_section; n++) {
 		
-		std::string line = read_line(file);
+		std::string line = lines[n];
 		
 		// eliminate whitespace at start of line
 		while (isspace(line[0])){
@@ -899,9 +894,8 @@ std::map<std::string, std::string> Frm2Retriever::extract_dictarray(std::ifstrea
 		return result;
 	}
 	
-	reset_file(infile);
-	while (infile.good()) {
-		std::string line = read_line(infile);
+	for (unsigned int n=0; n<lines.size(); n++) {
+		std::string line = lines[n];
 		//std::cout << "current line: " << line << std::endl;	
 		
 		// eliminate whitespace at start of line
@@ -1139,9 +1133,8 @@ std::vector<unsigned int> Frm2Retriever::extract_desc(std::ifstream &file, std::
 	std::string line="";
 	std::vector<unsigned int> result;
 	
-	reset_file(infile);
-	while (infile.good()) {
-		std::string line = read_line(infile);
+	for (unsigned int n=0; n<lines.size(); n++) {
+		std::string line = lines[n];
 
 		// eliminate whitespace at start of line
 		while (isspace(line[0])){
@@ -1191,7 +1184,7 @@ std::vector<std::string> Frm2Retriever::extract_toflog(std::ifstream &file, std:
 
 	reset_file(infile);
 	
-	skip_to_line(infile, cur_line, data_section+((from<0)?0:from)); 
+	skip_to_line(infile, line_offsets, cur_line, data_section+((from<0)?0:from)); 
 	
 	use_col_number = isNumber(col_name);
 	
@@ -1215,25 +1208,15 @@ std::vector<std::string> Frm2Retriever::extract_toflog(std::ifstream &file, std:
 		index--;
 	}
 	
-	line = read_line(infile);
-	while ((infile.good()) && ((to>=0 && to<count) || (to<0))) {			
-		if (!isdata(line)) {
-			break;
-		}
+	const std::vector<std::vector<std::string> > &rows = data_rows(cur_line);
+	for (unsigned int r=0; r<rows.size() && ((to>=0 && to<count) || (to<0)); r++) {
 		try {
-			std::vector<std::string> line_values = string_util::split_values(line);
-			/*for (std::vector<std::string>::iterator itt=values.begin(); itt!=values.end(); itt++) {
-				std::cout << "column------- vector: " << *itt << std::endl;
-			}*/
-			/*std::cout << endl << "pushing data: " << (string_util::str_to_float(string_values.at(index))) << std::endl;	
-			//double dbl_val = string_util::str_to_float(string_values.at(index));*/
-			values.push_back(line_values.at(index));
+			values.push_back(rows[r].at(index));
 		}
 		catch(...) {
 			cout << "exception in transforming column values " << endl;	
 		}
 		count++;
-		line = read_line(infile);
 	}
 		
 	reset_file(infile);
@@ -1245,15 +1228,14 @@ std::string Frm2Retriever::extract_line_below(std::ifstream &file, std::string a
 	unsigned int pos=0;
 	std::string line="";
 	
-	reset_file(infile);
-	while (infile.good()) {
-		line = read_line(infile);
+	for (unsigned int n=0; n<lines.size(); n++) {
+		line = lines[n];
 		while (isspace(line[0])){
 			line = line.substr(1);
 		}
 		pos = line.find(arg);
 		if (pos != std::string::npos && pos<2) {
-			line = read_line(infile);
+			line = (n+1<lines.size()) ? lines[n+1] : "";
 			break;
 		}
 	}
@@ -1275,9 +1257,8 @@ std::map<std::string,std::string > Frm2Retriever::extract_dictentry(std::ifstrea
 
 	std::map<std::string,std::string > result;
 	
-	reset_file(infile);
-	while (infile.good()) {
-		std::string line = read_line(infile);
+	for (unsigned int n=0; n<lines.size(); n++) {
+		std::string line = lines[n];
 		//std::cout << "current line: " << line << std::endl;	
 	
 		// eliminate whitespace at start of line
@@ -1384,7 +1365,7 @@ std::vector<std::string> Frm2Retriever::extract_column(ifstream &file, std::stri
 	std::string line = ""; // read_line(infile);
 
 	//std::cout << "datasection starts at line: " << data_section << std::endl;
-	skip_to_line(infile, cur_line, data_section+((from<0)?0:from)); 
+	skip_to_line(infile, line_offsets, cur_line, data_section+((from<0)?0:from)); 
 	//cout << endl << "counting headers: " << *(headers.begin()) << endl;	
 	
 	use_col_number = isNumber(col_name);
@@ -1415,27 +1396,15 @@ std::vector<std::string> Frm2Retriever::extract_column(ifstream &file, std::stri
 	
 
 //cout << endl << "pushing data.. [" << to << ","<< count<<"] error:"<< infile.good()<< endl;	
-	line = read_line(infile);
-	while ((infile.good()) && ((to>=0 && to<count) || (to<0))) {			
-		if (!isdata(line)) {
-			//std::cout << "NO DATA LINE:" << line << std::endl;
-			break;
-		}
+	const std::vector<std::vector<std::string> > &rows = data_rows(cur_line);
+	for (unsigned int r=0; r<rows.size() && ((to>=0 && to<count) || (to<0)); r++) {
 		try {
-			//std::cout << "transforming..." << std::endl;
-			std::vector<std::string> line_values = string_util::split_values(line);
-			/*for (std::vector<std::string>::iterator itt=line_values.begin(); itt!=line_values.end(); itt++) {
-				std::cout << "column------- vector: " << *itt << std::endl;
-			}*/
-			/*std::cout << endl << "pushing data: " << (string_util::str_to_float(string_values.at(index))) << std::endl;	
-			//double dbl_val = string_util::str_to_float(string_values.at(index));*/
-			values.push_back(line_values.at(index));
+			values.push_back(rows[r].at(index));
 		}
 		catch(...) {
 			cout << "exception in transforming column values " << endl;	
 		}
 		count++;
-		line = read_line(infile);
 	}
 	reset_file(infile);
 	return values;
@@ -1758,7 +1727,7 @@ std::vector<double> Frm2Retriever::extract_heidi_counts(ifstream &file, int entr
 	std::vector<double> values;
 	reset_file(infile);
 	int cur_line=0;
-	skip_to_line(infile, cur_line, data_section); 
+	skip_to_line(infile, line_offsets, cur_line, data_section); 
 // strategy: find datasection -> skip 3*entry_num lines -> read 8 param of first line -> 
 // n = number of scans -> read n 
 	std::string line = read_line(infile);
@@ -1864,7 +1833,7 @@ std::string Frm2Retriever::extract_data(std::ifstream &file, int entry_num, unsi
 	std::string line;
 
 	reset_file(infile);
-	skip_to_line(infile, cur_line, data_section);
+	skip_to_line(infile, line_offsets, cur_line, data_section);
 
 	line = read_line(infile);
 	std::vector<std::string> words = string_util::split_whitespace(line);
@@ -1904,7 +1873,7 @@ std::string Frm2Retriever::extract_heidiids(std::ifstream &file, int entry_num,
 	std::string line;
 
 	reset_file(infile);
-	skip_to_line(infile, cur_line, data_section);
+	skip_to_line(infile, line_offsets, cur_line, data_section);
 
 	line = read_line(infile);
 	std::vector<std::string> words = string_util::split_whitespace(line);
@@ -2000,6 +1969,38 @@ int Frm2Retriever::number_of_columns(std::string header_line) {
  * interpreting the string is left up to the implementing code.
  */
  
+/*
+ * Reads the file once, keeping each line as read_line() returns it and
+ * where it starts. The scans for entries go through the lines and
+ * skip_to_line() seeks to the offsets, instead of reading the file again.
+ */
+void Frm2Retriever::index_lines() {
+	reset_file(infile);
+	while (infile.good()) {
+		line_offsets.push_back(infile.tellg());
+		lines.push_back(read_line(infile));
+	}
+	reset_file(infile);
+}
+
+/*
+ * The values of the data lines from line start on, up to the first line
+ * which is not data. They are split when the first column is asked for
+ * and kept for the other columns.
+ */
+const std::vector<std::vector<std::string> >& Frm2Retriever::data_rows(int start) {
+	std::map<int, std::vector<std::vector<std::string> > >::iterator it = rows.find(start);
+	if (it != rows.end()) {
+		return it->second;
+	}
+	std::vector<std::vector<std::string> > &result = rows[start];
+	for (unsigned int n=start; n+1<lines.size() && isdata(lines[n]); n++) {
+		result.push_back(string_util::split_values(lines[n]));
+	}
+	return result;
+}
+
+
 Frm2Retriever::Frm2Retriever(const string &str): source(str),current_line(0){
   //cout << "Frm2Retriever(" << source << ")" << endl; // REMOVE
 
@@ -2013,6 +2014,7 @@ Frm2Retriever::Frm2Retriever(const string &str): source(str),current_line(0){
   }
 	
 	initUnits();
+	index_lines();
 
 	this->number_of_cols = 0;
 	this->number_of_entrys = 0;
@@ -2025,8 +2027,8 @@ Frm2Retriever::Frm2Retriever(const string &str): source(str),current_line(0){
 	std::string prev4_line="";
 	
  	//std::cout << "current line: " << line << std::endl;
-	while (infile.good())  {
-		line = read_line(infile);
+	for (unsigned int n=0; n<lines.size(); n++)  {
+		line = lines[n];
 		//std::cout << "current line: " << line << std::endl;
 		//std::cout << "prev1_line: " << prev1_line << std::endl;
 		//std::cout << "prev2_line: " << prev2_line << std::endl;
@@ -2056,16 +2058,14 @@ Frm2Retriever::Frm2Retriever(const string &str): source(str),current_line(0){
 
 	data_section = cur_line-2;
 	// check if we have a tof file ...
-	reset_file(infile);
 	cur_line=0;
-	while (infile.good()) {
-		line = read_line(infile);
+	for (unsigned int n=0; n<lines.size(); n++) {
+		line = lines[n];
 		int pos = line.find("aDetInfo");
 		if (pos != std::string::npos) {
 			//std::cout << "seems that we got a tof file" << std::endl;
 			data_section = cur_line+3;
-			read_line(infile);
-			extract_headers(read_line(infile));
+			extract_headers((n+2<lines.size()) ? lines[n+2] : "");
 			break;
 		}
 		cur_line++;
@@ -2073,11 +2073,10 @@ Frm2Retriever::Frm2Retriever(const string &str): source(str),current_line(0){
 
 	
 	// check if we have a heidi file ...
-	reset_file(infile);
 	cur_line=0;
 	std::string lastheader = "Omat";  	
-	while (infile.good()) {
-		line = read_line(infile);
+	for (unsigned int n=0; n<lines.size(); n++) {
+		line = lines[n];
 		if (string_util::contains(line, lastheader)) {
 			data_section = cur_line+3;
 			break;
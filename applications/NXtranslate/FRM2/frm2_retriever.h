@@ -34,6 +34,13 @@ protected:
   std::vector<std::string> detector_counts;
   std::vector<std::string> monitor_counts;
   
+  // the file as read once by index_lines()
+  std::vector<std::string> lines;
+  std::vector<std::streampos> line_offsets;
+  std::map<int, std::vector<std::vector<std::string> > > rows;
+  
+	void index_lines();
+	const std::vector<std::vector<std::string> >& data_rows(int start);
   
 	void extract_headers(std::string line);
 	void extract_toflogheaders(std::ifstream &file);
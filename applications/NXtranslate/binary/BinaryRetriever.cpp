@@ -8,6 +8,13 @@
 #include "binary/BinaryRetriever.hpp"
 #include "string_util.h"
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 using std::invalid_argument;
 using std::runtime_error;
 using std::string;
@@ -24,6 +31,8 @@ static const string myUINT32("UINT32");
 static const string myFLOAT32("FLOAT32");
 static const string myFLOAT64("FLOAT64");
 static const string myBYTE("BYTE");
+static const string myBIG("BIG");
+static const string myLITTLE("LITTLE");
 
 static const int NX_DEFAULT_TYPE=NX_UINT32;
 
@@ -37,22 +46,73 @@ static const int NX_DEFAULT_TYPE=NX_UINT32;
 static const string NAME("binary");
 
 /**
- * This is the constructor for the object. No resources are allocated.
+ * This is the constructor for the object. The file is not opened until
+ * data is first asked for.
  *
- * \param str The source string is ignored, but necessary to implement
- * the interface.
+ * \param source_file The file to read the data from.
  */
-BinaryRetriever::BinaryRetriever(const string &source_file): filename(source_file)
+BinaryRetriever::BinaryRetriever(const string &source_file): filename(source_file), opened(false), file_length(0), mapped(NULL)
 {
-  // there is nothing additional to allocate
+  // the file is opened by the first call to getData
 }
 
 /**
- * Since no resources were allocated, the destructor does nothing
+ * The destructor unmaps the file.
  */
 BinaryRetriever::~BinaryRetriever()
 {
-  // there is nothing to deallocate
+#ifndef _WIN32
+  if(mapped!=NULL)
+    {
+      munmap(mapped,file_length);
+    }
+#endif
+}
+
+/**
+ * Find the length of the file and map all of it, which is kept for the
+ * other locations read from the same file. Where the file cannot be
+ * mapped it is read with a stream instead.
+ */
+void BinaryRetriever::open()
+{
+  if(opened)
+    {
+      return;
+    }
+
+#ifndef _WIN32
+  int fd=::open(filename.c_str(),O_RDONLY);
+  if(fd<0)
+    {
+      throw runtime_error("Failed opening file");
+    }
+  struct stat info;
+  if(fstat(fd,&info)!=0)
+    {
+      close(fd);
+      throw runtime_error("Failed opening file");
+    }
+  file_length=static_cast<size_t>(info.st_size);
+  if(S_ISREG(info.st_mode) && file_length>0)
+    {
+      void *map=mmap(NULL,file_length,PROT_READ,MAP_PRIVATE,fd,0);
+      if(map!=MAP_FAILED)
+        {
+          mapped=static_cast<char *>(map);
+        }
+    }
+  close(fd);
+#else
+  std::ifstream data_file(filename.c_str(), std::ios::binary);
+  if(!(data_file.is_open()))
+    {
+      throw runtime_error("Failed opening file");
+    }
+  data_file.seekg(0,std::ios::end);
+  file_length=static_cast<size_t>(data_file.tellg());
+#endif
+  opened=true;
 }
 
 static size_t calculate_position(const vector<int> &file_size, 
@@ -68,11 +128,15 @@ static size_t calculate_position(const vector<int> &file_size,
   return result;
 }
 
+/**
+ * Move to the next position in the dimensions up to and including
+ * index, the later dimensions being read as one contiguous run.
+ */
 static bool increment_position(const vector<int> &offset,
                                const vector<int> &size,
-                               vector<int> &pos)
+                               vector<int> &pos,
+                               int index)
 {
-  int index=size.size()-2;
 
   while(index>=0){
     if(pos[index]+1<offset[index]+size[index])
@@ -147,9 +211,74 @@ static size_t getDataTypeSize(const int type){
   }
 }
 
+/**
+ * Whether the machine stores numbers little endian.
+ */
+static bool isLittleEndian(){
+  const unsigned short one=1;
+  return *reinterpret_cast<const unsigned char *>(&one)==1;
+}
+
+/**
+ * This function decides from the byte order in the location string
+ * whether the items must be swapped. Without a byte order they are
+ * taken as they are.
+ */
+static bool getSwap(const string &str_order){
+  if(str_order.empty()){
+    return false;
+  }else if(str_order==myBIG){
+    return isLittleEndian();
+  }else if(str_order==myLITTLE){
+    return !isLittleEndian();
+  }else{
+    throw invalid_argument("Invalid byte order: "+str_order);
+  }
+}
+
+/**
+ * Copy items while reversing the bytes of each, in one pass. The loops
+ * work on whole words so that compilers can vectorize them. The source
+ * may be the destination.
+ */
+static void swap_items(char *to, const char *from, const size_t num_items,
+                       const size_t item_size)
+{
+  if(item_size==2){
+    const uint16_t *in=reinterpret_cast<const uint16_t *>(from);
+    uint16_t *out=reinterpret_cast<uint16_t *>(to);
+    for( size_t i=0 ; i<num_items ; ++i ){
+      out[i]=static_cast<uint16_t>((in[i]>>8)|(in[i]<<8));
+    }
+  }else if(item_size==4){
+    const uint32_t *in=reinterpret_cast<const uint32_t *>(from);
+    uint32_t *out=reinterpret_cast<uint32_t *>(to);
+    for( size_t i=0 ; i<num_items ; ++i ){
+      uint32_t x=in[i];
+      out[i]=(x>>24)|((x>>8)&0x0000FF00u)|((x<<8)&0x00FF0000u)|(x<<24);
+    }
+  }else if(item_size==8){
+    const uint64_t *in=reinterpret_cast<const uint64_t *>(from);
+    uint64_t *out=reinterpret_cast<uint64_t *>(to);
+    for( size_t i=0 ; i<num_items ; ++i ){
+      uint64_t x=in[i];
+      uint64_t lo=x&0xFFFFFFFFu;
+      uint64_t hi=x>>32;
+      lo=(lo>>24)|((lo>>8)&0x0000FF00u)|((lo<<8)&0x00FF0000u)|((lo<<24)&0xFF000000u);
+      hi=(hi>>24)|((hi>>8)&0x0000FF00u)|((hi<<8)&0x00FF0000u)|((hi<<24)&0xFF000000u);
+      out[i]=(lo<<32)|hi;
+    }
+  }else if(to!=from){
+    memcpy(to,from,num_items*item_size);
+  }
+}
+
 /**
  * This is the method for retrieving data from a file. The string must
- * be of the form "type:offset,delta,number".
+ * be of the form "type:[file_size][start][size]", where the type is
+ * optional. A byte order of "BIG" or "LITTLE" may follow the type, as
+ * in "INT32:BIG:[file_size][start][size]", to swap the items where
+ * the machine differs.
  *
  * \param location is the string that is used by the retriever to
  * create the data.
@@ -163,17 +292,24 @@ void BinaryRetriever::getData(const string &location, tree<Node> &tr)
       throw invalid_argument("cannot parse empty string");
     }
 
-  // break the location string into a type and sizing information
+  // break the location string into a type, byte order and sizing information
   int type;
+  bool swap;
   string sizing;
   {
     vector<string> temp=string_util::split(location,":");
     if(temp.size()==1){
       type=getDataType("");
+      swap=getSwap("");
       sizing=location;
     }else if(temp.size()==2){
       type=getDataType(temp[0]);
+      swap=getSwap("");
       sizing=temp[1];
+    }else if(temp.size()==3){
+      type=getDataType(temp[0]);
+      swap=getSwap(temp[1]);
+      sizing=temp[2];
     }else{
       throw invalid_argument("can only specify one type in location string");
     }
@@ -205,6 +341,10 @@ void BinaryRetriever::getData(const string &location, tree<Node> &tr)
     {
       throw invalid_argument("All parts of the location string must be the same rank");
     }
+  if(rank<=0)
+    {
+      throw invalid_argument("the location string must have at least one dimension");
+    }
 
   // confirm that the size doesn't have a zero component
   for( size_t i=0 ; i<rank ; ++i )
@@ -245,85 +385,90 @@ void BinaryRetriever::getData(const string &location, tree<Node> &tr)
       dims[i]=size[i];
     }
 
-  // allocate the space for the result
+  // allocate the space for the result, which the reading sets all of
   void *data;
-  if(NXmalloc(&data,rank,&(dims[0]),type)!=NX_OK)
+  if(NXmallocex(&data,rank,&(dims[0]),type,NXMALLOC_NOINIT|NXMALLOC_HUGEPAGES)!=NX_OK)
     {
       throw runtime_error("NXmalloc failed");
     }
 
-  // prepare data buffer
   size_t data_size=getDataTypeSize(type);
-  /*
-  size_t num_items=1;
-  size_t buffer_size=num_items; // read a single element at a time
-  data_t data_buffer[buffer_size];
-  */
 
-  // open the file
-  std::ifstream data_file(filename.c_str(), std::ios::binary);
-  if(!(data_file.is_open()))
+  // open the file, the first time only, and check its size against claims
+  try
     {
-      throw runtime_error("Failed opening file");
+      this->open();
+      if(file_length!=tot_file_size*data_size)
+        {
+          throw runtime_error("Actual file size does not match claimed file size");
+        }
+    }
+  catch(...)
+    {
+      NXfree(&data);
+      throw;
     }
 
-  // check the file size against claims
-  {
-    data_file.seekg(0,std::ios::beg);
-    long begin=data_file.tellg();
-    data_file.seekg(0,std::ios::end);
-    long end=data_file.tellg();
-    if( (end-begin)!=(tot_file_size*data_size) )
-      {
-        throw runtime_error("Actual file size does not match claimed file size");
-      }
-  }
-
-  // number for the scalar version of the offset
-  size_t scalar_position;
-
-  // index into data array
-  size_t data_index=0;
-
-  // buffer to read data into
-  size_t num_items=*(size.rbegin());
+  // the dimensions after last are read whole, so the selection is read
+  // as contiguous runs which are as long as they can be
+  int last=rank-1;
+  while(last>0 && size[last]==file_size[last])
+    {
+      last--;
+    }
+  size_t num_items=size[last];
+  for( size_t i=last+1 ; i<rank ; ++i )
+    {
+      num_items*=file_size[i];
+    }
   size_t buffer_size=num_items*data_size;
-  std::vector<char>   data_buffer(buffer_size);
-
-  // push through the file grabbing the proper bits
-  scalar_position=data_size*calculate_position(file_size,pos);
-  data_file.seekg(scalar_position,std::ios::beg);
-  data_file.read(&(data_buffer[0]),buffer_size);
 
-  // copy into final array
-  memcpy((static_cast<char *>(data))+data_index*data_size,&(data_buffer[0]),buffer_size);
-  data_index+=num_items;
-
-  while(increment_position(start,size,pos))
+  // without a mapping the runs are read with a stream
+  std::ifstream data_file;
+  if(mapped==NULL)
     {
-      // calculate where to go and read in a block of data
-      scalar_position=data_size*calculate_position(file_size,pos);
-      data_file.seekg(scalar_position,std::ios::beg);
-      data_file.read(&(data_buffer[0]),buffer_size);
-      // copy into final array
-      memcpy((static_cast<char *>(data))+data_index*data_size,&(data_buffer[0]),buffer_size);
-      data_index+=num_items;
+      data_file.open(filename.c_str(), std::ios::binary);
+      if(!(data_file.is_open()))
+        {
+          NXfree(&data);
+          throw runtime_error("Failed opening file");
+        }
     }
 
-  // close the file
-  data_file.close();
+  // push through the file copying each run straight into the result
+  char *to=static_cast<char *>(data);
+  do
+    {
+      size_t scalar_position=data_size*calculate_position(file_size,pos);
+      if(mapped!=NULL)
+        {
+          if(swap)
+            swap_items(to,mapped+scalar_position,num_items,data_size);
+          else
+            memcpy(to,mapped+scalar_position,buffer_size);
+        }
+      else
+        {
+          data_file.seekg(scalar_position,std::ios::beg);
+          data_file.read(to,buffer_size);
+          if(!data_file)
+            {
+              NXfree(&data);
+              throw runtime_error("Failed reading file");
+            }
+          if(swap)
+            swap_items(to,to,num_items,data_size);
+        }
+      to+=buffer_size;
+    }
+  while(increment_position(start,size,pos,last-1));
 
-  // create the node - this copies the data
-  Node node=Node(NAME,data,rank,&(dims[0]),type);
+  // create the node - this hands the data over without copying it
+  Node node(NAME,"");
+  node.adopt_data(data,rank,&(dims[0]),type);
 
   // insert the data into the tree
   tr.insert(tr.begin(),node);
-
-  // delete the data
-  if(NXfree(&data)!=NX_OK)
-    {
-      throw runtime_error("NXfree failed");
-    }
 }
 
 /**
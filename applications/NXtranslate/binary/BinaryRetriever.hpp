@@ -16,7 +16,11 @@ class BinaryRetriever: public Retriever{
  private: // do not allow these automatically created functions to be called
   BinaryRetriever(const BinaryRetriever &other); //copy constructor
   BinaryRetriever& operator=(const BinaryRetriever &other);//operator "=" overloading
+  void open();
   std::string filename;
+  bool opened;        // the file was opened, and mapped if it could be
+  size_t file_length; // length of the file in bytes
+  char *mapped;       // the whole file mapped, or NULL
 };
 
 #endif
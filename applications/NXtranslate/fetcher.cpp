@@ -0,0 +1,266 @@
+#include <ctime>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <napiconfig.h>
+#include "fetcher.h"
+
+#if !defined(_WIN32) && HAVE_LIBPTHREAD
+#include <pthread.h>
+#include <sys/time.h>
+#define FETCHER_THREADS 1
+#endif
+
+using std::exception;
+using std::invalid_argument;
+using std::runtime_error;
+using std::string;
+using std::vector;
+
+// how many calls the threads may run ahead of the writing, per thread
+static const size_t WINDOW_PER_THREAD = 8;
+
+enum JobState { PENDING, RUNNING, DONE };
+enum JobError { FETCH_OK, FETCH_INVALID_ARGUMENT, FETCH_RUNTIME_ERROR,
+                FETCH_OTHER_ERROR };
+
+/*
+ * The threads only use the plain pointer to the retriever, as the
+ * reference count of Ptr is not safe to change from several threads.
+ */
+struct Fetcher::Job{
+  Ptr<Retriever> keep;
+  Retriever *retriever;
+  string location;
+  size_t index;
+  long previous; // the call before this one on the same retriever, or -1
+  JobState state;
+  JobError error;
+  string message;
+  tree<Node> result;
+};
+
+// thrown again for exceptions which are neither of the standard two
+class FetchError: public exception{
+ public:
+  FetchError(const string &message): message(message){}
+  ~FetchError() throw(){}
+  const char *what() const throw(){ return message.c_str(); }
+ private:
+  string message;
+};
+
+static double seconds(){
+#ifdef FETCHER_THREADS
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec * 1.e-6;
+#else
+  return static_cast<double>(clock()) / CLOCKS_PER_SEC;
+#endif
+}
+
+static void run(Fetcher::Job *job){
+  try{
+    job->retriever->getData(job->location, job->result);
+  }catch(invalid_argument &e){
+    job->error=FETCH_INVALID_ARGUMENT;
+    job->message=e.what();
+  }catch(runtime_error &e){
+    job->error=FETCH_RUNTIME_ERROR;
+    job->message=e.what();
+  }catch(exception &e){
+    job->error=FETCH_OTHER_ERROR;
+    job->message=e.what();
+  }
+}
+
+#ifdef FETCHER_THREADS
+struct Fetcher::Pool{
+  vector<Job *> *jobs;
+  size_t taken;   // jobs below this were taken or skipped
+  size_t window;
+  bool cancel;
+  double busy;
+  vector<pthread_t> threads;
+  pthread_mutex_t lock;
+  pthread_cond_t changed;
+};
+
+/*
+ * The first call in the window whose retriever is free, which is the
+ * case once the call before it on the same retriever is done.
+ */
+static Fetcher::Job *next_job(Fetcher::Pool *pool){
+  vector<Fetcher::Job *> &jobs=*(pool->jobs);
+  size_t end=pool->taken+pool->window;
+  if(end>jobs.size())
+    end=jobs.size();
+  for( size_t i=pool->taken ; i<end ; i++ ){
+    Fetcher::Job *job=jobs[i];
+    if(job->state==PENDING
+       && (job->previous<0 || jobs[job->previous]->state==DONE))
+      return job;
+  }
+  return NULL;
+}
+
+static void *worker(void *arg){
+  Fetcher::Pool *pool=static_cast<Fetcher::Pool *>(arg);
+
+  pthread_mutex_lock(&pool->lock);
+  for(;;){
+    Fetcher::Job *job=NULL;
+    while(!pool->cancel && (job=next_job(pool))==NULL)
+      pthread_cond_wait(&pool->changed,&pool->lock);
+    if(pool->cancel)
+      break;
+    job->state=RUNNING;
+    pthread_mutex_unlock(&pool->lock);
+
+    double start=seconds();
+    run(job);
+    double elapsed=seconds()-start;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->busy+=elapsed;
+    job->state=DONE;
+    if(job->index<pool->taken) // skipped while it ran
+      job->result.clear();
+    pthread_cond_broadcast(&pool->changed);
+  }
+  pthread_mutex_unlock(&pool->lock);
+  return NULL;
+}
+#else
+struct Fetcher::Pool{
+};
+#endif
+
+Fetcher::Fetcher(): pool(NULL), retrieved(0.), waited(0.){
+}
+
+Fetcher::~Fetcher(){
+#ifdef FETCHER_THREADS
+  if(pool!=NULL){
+    pthread_mutex_lock(&pool->lock);
+    pool->cancel=true;
+    pthread_cond_broadcast(&pool->changed);
+    pthread_mutex_unlock(&pool->lock);
+    for( size_t i=0 ; i<pool->threads.size() ; i++ )
+      pthread_join(pool->threads[i],NULL);
+    pthread_cond_destroy(&pool->changed);
+    pthread_mutex_destroy(&pool->lock);
+  }
+#endif
+  delete pool;
+  for( size_t i=0 ; i<jobs.size() ; i++ )
+    delete jobs[i];
+}
+
+size_t Fetcher::add(const Ptr<Retriever> &retriever, const string &location){
+  Job *job=new Job;
+  job->keep=retriever;
+  job->retriever=&(*retriever);
+  job->location=location;
+  job->index=jobs.size();
+  job->previous=-1;
+  for( size_t i=jobs.size() ; i>0 ; i-- ){
+    if(jobs[i-1]->retriever==job->retriever){
+      job->previous=static_cast<long>(i-1);
+      break;
+    }
+  }
+  job->state=PENDING;
+  job->error=FETCH_OK;
+  jobs.push_back(job);
+  return jobs.size()-1;
+}
+
+void Fetcher::start(int threads){
+#ifdef FETCHER_THREADS
+  if(threads<2 || jobs.empty() || pool!=NULL)
+    return;
+  pool=new Pool;
+  pool->jobs=&jobs;
+  pool->taken=0;
+  pool->window=WINDOW_PER_THREAD*threads;
+  pool->cancel=false;
+  pool->busy=0.;
+  pthread_mutex_init(&pool->lock,NULL);
+  pthread_cond_init(&pool->changed,NULL);
+  for( int i=0 ; i<threads ; i++ ){
+    pthread_t thread;
+    if(pthread_create(&thread,NULL,worker,pool)==0)
+      pool->threads.push_back(thread);
+  }
+#endif
+}
+
+void Fetcher::take(size_t job, tree<Node> &tree){
+  Job *current=jobs[job];
+#ifdef FETCHER_THREADS
+  if(pool!=NULL && !pool->threads.empty()){
+    double start=seconds();
+    pthread_mutex_lock(&pool->lock);
+    while(current->state!=DONE)
+      pthread_cond_wait(&pool->changed,&pool->lock);
+    pool->taken=job+1;
+    pthread_cond_broadcast(&pool->changed);
+    pthread_mutex_unlock(&pool->lock);
+    waited+=seconds()-start;
+  }
+#endif
+  if(current->state!=DONE){
+    double start=seconds();
+    run(current);
+    retrieved+=seconds()-start;
+    current->state=DONE;
+  }
+
+  tree=current->result;
+  current->result.clear();
+  switch(current->error){
+  case FETCH_INVALID_ARGUMENT:
+    throw invalid_argument(current->message);
+  case FETCH_RUNTIME_ERROR:
+    throw runtime_error(current->message);
+  case FETCH_OTHER_ERROR:
+    throw FetchError(current->message);
+  default:
+    break;
+  }
+}
+
+void Fetcher::skip(size_t job){
+  Job *current=jobs[job];
+#ifdef FETCHER_THREADS
+  if(pool!=NULL){
+    pthread_mutex_lock(&pool->lock);
+    if(current->state==PENDING)
+      current->state=DONE;
+    pool->taken=job+1;
+    pthread_cond_broadcast(&pool->changed);
+    pthread_mutex_unlock(&pool->lock);
+    return;
+  }
+#endif
+  current->state=DONE;
+}
+
+double Fetcher::retrieving() const{
+  double result=retrieved;
+#ifdef FETCHER_THREADS
+  if(pool!=NULL){
+    pthread_mutex_lock(&pool->lock);
+    result+=pool->busy;
+    pthread_mutex_unlock(&pool->lock);
+  }
+#endif
+  return result;
+}
+
+double Fetcher::waiting() const{
+  return waited;
+}
@@ -0,0 +1,65 @@
+#ifndef __FETCHER_H_GUARD
+#define __FETCHER_H_GUARD
+
+#include <string>
+#include <vector>
+#include "node.h"
+#include "retriever.h"
+#include "tree.hh"
+#include "Ptr.h"
+
+/**
+ * Runs the Retriever::getData calls of a translation file on a pool of
+ * threads, ahead of the writing of the output file. The calls of one
+ * retriever are made one at a time and in document order, as retrievers
+ * keep state between calls; calls of different retrievers run at the same
+ * time. The results are taken in document order, and the pool never runs
+ * more than a window of calls ahead of them, which bounds the memory.
+ */
+class Fetcher{
+ public:
+  /**
+   * Add a call to make. Returns the number by which its result is taken.
+   */
+  size_t add(const Ptr<Retriever> &retriever, const std::string &location);
+
+  /**
+   * Start the threads. Without thread support the calls are made as
+   * their results are taken.
+   */
+  void start(int threads);
+
+  /**
+   * Wait for the result of a call. Exceptions thrown by the retriever are
+   * thrown again here, with the same type and message.
+   */
+  void take(size_t job, tree<Node> &tree);
+
+  /**
+   * Skip the result of a call, which is not made if it has not started.
+   */
+  void skip(size_t job);
+
+  /**
+   * Seconds spent in the retrievers, summed over the threads, and seconds
+   * spent waiting for them in take.
+   */
+  double retrieving() const;
+  double waiting() const;
+
+  Fetcher();
+  ~Fetcher();
+
+  struct Job;
+  struct Pool;
+
+ private:
+  Fetcher(const Fetcher &);
+  Fetcher &operator=(const Fetcher &);
+
+  std::vector<Job *> jobs;
+  Pool *pool;
+  double retrieved;
+  double waited;
+};
+#endif
@@ -223,17 +223,11 @@ void LoopyRetriever::getData(const string &location, tree<Node> &tr)
                  dims[0]);
     }
 
-  // create the node - this copies the data
-  Node node=Node(NAME,data,1,dims,int_type);
+  // create the node - this hands the data over without copying it
+  Node node(NAME,"");
+  node.adopt_data(data,1,dims,int_type);
   // insert the data into the tree
   tr.insert(tr.begin(),node);
-
-  // delete the data
-  if(NXfree(&data)!=NX_OK)
-    {
-      throw runtime_error("NXfree failed");
-    }
-
 }
 
 /**
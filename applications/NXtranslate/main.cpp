@@ -8,6 +8,7 @@
 #include <napi.h>
 #include "string_util.h"
 #include <cstdio>
+#include <cstdlib>
 
 using std::cout;
 using std::endl;
@@ -24,6 +25,7 @@ typedef struct{
   NXaccess base;
   bool append;
   bool timing;
+  int threads;
   std::map<string,string> map;
 }Options;
 
@@ -101,6 +103,8 @@ static void print_help(const string &progname, int level){
 #endif
   cout << "  -D <macro>   Specify a macro. The macro should be in the form of\n"
        << "               \"FILE=old_nexus.nxs\". The \"=\" is required." << endl;
+  cout << "  --threads <n> Call the retrievers on n threads ahead of writing\n"
+       << "               the file. The default is 1, which does not." << endl;
 #ifdef USE_TIMING
   cout << "  --timing     Print out timing information for the execution of the program." << endl;
 #endif
@@ -114,6 +118,7 @@ int main(int argc, char *argv[]){
   options.base=NXACC_CREATE;
   options.append=false;
   options.timing=false;
+  options.threads=1;
 
   // parse the command line options (i=0 is the program name
   for( int i=1 ; i<argc ; i++ ){
@@ -160,6 +165,17 @@ int main(int argc, char *argv[]){
       }
       string key=split(arg1);
       options.map.insert(make_pair(key,arg1));
+    }else if(starts_with(arg1,"--threads")){
+      trim_arg(arg1,"--threads");
+      if(arg1.size()<=0){
+        arg1=arg2;
+        i++;
+      }
+      options.threads=atoi(arg1.c_str());
+      if(options.threads<1){
+        print_help(argv[0],0);
+        exit(-1);
+      }
     }else if(starts_with(arg1, "--timing")) {
       options.timing = true;
 #ifdef HDF4
@@ -223,7 +239,7 @@ int main(int argc, char *argv[]){
 
   // parse the file
   bool result=xml_parser::parse_xml_file(options.map,options.infile,&handle,
-                                         options.timing);
+                                         options.timing,options.threads);
 
   // close the output file
   NXclose(&handle);
@@ -112,13 +112,16 @@ static void getDataNode(NXhandle *handle, string &name, Node &node){
   if(NXgetinfo(*handle,&rank,dims,&type)!=NX_OK)
     throw runtime_error("NXgetinfo failed");
 
-  // allocate space for the data
+  // allocate space for the data, which the node takes over without
+  // copying it
   void *data;
   if(NXmalloc(&data,rank,dims,type)!=NX_OK)
     throw runtime_error("NXmalloc failed");
+  node.set_name(name);
+  node.adopt_data(data,rank,dims,type);
 
   // retrieve data from the file
-  if(NXgetdata(*handle,data)!=NX_OK)
+  if(NXgetdata(*handle,node.data())!=NX_OK)
     throw runtime_error("NXgetdata failed");
 
   // retrieve attributes from the file
@@ -146,15 +149,7 @@ static void getDataNode(NXhandle *handle, string &name, Node &node){
     attrs.push_back(my_attr);
   }
 
-  // create the data
-  node=Node(name,data,rank,dims,type);
-  //node.set_name(name);
-  //node.set_data(data,rank,dims,type);
   node.set_attrs(attrs);
-
-  // free the temporary data
-  if(NXfree(&data)!=NX_OK)
-    throw runtime_error("NXfree failed");
 }
 
 void get_subtree(NXhandle *handle, NodeTree &tree, NodeTree::pre_order_iterator parent, string &name){
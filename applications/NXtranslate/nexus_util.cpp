@@ -139,14 +139,11 @@ extern void nexus_util::make_data(NXhandle *handle, const Node& node){
   for( int i=0 ; i<node.num_attr() ; i++ )
     add_attribute(handle,node,i);
 
-  // put in the data
-  void *data(NULL);
-  node.copy_data(data);
-  if(data==NULL)
+  // put in the data straight from the node
+  if(node.data()==NULL)
     throw runtime_error("CANNOT ADD NULL DATA");// << std::endl;
-  if(NXputdata(*handle,data)!=NX_OK)
+  if(NXputdata(*handle,node.data())!=NX_OK)
     throw runtime_error("NXputdata failed");
-  NXfree(&data);
 }
 
 static void recurse_make_data(NXhandle *handle, const TreeNode &tree, const TreeNode::sibling_iterator &begin, const TreeNode::sibling_iterator &end){
@@ -43,6 +43,27 @@ static string convert_type(int type){
     throw runtime_error("Did not understand type in set_data");
 }
 
+/*
+ * The reference count is changed atomically where possible, as nodes
+ * which the retrievers keep are copied on the threads of the Fetcher
+ * while the writing thread lets go of earlier copies.
+ */
+static void ref_increment(size_t *count){
+#if defined(__GNUC__)
+  __sync_add_and_fetch(count,1);
+#else
+  (*count)++;
+#endif
+}
+
+static size_t ref_decrement(size_t *count){
+#if defined(__GNUC__)
+  return __sync_sub_and_fetch(count,1);
+#else
+  return --(*count);
+#endif
+}
+
 // ==================== Node implementation
 Node::Node(const std::string &name, const std::string &type):__name(name),__type(type),_value(NULL),__comp_type(COMP_NONE),__ref_count(new size_t(1)){
   // determine if this is data
@@ -55,67 +76,52 @@ Node::Node(const std::string &name, const std::string &type):__name(name),__type
 }
 
 Node::Node(const Node &old): __name(old.__name), __type(old.__type), __is_data(old.__is_data), __dims(old.__dims), _value(old._value), __attrs(old.__attrs), __comp_type(old.__comp_type), __ref_count(old.__ref_count){
-  (*__ref_count)++;
+  ref_increment(__ref_count);
   //std::cout << "Node(" << __name << ")" << std::endl; // REMOVE
 }
 
-Node::Node(const string &name, void * data, const int rank, const int* dims, const int type): __name(name), __is_data(true), __comp_type(COMP_NONE), __ref_count(new size_t(1)){
+Node::Node(const string &name, void * data, const int rank, const int* dims, const int type): __name(name), __is_data(true), _value(NULL), __comp_type(COMP_NONE), __ref_count(new size_t(1)){
   this->set_data(data,rank,dims,type);
 }
 
 Node& Node::operator=(const Node &old){
   if(this==&old) return *this;
 
-  // delete the old value (if necessary)
-  (*__ref_count)--;
-  if( (__is_data) && (*__ref_count==0) && (_value!=NULL) )
-    NXfree(&_value);
+  // share the value with the other node before letting go of the old one
+  ref_increment(old.__ref_count);
+  this->release();
+  _value=old._value;
+  __ref_count=old.__ref_count;
 
-  // copy everything except the value
+  // copy everything else
   __name=old.__name;
   __type=old.__type;
   __is_data=old.__is_data;
-  __dims.clear();
-  __dims.insert(__dims.begin(),old.__dims.begin(),old.__dims.end());
-  __attrs.clear();
-  __attrs.insert(__attrs.begin(),old.__attrs.begin(),old.__attrs.end());
+  __dims=old.__dims;
+  __attrs=old.__attrs;
   __comp_type=old.__comp_type;
-  __ref_count=new size_t(1);
-  _value=NULL;
-
-
-  // copy the value
-  if(__is_data){
-    int rank=__dims.size();
-    int dims[NX_MAXRANK];
-    for( int i=0 ; i<rank ; i++ )
-      dims[i]=__dims[i];
-    int type=this->int_type();
-
-    // allocate space for the data
-    NXmalloc(&_value,rank,dims,type);
-
-    // determine how much to copy
-    size_t size=nexus_util::calc_size(rank,dims,type);
-
-    // copy the array
-    memcpy(_value,old._value,size);
-  }
 
   return *this;
 }
 
 Node::~Node(){
   //std::cout << "~Node(" << __name << "," << *__ref_count << ")" << std::endl; // REMOVE
-  (*__ref_count)--;
-  if(*__ref_count==0){
+  this->release();
+}
+
+/*
+ * Let go of the value, which is freed if no other node refers to it.
+ */
+void Node::release(){
+  if(ref_decrement(__ref_count)==0){
     if(_value!=NULL){
       if(NXfree(&_value)!=NX_OK)
         throw runtime_error("NXfree failed in destructor");
-      _value=NULL;
     }
     delete __ref_count;
   }
+  _value=NULL;
+  __ref_count=NULL;
 }
 
 const string Node::name() const{
@@ -196,7 +202,7 @@ void Node::copy_data(void *&data)const{
 
 
   // allocate space for the data
-  NXmalloc(&data,int_rank,my_dims,type);
+  NXmallocex(&data,int_rank,my_dims,type,NXMALLOC_NOINIT);
 
   // determine how much to copy
   size_t size=nexus_util::calc_size(int_rank,my_dims,type);
@@ -248,26 +254,40 @@ const void Node::set_name(const string &name){
 }
 
 const void Node::set_data(void *&data,const int irank, const int* dims,const int type){
-  // copy the dimensions
-  __dims.clear();
+  convert_type(type); // throws before anything is allocated
+
   int my_dims[NX_MAXRANK];
-  for( int i=0 ; i<irank ; i++ ){
-    __dims.push_back(dims[i]);
+  for( int i=0 ; i<irank ; i++ )
     my_dims[i]=dims[i];
-  }
-
-  // copy the type
-  /* __type=str_type; */
-  __type=convert_type(type);
 
   // allocate space for the data
-  NXmalloc(&_value,irank,my_dims,type);
+  void *value=NULL;
+  NXmallocex(&value,irank,my_dims,type,NXMALLOC_NOINIT);
 
   // determine how much to copy
   size_t size=nexus_util::calc_size(irank,my_dims,type);
 
   // copy the array
-  memcpy(_value,data,size);
+  memcpy(value,data,size);
+
+  this->adopt_data(value,irank,dims,type);
+}
+
+const void Node::adopt_data(void *&data,const int irank, const int* dims,const int type){
+  // copy the type
+  /* __type=str_type; */
+  __type=convert_type(type);
+
+  // copy the dimensions
+  __dims.clear();
+  for( int i=0 ; i<irank ; i++ )
+    __dims.push_back(dims[i]);
+
+  // other nodes sharing the old value keep it
+  this->release();
+  __ref_count=new size_t(1);
+  _value=data;
+  data=NULL;
 
   // set that this is a data
   __is_data=true;
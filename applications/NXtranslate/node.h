@@ -24,7 +24,7 @@ class Node{
   Node(const std::string &name, void * data, const int rank, const int* dims, const int type);
   Node(const Node &); // copies share reference to the data
   ~Node();
-  Node& operator=(const Node &); // asignment operator
+  Node& operator=(const Node &); // assignment shares the data as well
 
   // accesor methods
   const std::string name() const;
@@ -44,12 +44,16 @@ class Node{
   const void set_comp(const std::string &comp_type);
   const void set_name(const std::string &name);
   const void set_data(void *&data,const int rank,const int* dims,const int type);
+  // take over data allocated with NXmalloc rather than copying it, data is
+  // set to NULL
+  const void adopt_data(void *&data,const int rank,const int* dims,const int type);
   const void set_attrs(const std::vector<Attr> &attrs);
   const void update_attrs(std::vector<Attr> &attrs);
   const void update_dims(std::vector<int> &dims);
 
  private:
   const void update_attr(Attr &attr);
+  void release();
 
   std::string __name;
   std::string __type;
@@ -1,4 +1,16 @@
 #include "retriever.hpp"
+#include <cstring>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if !defined(_WIN32) && HAVE_LIBPTHREAD
+#include <pthread.h>
+#define SNS_THREADS 1
+#endif
 
 #define SWAP_ENDIAN  //triger the swapping endian subroutine (if needed)
 
@@ -9,6 +21,23 @@ using std::string;
 using std::cout;
 using std::endl;
 using std::vector;
+
+//bytes of the binary file mapped at a time while loading it, which bounds
+//the pages of the file held in memory next to the histogram
+static const size_t LOAD_WINDOW = 16*1024*1024;
+
+//number of elements of the histogram
+static inline size_t array_size (vector<int> & GlobalArray)
+{
+  return static_cast<size_t>(GlobalArray[0])*GlobalArray[1]*GlobalArray[2];
+}
+
+//the number with its bytes in the reverse order, written with unsigned
+//shifts that compilers turn into byte swap and shuffle instructions
+static inline unsigned int swapped (unsigned int x)
+{
+  return (x>>24) | ((x>>8) & 0x0000FF00) | ((x<<8) & 0x00FF0000) | (x<<24);
+}
    
 /*********************************
 /SnsHistogramRetriever constructor
@@ -125,18 +154,30 @@ void SnsHistogramRetriever::getData(const string &location, tree<Node> &tr)
       GlobalArraySize *= GlobalArray[i];
     }
   
-  binary_type * BinaryArray = new binary_type [GlobalArraySize];
-  
-  //transfer the data from the binary file into the GlobalArray
-  fread(&BinaryArray[0],sizeof(BinaryArray[0]), GlobalArraySize, BinaryFile);
-  
-  //swap endian if necessary
-#ifdef SWAP_ENDIAN
+  //the histogram is read from the start of the file on every call, which
+  //sets all of it, so it is not cleared first
+  void * Buffer = NULL;
+  if (NXmallocex(&Buffer,
+                 static_cast<int>(GlobalArray.size()),
+                 &(GlobalArray[0]),
+                 NX_INT32,
+                 NXMALLOC_NOINIT | NXMALLOC_HUGEPAGES) != NX_OK)
+    throw runtime_error("Could not allocate the histogram of "+source);
+  binary_type * BinaryArray = static_cast<binary_type *>(Buffer);
+
+  //transfer the data from the binary file into the GlobalArray,
+  //swapping endian if necessary
+  try
+    {
+      load_binary (BinaryFile, source, BinaryArray,
+                   static_cast<size_t>(GlobalArraySize));
+    }
+  catch (...)
+    {
+      NXfree(&Buffer);
+      throw;
+    }
 
-  swap_endian (GlobalArray, BinaryArray);
-  
-#endif  //SWAP_ENDIAN
-  
   //Calculate arrays according to definition
   calculate_array(GrpPriority,
                   InverseDef, 
@@ -387,88 +428,64 @@ void calculate_array (vector<int> & GrpPriority,
       ArraySizeGlobal *= GlobalArray[i];
     }
   
-  //Allocate memory for each grp
-  binary_type **MyGrpArray;
-  MyGrpArray = new binary_type*[GrpPriority.size()];
-
-  for (int i=0 ; i<GrpPriority.size() ; ++i)
-    {
-      MyGrpArray[i]=new binary_type[ArraySizeGlobal];
-      InitializeArray(MyGrpArray[i], GlobalArray);
-    }
-
-  //Allocate memory for the final array created
-  void * NewArray;
   int rank=3;
   std::vector<int> dims(GlobalArray.size());
   for (int j=0 ; j< GlobalArray.size() ; ++j)
     {
       dims[j]=GlobalArray[j];
     }
-  
-  //  int dims[]={3,10,5};
-  NXmalloc(&NewArray,rank,&(dims[0]),NX_INT32);
-  
-  //make an array for each group
+
+  //Allocate memory for each grp, with NXmalloc as the one left at the
+  //end becomes the data of the node. Every group sets all of its array,
+  //so none is cleared here; when everything is wanted the array read
+  //from the file is the group array itself
+  binary_type **MyGrpArray;
+  MyGrpArray = new binary_type*[GrpPriority.size()];
+  std::vector<void *> GrpArrays(GrpPriority.size());
+
   for (int i=0 ; i<GrpPriority.size() ; ++i)
     {
-      
-      if (Tag[i]=="pixelID") 
+      if (Tag[i]=="*")
         {
-          MakeArray_pixelID(MyGrpArray[i],
-                            BinaryArray,
-                            i,
-                            InverseDef[i], 
-                            Def, 
-                            LocalArray, 
-                            GlobalArray, 
-                            GrpPara);
+          GrpArrays[i]=BinaryArray;
         }
-      else if (Tag[i]=="pixelX")
+      else if (NXmallocex(&(GrpArrays[i]),rank,&(dims[0]),NX_INT32,
+                          NXMALLOC_NOINIT | NXMALLOC_HUGEPAGES) != NX_OK)
         {
-          MakeArray_pixelX(MyGrpArray[i],
-                           BinaryArray,
-                           i,
-                           InverseDef[i], 
-                           Def, 
-                           LocalArray, 
-                           GlobalArray, 
-                           GrpPara);
-        }
-      else if (Tag[i]=="pixelY")
-        {
-          
-          MakeArray_pixelY(MyGrpArray[i],
-                           BinaryArray,
-                           i,
-                           InverseDef[i], 
-                           Def, 
-                           LocalArray, 
-                           GlobalArray, 
-                           GrpPara);
-        }
-      else if (Tag[i]=="Tbin")
-        {
-          MakeArray_Tbin(MyGrpArray[i],
-                         BinaryArray,
-                         i,
-                         InverseDef[i], 
-                         Def, 
-                         LocalArray, 
-                         GlobalArray, 
-                         GrpPara);
-        }
-      else if (Tag[i]=="*")
-        {
-          MakeArray_Everything(MyGrpArray[i],
-                               BinaryArray, 
-                               LocalArray, 
-                               GlobalArray);
+          //let go of the arrays taken so far and of the binary array,
+          //which is otherwise freed below
+          for (int j=0 ; j<i ; ++j)
+            {
+              if (GrpArrays[j] != BinaryArray)
+                {
+                  NXfree(&(GrpArrays[j]));
+                }
+            }
+          void * Buffer = BinaryArray;
+          NXfree(&Buffer);
+          delete[] MyGrpArray;
+          throw runtime_error("Could not allocate the array of group "+Tag[i]);
         }
+      MyGrpArray[i]=static_cast<binary_type *>(GrpArrays[i]);
     }
   
-  //free memory of binary array 
-  delete[] BinaryArray;    
+  //make an array for each group
+  MakeArray_Groups(MyGrpArray,
+                   BinaryArray,
+                   static_cast<int>(GrpPriority.size()),
+                   InverseDef,
+                   Tag,
+                   Def,
+                   LocalArray,
+                   GlobalArray,
+                   GrpPara);
+  
+  //free memory of binary array, unless it is the array of a group
+  if (Tag[0]!="*")
+    {
+      void * Buffer = BinaryArray;
+      NXfree(&Buffer);
+    }
   
   //calculate the final Array according to all the parameters 
   //retrieved in the rest of the code 
@@ -481,20 +498,239 @@ void calculate_array (vector<int> & GrpPriority,
                   Ope, 
                   GrpPara);
  
-  NewArray = MyGrpArray[0];
+  //the final array is handed over to the node without copying it,
+  //the arrays of the other groups are freed
+  void * NewArray = MyGrpArray[0];
   
   delete[] MyGrpArray;  
+
+  for (int i=0 ; i<GrpArrays.size() ; ++i)
+    {
+      if (GrpArrays[i] != NewArray)
+        {
+          NXfree(&(GrpArrays[i]));
+        }
+    }
   
   //write into nexus file
-  Node node("New Array from string location",NewArray,rank,&(dims[0]),NX_INT32);
+  Node node("New Array from string location","");
+  node.adopt_data(NewArray,rank,&(dims[0]),NX_INT32);
   
   tr.insert(tr.begin(),node);   
   
-  NXfree(&NewArray);
-  
   return;  
 }
 
+/**
+ * \brief This function calculates the array of one group according to
+ * its definition tag
+ *
+ * \param MyGrpArray (OUTPUT) is the array of the group
+ * \param BinaryArray (INPUT) is the array coming from the binary file
+ * \param grp_number (INPUT) is the group index
+ * \param InverseDef (INPUT) is the list of inverse flags of the groups
+ * \param Tag (INPUT) is the list of the tag_names
+ * \param Def (INPUT) is the list of the tag_definitions
+ * \param LocalArray (INPUT) ??? not used ???
+ * \param GlobalArray (INPUT) is the list of parameters of the global
+ * declaration part
+ * \param GrpPara (INPUT) is the list of parameters of the groups
+ */
+void MakeArray_Group (binary_type * MyGrpArray,
+                      binary_type * BinaryArray,
+                      int grp_number,
+                      vector<int> & InverseDef,
+                      vector<string> & Tag,
+                      vector<string> & Def,
+                      vector<int> & LocalArray,
+                      vector<int> & GlobalArray,
+                      vector<Grp_parameters> & GrpPara)
+{
+  int i = grp_number;
+
+  if (Tag[i]=="pixelID") 
+    {
+      MakeArray_pixelID(MyGrpArray,
+                        BinaryArray,
+                        i,
+                        InverseDef[i], 
+                        Def, 
+                        LocalArray, 
+                        GlobalArray, 
+                        GrpPara);
+    }
+  else if (Tag[i]=="pixelX")
+    {
+      MakeArray_pixelX(MyGrpArray,
+                       BinaryArray,
+                       i,
+                       InverseDef[i], 
+                       Def, 
+                       LocalArray, 
+                       GlobalArray, 
+                       GrpPara);
+    }
+  else if (Tag[i]=="pixelY")
+    {
+      MakeArray_pixelY(MyGrpArray,
+                       BinaryArray,
+                       i,
+                       InverseDef[i], 
+                       Def, 
+                       LocalArray, 
+                       GlobalArray, 
+                       GrpPara);
+    }
+  else if (Tag[i]=="Tbin")
+    {
+      MakeArray_Tbin(MyGrpArray,
+                     BinaryArray,
+                     i,
+                     InverseDef[i], 
+                     Def, 
+                     LocalArray, 
+                     GlobalArray, 
+                     GrpPara);
+    }
+  else if (Tag[i]=="*")
+    {
+      MakeArray_Everything(MyGrpArray,
+                           BinaryArray, 
+                           LocalArray, 
+                           GlobalArray);
+    }
+  else
+    {
+      //unknown tags leave an empty array, as they always did
+      InitializeArray(MyGrpArray, GlobalArray);
+    }
+  return;
+}
+
+#ifdef SNS_THREADS
+//the groups still to make, shared by the threads making them
+struct GrpQueue
+{
+  binary_type ** MyGrpArray;
+  binary_type * BinaryArray;
+  int GrpNumber;
+  int next;
+  pthread_mutex_t lock;
+  vector<int> * InverseDef;
+  vector<string> * Tag;
+  vector<string> * Def;
+  vector<int> * LocalArray;
+  vector<int> * GlobalArray;
+  vector<Grp_parameters> * GrpPara;
+};
+
+static void * MakeArray_Worker (void * arg)
+{
+  GrpQueue * queue = static_cast<GrpQueue *>(arg);
+
+  for (;;)
+    {
+      pthread_mutex_lock(&queue->lock);
+      int i = queue->next++;
+      pthread_mutex_unlock(&queue->lock);
+      if (i >= queue->GrpNumber)
+        break;
+      MakeArray_Group(queue->MyGrpArray[i],
+                      queue->BinaryArray,
+                      i,
+                      *(queue->InverseDef),
+                      *(queue->Tag),
+                      *(queue->Def),
+                      *(queue->LocalArray),
+                      *(queue->GlobalArray),
+                      *(queue->GrpPara));
+    }
+  return NULL;
+}
+#endif //SNS_THREADS
+
+/**
+ * \brief This function calculates the array of every group. The groups
+ * only read the binary array and each writes its own array, so they are
+ * made on as many threads as there are processors, up to one per group
+ *
+ * \param MyGrpArray (OUTPUT) are the arrays of each group
+ * \param BinaryArray (INPUT) is the array coming from the binary file
+ * \param GrpNumber (INPUT) is the number of groups
+ * \param InverseDef (INPUT) is the list of inverse flags of the groups
+ * \param Tag (INPUT) is the list of the tag_names
+ * \param Def (INPUT) is the list of the tag_definitions
+ * \param LocalArray (INPUT) ??? not used ???
+ * \param GlobalArray (INPUT) is the list of parameters of the global
+ * declaration part
+ * \param GrpPara (INPUT) is the list of parameters of the groups
+ */
+void MakeArray_Groups (binary_type ** MyGrpArray,
+                       binary_type * BinaryArray,
+                       int GrpNumber,
+                       vector<int> & InverseDef,
+                       vector<string> & Tag,
+                       vector<string> & Def,
+                       vector<int> & LocalArray,
+                       vector<int> & GlobalArray,
+                       vector<Grp_parameters> & GrpPara)
+{
+  int first = 0;
+
+#ifdef SNS_THREADS
+  long processors = sysconf(_SC_NPROCESSORS_ONLN);
+  int threads = GrpNumber;
+  if (processors > 0 && processors < threads)
+    threads = static_cast<int>(processors);
+
+  if (threads > 1)
+    {
+      GrpQueue queue;
+      queue.MyGrpArray = MyGrpArray;
+      queue.BinaryArray = BinaryArray;
+      queue.GrpNumber = GrpNumber;
+      queue.next = 0;
+      queue.InverseDef = &InverseDef;
+      queue.Tag = &Tag;
+      queue.Def = &Def;
+      queue.LocalArray = &LocalArray;
+      queue.GlobalArray = &GlobalArray;
+      queue.GrpPara = &GrpPara;
+      pthread_mutex_init(&queue.lock, NULL);
+
+      //the calling thread makes groups too
+      vector<pthread_t> workers;
+      for (int i=1 ; i<threads ; ++i)
+        {
+          pthread_t thread;
+          if (pthread_create(&thread, NULL, MakeArray_Worker, &queue) == 0)
+            workers.push_back(thread);
+        }
+      MakeArray_Worker(&queue);
+      for (size_t i=0 ; i<workers.size() ; ++i)
+        {
+          pthread_join(workers[i], NULL);
+        }
+      pthread_mutex_destroy(&queue.lock);
+      first = GrpNumber;
+    }
+#endif //SNS_THREADS
+
+  for (int i=first ; i<GrpNumber ; ++i)
+    {
+      MakeArray_Group(MyGrpArray[i],
+                      BinaryArray,
+                      i,
+                      InverseDef,
+                      Tag,
+                      Def,
+                      LocalArray,
+                      GlobalArray,
+                      GrpPara);
+    }
+  return;
+}
+
 /**
  * \brief This function determines the highest priority of all the groups.
  * A group is a set of operation, can be a loop or a list of identifiers
@@ -799,18 +1035,10 @@ void  MakeArray_Everything (binary_type* MyGrpArray,
                             vector<int> & LocalArray, 
                             vector<int> & GlobalArray)
 {
-  for (int y=0 ; y<GlobalArray[0] ; ++y)
+  if (MyGrpArray != BinaryArray)
     {
-      for (int x=0; x<GlobalArray[1] ; ++x)
-        {
-          for (int tbin=0;tbin<GlobalArray[2];++tbin)
-            {
-              MyGrpArray[(x*GlobalArray[2]+tbin)+\
-                         (y*GlobalArray[2]*GlobalArray[1])]=
-                BinaryArray[(x*GlobalArray[2]+tbin)+\
-                            (y*GlobalArray[2]*GlobalArray[1])];
-            }	     
-        }
+      memcpy(MyGrpArray, BinaryArray,
+             array_size(GlobalArray)*sizeof(binary_type));
     }
   return ;
 }
@@ -834,48 +1062,49 @@ void DoCalculation (binary_type * GrpArray1,
                     vector<int> & GlobalArray, 
                     vector<Grp_parameters> & GrpPara)
 {
+  size_t size = array_size(GlobalArray);
+  size_t j = 0;
   string OR="OR";
   
+  //both merges select with masks of all ones or all zeros instead of
+  //branches, four numbers at a time, so that the compiler can vectorize
+  //them
   if (Operator[0] == OR[0])
     {
-      for (int y=0 ; y<GlobalArray[0] ; ++y)
+      //keep the first array where it is set, else take the second one
+      for ( ; j+4<=size ; j+=4)
         {
-          for (int x=0 ; x<GlobalArray[1] ; ++x)
-            { 
-              for (int tbin=0;tbin<GlobalArray[2];tbin++)
-                {	  
-                  if ((GrpArray1[(x*GlobalArray[2]+tbin)+
-                                 (y*GlobalArray[2]*GlobalArray[1])]==0)&&
-                      (GrpArray2[(x*GlobalArray[2]+tbin)+
-                                 (y*GlobalArray[2]*GlobalArray[1])]!=0))
-                    {
-                      GrpArray1[(x*GlobalArray[2]+tbin)+
-                                (y*GlobalArray[2]*GlobalArray[1])]=
-                        GrpArray2[(x*GlobalArray[2]+tbin)+
-                                  (y*GlobalArray[2]*GlobalArray[1])];
-                    }
-                }
-            }
+          binary_type a0 = GrpArray1[j], a1 = GrpArray1[j+1];
+          binary_type a2 = GrpArray1[j+2], a3 = GrpArray1[j+3];
+          binary_type b0 = GrpArray2[j], b1 = GrpArray2[j+1];
+          binary_type b2 = GrpArray2[j+2], b3 = GrpArray2[j+3];
+          GrpArray1[j] = a0 | (b0 & -(a0 == 0));
+          GrpArray1[j+1] = a1 | (b1 & -(a1 == 0));
+          GrpArray1[j+2] = a2 | (b2 & -(a2 == 0));
+          GrpArray1[j+3] = a3 | (b3 & -(a3 == 0));
+        }
+      for ( ; j<size ; ++j)
+        {
+          GrpArray1[j] = GrpArray1[j] | (GrpArray2[j] & -(GrpArray1[j] == 0));
         }
     }
   else
     {
-      for (int y=0 ; y<GlobalArray[0] ; ++y)
+      //keep the first array where both agree, else clear it
+      for ( ; j+4<=size ; j+=4)
         {
-          for (int x=0 ; x<GlobalArray[1]; ++x)
-            {
-              for (int tbin=0 ; tbin<GlobalArray[2] ; ++tbin)
-                {
-                  if (GrpArray2[(x*GlobalArray[2]+tbin)+
-                                (y*GlobalArray[2]*GlobalArray[1])]!=
-                      GrpArray1[(x*GlobalArray[2]+tbin)+
-                                (y*GlobalArray[2]*GlobalArray[1])])
-                    {
-                      GrpArray1[(x*GlobalArray[2]+tbin)+
-                                (y*GlobalArray[2]*GlobalArray[1])]=0;
-                    }	     
-                }
-            }
+          binary_type a0 = GrpArray1[j], a1 = GrpArray1[j+1];
+          binary_type a2 = GrpArray1[j+2], a3 = GrpArray1[j+3];
+          binary_type b0 = GrpArray2[j], b1 = GrpArray2[j+1];
+          binary_type b2 = GrpArray2[j+2], b3 = GrpArray2[j+3];
+          GrpArray1[j] = a0 & -(a0 == b0);
+          GrpArray1[j+1] = a1 & -(a1 == b1);
+          GrpArray1[j+2] = a2 & -(a2 == b2);
+          GrpArray1[j+3] = a3 & -(a3 == b3);
+        }
+      for ( ; j<size ; ++j)
+        {
+          GrpArray1[j] = GrpArray1[j] & -(GrpArray1[j] == GrpArray2[j]);
         }
     }
   return;
@@ -888,10 +1117,7 @@ void DoCalculation (binary_type * GrpArray1,
  */
 inline void endian_swap (binary_type & x)
 {
-  x = ((x>>24) & 0x000000FF) |
-    ((x<<8) & 0x00FF0000) |
-    ((x>>8) & 0x0000FF00) |
-    ((x<<24) & 0xFF000000);
+  x = static_cast<binary_type>(swapped(static_cast<unsigned int>(x)));
 }
 
 /**
@@ -903,17 +1129,7 @@ inline void endian_swap (binary_type & x)
 void InitializeArray(binary_type * MyGrpArray, 
                      vector<int> & GlobalArray)
 {
-  for (int a=0 ; a<GlobalArray[1] ; ++a)
-    {
-      for (int b=0 ; b<GlobalArray[0] ; ++b)
-	{
-	  for (int c=0 ; c<GlobalArray[2] ; ++c)
-	    {
-	      MyGrpArray[c+b*GlobalArray[1]*
-                         GlobalArray[2]+a*GlobalArray[2]]=0;
-	    }
-	}
-    }  
+  memset(MyGrpArray, 0, array_size(GlobalArray)*sizeof(binary_type));
   return;   
 }
 
@@ -933,20 +1149,13 @@ void InversePixelIDLoop (binary_type * MyGrpArray,
                          vector<Grp_parameters> & GrpPara, 
                          int grp_number)
 {
-  for (int i=0 ; i<GlobalArray[0]*GlobalArray[1] ; ++i)
-    {
-      for (int k=0 ; k<GlobalArray[2] ; ++k)
-        {
-          MyGrpArray[i*GlobalArray[2]+k]=BinaryArray[i*GlobalArray[2]+k];
-        }
-    }
+  size_t tbins = GlobalArray[2];
+  
+  memcpy(MyGrpArray, BinaryArray, array_size(GlobalArray)*sizeof(binary_type));
   for (int i=GrpPara[grp_number].init;i<=GrpPara[grp_number].last;i=
          i+GrpPara[grp_number].increment)
     {
-      for (int tbin=0 ; tbin < GlobalArray[2] ; ++tbin)
-        {
-          MyGrpArray[i*GlobalArray[2]+tbin]=0;
-        }
+      memset(MyGrpArray+i*tbins, 0, tbins*sizeof(binary_type));
     }
   return;
 }
@@ -967,15 +1176,15 @@ void PixelIDLoop (binary_type * MyGrpArray,
                   vector<Grp_parameters> & GrpPara, 
                   int grp_number)
 {
+  size_t tbins = GlobalArray[2];
+  
+  InitializeArray(MyGrpArray, GlobalArray);
   for (int i=GrpPara[grp_number].init;
        i<=GrpPara[grp_number].last;
        i=i+GrpPara[grp_number].increment)
     {
-      for (int tbin=0 ; tbin < GlobalArray[2] ; ++tbin)
-        {
-          MyGrpArray[i*GlobalArray[2]+tbin]=
-            BinaryArray[i*GlobalArray[2]+tbin];
-        }
+      memcpy(MyGrpArray+i*tbins, BinaryArray+i*tbins,
+             tbins*sizeof(binary_type));
     }
   return;
 }
@@ -996,19 +1205,13 @@ void InversePixelIDList (binary_type * MyGrpArray,
                          vector<Grp_parameters> & GrpPara, 
                          int grp_number)
 {
-  for (int i=0 ; i<GlobalArray[0]*GlobalArray[1] ; ++i)
-    {
-      for (int k=0 ; k<GlobalArray[2] ; ++k)
-        {
-          MyGrpArray[i*GlobalArray[2]+k]=BinaryArray[i*GlobalArray[2]+k];
-        }
-    }
+  size_t tbins = GlobalArray[2];
+  
+  memcpy(MyGrpArray, BinaryArray, array_size(GlobalArray)*sizeof(binary_type));
   for (int j=0 ; j<GrpPara[grp_number].value.size() ; ++j)
     {
-      for (int tbin=0 ; tbin < GlobalArray[2] ; ++tbin)
-        {
-          MyGrpArray[GrpPara[grp_number].value[j]*GlobalArray[2]+tbin]=0;
-        }
+      memset(MyGrpArray+GrpPara[grp_number].value[j]*tbins, 0,
+             tbins*sizeof(binary_type));
     }
   return;
 }
@@ -1029,13 +1232,13 @@ void PixelIDList (binary_type * MyGrpArray,
                   vector<Grp_parameters> & GrpPara, 
                   int grp_number)
 {
+  size_t tbins = GlobalArray[2];
+  
+  InitializeArray(MyGrpArray, GlobalArray);
   for (int j=0 ; j<GrpPara[grp_number].value.size() ; ++j)
     {
-      for (int tbin=0 ; tbin < GlobalArray[2] ; ++tbin)
-        {
-          MyGrpArray[GrpPara[grp_number].value[j]*GlobalArray[2]+tbin]=
-            BinaryArray[GrpPara[grp_number].value[j]*GlobalArray[2]+tbin];
-        }
+      size_t start = GrpPara[grp_number].value[j]*tbins;
+      memcpy(MyGrpArray+start, BinaryArray+start, tbins*sizeof(binary_type));
     }
   return;
 }
@@ -1056,24 +1259,17 @@ void InversePixelXLoop (binary_type * MyGrpArray,
                         vector<Grp_parameters> & GrpPara, 
                         int grp_number)
 {
-  for (int i=0 ; i<GlobalArray[0]*GlobalArray[1] ; ++i)
-    {
-      for (int k=0 ; k<GlobalArray[2] ; ++k)
-        {
-          MyGrpArray[i*GlobalArray[2]+k]=BinaryArray[i*GlobalArray[2]+k];
-        }
-    }
+  size_t tbins = GlobalArray[2];
+  size_t plane = GlobalArray[1]*tbins;
+  
+  memcpy(MyGrpArray, BinaryArray, array_size(GlobalArray)*sizeof(binary_type));
   for (int y=0 ; y<GlobalArray[0] ; ++y)
     {
       for (int x = GrpPara[grp_number].init; 
            x <= GrpPara[grp_number].last; 
            x = x + GrpPara[grp_number].increment)
         {
-          for (int tbin=0 ; tbin < GlobalArray[2] ; ++tbin)
-            {
-              MyGrpArray[(x*GlobalArray[2]+tbin)+
-                         (y*GlobalArray[2]*GlobalArray[1])]=0;
-            }
+          memset(MyGrpArray+(y*plane+x*tbins), 0, tbins*sizeof(binary_type));
         } 
     }
   return;
@@ -1095,19 +1291,19 @@ void PixelXLoop (binary_type * MyGrpArray,
                  vector<Grp_parameters> & GrpPara, 
                  int grp_number)
 {
+  size_t tbins = GlobalArray[2];
+  size_t plane = GlobalArray[1]*tbins;
+  
+  InitializeArray(MyGrpArray, GlobalArray);
   for (int y=0 ; y<GlobalArray[0] ; ++y)
     {
       for (int x = GrpPara[grp_number].init; 
            x <= GrpPara[grp_number].last; 
            x = x + GrpPara[grp_number].increment)
         {
-          for (int tbin=0 ; tbin<GlobalArray[2] ; ++tbin)
-            {
-              MyGrpArray[(x*GlobalArray[2]+tbin)+
-                         (y*GlobalArray[2]*GlobalArray[1])]=
-                BinaryArray[(x*GlobalArray[2]+tbin)+
-                            (y*GlobalArray[2]*GlobalArray[1])];
-            }
+          size_t start = y*plane+x*tbins;
+          memcpy(MyGrpArray+start, BinaryArray+start,
+                 tbins*sizeof(binary_type));
         } 
     }
   return;
@@ -1129,22 +1325,16 @@ void InversePixelXList (binary_type * MyGrpArray,
                         vector<Grp_parameters> & GrpPara, 
                         int grp_number)
 {
-  for (int i=0 ; i<GlobalArray[0]*GlobalArray[1] ; ++i)
-    {
-      for (int k=0 ; k<GlobalArray[2]; ++k)
-        {
-          MyGrpArray[i*GlobalArray[2]+k]=BinaryArray[i*GlobalArray[2]+k];
-        }
-    }
+  size_t tbins = GlobalArray[2];
+  size_t plane = GlobalArray[1]*tbins;
+  
+  memcpy(MyGrpArray, BinaryArray, array_size(GlobalArray)*sizeof(binary_type));
   for (int y=0 ; y<GlobalArray[0] ; ++y)
     {
       for (int x=0 ; x<GrpPara[grp_number].value.size() ; ++x)
         {
-          for (int tbin=0 ; tbin<GlobalArray[2] ; ++tbin)
-            {
-              MyGrpArray[(GrpPara[grp_number].value[x]*GlobalArray[2]+tbin)+
-                         (y*GlobalArray[2]*GlobalArray[1])]=0;
-            }
+          memset(MyGrpArray+(y*plane+GrpPara[grp_number].value[x]*tbins), 0,
+                 tbins*sizeof(binary_type));
         }
     }
   return;
@@ -1166,17 +1356,17 @@ void PixelXList (binary_type * MyGrpArray,
                  vector<Grp_parameters> & GrpPara, 
                  int grp_number)
 {
+  size_t tbins = GlobalArray[2];
+  size_t plane = GlobalArray[1]*tbins;
+  
+  InitializeArray(MyGrpArray, GlobalArray);
   for (int y=0 ; y<GlobalArray[0] ; ++y)
     {
       for (int x=0 ; x<GrpPara[grp_number].value.size() ; ++x)
         {
-          for (int tbin=0 ; tbin<GlobalArray[2] ; ++tbin)
-            {
-              MyGrpArray[(GrpPara[grp_number].value[x]*GlobalArray[2]+tbin)+
-                         (y*GlobalArray[2]*GlobalArray[1])]=
-                BinaryArray[(GrpPara[grp_number].value[x]*GlobalArray[2]+tbin)+
-                            (y*GlobalArray[2]*GlobalArray[1])];
-            }
+          size_t start = y*plane+GrpPara[grp_number].value[x]*tbins;
+          memcpy(MyGrpArray+start, BinaryArray+start,
+                 tbins*sizeof(binary_type));
         }
     }
   return;
@@ -1198,25 +1388,14 @@ void InversePixelYLoop (binary_type * MyGrpArray,
                         vector<Grp_parameters> & GrpPara, 
                         int grp_number) 
 {
-  for (int i=0 ; i<GlobalArray[0]*GlobalArray[1] ; ++i)
-    {
-      for (int k=0 ; k<GlobalArray[2] ; ++k)
-        {
-          MyGrpArray[i*GlobalArray[2]+k]=BinaryArray[i*GlobalArray[2]+k];
-        }
-    }
+  size_t plane = GlobalArray[1]*static_cast<size_t>(GlobalArray[2]);
+  
+  memcpy(MyGrpArray, BinaryArray, array_size(GlobalArray)*sizeof(binary_type));
   for (int y=GrpPara[grp_number].init; 
        y<=GrpPara[grp_number].last; 
        y=y + GrpPara[grp_number].increment)
     {
-      for (int x=0; x<GlobalArray[1] ; ++x)
-        {
-          for (int tbin=0; tbin<GlobalArray[2] ; ++tbin)
-            {
-              MyGrpArray[(x*GlobalArray[2]+tbin)+
-                         (y*GlobalArray[2]*GlobalArray[1])]=0;
-            }
-        } 
+      memset(MyGrpArray+y*plane, 0, plane*sizeof(binary_type));
     }
   return;
 }
@@ -1237,20 +1416,15 @@ void PixelYLoop  (binary_type * MyGrpArray,
                   vector<Grp_parameters> & GrpPara, 
                   int grp_number) 
 {
+  size_t plane = GlobalArray[1]*static_cast<size_t>(GlobalArray[2]);
+  
+  InitializeArray(MyGrpArray, GlobalArray);
   for (int y=GrpPara[grp_number].init; 
        y<=GrpPara[grp_number].last; 
        y=y + GrpPara[grp_number].increment)
     {
-      for (int x=0 ; x<GlobalArray[1] ; ++x)
-        {
-          for (int tbin=0; tbin<GlobalArray[2] ; ++tbin)
-            {
-              MyGrpArray[(x*GlobalArray[2]+tbin)+
-                         (y*GlobalArray[2]*GlobalArray[1])]=
-                BinaryArray[(x*GlobalArray[2]+tbin)+
-                            (y*GlobalArray[2]*GlobalArray[1])];
-            }
-        } 
+      memcpy(MyGrpArray+y*plane, BinaryArray+y*plane,
+             plane*sizeof(binary_type));
     }
   return;
 }
@@ -1271,24 +1445,13 @@ void InversePixelYList (binary_type * MyGrpArray,
                         vector<Grp_parameters> & GrpPara, 
                         int grp_number) 
 {
-  for (int i=0 ; i<GlobalArray[0]*GlobalArray[1] ; ++i)
-    {
-      for (int k=0 ; k<GlobalArray[2] ; ++k)
-        {
-          MyGrpArray[i*GlobalArray[2]+k]=BinaryArray[i*GlobalArray[2]+k];
-        }
-    }
+  size_t plane = GlobalArray[1]*static_cast<size_t>(GlobalArray[2]);
+  
+  memcpy(MyGrpArray, BinaryArray, array_size(GlobalArray)*sizeof(binary_type));
   for (int y=0 ; y<GrpPara[grp_number].value.size() ; ++y)
     {
-      for (int x=0 ; x<GlobalArray[1] ; ++x)
-        {
-          for (int tbin=0 ; tbin<GlobalArray[2] ; ++tbin)
-            {
-              MyGrpArray[(x*GlobalArray[2]+tbin)+
-                         (GrpPara[grp_number].value[y]*
-                          GlobalArray[2]*GlobalArray[1])]=0;
-            }
-        }
+      memset(MyGrpArray+GrpPara[grp_number].value[y]*plane, 0,
+             plane*sizeof(binary_type));
     } 
   return;
 }
@@ -1309,20 +1472,13 @@ void PixelYList (binary_type * MyGrpArray,
                  vector<Grp_parameters> & GrpPara, 
                  int grp_number) 
 {
+  size_t plane = GlobalArray[1]*static_cast<size_t>(GlobalArray[2]);
+  
+  InitializeArray(MyGrpArray, GlobalArray);
   for (int y=0 ; y<GrpPara[grp_number].value.size() ; ++y)
     {
-      for (int x=0; x<GlobalArray[1] ;++x)
-        {
-          for (int tbin=0 ; tbin<GlobalArray[2] ; ++tbin)
-	    {
-	      MyGrpArray[(x*GlobalArray[2]+tbin)+
-                         (GrpPara[grp_number].value[y]*
-                          GlobalArray[2]*GlobalArray[1])]= 
-                BinaryArray[(x*GlobalArray[2]+tbin)+
-                            (GrpPara[grp_number].value[y]*
-                             GlobalArray[2]*GlobalArray[1])];
-	    }
-        }
+      size_t start = GrpPara[grp_number].value[y]*plane;
+      memcpy(MyGrpArray+start, BinaryArray+start, plane*sizeof(binary_type));
     }
   return;
 }
@@ -1343,25 +1499,32 @@ void InverseTbinLoop (binary_type * MyGrpArray,
                       vector<Grp_parameters> & GrpPara, 
                       int grp_number) 
 {
-  for (int i=0 ; i<GlobalArray[0]*GlobalArray[1] ; ++i)
+  size_t tbins = GlobalArray[2];
+  size_t rows = GlobalArray[0]*static_cast<size_t>(GlobalArray[1]);
+  Grp_parameters & para = GrpPara[grp_number];
+  
+  memcpy(MyGrpArray, BinaryArray, array_size(GlobalArray)*sizeof(binary_type));
+  for (size_t row=0 ; row<rows ; ++row)
     {
-      for (int k=0 ; k<GlobalArray[2] ; ++k)
+      binary_type * out = MyGrpArray+row*tbins;
+      
+      if (para.increment == 1)   //a single range of each row
         {
-          MyGrpArray[i*GlobalArray[2]+k]=BinaryArray[i*GlobalArray[2]+k];
+          if (para.last >= para.init)
+            {
+              memset(out+para.init, 0,
+                     (para.last-para.init+1)*sizeof(binary_type));
+            }
         }
-    }
-  for (int y=0 ; y<GlobalArray[0] ; ++y )
-    {
-      for (int x=0 ; x<GlobalArray[1] ; ++x)
+      else
         {
-          for (int tbin=GrpPara[grp_number].init; 
-               tbin <= GrpPara[grp_number].last; 
-               tbin = tbin + GrpPara[grp_number].increment)
+          for (int tbin=para.init; 
+               tbin <= para.last; 
+               tbin = tbin + para.increment)
             {
-              MyGrpArray[(x*GlobalArray[2]+tbin)+
-                         (y*GlobalArray[2]*GlobalArray[1])]=0;
+              out[tbin]=0;
             }
-        } 
+        }
     }
   return;
 }
@@ -1382,20 +1545,42 @@ void TbinLoop (binary_type * MyGrpArray,
                vector<Grp_parameters> & GrpPara, 
                int grp_number) 
 {
-  for (int y=0 ; y<GlobalArray[0] ; ++y )
+  size_t tbins = GlobalArray[2];
+  size_t rows = GlobalArray[0]*static_cast<size_t>(GlobalArray[1]);
+  Grp_parameters & para = GrpPara[grp_number];
+  
+  if (para.increment == 1 && para.init >= 0 && para.init <= para.last &&
+      para.last < GlobalArray[2])
     {
-      for (int x=0; x<GlobalArray[1] ; ++x)
+      //a single range of each row, so each row is written once
+      size_t before = para.init;
+      size_t length = para.last-para.init+1;
+      size_t after = tbins-before-length;
+      
+      for (size_t row=0 ; row<rows ; ++row)
         {
-          for (int tbin=GrpPara[grp_number].init; 
-               tbin <= GrpPara[grp_number].last;
-               tbin = tbin + GrpPara[grp_number].increment)
-            {
-              MyGrpArray[(x*GlobalArray[2]+tbin)+
-                         (y*GlobalArray[2]*GlobalArray[1])]=
-                BinaryArray[(x*GlobalArray[2]+tbin)+
-                            (y*GlobalArray[2]*GlobalArray[1])];
-            }
-        } 
+          binary_type * out = MyGrpArray+row*tbins;
+          binary_type * in = BinaryArray+row*tbins;
+          
+          memset(out, 0, before*sizeof(binary_type));
+          memcpy(out+before, in+before, length*sizeof(binary_type));
+          memset(out+before+length, 0, after*sizeof(binary_type));
+        }
+      return;
+    }
+  
+  InitializeArray(MyGrpArray, GlobalArray);
+  for (size_t row=0 ; row<rows ; ++row)
+    {
+      binary_type * out = MyGrpArray+row*tbins;
+      binary_type * in = BinaryArray+row*tbins;
+      
+      for (int tbin=para.init; 
+           tbin <= para.last;
+           tbin = tbin + para.increment)
+        {
+          out[tbin]=in[tbin];
+        }
     }
   return;
 }
@@ -1416,22 +1601,17 @@ void InverseTbinList  (binary_type * MyGrpArray,
                        vector<Grp_parameters> & GrpPara, 
                        int grp_number) 
 {
-  for (int i=0 ; i<GlobalArray[0]*GlobalArray[1] ; ++i)
-    {
-      for (int k=0 ; k<GlobalArray[2] ; ++k)
-        {
-          MyGrpArray[i*GlobalArray[2]+k]=BinaryArray[i*GlobalArray[2]+k];
-        }
-    }
-  for (int y=0 ; y<GlobalArray[0] ; ++y)
+  size_t tbins = GlobalArray[2];
+  size_t rows = GlobalArray[0]*static_cast<size_t>(GlobalArray[1]);
+  vector<int> & value = GrpPara[grp_number].value;
+  
+  memcpy(MyGrpArray, BinaryArray, array_size(GlobalArray)*sizeof(binary_type));
+  for (size_t row=0 ; row<rows ; ++row)
     {
-      for (int x=0 ; x<GlobalArray[1] ; ++x)
+      binary_type * out = MyGrpArray+row*tbins;
+      for (int tbin=0 ; tbin<value.size() ; ++tbin)
         {
-          for (int tbin=0 ; tbin<GrpPara[grp_number].value.size() ; ++tbin)
-            {
-              MyGrpArray[(x*GlobalArray[2]+GrpPara[grp_number].value[tbin])+
-                         y*GlobalArray[2]*GlobalArray[1]]=0;
-            }
+          out[value[tbin]]=0;
         }
     } 
   return;
@@ -1453,17 +1633,18 @@ void TbinList (binary_type * MyGrpArray,
                vector<Grp_parameters> & GrpPara, 
                int grp_number) 
 {
-  for (int y=0 ; y<GlobalArray[0] ; ++y)
+  size_t tbins = GlobalArray[2];
+  size_t rows = GlobalArray[0]*static_cast<size_t>(GlobalArray[1]);
+  vector<int> & value = GrpPara[grp_number].value;
+  
+  InitializeArray(MyGrpArray, GlobalArray);
+  for (size_t row=0 ; row<rows ; ++row)
     {
-      for (int x=0 ; x<GlobalArray[1] ; ++x)
+      binary_type * out = MyGrpArray+row*tbins;
+      binary_type * in = BinaryArray+row*tbins;
+      for (int tbin=0 ; tbin<value.size() ; tbin++)
         {
-          for (int tbin=0 ; tbin<GrpPara[grp_number].value.size() ; tbin++)
-            {
-              MyGrpArray[(x*GlobalArray[2]+GrpPara[grp_number].value[tbin])+
-                         y*GlobalArray[2]*GlobalArray[1]]= 
-		BinaryArray[(x*GlobalArray[2]+GrpPara[grp_number].value[tbin])+
-                            y*GlobalArray[2]*GlobalArray[1]];
-            }
+          out[value[tbin]]=in[value[tbin]];
         }
     }
   return;
@@ -1678,9 +1859,107 @@ void check_want_everything (vector<string> & decla_def,
 void swap_endian (vector<int> & GlobalArray, 
                  binary_type * BinaryArray)
 {
-  for (int j=0 ; j<GlobalArray[1]*GlobalArray[2]*GlobalArray[0] ; ++j)
+  copy_endian (BinaryArray, BinaryArray, array_size(GlobalArray));
+  return;
+}
+
+/**
+ * \brief This function copies numbers, swapping their endians if necessary.
+ * The numbers are swapped four at a time, so that the compiler vectorizes
+ * the loop
+ *
+ * \param Destination (OUTPUT) is where to copy the numbers to
+ * \param Source (INPUT) is where to copy the numbers from, which may be
+ * the destination
+ * \param count (INPUT) is how many numbers to copy
+ */
+void copy_endian (binary_type * Destination, 
+                  const binary_type * Source, 
+                  size_t count)
+{
+#ifdef SWAP_ENDIAN
+  const unsigned int * in = reinterpret_cast<const unsigned int *>(Source);
+  unsigned int * out = reinterpret_cast<unsigned int *>(Destination);
+  
+  size_t j = 0;
+  
+  for ( ; j+4<=count ; j+=4)
     {
-      endian_swap(BinaryArray[j]);
-    } 
+      unsigned int x0 = in[j], x1 = in[j+1], x2 = in[j+2], x3 = in[j+3];
+      out[j] = swapped(x0);
+      out[j+1] = swapped(x1);
+      out[j+2] = swapped(x2);
+      out[j+3] = swapped(x3);
+    }
+  for ( ; j<count ; ++j)
+    {
+      out[j] = swapped(in[j]);
+    }
+#else
+  if (Destination != Source)
+    {
+      memcpy(Destination, Source, count*sizeof(binary_type));
+    }
+#endif  //SWAP_ENDIAN
+  return;
+}
+
+/**
+ * \brief This function loads the histogram from the start of the binary
+ * file. The file is mapped a window at a time and swapped straight into
+ * the array, without reading it into a buffer first; where it cannot be
+ * mapped it is read and swapped in place
+ *
+ * \param BinaryFile (INPUT) is the binary file
+ * \param source (INPUT) is the name of the binary file, for errors
+ * \param BinaryArray (OUTPUT) is the array to load the histogram into
+ * \param count (INPUT) is the number of elements of the histogram
+ */
+void load_binary (FILE * BinaryFile, 
+                  const string & source, 
+                  binary_type * BinaryArray, 
+                  size_t count)
+{
+  size_t bytes = count*sizeof(binary_type);
+  size_t offset = 0;
+  
+#ifndef _WIN32
+  int fd = fileno(BinaryFile);
+  struct stat info;
+  
+  if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode))
+    {
+      if (static_cast<size_t>(info.st_size) < bytes)
+        throw runtime_error("File "+source+" is smaller than the histogram");
+      
+      while (offset < bytes)
+        {
+          size_t length = std::min(LOAD_WINDOW, bytes-offset);
+          void * window = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd,
+                               static_cast<off_t>(offset));
+          if (window == MAP_FAILED)
+            break;
+          madvise(window, length, MADV_SEQUENTIAL);
+          copy_endian(BinaryArray+offset/sizeof(binary_type),
+                      static_cast<const binary_type *>(window),
+                      length/sizeof(binary_type));
+          munmap(window, length);
+          offset += length;
+        }
+    }
+#endif //_WIN32
+  
+  if (offset < bytes)
+    {
+      //pipes cannot seek, but are read from their start anyway
+      if ((fseek(BinaryFile, static_cast<long>(offset), SEEK_SET) != 0 &&
+           offset > 0) ||
+          fread(BinaryArray+offset/sizeof(binary_type), 1, bytes-offset,
+                BinaryFile) != bytes-offset)
+        throw runtime_error("Could not read the histogram from "+source);
+      copy_endian(BinaryArray+offset/sizeof(binary_type),
+                  BinaryArray+offset/sizeof(binary_type),
+                  (bytes-offset)/sizeof(binary_type));
+    }
   return;
 }
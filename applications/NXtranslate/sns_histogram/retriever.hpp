@@ -118,6 +118,58 @@ void calculate_array (vector<int> & GrpPriority,
                       vector<int> & LocalArray, 
                       vector<int> & GlobalArray, 
                       vector<Grp_parameters> & GrpPara);  
+
+/**
+ * \brief This function calculates the array of one group according to
+ * its definition tag
+ *
+ * \param MyGrpArray (OUTPUT) is the array of the group
+ * \param BinaryArray (INPUT) is the array coming from the binary file
+ * \param grp_number (INPUT) is the group index
+ * \param InverseDef (INPUT) is the list of inverse flags of the groups
+ * \param Tag (INPUT) is the list of the tag_names
+ * \param Def (INPUT) is the list of the tag_definitions
+ * \param LocalArray (INPUT) ??? not used ???
+ * \param GlobalArray (INPUT) is the list of parameters of the global
+ * declaration part
+ * \param GrpPara (INPUT) is the list of parameters of the groups
+ */
+void MakeArray_Group (binary_type * MyGrpArray,
+                      binary_type * BinaryArray,
+                      int grp_number,
+                      vector<int> & InverseDef,
+                      vector<string> & Tag,
+                      vector<string> & Def,
+                      vector<int> & LocalArray,
+                      vector<int> & GlobalArray,
+                      vector<Grp_parameters> & GrpPara);
+
+/**
+ * \brief This function calculates the array of every group. The groups
+ * only read the binary array and each writes its own array, so they are
+ * made on as many threads as there are processors, up to one per group
+ *
+ * \param MyGrpArray (OUTPUT) are the arrays of each group
+ * \param BinaryArray (INPUT) is the array coming from the binary file
+ * \param GrpNumber (INPUT) is the number of groups
+ * \param InverseDef (INPUT) is the list of inverse flags of the groups
+ * \param Tag (INPUT) is the list of the tag_names
+ * \param Def (INPUT) is the list of the tag_definitions
+ * \param LocalArray (INPUT) ??? not used ???
+ * \param GlobalArray (INPUT) is the list of parameters of the global
+ * declaration part
+ * \param GrpPara (INPUT) is the list of parameters of the groups
+ */
+void MakeArray_Groups (binary_type ** MyGrpArray,
+                       binary_type * BinaryArray,
+                       int GrpNumber,
+                       vector<int> & InverseDef,
+                       vector<string> & Tag,
+                       vector<string> & Def,
+                       vector<int> & LocalArray,
+                       vector<int> & GlobalArray,
+                       vector<Grp_parameters> & GrpPara);
+
 /**
  * \brief This function calculates the array if the definition tag is PixelID
  *
@@ -603,3 +655,29 @@ void check_want_everything (vector<string> & DeclaDef,
  */
 void swap_endian (vector<int> & GlobalArray, 
                   binary_type * BinaryArray);
+
+/**
+ * \brief This function copies numbers, swapping their endians if necessary
+ *
+ * \param Destination (OUTPUT) is where to copy the numbers to
+ * \param Source (INPUT) is where to copy the numbers from, which may be
+ * the destination
+ * \param count (INPUT) is how many numbers to copy
+ */
+void copy_endian (binary_type * Destination, 
+                  const binary_type * Source, 
+                  size_t count);
+
+/**
+ * \brief This function loads the histogram from the start of the binary
+ * file, swapping endians if necessary
+ *
+ * \param BinaryFile (INPUT) is the binary file
+ * \param source (INPUT) is the name of the binary file, for errors
+ * \param BinaryArray (OUTPUT) is the array to load the histogram into
+ * \param count (INPUT) is the number of elements of the histogram
+ */
+void load_binary (FILE * BinaryFile, 
+                  const std::string & source, 
+                  binary_type * BinaryArray, 
+                  size_t count);
@@ -305,10 +305,11 @@ void store_operators(string & StrS,
 /**
  * \brief This function localize the position of each operator
  *
- * \param s (INPUT) is the definition part of the string location
+ * \param s (INPUT) is the definition part of the string location, which
+ * the returned iterators point into
  * \param TagName_Number (INPUT) is the number of tags, or groups.
  */
-vector<string::iterator> PositionSeparator(string s, 
+vector<string::iterator> PositionSeparator(string & s, 
                                            int TagName_Number)
 { 
   std::vector<string::iterator> VecIter;
@@ -108,10 +108,11 @@ void store_operators(string & s,
 /**
  * \brief This function localize the position of each operator
  *
- * \param s (INPUT) is the definition part of the string location
+ * \param s (INPUT) is the definition part of the string location, which
+ * the returned iterators point into
  * \param TagName_Number (INPUT) is the number of tags, or groups.
  */
-vector<string::iterator> PositionSeparator(string s, 
+vector<string::iterator> PositionSeparator(string & s, 
                                            int TagName_Number);
 
 /*********************************
@@ -337,12 +337,12 @@ bool refill_time(ifstream &in, char *result){
 *             
 * Returns: int position of a label or zero if label does not exists  
 */
-int get_label_position(ifstream &in, char *label, int scan){ 
+int get_label_position(ifstream &in, char *label, int scan, scan_index *index){ 
     int position;
     //
     //go to the scan
     //
-    scan_rewinder(in, scan);
+    scan_rewinder(in, scan, index);
     int MAX=count_columns(in);
     char temp[50];
     char str[BUFFER_SIZE];
@@ -469,7 +469,7 @@ int count_columns(ifstream &in){
 *             output - double results[] - array with results obtained during experiment.
 * Returns: true if data was read, false otherwise  
 */
-bool get_values(ifstream &in, int number, double results[], int scan_number){
+bool get_values(ifstream &in, int number, double results[], int scan_number, scan_index *index){
     double value;
     int counter=0; 
     bool flag=0;
@@ -483,7 +483,7 @@ bool get_values(ifstream &in, int number, double results[], int scan_number){
     //
     //go to the scan
     //
-    scan_rewinder(in, scan_number);
+    scan_rewinder(in, scan_number, index);
     //
     //finish working until EOF
     //
@@ -597,7 +597,7 @@ int count_data_sets(ifstream &in){
 *             output - int motor group where given motor is
 * Returns: int position of motor in the group, or zero if motor does not belogs to any,  
 */
-int get_motor_position(ifstream &in, char *label, int &motor_group, int scan){
+int get_motor_position(ifstream &in, char *label, int &motor_group, int scan, scan_index *index){
     char str[BUFFER_SIZE];
     char temp1[BUFFER_SIZE], temp2[50];
     char a,b;
@@ -608,13 +608,13 @@ int get_motor_position(ifstream &in, char *label, int &motor_group, int scan){
     //go to scan and check if new motors are specified  
     //
     if(scan>1){
-        scan_rewinder(in, scan);
+        scan_rewinder(in, scan, index);
         new_motors = is_motor(in);
     }
     //
     //if there are new motors in the scan go there
     //
-    if(new_motors)scan_rewinder(in, scan);
+    if(new_motors)scan_rewinder(in, scan, index);
     //
     //count motor groups
     //
@@ -625,7 +625,7 @@ int get_motor_position(ifstream &in, char *label, int &motor_group, int scan){
     //
     //count motors in last group, in the rest of the groups there is always 8
     //
-    scan_rewinder(in, scan);  
+    scan_rewinder(in, scan, index);  
     if(!(motors_in_last_group = m_label_counter(in, total_motor_groups-1 ))) {
         cout<<"NO motors in last group\n";
         exit(1);
@@ -633,7 +633,7 @@ int get_motor_position(ifstream &in, char *label, int &motor_group, int scan){
     //
     //if new motors in the scan go there, else work at the beginnig of the file 
     //
-    if(new_motors)scan_rewinder(in, scan);
+    if(new_motors)scan_rewinder(in, scan, index);
   
     motor_group = 0;
     //
@@ -969,13 +969,13 @@ bool is_motor(ifstream &in){
 *             int motor position, int scan number 
 * Returns: double value of the motor in the scan.  
 */
-double get_motor_value(ifstream &in, int noMotor, int noValue, int scan){
+double get_motor_value(ifstream &in, int noMotor, int noValue, int scan, scan_index *index){
     char str[BUFFER_SIZE];
     double value;
     //
     //go to scan
     //
-    scan_rewinder(in, scan);
+    scan_rewinder(in, scan, index);
     //
     //count motors in the group
     //
@@ -987,7 +987,7 @@ double get_motor_value(ifstream &in, int noMotor, int noValue, int scan){
     //
     //go back to the scan
     //
-    scan_rewinder(in, scan);
+    scan_rewinder(in, scan, index);
     char a,b;
     int motor=0;
     //
@@ -1035,19 +1035,33 @@ double get_motor_value(ifstream &in, int noMotor, int noValue, int scan){
 * Function set the carriage at the beginning of the scan,
 * from which we want to read data. If the scan number parameter
 * is bigger then number of last scan in the file, error will notified. 
-* Parameters: input - input file stream, int scan number
+* With an index the carriage is set without reading the file. 
+* Parameters: input - input file stream, int scan number,
+*             scan_index *index or NULL
 *            
 * Returns: true if scan was found, false otherwise  
 */
-bool scan_rewinder(ifstream &in, int scan_number){
+bool scan_rewinder(ifstream &in, int scan_number, scan_index *index){
     //
     //check if the scan number exist in the file
     //
-    if(scan_number>total_scans(in)){
+    if(scan_number>total_scans(in, index)){
         cout<<" Scan number "<<scan_number<<" does not exist in the file. ";
         in.seekg(0);
         exit(1);
     }
+    //
+    //jump straight to the scan when it is indexed
+    //
+    if(index!=NULL){
+        in.clear(in.rdstate() & ~ios::eofbit & ~ios::failbit);
+        if(scan_number<1){
+            in.seekg(0, ios::end);
+            return 0;
+        }
+        in.seekg(index->scans[scan_number-1]);
+        return 1;
+    }
     bool correct=0;
     int counter=0;
     char string[BUFFER_SIZE];
@@ -1099,11 +1113,20 @@ bool scan_rewinder(ifstream &in, int scan_number){
 * Function counts all scans in the file.
 * Carriage is rewinded at the beginning of the file
 * after scans were counted. 
-* Parameters: input - input file stream, 
+* Parameters: input - input file stream, scan_index *index or NULL
 *            
 * Returns: int number of scans.  
 */
-int total_scans(ifstream &in){
+int total_scans(ifstream &in, scan_index *index){
+    //
+    //count the scans once and keep where they start
+    //
+    if(index!=NULL){
+        if(!index->built)index_scans(in, *index);
+        in.clear(in.rdstate() & ~ios::eofbit & ~ios::failbit);
+        in.seekg(0);
+        return index->scans.size();
+    }
     int counter=0;
     char string[BUFFER_SIZE];
     char a,b;
@@ -1149,6 +1172,56 @@ int total_scans(ifstream &in){
 }
 
 
+/**
+* Function records where every scan of the file starts, reading the file
+* the same way as total_scans(...) does, but only once. 
+* Carriage is rewinded at the beginning of the file afterwards. 
+* Parameters: input - input file stream, 
+*             output - scan_index &index
+*/
+void index_scans(ifstream &in, scan_index &index){
+    char string[BUFFER_SIZE];
+    char a,b;
+    index.scans.clear();
+    //
+    //rewind file
+    //
+    in.clear();
+    in.seekg(0);
+    //
+    //finish with the end of file
+    //
+    while(!(in.eof())){
+        //
+	//fail bit prevention
+        //
+	if(in.fail()){
+            in.clear(in.rdstate() & ~ios::failbit);
+            in.getline(string, BUFFER_SIZE-1);
+        }
+        in.get(a);
+        while(isspace(a)!=0 && in.good()){
+            in.get(a);
+        }
+        in.get(b);
+	//
+	//new scan section, keep the position scan_rewinder(...) stops at
+        //
+	if(a=='#'&& b=='S'){
+            index.scans.push_back(in.tellg());
+        }
+        in.getline(string, 255);
+    }
+    //
+    //reset flags in stream for EOF and rewind file
+    //
+    in.clear(in.rdstate() & ~ios::eofbit & ~ios::failbit);
+    in.seekg(0);
+    index.built=true;
+}
+
+
+
 
 /**
 * Function returns name of the label corresponding to its position.
@@ -1157,9 +1230,9 @@ int total_scans(ifstream &in){
 *             output - char* label
 * Returns: zero if there is no label for that postion, 1 otherwise  
 */
-bool get_label(ifstream &in, int number, char *label, int scan_number){ 
+bool get_label(ifstream &in, int number, char *label, int scan_number, scan_index *index){ 
     bool empty = 0;
-    scan_rewinder(in, scan_number);
+    scan_rewinder(in, scan_number, index);
     char temp[50];
     char str[BUFFER_SIZE];
     char a,b;
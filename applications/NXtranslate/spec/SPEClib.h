@@ -27,32 +27,45 @@
 #include <cstdlib>
 #include <fstream>
 #include <iomanip>
+#include <vector>
 
 #define BUFFER_SIZE  256
 //#define DELIMITER ':'
 using namespace std;
 
+//
+//where every scan of a file starts, filled once by index_scans(...) so that
+//scan_rewinder(...) and total_scans(...) can seek instead of reading the
+//file from the beginning every time
+//
+struct scan_index{
+    bool built;
+    vector<streampos> scans;//position just after each #S tag
+    scan_index(): built(false){}
+};
+
 bool get_file_name(ifstream &in, char *result);
 bool get_date(ifstream &in, char *result);
 bool get_userID(ifstream &in, char *result);
 bool refill_time(ifstream &in, char *result);
 bool refill_mode(ifstream &in, char *result);
-bool get_label(ifstream &in, int number, char *label, int scan_number);
+bool get_label(ifstream &in, int number, char *label, int scan_number, scan_index *index=NULL);
 int count_columns(ifstream &in);
 //long double get_value(ifstream &in, int number, int scanNumber);
-bool get_values(ifstream &in, int number, double results[], int scan_number);
-int get_motor_position(ifstream &in, char *label, int &motor_group, int scan);
+bool get_values(ifstream &in, int number, double results[], int scan_number, scan_index *index=NULL);
+int get_motor_position(ifstream &in, char *label, int &motor_group, int scan, scan_index *index=NULL);
 int motor_counter(ifstream &in);
-double get_motor_value(ifstream &in, int noMotor, int noValue, int scan);
+double get_motor_value(ifstream &in, int noMotor, int noValue, int scan, scan_index *index=NULL);
 //bool get_scan_comment(ifstream &in, char *result);
 //double time_used(ifstream &in);
 //int get_scan_number(ifstream &in);
-int get_label_position(ifstream &in, char *label, int scan);
+int get_label_position(ifstream &in, char *label, int scan, scan_index *index=NULL);
 int count_data_sets(ifstream &in);
 int m_label_counter(ifstream &in, int noMotor);
 //int count_scans(ifstream &in);*/
-int total_scans(ifstream &in);
-bool scan_rewinder(ifstream &in, int scan_number);
+int total_scans(ifstream &in, scan_index *index=NULL);
+bool scan_rewinder(ifstream &in, int scan_number, scan_index *index=NULL);
+void index_scans(ifstream &in, scan_index &index);
 bool is_motor(ifstream &in);
 void get_motor_name(ifstream &in, char *motor_name, int motor_group, int motor_position);
 //bool command_parser(const string &location, char &letter, char *label, int &scan);
@@ -143,7 +143,7 @@ bool command_parser(const string &location, char &letter, char *label, int &scan
  * specifies where to locate the data (e.g. a filename), but
  * interpreting the string is left up to the implementing code.
  */
-SpecRetriever::SpecRetriever(const string &str): source(str){
+SpecRetriever::SpecRetriever(const string &str): source(str), scans(new scan_index){
     //
     // open the file
     //
@@ -163,6 +163,7 @@ SpecRetriever::~SpecRetriever(){
     //
     if(infile)
         infile.close();
+    delete scans;
 }
 
 /**
@@ -217,7 +218,7 @@ void SpecRetriever::getData(const string &location, tree<Node> &tr){
 		    //
 		    //go to the scan and count number of measurements
 	            //
-		    scan_rewinder(infile, scan_number);
+		    scan_rewinder(infile, scan_number, scans);
 	        const int size_of_data = count_data_sets(infile);
 	            if(!(size_of_data)){
 	                cout<<" No data was collected in the scan "<<scan_number<<"\n";
@@ -231,7 +232,7 @@ void SpecRetriever::getData(const string &location, tree<Node> &tr){
 	            //
 		    //count labels
 	            //
-		    scan_rewinder(infile,scan_number);
+		    scan_rewinder(infile, scan_number, scans);
 		    if(!(MaxLabel = count_columns(infile))){
 	                cout<<" No labels in the scan "<<scan_number<<"\n";
 	                exit(1);		    
@@ -243,7 +244,7 @@ void SpecRetriever::getData(const string &location, tree<Node> &tr){
 		        //
 			//get the name of the label j-th
 	                //
-			if(!get_label(infile, j, lab, scan_number)){
+			if(!get_label(infile, j, lab, scan_number, scans)){
 		            cout<<" Label number "<<j<<" in scan number "<<scan_number<<" does not exist. ";
 		            strcpy(lab, "translation_error");
 		        }
@@ -258,7 +259,7 @@ void SpecRetriever::getData(const string &location, tree<Node> &tr){
 		        //
 			//get values corresponding to label j-th
 	                //
-			get_values(infile, j, &(data[0]), scan_number);
+			get_values(infile, j, &(data[0]), scan_number, scans);
 	            
 			//
 			//create NXdata group for storing label data item
@@ -290,14 +291,14 @@ void SpecRetriever::getData(const string &location, tree<Node> &tr){
                     //
 		    //get position of label indicated by "label" parameter 
 	            //
-		    if(!(label_position = get_label_position(infile, label, scan_number))){
+		    if(!(label_position = get_label_position(infile, label, scan_number, scans))){
 	                cout<<" Variable "<<label<<" is not in the scan number "<<scan_number<<"\n";
 	                exit(1);
 	            }
                     //
 		    //go to scan
 	            //
-		    scan_rewinder(infile, scan_number);
+		    scan_rewinder(infile, scan_number, scans);
 	            //
 		    //count data sets and prepare array for results
 		    //
@@ -311,7 +312,7 @@ void SpecRetriever::getData(const string &location, tree<Node> &tr){
                     //
 		    //store values read from scan
                     //
-		    get_values(infile, label_position, &(data[0]), scan_number);
+		    get_values(infile, label_position, &(data[0]), scan_number, scans);
                     //
 		    //insert data item with label values
 	            //
@@ -343,7 +344,7 @@ void SpecRetriever::getData(const string &location, tree<Node> &tr){
 	            //
 		    //count scans
 	            //
-		    int scan_total=total_scans(infile);
+		    int scan_total=total_scans(infile, scans);
                     //
 		    //fetch data from every scans	
 	            //
@@ -351,7 +352,7 @@ void SpecRetriever::getData(const string &location, tree<Node> &tr){
 		        //
 			//find postion of label
 	                //
-			if(!(label_position = get_label_position(infile, label, i))){
+			if(!(label_position = get_label_position(infile, label, i, scans))){
 	                    cout<<" Variable "<<label<<" is not in the scan number "<<i<<"\n";
 	                }
 			//
@@ -362,7 +363,7 @@ void SpecRetriever::getData(const string &location, tree<Node> &tr){
 	                //
 			//go to scan i and count data sets in order to prepare array for data
 			//
-			scan_rewinder(infile, i);
+			scan_rewinder(infile, i, scans);
 	                if(!(size_of_data = count_data_sets(infile))){
 	                    cout<<" No data was collected in the scan "<<i<<"\n";
 	                    exit(1);
@@ -373,7 +374,7 @@ void SpecRetriever::getData(const string &location, tree<Node> &tr){
                         //
 			//fetch data corresponding to label in i-th scan
 	                //
-			get_values(infile, label_position, &(data[0]), i);
+			get_values(infile, label_position, &(data[0]), i, scans);
                         //
 			//insert data group with the name of the scan, 
 	                //
@@ -418,7 +419,7 @@ void SpecRetriever::getData(const string &location, tree<Node> &tr){
 		Node node("empty", "NXlog"); 
 	        first_gen = tr.insert(tr.end(),node);
 		    
-	        scan_rewinder(infile, scan_number);
+	        scan_rewinder(infile, scan_number, scans);
 		//
 		//count motor groups
                 //
@@ -429,7 +430,7 @@ void SpecRetriever::getData(const string &location, tree<Node> &tr){
                 //
                 //count motors in last group, in the rest of the groups there is always 8
                 //
-		scan_rewinder(infile, scan_number);  
+		scan_rewinder(infile, scan_number, scans);  
                 if(!(motors_in_last_group = m_label_counter(infile, motor_groups-1 ))) {
                     cout<<"NO motors in last group\n";
                     exit(1);
@@ -454,7 +455,7 @@ void SpecRetriever::getData(const string &location, tree<Node> &tr){
 		       //
 		       //get position of the motor k-th from j-th
 	               // 
-			motor_value[0] = get_motor_value(infile, j, k, scan_number);
+			motor_value[0] = get_motor_value(infile, j, k, scan_number, scans);
 		        //
 	                //insert data item with motor value into NXlog group
 		        //
@@ -481,7 +482,7 @@ void SpecRetriever::getData(const string &location, tree<Node> &tr){
 		    //    
 		    //get position of the motor k-th from j-th
 	            //
-		    motor_value[0] = get_motor_value(infile, motor_groups-1, k, scan_number);
+		    motor_value[0] = get_motor_value(infile, motor_groups-1, k, scan_number, scans);
 		    //    
 	            //insert data item with motor value into NXlog group
 		    //
@@ -500,14 +501,14 @@ void SpecRetriever::getData(const string &location, tree<Node> &tr){
 	            //    
 	            //look for motor position in the list of motors
 	            //
-		    if(!(motor_position = get_motor_position(infile, label, motor_group, scan_number))){
+		    if(!(motor_position = get_motor_position(infile, label, motor_group, scan_number, scans))){
 	                cout<<" Variable "<<label<<" is not in the scan number "<<scan_number<<"\n";
 	                exit(1);
 	            }        
                     //
 	            //fetch motor value from interesting scan
 	            //
-		    motor_value[0] = get_motor_value(infile, motor_group, motor_position, scan_number);
+		    motor_value[0] = get_motor_value(infile, motor_group, motor_position, scan_number, scans);
                     //
 	            //insert data item in the place from where it was called
     	            //
@@ -539,7 +540,7 @@ void SpecRetriever::getData(const string &location, tree<Node> &tr){
 		    //
 		    //count scans
 	            //
-		    int scan_total=total_scans(infile);
+		    int scan_total=total_scans(infile, scans);
                     //
 		    //fetch data from every scans	
 	            //
@@ -547,14 +548,14 @@ void SpecRetriever::getData(const string &location, tree<Node> &tr){
 	                //
 			//look for motor position in the list of motors
 	                //
-			if(!(motor_position = get_motor_position(infile, label, motor_group, i))){
+			if(!(motor_position = get_motor_position(infile, label, motor_group, i, scans))){
 	                    cout<<" Variable "<<label<<" is not in the scan number "<<i<<"\n";
 	                    exit(1);
 	                }        
                         //
 	                //fetch motor value from interesting scan
 	                //
-			motor_value[0] = get_motor_value(infile, motor_group, motor_position, i);
+			motor_value[0] = get_motor_value(infile, motor_group, motor_position, i, scans);
 		        //
 		        //prepare name of the scan
 	                //
@@ -588,7 +589,7 @@ void SpecRetriever::getData(const string &location, tree<Node> &tr){
                 //
 	        //go to scan
 	        //
-		scan_rewinder(infile, scan_number);
+		scan_rewinder(infile, scan_number, scans);
 	        //
 		//read refill mode
 	        //
@@ -614,7 +615,7 @@ void SpecRetriever::getData(const string &location, tree<Node> &tr){
                 //
 		//go to scan
 	        //
-		scan_rewinder(infile, scan_number);
+		scan_rewinder(infile, scan_number, scans);
 	        //
 		//read time of refill, print error if it is not found
 	        //
@@ -685,7 +686,7 @@ void SpecRetriever::getData(const string &location, tree<Node> &tr){
 		    //
 		    //go to the scan
 	            //
-		    scan_rewinder(infile, scan_number);
+		    scan_rewinder(infile, scan_number, scans);
 	            //
 		    //read date of the scan 
 		    //
@@ -715,7 +716,7 @@ void SpecRetriever::getData(const string &location, tree<Node> &tr){
 	            //
 		    //count scans
 	            //
-		    int scan_total=total_scans(infile);
+		    int scan_total=total_scans(infile, scans);
                     //
 		    //fetch data from every scans	
 	            //
@@ -723,7 +724,7 @@ void SpecRetriever::getData(const string &location, tree<Node> &tr){
 		        //
 			//go to the scan
 	                //
-			scan_rewinder(infile, i);
+			scan_rewinder(infile, i, scans);
 			//
 			//get date of the file
 		        //
@@ -791,7 +792,7 @@ void SpecRetriever::auto_translation(tree<Node> &t){
     //
     //set number of scans from the file
     //
-    int MAX =total_scans(infile);
+    int MAX =total_scans(infile, scans);
     //
     //for text fields of date, userId, file name
     //
@@ -857,7 +858,7 @@ void SpecRetriever::auto_translation(tree<Node> &t){
 	//                
 	//go to the scan i and set number of data sets obtained during experiment    
 	//
-	scan_rewinder(infile, i);
+	scan_rewinder(infile, i, scans);
 	if(!(size_of_data = count_data_sets(infile))){
 	    cout<<" No data was collected in the scan "<<i<<"\n";
 	    exit(1);
@@ -870,7 +871,7 @@ void SpecRetriever::auto_translation(tree<Node> &t){
 	//               
 	//go back to scan and count every labels
 	//
-	scan_rewinder(infile,i);
+	scan_rewinder(infile, i, scans);
 	if(!(MaxLabel = count_columns(infile))){
 	    cout<<" No labels in the scan "<<i<<"\n";
 	    exit(1);		    
@@ -882,7 +883,7 @@ void SpecRetriever::auto_translation(tree<Node> &t){
 	//                    
 	//get name of the j-th label in scan i-th    
 	//
-	if(!get_label(infile, j, lab, i)){
+	if(!get_label(infile, j, lab, i, scans)){
 	    cout<<" Label number "<<j<<" in scan number "<<i<<" does not exist. ";
 	    strcpy(lab, "translation_error");
         }
@@ -896,7 +897,7 @@ void SpecRetriever::auto_translation(tree<Node> &t){
 	//	            
 	//get the results coresponding to j-th label in i-th scan 
 	//
-	get_values(infile, j, &(data[0]), i);
+	get_values(infile, j, &(data[0]), i, scans);
 	//            
 	//create folder to keep data items
 	//
@@ -930,7 +931,7 @@ void SpecRetriever::auto_translation(tree<Node> &t){
 	Node node_motors("Motors", "NXlog"); 
 	second_gen = t.append_child(first_gen,node_motors);
 		    
-        scan_rewinder(infile, i);
+        scan_rewinder(infile, i, scans);
 	//
 	//count motor groups
         //
@@ -941,7 +942,7 @@ void SpecRetriever::auto_translation(tree<Node> &t){
         //
         //count motors in last group, in the rest of the groups there is always 8
         //
-	scan_rewinder(infile, i);  
+	scan_rewinder(infile, i, scans);  
         if(!(motors_in_last_group = m_label_counter(infile, motor_groups-1 ))) {
             cout<<"NO motors in last group\n";
             exit(1);
@@ -965,7 +966,7 @@ void SpecRetriever::auto_translation(tree<Node> &t){
 	       //	        
 	       //get value of the motor k-th from j-th
 	       // 
-		motor_value[0] = get_motor_value(infile, j, k, i);
+		motor_value[0] = get_motor_value(infile, j, k, i, scans);
                 //       
 	        //insert data item with motor value into NXlog group
 		//
@@ -991,7 +992,7 @@ void SpecRetriever::auto_translation(tree<Node> &t){
             //
             //get value of the motor k-th from j-th
 	    //
-	    motor_value[0] = get_motor_value(infile, motor_groups-1, k, i);
+	    motor_value[0] = get_motor_value(infile, motor_groups-1, k, i, scans);
             //        
 	    //insert data item with motor value into NXlog group
             //
@@ -1002,7 +1003,7 @@ void SpecRetriever::auto_translation(tree<Node> &t){
 	//insert dates of scanning into NXlog group
 	//go to the scan
 	//
-	scan_rewinder(infile, i);
+	scan_rewinder(infile, i, scans);
 	//
 	//read date of the scan 
 	//
@@ -1014,7 +1015,7 @@ void SpecRetriever::auto_translation(tree<Node> &t){
         //
         //go to the scan
 	//
-	scan_rewinder(infile, i);
+	scan_rewinder(infile, i, scans);
 	//                
 	//store data in NXlog group
         //
@@ -20,6 +20,9 @@
 
 #include "../retriever.h"
 #include <fstream>
+
+struct scan_index;
+
 //
 // this is not intended to be inherited from
 //
@@ -32,9 +35,10 @@ class SpecRetriever: public Retriever{
   static const std::string MIME_TYPE;
  private:
   void auto_translation(tree<Node> &);
- // SpecRetriever(const SpecRetriever&);
- // SpecRetriever& operator=(const SpecRetriever&);
+  SpecRetriever(const SpecRetriever&);
+  SpecRetriever& operator=(const SpecRetriever&);
   std::string source;
   std::ifstream infile;
+  scan_index *scans; // where the scans start, filled on first use
 };
 #endif
@@ -89,44 +89,17 @@ static unsigned int convert_type(std::string nxtype) {
 	return NX_FLOAT64;
 }
 
-static void reset_file(ifstream &file){
-	file.clear();
-	file.seekg(0,std::ios::beg);
-	file.clear();
-}
-
 static string read_line(ifstream &file){
-  static char buffer[BUFFER_SIZE];
+  char buffer[BUFFER_SIZE];
   file.get(buffer,BUFFER_SIZE);
   file.get();
   return string(buffer);
 }
 
-static void skip_to_line(ifstream &file,int &cur_line, int new_line){
-   file.seekg(0,std::ios::beg);
-  if(new_line==cur_line){ // skip out early if possible
-    return;
-  }else if(new_line<cur_line){  // go to the beginning if necessary
-    file.seekg(0,std::ios::beg);
-    cur_line=0;
-  }
-
-  // scan down to the right place
-  while( (file.good()) && (cur_line<new_line) ){
-    string text=read_line(file);
-    //cout << "LINE" << cur_line << "[" << file.tellg() << "]:" << text << endl;
-    cur_line++;
-  }
-
-  if(!(file.good()))
-    throw invalid_argument("Could not reach line "
-                           +string_util::int_to_str(new_line));
-}
-
 
 std::string TextCollistRetriever::parse_method(std::string location){
 	unsigned int pos = 0;
-	static std::string sub_str;
+	std::string sub_str;
 	
 	pos = location.find_first_of(TextCollistRetriever::METHOD_OPEN_BRACKET);
 	if (pos != std::string::npos) {
@@ -153,7 +126,7 @@ std::string TextCollistRetriever::parse_method(std::string location){
 
 std::string TextCollistRetriever::parse_type(std::string location){
 	unsigned int pos = 0;
-	static std::string sub_str;
+	std::string sub_str;
 	
 	pos = location.find_last_of(TextCollistRetriever::TYPE_OPEN_BRACKET);
 	if (pos != std::string::npos) {
@@ -172,7 +145,7 @@ std::string TextCollistRetriever::parse_arg(std::string location){
 	// check if column
 	unsigned int start_pos = 0;
 	unsigned int end_pos = 0;
-	static std::string sub_str;
+	std::string sub_str;
 	
 	if (location.find_first_of(TextCollistRetriever::COLUMN_TAG) != std::string::npos) {
 		start_pos = location.find_first_of(TextCollistRetriever::METHOD_OPEN_BRACKET, location.find_first_of(TextCollistRetriever::COLUMN_TAG));
@@ -202,7 +175,7 @@ std::string TextCollistRetriever::parse_arg(std::string location){
 
 void TextCollistRetriever::parse_range(std::string location, int &x, int &y){
 	unsigned int pos = 0;
-	static std::string sub_str;
+	std::string sub_str;
 	
 	pos = location.find_last_of(TextCollistRetriever::RANGE_OPEN_BRACKET);
 	if (pos != std::string::npos) {
@@ -297,9 +270,9 @@ std::string TextCollistRetriever::extract_dictentry(std::ifstream &file, std::st
 	std::string str="";
 	std::string ustr="";
 
-	reset_file(infile);
 	while (i<data_section) {
-		std::string line = read_line(infile);
+		// past the end of the file reading gives empty lines
+		std::string line = (static_cast<unsigned int>(i)<lines.size()) ? lines[i] : "";
 		//std::cout << "current line: " << line << std::endl;	
 
 		while (isspace(line[j])){
@@ -350,55 +323,87 @@ std::string TextCollistRetriever::extract_dictentry(std::ifstream &file, std::st
 	return ustr+str;
 }
 
+/**
+ * Reads the whole file once, keeping each line as read_line() returns
+ * it. The header and dictionary lookups go through these lines.
+ */
+void TextCollistRetriever::index_lines() {
+	while (infile.good()) {
+		lines.push_back(read_line(infile));
+	}
+}
+
+/**
+ * Converts the data section into one array per column in a single pass
+ * over its lines, the first time any column is asked for. Values which
+ * are missing or not numbers are marked as such.
+ */
+void TextCollistRetriever::index_columns() {
+	columns.assign(headers.size(), std::vector<double>());
+	parsed.assign(headers.size(), std::vector<bool>());
+	for (unsigned int n=data_section; n+1<lines.size() && isdata(lines[n]); n++) {
+		std::vector<std::string> string_values = string_util::split_values(lines[n]);
+		for (unsigned int col=0; col<headers.size(); col++) {
+			double dbl_val = 0.;
+			bool ok = false;
+			if (col<string_values.size()) {
+				try {
+					dbl_val = string_util::str_to_float(string_values[col]);
+					ok = true;
+				}
+				catch(...) {
+				}
+			}
+			columns[col].push_back(dbl_val);
+			parsed[col].push_back(ok);
+		}
+	}
+	number_of_entrys = (headers.size()>0) ? columns[0].size() : 0;
+	columns_indexed = true;
+}
+
 std::vector<double> TextCollistRetriever::extract_column(ifstream &file, std::string col_name, int from, int to)
 {
 	int count = 0;
 	int index = 0;
 	std::vector<double> values;
-	reset_file(infile);
-	int cur_line=0;
-	skip_to_line(infile, cur_line, data_section+((from<0)?0:from)); 
+	int first = (from<0) ? 0 : from;
+	if (static_cast<unsigned int>(data_section+first)>=lines.size()) {
+		throw invalid_argument("Could not reach line "
+                           +string_util::int_to_str(data_section+first));
+	}
+	if (!columns_indexed) {
+		index_columns();
+	}
 	
 //cout << endl << "counting headers: " << *(headers.begin()) << endl;	
 
 	std::vector<std::string>::iterator it = headers.begin();
-	while (*it != col_name && it != headers.end()) {
+	while (it != headers.end() && *it != col_name) {
 		it++;
 		index++;
 	}
 
-	std::string line = read_line(infile);
-
 	if (it== headers.end()) {
 		std::cout << "no column '"<< col_name << "' found in file ... filling with 0s" << std::endl;
-		while ((infile.good()) && ((to>=0 && to<count) || (to<0))) {			
-			if (!isdata(line)) {
-				break;
-			}
+		for (int row=first; row<number_of_entrys && ((to>=0 && to<count) || (to<0)); row++) {
 			values.push_back(0);
 			count++;
-			line = read_line(infile);
 		}
 		return values;
 	}
 
 //cout << endl << "pushing data: " << to << " "<< count<<" "<< infile.good()<< endl;	
-	while ((infile.good()) && ((to>=0 && to<count) || (to<0))) {			
-		if (!isdata(line)) {
-			break;
-		}
-		try {
-			std::vector<std::string> string_values = string_util::split_values(line);
-	//cout << endl << "pushing data: " << (string_util::str_to_float(string_values.at(index))) << endl;	
-			double dbl_val = string_util::str_to_float(string_values.at(index));
-			values.push_back(dbl_val);
+	const std::vector<double> &column = columns[index];
+	const std::vector<bool> &ok = parsed[index];
+	for (int row=first; row<number_of_entrys && ((to>=0 && to<count) || (to<0)); row++) {
+		if (ok[row]) {
+			values.push_back(column[row]);
 		}
-		catch(...) {
+		else {
 			cout << "exception in transforming column values " << endl;	
-					
 		}
 		count++;
-		line = read_line(infile);
 	}
 	return values;
 }
@@ -443,17 +448,22 @@ TextCollistRetriever::TextCollistRetriever(const string &str): source(str),curre
 
 	this->number_of_cols = 0;
 	this->number_of_entrys = 0;
+	this->columns_indexed = false;
+	
+	// everything below is served from the lines read here
+	index_lines();
+	infile.close();
 	
 	int cur_line = 0;
-	std::string line = read_line(infile);
+	std::string line = lines[0];
 	std::string prev_line="";
 	std::string prev_prev_line="";
 	
  	//std::cout << "current line: " << line << std::endl;
-	while (infile.good() && !isdata(line)) {
+	while (static_cast<unsigned int>(cur_line+1)<lines.size() && !isdata(line)) {
 		prev_prev_line = prev_line;
 		prev_line=line;
-		line = read_line(infile);
+		line = lines[cur_line+1];
 		//std::cout << "current line: " << line << std::endl;
 		cur_line++;
 	}
@@ -566,28 +576,33 @@ void TextCollistRetriever::getData(const string &location, tree<Node> &tr){
 			throw runtime_error("NXmalloc failed");
 		}
 
-		for( unsigned int i=0 ; i<values.size() ; i++ ) {
-			switch (convert_type(nxtype)) {
-				case NX_INT32: 
-					*(((int*)data)+i)=static_cast<int>(values.at(i));
-					break;
-				case NX_UINT32: 
-					*(((unsigned int*)data)+i)=static_cast<unsigned int>(values.at(i));
-					break;
-				case NX_INT16: 
-					*(((short*)data)+i)=static_cast<short>(values.at(i));
-					break;
-				case NX_UINT16: 
-					*(((unsigned short*)data)+i)=static_cast<unsigned short>(values.at(i));
-					break;
-				case NX_FLOAT64:
-					*(((double*)data)+i)=static_cast<double>(values.at(i));
-					break;
-				case NX_FLOAT32:
-					*(((float*)data)+i)=static_cast<float>(values.at(i));
-					break;
-					
-			}
+		// the type is looked up once, each case is then a plain conversion loop
+		const double *from = &(values[0]);
+		unsigned int n = values.size();
+		switch (convert_type(nxtype)) {
+			case NX_INT32: 
+				for( unsigned int i=0 ; i<n ; i++ )
+					((int*)data)[i]=static_cast<int>(from[i]);
+				break;
+			case NX_UINT32: 
+				for( unsigned int i=0 ; i<n ; i++ )
+					((unsigned int*)data)[i]=static_cast<unsigned int>(from[i]);
+				break;
+			case NX_INT16: 
+				for( unsigned int i=0 ; i<n ; i++ )
+					((short*)data)[i]=static_cast<short>(from[i]);
+				break;
+			case NX_UINT16: 
+				for( unsigned int i=0 ; i<n ; i++ )
+					((unsigned short*)data)[i]=static_cast<unsigned short>(from[i]);
+				break;
+			case NX_FLOAT64:
+				memcpy(data, from, n*sizeof(double));
+				break;
+			case NX_FLOAT32:
+				for( unsigned int i=0 ; i<n ; i++ )
+					((float*)data)[i]=static_cast<float>(from[i]);
+				break;
 		}
 
 		//cout << endl << "info: " << ((double*)data)[0] << " "<<((double*)data)[1]<<" "<<((double*)data)[2]<< endl;	
@@ -29,6 +29,15 @@ protected:
   std::vector<std::string> headers;
   std::vector<std::string> units;
   
+  // the file as read once by index_lines(), and its data section as one
+  // array per column, filled by index_columns() on first use
+  std::vector<std::string> lines;
+  std::vector<std::vector<double> > columns;
+  std::vector<std::vector<bool> > parsed;
+  bool columns_indexed;
+  
+  void index_lines();
+  void index_columns();
   void extract_headers(std::string line);
   void extract_units(std::string line);
 
@@ -20,7 +20,7 @@ using std::vector;
 static const int BUFFER_SIZE=256;
 
 static string read_line(ifstream &file){
-  static char buffer[BUFFER_SIZE];
+  char buffer[BUFFER_SIZE];
   file.get(buffer,BUFFER_SIZE);
   file.get();
   return string(buffer);
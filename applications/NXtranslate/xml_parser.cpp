@@ -14,6 +14,7 @@
 #include "string_util.h"
 #include "xml_parser.h"
 #include "xml_util.h"
+#include "fetcher.h"
 #include "Ptr.h"
 #include "tree.hh"
 #include "nxtranslate_debug.h"
@@ -62,6 +63,39 @@ static const string EXCEPTION         = "EXCEPTION";
 static const string INVALID_ARGUMENT  = "INVALID ARGUMENT";
 static const string RUNTIME_ERROR     = "RUNTIME ERROR";
 
+/*
+ * What the start tag of an element says. The stacks of mime types and
+ * retrievers are used to work it out, the nodes and the output file to
+ * apply it.
+ */
+typedef struct{
+  string name;
+  string type;
+  string location;
+  string compression;
+  string except_label;
+  vector<Attr> attrs;
+  bool is_link;
+  bool has_target;
+  StrVector target;       // where a link points to
+  bool set_dims;          // whether the type sets the dimensions
+  vector<int> dims;
+  bool update_dims;
+  RetrieverPtr retriever;
+  long job;               // the call of the retriever in the fetcher, or -1
+}Element;
+
+/*
+ * The translation file as it is parsed ahead of the translation: start
+ * tags, character data and end tags in document order.
+ */
+typedef enum{ START_ELEMENT, CHARACTERS, END_ELEMENT }EventKind;
+typedef struct{
+  EventKind kind;
+  size_t element;         // for START_ELEMENT
+  string text;            // character data, or the name of the end tag
+}Event;
+
 typedef struct{
   NXhandle *handle;       // output file handle
   int status;             // status of parsing
@@ -73,20 +107,26 @@ typedef struct{
   vector<int> dims;       // dimensions of the array in current node
   vector<string> mime_types; // vector of mime_types (for nesting)
   vector<RetrieverPtr> retrievers; // vector of retrievers (for nesting)
+  bool planning;          // record the document rather than translating it
+  vector<Element> elements; // start tags recorded while planning
+  vector<Event> events;   // everything recorded while planning
+  Fetcher *fetcher;       // runs the retrievers ahead of the translation
 }UserData;
 
 #ifdef USE_TIMING
 static time_t start_time = time(NULL);
 static time_t intermediate_time = time(NULL);
-extern string print_time(const time_t & start,
-                         const  time_t & stop) {
-  double seconds = difftime(stop, start);
+static string print_seconds(double seconds) {
   long minutes = static_cast<long>(seconds/60.);
   seconds = seconds - 60. * static_cast<double>(minutes);
   std::stringstream result;
   result << minutes << "m" << seconds  << "s";
   return result.str();
 }
+extern string print_time(const time_t & start,
+                         const  time_t & stop) {
+  return print_seconds(difftime(stop, start));
+}
 #endif
 
 // variable so the line and column numbers can be accessed
@@ -189,15 +229,25 @@ static void my_characters(void *user_data, const xmlChar *ch, int len){
   // if it is empty just return
   if(str.size()<=0) return;
 
+  // keep the characters for later when planning
+  if(((UserData *)user_data)->planning){
+    Event event;
+    event.kind=CHARACTERS;
+    event.element=0;
+    event.text=str;
+    ((UserData *)user_data)->events.push_back(event);
+    return;
+  }
+
   // add the characters with a space between it and what was there
   ((UserData *)user_data)->char_data+=str;
 }
 
-static void my_startElement(void *user_data, const xmlChar *name,
-                                                       const xmlChar ** attrs){
-#ifdef DEBUG1_XML_PARSER
-  std::cout << "startElement(" << name << ")" << std::endl;
-#endif
+/*
+ * Work out what the start tag says, and push its mime type and retriever.
+ */
+static void prepare_element(UserData *user_data, const xmlChar *name,
+                            const xmlChar ** attrs, Element &element){
   static const string LEFT  = "[";
   static const string RIGHT = "]";
 
@@ -218,8 +268,9 @@ static void my_startElement(void *user_data, const xmlChar *name,
   string location;
   string compression;
   string type;
-  bool update_dims=false;
-  vector<Attr> node_attrs;
+  element.set_dims=false;
+  element.update_dims=false;
+  element.has_target=false;
   for( StrVector::iterator it=str_attrs.begin() ; it!=str_attrs.end() ; it+=2){
     if( (*it==SOURCE) || (*it==MIME_TYPE) || (*it==LOCATION) || (*it==TYPE)
         || ((*it==TARGET) && (is_link)) || (*it==NAME) || (*it==COMPRESSION) ){
@@ -241,61 +292,56 @@ static void my_startElement(void *user_data, const xmlChar *name,
         }else if(type.substr(type.size()-1,type.size())==RIGHT){
           int start=type.find(LEFT);
           string dim=type.substr(start,type.size());
+          element.set_dims=true;
           if(dim.size()>0){
-            ((UserData *)user_data)->dims=string_util::str_to_intVec(dim);
-            update_dims=true;
+            element.dims=string_util::str_to_intVec(dim);
+            element.update_dims=true;
           }else{
-            ((UserData *)user_data)->dims.clear();
-            ((UserData *)user_data)->dims.push_back(1);
+            element.dims.clear();
+            element.dims.push_back(1);
           }
           type=type.erase(start,type.size());
         }else{
-          ((UserData *)user_data)->dims.clear();
-          ((UserData *)user_data)->dims.push_back(1);
+          element.set_dims=true;
+          element.dims.clear();
+          element.dims.push_back(1);
         }
       }else if((is_link) && (*it==TARGET)){ // working with a link
-        StrVector str_vec;
-        NodeVector node_vec=((UserData *)user_data)->nodes;
-        for( NodeVector::const_iterator node_it=node_vec.begin() ; node_it!=node_vec.end() ; node_it++ ){
-          if(node_it->name()!=NXROOT)
-            str_vec.push_back(node_it->name());
-        }
-        ((UserData *)user_data)->loc_to_source.push_back(str_vec);
-        ((UserData *)user_data)->loc_to_source.push_back(string_util::string_to_path(*(it+1)));
+        element.has_target=true;
+        element.target=string_util::string_to_path(*(it+1));
         type=LINK;
       }
       str_attrs.erase(it,it+2);
       it-=2;
     }else{ // everything else is an attribute
       try{
-        node_attrs.push_back(make_attr(*it,*(it+1)));
+        element.attrs.push_back(make_attr(*it,*(it+1)));
       }catch(std::invalid_argument &e){
-        print_error(((UserData *)user_data),INVALID_ARGUMENT+except_label+e.what());
+        print_error(user_data,INVALID_ARGUMENT+except_label+e.what());
       }
     }
   }
-  ((UserData *)user_data)->is_link=is_link;
 
   // if type is not defined (and it is not root) it is a character array
   if( (type.size()<=0) && (str_name!=NXROOT) )
     type="NX_CHAR";
 
   // map everything using the macro replacement
-  map_string(((UserData *)user_data)->map,source);
-  map_string(((UserData *)user_data)->map,mime_type);
-  map_string(((UserData *)user_data)->map,location);
+  map_string(user_data->map,source);
+  map_string(user_data->map,mime_type);
+  map_string(user_data->map,location);
 
   // set the mime_type
   if(mime_type.size()<=0){
-    if(((UserData *)user_data)->mime_types.size()<=0)
+    if(user_data->mime_types.size()<=0)
       mime_type=DEFAULT_MIME_TYPE;
     else
-      mime_type=*(((UserData *)user_data)->mime_types.rbegin());
+      mime_type=*(user_data->mime_types.rbegin());
   }
-  ((UserData *)user_data)->mime_types.push_back(mime_type);
+  user_data->mime_types.push_back(mime_type);
 
   // confirm that maximum node depth is not exceded
-  if(((UserData *)user_data)->mime_types.size()>MAX_NODE_DEPTH)
+  if(user_data->mime_types.size()>MAX_NODE_DEPTH)
     throw runtime_error("Exceded maximum node depth");
 
   // create a new retriever if necessary
@@ -304,96 +350,169 @@ static void my_startElement(void *user_data, const xmlChar *name,
     try{
       retriever=Retriever::getInstance(mime_type,source);
     }catch(runtime_error &e){
-      print_error(((UserData *)user_data),RUNTIME_ERROR+except_label+e.what());
+      print_error(user_data,RUNTIME_ERROR+except_label+e.what());
     }catch(exception &e){
-      print_error(((UserData *)user_data),EXCEPTION+except_label+e.what());
+      print_error(user_data,EXCEPTION+except_label+e.what());
     }
-  }else if(((UserData *)user_data)->retrievers.size()>0){
-    retriever=*(((UserData *)user_data)->retrievers.rbegin());
+  }else if(user_data->retrievers.size()>0){
+    retriever=*(user_data->retrievers.rbegin());
   }
-  ((UserData *)user_data)->retrievers.push_back(retriever);
+  user_data->retrievers.push_back(retriever);
+
+  element.name=str_name;
+  element.type=type;
+  element.location=location;
+  element.compression=compression;
+  element.except_label=except_label;
+  element.is_link=is_link;
+  element.retriever=retriever;
+  element.job=-1;
+}
+
+/*
+ * Get the tree for the location of the element from its retriever, or
+ * from the fetcher which called it ahead.
+ */
+static void fetch(UserData *user_data, const Element &element,
+                  tree<Node> &tree){
+  if(element.job>=0)
+    user_data->fetcher->take(element.job,tree);
+  else
+    element.retriever->getData(element.location,tree);
+}
+
+/*
+ * Create the node of the element, and write it to the file if it is a
+ * group or came from a retriever.
+ */
+static void apply_element(UserData *user_data, Element &element){
+  string str_name=element.name;
+  string except_label=element.except_label;
+  bool is_link=element.is_link;
+  bool update_dims=element.update_dims;
+  if(element.set_dims)
+    user_data->dims=element.dims;
+
+  // the link goes from the current node to the target
+  if(element.has_target){
+    StrVector str_vec;
+    NodeVector node_vec=user_data->nodes;
+    for( NodeVector::const_iterator node_it=node_vec.begin() ; node_it!=node_vec.end() ; node_it++ ){
+      if(node_it->name()!=NXROOT)
+        str_vec.push_back(node_it->name());
+    }
+    user_data->loc_to_source.push_back(str_vec);
+    user_data->loc_to_source.push_back(element.target);
+  }
+  user_data->is_link=is_link;
 
   // create a new node
   bool node_from_retriever=false;
-  Node node(str_name,type);  // default
+  Node node(str_name,element.type);  // default
   tree<Node> tree;
-  if(location.size()>0 && retriever){ // if there is a location and a retriever
-    if(!(((UserData *)user_data)->status)){
+  if(element.location.size()>0 && element.retriever){ // if there is a location and a retriever
+    if(!(user_data->status)){
       try{
-        retriever->getData(location,tree);
+        fetch(user_data,element,tree);
 		  if (tree.size() <=0) {
 			  node_from_retriever=false;
 		  }
 		  else {
 			  tree.begin()->set_name(str_name);
 			  if( (tree.begin()->is_data()) && update_dims )
-				 tree.begin()->update_dims(((UserData *)user_data)->dims);
+				 tree.begin()->update_dims(user_data->dims);
 			  node=*(tree.begin());
 			  node_from_retriever=true;
 		  }
       }catch(invalid_argument &e){
-        print_error(((UserData *)user_data),INVALID_ARGUMENT+except_label+e.what());
+        print_error(user_data,INVALID_ARGUMENT+except_label+e.what());
       }catch(runtime_error &e){
-        print_error(((UserData *)user_data),RUNTIME_ERROR+except_label+e.what());
+        print_error(user_data,RUNTIME_ERROR+except_label+e.what());
       }catch(exception &e){
-        print_error(((UserData *)user_data),EXCEPTION+except_label+e.what());
+        print_error(user_data,EXCEPTION+except_label+e.what());
       }
+    }else if(element.job>=0){
+      user_data->fetcher->skip(element.job);
     }
   }
 
   // set the compression flag
-  if(!compression.empty()){
+  if(!element.compression.empty()){
     if(node_from_retriever){
       for( NodeTree::iterator it=tree.begin() ; it!=tree.end() ; ++it ){
-        it->set_comp(compression);
+        it->set_comp(element.compression);
       }
     }else{
-      node.set_comp(compression);
+      node.set_comp(element.compression);
     }
   }
 
   // mutate the attributes if necessary
-  if(node_attrs.size()>0) {
+  if(element.attrs.size()>0) {
     if(node_from_retriever) {
-      tree.begin()->update_attrs(node_attrs);
+      tree.begin()->update_attrs(element.attrs);
     } else {
-      node.update_attrs(node_attrs);
+      node.update_attrs(element.attrs);
     }
   }
 
   // add the node to the end of the vector
-  ((UserData *)user_data)->nodes.push_back(node);
+  user_data->nodes.push_back(node);
 
   // check that the node is a group or data
   if(!is_link){
     if(node_from_retriever){
-      NXhandle *handle=((UserData *)user_data)->handle;
+      NXhandle *handle=user_data->handle;
       // write the data to the file
       try{
         nexus_util::make_data(handle,tree);
         nexus_util::open(handle,node);
       }catch(runtime_error &e){
-        print_error(((UserData *)user_data),RUNTIME_ERROR+except_label+e.what());
+        print_error(user_data,RUNTIME_ERROR+except_label+e.what());
       }catch(exception &e){
-        print_error(((UserData *)user_data),EXCEPTION+except_label+e.what());
+        print_error(user_data,EXCEPTION+except_label+e.what());
       }
     }else if( !node.is_data()){  // create group and open it
-      NXhandle *handle=((UserData *)user_data)->handle;
+      NXhandle *handle=user_data->handle;
       nexus_util::open(handle,node);
     }
   }
 }
 
-static void my_endElement(void *user_data, const xmlChar *name){
+static void my_startElement(void *user_data, const xmlChar *name,
+                                                       const xmlChar ** attrs){
 #ifdef DEBUG1_XML_PARSER
-  std::cout << "endElement(" << name << ")" << std::endl;
+  std::cout << "startElement(" << name << ")" << std::endl;
 #endif
+  UserData *data=(UserData *)user_data;
+  Element element;
+  prepare_element(data,name,attrs,element);
+  if(!data->planning){
+    apply_element(data,element);
+    return;
+  }
 
+  // only record the element, and have its retriever called ahead
+  if(element.location.size()>0 && element.retriever && !data->status)
+    element.job=static_cast<long>(data->fetcher->add(element.retriever,
+                                                      element.location));
+  Event event;
+  event.kind=START_ELEMENT;
+  event.element=data->elements.size();
+  data->elements.push_back(element);
+  data->events.push_back(event);
+}
+
+/*
+ * Write the character data of the element and close its node. Returns
+ * false if the character data could not be understood.
+ */
+static bool finish_element(void *user_data, const string &str_name){
   // an alias for whether the current node is a link
   bool is_link=((UserData *)user_data)->is_link;
 
   // create a label for the element when writing out exceptions
-  string except_label="</"+xml_util::xmlChar_to_str(name,-1)+">";
+  string except_label="</"+str_name+">";
 
   // get an alias to the node, this uses the copy constructor
   Node node=*(((UserData *)user_data)->nodes.rbegin());
@@ -416,7 +535,7 @@ static void my_endElement(void *user_data, const xmlChar *name){
     }catch(invalid_argument &e){
       print_error(((UserData *)user_data),
                                    INVALID_ARGUMENT+":"+except_label+e.what());
-      return;
+      return false;
     }
 
     // clear out the dimensions value
@@ -445,6 +564,25 @@ static void my_endElement(void *user_data, const xmlChar *name){
 
   // pop the node off of the end of the vector
   ((UserData *)user_data)->nodes.pop_back();
+  return true;
+}
+
+static void my_endElement(void *user_data, const xmlChar *name){
+#ifdef DEBUG1_XML_PARSER
+  std::cout << "endElement(" << name << ")" << std::endl;
+#endif
+  string str_name=xml_util::xmlChar_to_str(name,-1);
+
+  if(((UserData *)user_data)->planning){
+    Event event;
+    event.kind=END_ELEMENT;
+    event.element=0;
+    event.text=str_name;
+    ((UserData *)user_data)->events.push_back(event);
+  }else if(!finish_element(user_data,str_name)){
+    return;
+  }
+
   // pop the mime_type off of the end of the vector
   ((UserData *)user_data)->mime_types.pop_back();
   // pop the retriever off of the end of the vector
@@ -545,10 +683,26 @@ static bool resolve_links(UserData *user_data){
   return false;
 }
 
+/*
+ * Translate what was recorded while planning, in document order.
+ */
+static void replay(UserData *user_data){
+  typedef vector<Event>::const_iterator event_iter;
+  for( event_iter it=user_data->events.begin() ; it!=user_data->events.end() ; it++ ){
+    if(it->kind==START_ELEMENT)
+      apply_element(user_data,user_data->elements[it->element]);
+    else if(it->kind==CHARACTERS)
+      user_data->char_data+=it->text;
+    else
+      finish_element(user_data,it->text);
+  }
+}
+
 extern bool xml_parser::parse_xml_file(const std::map<string,string> &map,
                                        const string &filename,
                                        NXhandle *handle,
-                                       const bool timing){
+                                       const bool timing,
+                                       const int threads){
 #ifdef DEBUG3_XML_PARSER
   std::cout << "xml_parser::parse_xml_file" << std::endl;
 #endif
@@ -561,6 +715,11 @@ extern bool xml_parser::parse_xml_file(const std::map<string,string> &map,
   user_data.mime_types.reserve(MAX_NODE_DEPTH);
   user_data.dims.reserve(25);
   user_data.retrievers.reserve(MAX_NODE_DEPTH);
+  Fetcher fetcher;
+  user_data.fetcher=&fetcher;
+  // with threads the file is parsed first and translated afterwards, so
+  // the retrievers can be called ahead of the writing
+  user_data.planning=(threads>1);
 
   // parse the translation file (context needed to get positions in the file)
   context=xmlCreateFileParserCtxt(filename.c_str());
@@ -574,9 +733,32 @@ extern bool xml_parser::parse_xml_file(const std::map<string,string> &map,
   else if(result<0)
     return true; // return generic error
 
+  if(user_data.planning){
+#ifdef USE_TIMING
+    if (timing) {
+      cout << print_time(intermediate_time) << " to plan the translation" << endl;
+      intermediate_time = time(NULL);
+    }
+#endif
+    user_data.planning=false;
+    fetcher.start(threads);
+    try{
+      replay(&user_data);
+    }catch(runtime_error &e){ // deal with problems
+      cerr << RUNTIME_ERROR << ": " << e.what() << endl;
+      return true;
+    }
+    if(user_data.status)
+      return user_data.status;
+  }
+
 #ifdef USE_TIMING
   if (timing) {
     cout << print_time(intermediate_time) << " to add new information" << endl;
+    if (threads>1) {
+      cout << print_seconds(fetcher.retrieving()) << " in the retrievers" << endl;
+      cout << print_seconds(fetcher.waiting()) << " waiting for the retrievers" << endl;
+    }
     intermediate_time = time(NULL);
   }
 #endif
@@ -16,6 +16,6 @@ extern std::string print_time(const time_t & start,
 namespace xml_parser{
   extern bool parse_xml_file(const std::map<std::string,std::string>&map,
                              const std::string &filename, NXhandle *handle,
-                             const bool timing);
+                             const bool timing, const int threads);
 };
 #endif
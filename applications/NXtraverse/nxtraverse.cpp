@@ -29,6 +29,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <vector>
 #include "nxtraverse.h"
 
 
@@ -85,7 +86,7 @@ int CNXTraverse::show_objects(const char* file_name)
 
 
     // traverse
-    if ( traverse( handle,  "/"  ) == NX_ERROR )
+    if ( traverse( handle ) == NX_ERROR )
         goto out;
 
     //close file
@@ -106,86 +107,66 @@ out:
 
 
 /*-------------------------------------------------------------------------
-* Function: traverse
-*
-* Purpose: recursive function that traverses a NeXus file and prints all objects
+* Function: collect_object
 *
+* Purpose: NXvisit callback that keeps the kind and path of every object
 *
 *-------------------------------------------------------------------------
 */
 
-int CNXTraverse::traverse( NXhandle handle, const char *grp_name  )
+static int collect_object( const NXvisitinfo *info, void *userdata )
 {
+    std::vector< std::pair<int, std::string> > *objects =
+        static_cast< std::vector< std::pair<int, std::string> > * >( userdata );
 
-    NXname name, nxclass;
-    int nxdataype;
-    int num_groups;
-    std::string path;
-
-    if ( NXinitgroupdir (handle) != NX_OK) 
-        return NX_ERROR;
-
-    if ( NXgetgroupinfo( handle, &num_groups, name, nxclass) != NX_OK )
-        return NX_ERROR;
+    objects->push_back( std::make_pair( info->kind, std::string( info->path ) ) );
+    return 0;
+}
 
-    for ( int i = 0; i < num_groups; i++ )
-    {
 
-        if ( NXgetnextentry ( handle, name, nxclass, &nxdataype) == NX_ERROR ) 
-            return NX_ERROR;
 
-        if (strcmp(nxclass,"SDS") == 0)
-        {
+/*-------------------------------------------------------------------------
+* Function: traverse
+*
+* Purpose: traverses a NeXus file and prints all objects. The tree is
+* listed by a single NXvisit, groups are only opened to read data.
+*
+*
+*-------------------------------------------------------------------------
+*/
 
-            
-            path = grp_name;
-            path += "/";
-            path += name;
+int CNXTraverse::traverse( NXhandle handle )
+{
+    std::vector< std::pair<int, std::string> > objects;
+    std::string path, name;
 
-            if ( options.read_data )
-            {
-                //do not print end line, data will be appended to this line
-                cout << path << "=";
+    if ( NXvisit( handle, 0, collect_object, &objects ) != NX_OK )
+        return NX_ERROR;
 
-                if ( show_dataset( handle, name, path.c_str() ) == NX_ERROR ) 
-                    return NX_ERROR;
-            }
-            else
-            {
+    for ( size_t i = 0; i < objects.size(); i++ )
+    {
+        path = objects[i].second;
 
-                //print name and end line
-                cout << path << endl;
+        if ( objects[i].first == NXVISIT_DATASET && options.read_data )
+        {
+            //do not print end line, data will be appended to this line
+            cout << path << "=";
 
-            }
-           
+            if ( NXopengrouppath( handle, path.c_str() ) != NX_OK )
+                return NX_ERROR;
 
+            name = path.substr( path.rfind( '/' ) + 1 );
+            if ( show_dataset( handle, name.c_str(), path.c_str() ) == NX_ERROR ) 
+                return NX_ERROR;
         }
         else
         {
 
-
-            path = grp_name;
-            if ( path !=  "/" )
-            path += "/";
-            path += name;
-
-
+            //print name and end line
             cout << path << endl;
 
-            if ( NXopengroup( handle, name, nxclass ) != NX_OK )
-                return NX_ERROR;
-
-            if ( traverse( handle, path.c_str() ) != NX_OK )
-                return NX_ERROR;
-
-            if ( NXclosegroup( handle ) != NX_OK )
-                return NX_ERROR;
-
-      
         }
 
-
-
     }
     
 
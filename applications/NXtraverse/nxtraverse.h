@@ -53,7 +53,7 @@ class CNXTraverse
 private:
 
     //traverse file
-    int traverse( NXhandle handle, const char *grp_name  );
+    int traverse( NXhandle handle );
 
     //print dataset
     int show_dataset( NXhandle handle, const char* dset_name, const char* path);
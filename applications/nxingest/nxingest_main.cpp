@@ -18,6 +18,11 @@
 			To avoid wrapping the xml document, 
 			set constnty 'MXML_WRAP' to a high value in mxml.h (under linux) or 
 			under windows, add function mxmlSetWrapMargin(0);
+
+		Version 2.0		19/10/2026
+			Several NeXus files for one mapping file, with the option -d for 
+			the directory of the outputs and -j for the number of files read 
+			at the same time. 
 		
   Copyright : 
 		nxingest  - extraction of metadata from NeXus files into a xml document.
@@ -56,43 +61,144 @@
 	return (NULL);
 }
 
+// *****************************************************************************
+//	Class : Ingest
+//		
+//		Writes the output of each NeXus file once NeXus::Extract has read 
+//		the values of the tags collected from the mapping file. 
+//		Called in the order of the files, on the main thread.
+// 
+// *****************************************************************************
+class Ingest : public NeXus::Extract::Handler
+{
+	private:
+		mxml_node_t *inTree;
+		NxRequests *requests;
+		const std::vector<string> &outputs;
+
+	public:
+		Ingest(mxml_node_t *tree, NxRequests *req, const std::vector<string> &out) 
+			: inTree(tree), requests(req), outputs(out) {}
+
+		void process(const NeXus::Extract::Result &result)
+		{
+			Log log;
+			FILE *outFp = 0;
+			mxml_node_t *outTree = 0;
+			const char *outputFl = outputs[result.index].c_str();
+			try
+			{
+				log.set("main", "input - nexus  ", result.filename.c_str()).printLevel(NXING_LOG_NORMAL);
+				log.set("main", "input - output ", outputFl).printLevel(NXING_LOG_NORMAL);
+
+				// Create XML output to ICAT. 
+				// **************************
+				outFp = fopen(outputFl, "w");
+				if( outFp == 0 ) throw log.set("main", "Can't open the output file!", outputFl, "", NXING_ERR_CANT_OPEN_OUTPUT);
+				if(inTree->type == MXML_ELEMENT  && (strncmp(inTree->value.element.name, "?xml", 4) == 0)){	
+					outTree = mxmlNewElement(MXML_NO_PARENT,  inTree->value.element.name);
+				}
+				log.set("main", "Output Created, first tag added!", inTree->value.element.name).printLevel(NXING_LOG_DEBUG);
+
+				//
+				// The values read from the neXus file.
+				// ************************************
+				NxClass nx(requests, &result);
+				log.set("main", "NeXus file read!", result.filename.c_str(), "", nx.status).printLevel(NXING_LOG_DEBUG);
+
+				/*
+				 * Parse the parameter file and populate the XML output. 
+				 */
+				log.set("main", "Parsing the mapping file!").printLevel(NXING_LOG_DEBUG);
+				mxml_node_t *inNode = mxmlWalkNext(inTree, inTree, MXML_DESCEND);
+				parseXml(inNode, inTree, &outTree, nx);
+
+				/* 
+				 * Save the output file
+				 */  	
+				mxmlSaveFile(outTree, outFp, whitespace_cb); 
+				log.set("main", "Output file Saved!", outputFl).printLevel(NXING_LOG_DEBUG);
+				fclose(outFp);
+				mxmlDelete(outTree);
+			}
+			catch(Log log)
+			{
+				log.printLevel(NXING_LOG_ERROR);
+				if(outFp != 0) fclose(outFp);
+				if(outTree != 0) mxmlDelete(outTree);
+			}
+		}
+};
+
+// *****************************************************************************
+//	Function : outputName
+//		
+//		Name of the output of a NeXus file in the output directory: 
+//		the name of the NeXus file with the extension .xml
+// 
+// *****************************************************************************
+static string outputName(const char *dir, const string &nexusFl)
+{
+	string name = nexusFl;
+	size_t found = name.find_last_of("/\\");
+	if(found != string::npos) name = name.substr(found+1);
+	found = name.find_last_of(".");
+	if(found != string::npos && found > 0) name = name.substr(0, found);
+	return string(dir) + "/" + name + ".xml";
+}
+
 int main (int argc, char *argv[])
 {
 	Log log;
 	FILE *inFp = 0;
-	FILE *outFp = 0; 
-	mxml_node_t 	*outTree = 0;	// hold the xml input to ICAT
 	mxml_node_t 	*inTree = 0;	// Hold the parameter list
+	mxml_node_t 	*scratchTree = 0;	// Output of the pass collecting the tags
 	try
 	{
 		// Check if my assumption of type size are correct. 
 		// ************************************************
-
 		if(sizeof(short) != 2 || sizeof(int) != 4 )
 			log.set("Compiler Test", "The integer sizes are not as expected", "(short 2 bytes; int 4 bytes)").printLevel(NXING_LOG_WARNING);
 		if(sizeof(float) != 4 ||sizeof(double) != 8)
 			log.set("Compiler Test", "The float sizes are not as expected", "(float 4 bytes; double 8 bytes)").printLevel(NXING_LOG_WARNING);
 
 		char mappingFl[NXING_BIG_SIZE] = "";	
-		char nexusFl[NXING_BIG_SIZE]   = "";
-		char outputFl[NXING_BIG_SIZE]  = "";	
-		
-		if(argc < 3)
+		const char *outputDir = 0;
+		int threads = 2;
+		std::vector<string> nexusFls;
+		std::vector<string> outputFls;
+
+		// Options come first : -d output directory, -j number of threads.
+		int arg = 1;
+		while(arg < argc && argv[arg][0] == '-')
+		{
+			if(strcmp(argv[arg], "-d") == 0 && arg+1 < argc) outputDir = argv[++arg];
+			else if(strcmp(argv[arg], "-j") == 0 && arg+1 < argc) threads = atoi(argv[++arg]);
+			else throw log.set("main", "Unknown option!", argv[arg], "Options are -d directory and -j threads.", NXING_ERR_WRONG_INPUT);
+			arg++;
+		}
+		if(argc - arg < 2)
 		{
 			throw log.set("main", "Not enough input parameters!", "Needs 2 input files, mapping file and the NeXus file.", "And one output file.", NXING_ERR_WRONG_INPUT);
 		}
+		strcpy(mappingFl, argv[arg++]);
+		if(outputDir != 0)
+		{
+			// All the other parameters are NeXus files.
+			for(; arg < argc; arg++)
+			{
+				nexusFls.push_back(argv[arg]);
+				outputFls.push_back(outputName(outputDir, argv[arg]));
+			}
+		}
 		else 
 		{
-			if(argv[1] != 0) strcpy(mappingFl, argv[1]);	
-			if(argv[2] != 0) strcpy(nexusFl, argv[2]);
-			if(argv[3] != 0) strcpy(outputFl, argv[3]);
-			else strcpy(outputFl, "output.xml");	
+			nexusFls.push_back(argv[arg++]);
+			if(arg < argc) outputFls.push_back(argv[arg]);
+			else outputFls.push_back("output.xml");	
 		}
 		log.set("main", "input - mapping", mappingFl).printLevel(NXING_LOG_NORMAL);
-		log.set("main", "input - nexus  ", nexusFl).printLevel(NXING_LOG_NORMAL);
-		log.set("main", "input - output ", outputFl).printLevel(NXING_LOG_NORMAL);
-		
-		
+
 		// Read input XML Parameters. 
 		// **************************'
 #ifndef MXML_WRAP
@@ -100,65 +206,47 @@ int main (int argc, char *argv[])
 #endif
 		inFp = fopen(mappingFl, "r");
 		if( inFp == 0 ) throw log.set("main", "Can't open the parameter file!", mappingFl, "", NXING_ERR_CANT_OPEN_PARAM);
-		mxml_node_t 	*inNode;	// hold the node to read from.
 		inTree = mxmlLoadFile(NULL, inFp, MXML_TEXT_CALLBACK);
 		fclose(inFp);
 		inFp = 0;
 		if(inTree != 0) log.set("main", "The mapping file has been read!", mappingFl).printLevel(NXING_LOG_ALL);
 
-		
-		// Create XML output to ICAT. 
-		// **************************
-		outFp = fopen(outputFl, "w");
-		if( outFp == 0 ) throw log.set("main", "Can't open the output file!", outputFl, "", NXING_ERR_CANT_OPEN_OUTPUT);
-	
-		if(inTree->type == MXML_ELEMENT  && (strncmp(inTree->value.element.name, "?xml", 4) == 0)){	
-			outTree = mxmlNewElement(MXML_NO_PARENT,  inTree->value.element.name);
+		/*
+		 * Parse the parameter file once to collect the tags to read 
+		 * from the neXus files.
+		 */
+		NxRequests requests;
+		{
+			NxClass collector(&requests);
+			scratchTree = mxmlNewElement(MXML_NO_PARENT, "scratch");
+			mxml_node_t *inNode = mxmlWalkNext(inTree, inTree, MXML_DESCEND);
+			parseXml(inNode, inTree, &scratchTree, collector);
+			mxmlDelete(scratchTree);
+			scratchTree = 0;
 		}
-		
-		log.set("main", "Output Created, first tag added!", inTree->value.element.name).printLevel(NXING_LOG_DEBUG);
-		//
-
-		// Open the neXus file.
-		// ********************
-		NxClass nx(nexusFl);
-		//if(nx.isNotOK) throw log.set("Can't open the neXus file!", nexusFl, nx.status);
-		log.set("main", "NeXs file read!", nexusFl, "", nx.status).printLevel(NXING_LOG_DEBUG);
+		char str[NXING_MED_SIZE];
+		sprintf(str, "%d", (int)requests.tags.size()); 
+		log.set("main", "Tags collected from the mapping file", str).printLevel(NXING_LOG_DEBUG);
 
 		/*
-	 	 * Parse the parameter file, read the neXus file and populate the XML output. 
+		 * Read the neXus files and write the outputs. 
 		 */
-		 log.set("main", "Parsing the mapping file!").printLevel(NXING_LOG_DEBUG);
-		 inNode = mxmlWalkNext(inTree, inTree, MXML_DESCEND);
-		 parseXml(inNode, inTree, &outTree, nx);
+		Ingest ingest(inTree, &requests, outputFls);
+		requests.extractor.setThreads(threads);
+		requests.extractor.run(nexusFls, ingest);
 
-	
-		/* 
-		 * Save the output file
-		 */  	
-		mxmlSaveFile(outTree, outFp, whitespace_cb); 
-		log.set("main", "Output file Saved!", outputFl).printLevel(NXING_LOG_DEBUG);
-
-		/* 
-		 * Close the files
-		 */
-		fclose(outFp);
 		/*
 	     * Delete the xml Trees
 	     */
 		mxmlDelete(inTree);
-	 	mxmlDelete(outTree);
 		exit(0);
 	}
 	catch(Log log)
 	{
 		log.printLevel(NXING_LOG_ERROR);
 		if(inFp  != 0) fclose(inFp);		
-		if(outFp != 0) fclose(outFp);
-		
 		if(inTree  != 0) mxmlDelete(inTree);
-	 	if(outTree != 0) mxmlDelete(outTree);
+	 	if(scratchTree != 0) mxmlDelete(scratchTree);
 		exit(0);
 	}	
 }
-	
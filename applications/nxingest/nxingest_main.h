@@ -32,6 +32,9 @@
 #include "nxingest_utils.h"
 #include "nxingest_parse.h"
 
+#include <string>
+#include <vector>
+
 #define NXING_ERR_WRONG_INPUT		NXING_ERR_BASE_MAIN -1
 #define NXING_ERR_CANT_OPEN_PARAM	NXING_ERR_BASE_MAIN -2
 #define NXING_ERR_CANT_OPEN_OUTPUT	NXING_ERR_BASE_MAIN -3
@@ -22,6 +22,11 @@
 
 		Version 1.9		08/09/2007		
 			Make sure that the location string will use the linxu separator '/'
+
+		Version 2.0		19/10/2026
+			Read the values through NeXus::Extract, which collects the tags of 
+			the mapping file first and reads them from every file in one walk.
+			Accept [AVG] as documented.
 		
   Copyright : 
 		nxingest  - extraction of metadata from NeXus files into a xml document.
@@ -44,69 +49,58 @@
 #include <vector>
 
 using std::string;
+using NeXus::Extract::Request;
+using NeXus::Extract::Value;
 
-string buff2str(const void* buff, int rank, const int dim[], int data_type, const char* vector);
+static Request tag2request(const string &tag);
+static string value2str(const Value &value, NeXus::Extract::Operation operation);
 
-// Enumeration for the different calculation available for arrays. 
-// Positives number are used for specific value of the array. 
-enum Calculation { Direct = 0, Avg = -1, Min = -2, Max = -3, Std = -4, Sum = -5};
+NxRequests::NxRequests()
+{
+	// The number of users decides how often the user tables are parsed.
+	users = extractor.add("/{NXentry}/{NXuser}", "", NeXus::Extract::COUNT);
+}
 
 // *****************************************************************************
-//	Function : NxClass Constructor
+//	Function : NxClass Constructors
 //		
-//		The constructor will initialise the class by opening the NeXus file and 
-//		Searching for the class name for the class NXentry, NXinstrument and 
-//		NXuser. More than 1 NXuser class may be present.
+//		Without a result, the class collects the tags read from the mapping 
+//		file into the requests, and readTag returns no value. 
+//		With the result of a NeXus file, readTag returns the values read for 
+//		the tags. More than 1 NXuser class may be present.
 // 
 // *****************************************************************************
  
-NxClass::NxClass(const char* filename)
+NxClass::NxClass(NxRequests *requests)
+{
+	this->requests = requests;
+	result = 0;
+	numUsers = 1;
+	currentUser = 0;
+	status = NXING_OK;
+}
+
+NxClass::NxClass(NxRequests *requests, const NeXus::Extract::Result *result)
 {
 	Log log;
+	this->requests = requests;
+	this->result = result;
 	numUsers = 0;
 	currentUser = -1;
 	status = NXING_OK;
-	try
-	{		
-		status = NXopen (filename, NXACC_READ, &nxFp );
-		if( status != NXING_OK ) throw log.set("NxClass", "Can't open the neXus file!", filename, "", NXING_ERR_BASE_NEXUS-status);
-		char nx_name[NX_MAXNAMELEN];
-		char nx_group[NX_MAXNAMELEN];
-		int data_type;
-		
-		// Find the NXentry and open the group
-		status = NXinitgroupdir(nxFp);
-		while( (status = NXgetnextentry (nxFp, nx_name, nx_group, &data_type)) == NXING_OK && strcmp(nx_group, "NXentry") != 0 ){;}
-		if(strcmp(nx_group, "NXentry") == 0) strcpy(entry, nx_name);
-		status = NXopengroup(nxFp, nx_name, nx_group);
-		if( status != NXING_OK ) throw log.set("NxClass", "Can't open the neXus group!", nx_name, nx_group, NXING_ERR_BASE_NEXUS-status);
-
-		// Find the NXuser and NXinstrument class 
-		status = NXinitgroupdir(nxFp);
-		while( (status = NXgetnextentry (nxFp, nx_name, nx_group, &data_type)) == NXING_OK)
-		{
-			if(strcmp(nx_group, "NXinstrument") == 0) 
-			{
-				strcpy(inst, nx_name);
-			}
-			if(strcmp(nx_group, "NXuser") == 0)  
-			{
-				strcpy(users[numUsers], nx_name);
-				numUsers++;
-				currentUser = 0;
-			}
-		}
-		char str[NXING_MED_SIZE];
-		sprintf(str, "%d Users found!",numUsers); 
-		log.set("NxClass", entry, inst, str).printLevel(NXING_LOG_DEBUG);
-		status = NXING_OK;
-		return;
-	}
-	catch(Log log)
+	if(!result->ok)
 	{
-		log.printLevel(NXING_LOG_ERROR);
+		status = NXING_ERR_BASE_NEXUS - NX_ERROR;
+		log.set("NxClass", "Can't open the neXus file!", result->filename.c_str(), "", status).printLevel(NXING_LOG_ERROR);
 		return;
 	}
+	const std::vector<Value> &users = result->values[requests->users];
+	for(size_t i = 0; i < users.size() && numUsers < NXING_MAX_USERS; i++)
+		if(users[i].ok) numUsers++;
+	if(numUsers > 0) currentUser = 0;
+	char str[NXING_MED_SIZE];
+	sprintf(str, "%d Users found!",numUsers); 
+	log.set("NxClass", result->filename.c_str(), str).printLevel(NXING_LOG_DEBUG);
 }
 
 NxClass::~NxClass()
@@ -119,13 +113,12 @@ NxClass::~NxClass()
 // *****************************************************************************
 //	Function : NxClass::readTag
 //		
-//		The function will parse the input NeXus path to replace the NXentry, 
-//		NXinstrument and NXuser by their proper value. 
-//		After that it will check if it need to read 
+//		The {NXentry}, {NXinstrument} and {NXuser} of the input NeXus path 
+//		are resolved by NeXus::Extract, which reads
 //		- an attribute (separated from the path with a '.') or 
 //		- an array (which ends with [i], [AVG], [STD], [MIN] or [MAX])
-//		Read the data and ask the function buff2str to transform it into 
-//		a string that the function will return. 
+//		The function looks up the value read for the tag and transforms it 
+//		into a string that the function will return. 
 // 
 // *****************************************************************************
 char* NxClass::readTag(char *input, char *value, int user)
@@ -134,90 +127,35 @@ char* NxClass::readTag(char *input, char *value, int user)
 	try 
 	{
 		if(user != -1 && (user >= 0 && user < numUsers)) currentUser = user;
-			
-		// Replace the {NXentry}, {NXinstrument} and {NXuser} 
-		// by their values read at initialisation.
-		// Store the modified string into nx_name
-		// ***************************************************
-		char nx_name[NXING_BIG_SIZE] = "";
-		char *pch = strtok (input,"{}");
-		while (pch != NULL)
+
+		string tag(input);
+		while(tag.size() > 0 && tag[tag.size()-1] == ' ') tag.erase(tag.size()-1);
+
+		std::map<string, size_t>::iterator it = requests->tags.find(tag);
+		if(isCollecting())
 		{
-			if(strcmp(pch, "NXentry") == 0) strcat(nx_name, entry);
-			else if(strcmp(pch, "NXinstrument") == 0 ) strcat(nx_name, inst);
-			else if(strcmp(pch, "NXuser") == 0) strcat(nx_name, users[currentUser]);
-			else strcat(nx_name, pch);
-			pch = strtok (NULL, "{}");
-			
+			if(it == requests->tags.end())
+				requests->tags[tag] = requests->extractor.add(tag2request(tag));
+			return 0;
 		}
-		while(nx_name[strlen(nx_name)-1] == ' ') nx_name[strlen(nx_name)-1] = 0;
-		log.set("readTag","Path transformed into", nx_name).printLevel(NXING_LOG_DEBUG);
+		if(it == requests->tags.end())
+			throw log.set("readTag", "Tag not collected from the mapping file", tag.c_str());
 
-		// Some declaration
-		unsigned int nd = 0;				// Position of special character
-		int length = 0;			
-		int rank = 1;						// Number of dimension of the data
-		int dim[NXING_MAX_DIM];				// size of each dimension
-		int data_type;						// data type
-		char nexus_path[NXING_BIG_SIZE] = ""; // String to hold the neXus path while it is split in its different part.
-		char name[NXING_MED_SIZE] = "";		// string to hold the name of the various attribute while looking for the type of the attribute.
-		char *vector = 0;					// End of the neXus path that describe what to do with array data.
-		char *attr_name;					// Name of the attribute to be read
-		void * buff;						// Buffer to store the data from the neXus API.
-		
-		status = NXING_OK;
-		
-		// check if it is an attribute. (presence of '.')
-		// ****************************
-		
-		if((nd = strcspn(nx_name, ".") ) < strlen(nx_name)) 
+		// A path through {NXuser} matches every user, in order.
+		const std::vector<Value> &values = result->values[it->second];
+		size_t match = 0;
+		if(tag.find("{NXuser}") != string::npos) 
 		{
-			strncpy(nexus_path, nx_name, nd);
-			nexus_path[nd] = 0;
-			attr_name = &nx_name[nd+1];
-			status = NXopenpath(nxFp, nexus_path);
-			if(status != NXING_OK) 
-				throw log.set( "readTag", "Can't open the path to element", nexus_path, attr_name);
-			status = NXinitattrdir (nxFp);
-			while( ((status = NXgetnextattr (nxFp, name, &length, &data_type)) == NXING_OK) && (strcmp(name, attr_name) != 0 ));
-			if(status != NXING_OK) 
-				throw log.set("readTag", "No attribute with the following name found!", attr_name);
-			else 
-			{
-				dim[0] = length+2;
-				status = NXmalloc (&buff, 1, dim, data_type);
-				if(status != NXING_OK) throw log.set("readTag", "Can't allocate the buffer", nexus_path, attr_name ,NXING_ERR_BASE_NEXUS-status);
-				status = NXgetattr (nxFp, attr_name, buff, &dim[0], &data_type);
-				if(status != NXING_OK) throw log.set("readTag", "Can't read the attribute", attr_name, "",NXING_ERR_BASE_NEXUS-status);
-			}
-		}
-		else
-		{			
-			// Check if is is an element part of an array (presence of '[]' or [x]
-			if((nd = strcspn(nx_name, "[") ) < strlen(nx_name))
-			{
-				strncpy(nexus_path, nx_name, nd);
-				nexus_path[nd] = 0;
-				vector = &nx_name[nd];
-			}
-			else
-			{
-				strcpy(nexus_path,nx_name);
-				vector = &nx_name[strlen(nx_name)];
-			}
-			log.set("readTag", "Get Data ", nexus_path, vector).printLevel(NXING_LOG_DEBUG);
-			status = NXopenpath(nxFp, nexus_path);
-			if(status != NXING_OK) throw log.set( "readTag", "Can't open the path to element", nexus_path, "");
-			status = NXgetinfo (nxFp, &rank, dim, &data_type);
-			if(status != NXING_OK) throw log.set("readTag", "Can't collect the info on element", nexus_path, "",NXING_ERR_BASE_NEXUS-status);
-			status = NXmalloc (&buff, rank, dim, data_type);
-			if(status != NXING_OK) throw log.set("readTag", "Can't allocate the buffer", nexus_path, "",NXING_ERR_BASE_NEXUS-status);
-			status = NXgetdata (nxFp, buff); 
-			if(status != NXING_OK) throw log.set("readTag", "Can't get the data", nexus_path, "",NXING_ERR_BASE_NEXUS-status);
+			if(currentUser < 0) throw log.set("readTag", "No user for", tag.c_str());
+			match = currentUser;
 		}
-		const string strval = buff2str(buff,  rank, dim, data_type, vector);
+		if(match >= values.size() || !values[match].ok)
+			throw log.set("readTag", "Can't read the element", tag.c_str(), match < values.size() ? values[match].error.c_str() : "");
+
+		const Request &request = requests->extractor.getRequests()[it->second];
+		const string strval = value2str(values[match], request.operation);
 		strcpy(value, strval.c_str());
-		log.set("readTag", nx_name, "Return", value).printLevel(NXING_LOG_DEBUG);
+		log.set("readTag", tag.c_str(), "Return", value).printLevel(NXING_LOG_DEBUG);
 
 		return value;
 	}	
@@ -230,7 +168,13 @@ char* NxClass::readTag(char *input, char *value, int user)
 }
 char* NxClass::getLocation(char *value)
 {
-	NXinquirefile(nxFp, value, NXING_MED_SIZE); 
+	if(isCollecting()) 
+	{
+		strcpy(value, "");
+		return value;
+	}
+	strncpy(value, result->filename.c_str(), NXING_MED_SIZE);
+	value[NXING_MED_SIZE-1] = 0;
 	char keys[] = "\\";
 	int i= strcspn (value,keys);
 	while(i < strlen(value))
@@ -243,172 +187,110 @@ char* NxClass::getLocation(char *value)
 
 
 // *****************************************************************************
-//	Function : buff2str
+//	Function : tag2request
 //		
-//		The function will parse the data buffer according to the content of 
-//		vector and return a string.
+//		The function will parse the NeXus path of a tag. 
+//		An attribute is separated from the path with a '.'. 
+//		An array is followed by what has to be done with it :
+//		[AVG] Average, [STD] Standard Deviation, [MIN]/[MAX] Minimum/Maximum 
+//		value, [SUM] Sum or [i] a single element. Single values are element 0.
+//
+// *****************************************************************************
+static Request tag2request(const string &tag)
+{
+	size_t nd;
+	if((nd = tag.find('.')) != string::npos)
+	{
+		return Request(tag.substr(0, nd), tag.substr(nd+1), NeXus::Extract::ELEMENT, 0);
+	}
+	if((nd = tag.find('[')) == string::npos)
+	{
+		return Request(tag, "", NeXus::Extract::ELEMENT, 0);
+	}
+	const string path = tag.substr(0, nd);
+	const string vector = tag.substr(nd);
+	if(vector == "[]" || vector == "[AVG]" || vector == "[AVR]")
+		return Request(path, "", NeXus::Extract::MEAN);
+	if(vector == "[MIN]")
+		return Request(path, "", NeXus::Extract::MIN);
+	if(vector == "[MAX]")
+		return Request(path, "", NeXus::Extract::MAX);
+	if(vector == "[STD]")
+		return Request(path, "", NeXus::Extract::STDDEV);
+	if(vector == "[SUM]")
+		return Request(path, "", NeXus::Extract::SUM);
+	return Request(path, "", NeXus::Extract::ELEMENT, atoi(&vector[1]));
+}
+
+// *****************************************************************************
+//	Function : value2str
+//		
+//		The function will transform a value into a string.
 //		if data_type is NX_CHAR, return the string.
-//		if vector is empty, transform the buffer into a number.
-//		else transform the buffer into an array of double and apply the 
-//		calculation. [AVG] Average, [STD] Standard Deviation, 
-//		[MIN]/[MAX] Minimum/Maximum value.
+//		For a single element, transform the element into a number.
+//		else print the result of the calculation, as an integer for 
+//		the minimum, maximum and sum of integers.
 //
 // *****************************************************************************
-string buff2str(const void* buff, int rank, const int dim[], int data_type, const char* vector)
+static string value2str(const Value &value, NeXus::Extract::Operation operation)
 {
-	Log log;
-	try 
+	// If type NX_CHAR, return the buffer
+	// **********************************
+	if(value.type == NX_CHAR)
 	{
-		// If type NX_CHAR, return the buffer
-		// **********************************
-		if(data_type == NX_CHAR)
-		{
-			return string(static_cast<const char*>(buff));
-		}
-		int vec = 0;
-		std::stringstream stream;
-		// Parse the vector to check what has to be done with the buffer
-		// **************************************************************
-		if(vector == 0  || strlen(vector) == 0) vec = Direct;	
-		else if ( strcmp(vector, "[]") == 0 || strcmp(vector, "[AVR]") == 0 ) vec = Avg; // Average
-		else if (  strcmp(vector, "[MIN]") == 0) vec = Min;		// Min value
-		else if (  strcmp(vector, "[MAX]") == 0) vec = Max;		// Max value
-		else if (  strcmp(vector, "[STD]") == 0) vec = Std;		// Standard Deviation
-		else if (  strcmp(vector, "[SUM]") == 0) vec = Sum;		// Sum of all values
-		else 
+		return string(&value.data[0]);
+	}
+	std::stringstream stream;
+	// Single Value
+	// ************
+	if(operation == NeXus::Extract::ELEMENT)
+	{
+		const void *buff = &value.data[0];
+		switch(value.type)
 		{
-			vec = atoi(&vector[1]); 
+			case NX_INT8	:
+				stream << static_cast<int>(static_cast<const int8_t*>(buff)[0]);
+				break;			
+			case NX_UINT8	:
+				stream << static_cast<int>(static_cast<const uint8_t*>(buff)[0]);
+				break;			
+			case NX_INT16	:
+				stream << static_cast<const int16_t*>(buff)[0];
+				break;
+			case NX_INT32	:
+				stream << static_cast<const int32_t*>(buff)[0];
+				break;
+			case NX_UINT16	:
+				stream << static_cast<const uint16_t*>(buff)[0];
+				break;
+			case NX_UINT32	:
+				stream << static_cast<const uint32_t*>(buff)[0];
+				break;
+			case NX_INT64	:
+				stream << static_cast<long long int>(static_cast<const int64_t*>(buff)[0]);
+				break;
+			case NX_UINT64	:
+				stream << static_cast<unsigned long long int>(static_cast<const uint64_t*>(buff)[0]);
+				break;
+			case NX_FLOAT32	:
+				stream << static_cast<const float*>(buff)[0];
+				break;
+			case NX_FLOAT64	:
+				stream << static_cast<const double*>(buff)[0];
+				break;
+			default	:
+				break;
 		}	
-		// Single Value
-		// ************
-		if(vec >= 0)
-		{
-			switch(data_type)
-			{
-				case NX_INT8	:
-					stream << static_cast<int>(static_cast<const char*>(buff)[vec]);
-					break;			
-				case NX_INT16	:
-					stream << static_cast<const int16_t*>(buff)[vec];
-					break;
-				case NX_INT32	:
-					stream << static_cast<const int32_t*>(buff)[vec];
-					break;
-				case NX_UINT16	:
-					stream << static_cast<const uint16_t*>(buff)[vec];
-					break;
-				case NX_UINT32	:
-					stream << static_cast<const uint32_t*>(buff)[vec];
-					break;
-				case NX_FLOAT32	:
-					stream << static_cast<const float*>(buff)[vec];
-					break;
-				case NX_FLOAT64	:
-					stream << static_cast<const double*>(buff)[vec];
-					break;
-				default	:
-					break;
-			}	
-		} 
-		// Array from which a value need to be extracted
-		// *********************************************
-		else if (vec < Direct)
-		{
-			// Don't need to look for multi-dimension array. 
-			// All data is 1 dimension only.
-			// **********************************************
-			long num_val = dim[0];
-			for(int i =1; i< rank; i++) num_val *= dim[i];
-			if(num_val <= 0) { 
-				throw log.set("buff2str", "The number of value of the array is null or negative.", "", "" ,NXING_ERR_NEGATIVE_NUMVAL);
-			}		// Big mistake
-			std::vector<double> dblBuff = std::vector<double>(num_val, 0.0);
-			// Transform the array of unknown type into an array of double
-			// ***********************************************************
-			int i = 0;
-			switch(data_type)
-			{
-				case NX_INT8	:
-					for( i = 0; i< num_val; i++)
-						dblBuff[i] = static_cast<const char*>(buff)[i];
-					break;			
-				case NX_INT16	:
-					for( i = 0; i< num_val; i++)
-						dblBuff[i] = static_cast<const int16_t*>(buff)[i];
-					break;			
-				case NX_INT32	:
-					for( i = 0; i< num_val; i++)
-						dblBuff[i] = static_cast<const int32_t*>(buff)[i];
-					break;			
-				case NX_UINT16	:
-					for( i = 0; i< num_val; i++)
-						dblBuff[i] = static_cast<const uint16_t*>(buff)[i];
-					break;			
-				case NX_UINT32	:
-					for( i = 0; i< num_val; i++)
-						dblBuff[i] = static_cast<const uint32_t*>(buff)[i];
-					break;
-				case NX_FLOAT32	:
-					for( i = 0; i< num_val; i++)
-						dblBuff[i] = static_cast<const float*>(buff)[i];
-					break;		
-				case NX_FLOAT64	:
-					for( i = 0; i< num_val; i++)
-						dblBuff[i] = static_cast<const double*>(buff)[i];
-					break;		
-				default	:
-					break;
-			}
-			// Perform the caclulations.
-			// *************************
-			double num_value = 0.0;
-			double avrg = 0.0;	
-			int j = 0;			
-			switch (vec){
-				case Avg :
-					for( j = 0; j< num_val; j++) num_value +=  dblBuff[j];
-					num_value /= (double)num_val;
-					break; 
-					
-				case Std :
-					for( j = 0; j< num_val; j++) avrg +=  dblBuff[j];
-					avrg /= (double)num_val;
-					num_value = 0;
-					for( j = 0; j< num_val; j++) num_value +=  pow((avrg - dblBuff[j]),2);
-						num_value = sqrt(num_value/(double)num_val);				
-					break; 
-					
-				case Min : 
-					num_value = dblBuff[0];
-					for( j = 1; j< num_val; j++) 
-						if( dblBuff[j] < num_value)
-							num_value = dblBuff[j];				
-						break; 
-					
-				case Max :
-					num_value = dblBuff[0];
-					for( j = 1; j< num_val; j++) 
-						if( dblBuff[j] > num_value) 
-							num_value = dblBuff[j];
-						break; 				
-				case Sum :
-					for( j = 0; j< num_val; j++) num_value +=  dblBuff[j];
-					break; 
-					
-				default : 
-					break; 
-			}
-			if((vec == Min || vec == Max || vec == Sum ) && (data_type == NX_INT8 || data_type == NX_INT16 || data_type == NX_INT32 || data_type == NX_UINT16 || data_type == NX_UINT32))
-			        stream << static_cast<long long int>(num_value);
-			else 
-			        stream << num_value;
-		}
-		return(stream.str());
-	}	
-	catch(Log log)
+	} 
+	// Value derived from an array
+	// ***************************
+	else
 	{
-		log.printLevel(NXING_LOG_ERROR);
-		throw;
+		bool integer = (value.type != NX_FLOAT32 && value.type != NX_FLOAT64);
+		if((operation == NeXus::Extract::MIN || operation == NeXus::Extract::MAX || operation == NeXus::Extract::SUM) && integer)
+		        stream << static_cast<long long int>(value.number);
+		else 
+		        stream << value.number;
 	}
-	
+	return(stream.str());
 }
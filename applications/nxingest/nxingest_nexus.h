@@ -30,18 +30,30 @@
 #include "nxingest.h"
 #include "nxingest_debug.h"
 #include "nxingest_utils.h"
+#include "NeXusExtract.hpp"
+
+#include <map>
+#include <string>
 
 #define		NXING_MAX_USERS		64
 
 #define		NXING_ERR_NEGATIVE_NUMVAL	NXING_ERR_BASE_NEXUS - 100
 
+// The requests collected from the mapping file, read from every NeXus file.
+struct NxRequests
+{
+	NeXus::Extract::Extractor extractor;
+	std::map<std::string, size_t> tags;		// Tag of the mapping file to request
+	size_t users;							// Request counting the NXuser groups
+
+	NxRequests();
+};
+
 class NxClass
 {
 	private:
-		NXhandle	nxFp;
-		char entry[NX_MAXNAMELEN];					// Replace {NXentry}
-		char inst[NX_MAXNAMELEN];					// Replace {NXinstrument}
-		char users[NXING_MAX_USERS][NX_MAXNAMELEN];	// Replace {NXuser}
+		NxRequests *requests;
+		const NeXus::Extract::Result *result;	// 0 while collecting the requests
 		int numUsers;
 		int currentUser;
 		
@@ -49,7 +61,8 @@ class NxClass
 		int status;
 	
 	public:
-		NxClass(const char* filename); 
+		NxClass(NxRequests *requests);
+		NxClass(NxRequests *requests, const NeXus::Extract::Result *result);
 		~NxClass();
 		char* readTag(char *input, char *value, int user);
 		char* getLocation(char *value);
@@ -60,6 +73,7 @@ class NxClass
 		int setUser(int u = 0){ if(u>=0 && u < numUsers) { currentUser = u; return currentUser; } else { return -1;} };
 		bool isOK(){ if(status == NXING_OK) return true; else return false; }
 		bool isNotOK(){ if(status != NXING_OK) return true; else return false; }
+		bool isCollecting(){ return result == 0; }
 
 };
 
@@ -0,0 +1,1286 @@
+//
+//  NeXus - Neutron & X-ray Common Data Format
+//
+//  Extraction of the same values from many NeXus files
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free
+//  Software Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+//  MA  02111-1307  USA
+//
+//  For further information, see http://www.nexusformat.org/
+//
+
+/**
+ * \file NeXusExtract.cpp
+ * Implementation of the extraction of values from many files
+ */
+
+#include <cmath>
+#include <cstring>
+#include <sstream>
+#include "napiconfig.h"
+#include "NeXusExtract.hpp"
+
+#if !defined(_WIN32) && HAVE_LIBPTHREAD
+#include <pthread.h>
+#define NX_EXTRACT_THREADS 1
+#endif
+
+using std::map;
+using std::string;
+using std::vector;
+
+namespace NeXus {
+namespace Extract {
+
+Request::Request(const string& path, const string& attribute,
+                 Operation operation, int64_t element, double low,
+                 double high) :
+  path(path), attribute(attribute), operation(operation), element(element),
+  low(low), high(high)
+{
+}
+
+bool Request::operator<(const Request& other) const
+{
+  if (path != other.path) {
+    return path < other.path;
+  }
+  if (attribute != other.attribute) {
+    return attribute < other.attribute;
+  }
+  if (operation != other.operation) {
+    return operation < other.operation;
+  }
+  if (element != other.element) {
+    return element < other.element;
+  }
+  if (low != other.low) {
+    return low < other.low;
+  }
+  return high < other.high;
+}
+
+Value::Value() : ok(false), type(CHAR), number(0.)
+{
+}
+
+Handler::~Handler()
+{
+}
+
+namespace {
+  /*
+   * The requests sorted into a tree of path elements. Each node lists the
+   * requests for its object.
+   */
+  struct Node {
+    map<string, Node*> children;
+    vector<size_t> requests;
+
+    ~Node()
+    {
+      for (map<string, Node*>::iterator it = children.begin();
+           it != children.end(); ++it) {
+        delete it->second;
+      }
+    }
+
+    Node* child(const string& element)
+    {
+      Node*& node = children[element];
+      if (node == NULL) {
+        node = new Node();
+      }
+      return node;
+    }
+  };
+
+  class Plan {
+  public:
+    Plan(const vector<Request>& requests, size_t blockSize, bool overlap) :
+      blockSize(blockSize), overlap(overlap), m_requests(requests)
+    {
+      for (size_t i = 0; i < requests.size(); i++) {
+        Node* node = &m_root;
+        std::istringstream elements(requests[i].path);
+        string element;
+        while (std::getline(elements, element, '/')) {
+          if (!element.empty()) {
+            node = node->child(element);
+          }
+        }
+        node->requests.push_back(i);
+      }
+    }
+
+    const Node& root() const
+    {
+      return m_root;
+    }
+
+    const vector<Request>& requests() const
+    {
+      return m_requests;
+    }
+
+    /* how the reductions read fields */
+    const size_t blockSize;
+    const bool overlap;
+
+  private:
+    Plan(const Plan&);
+    Plan& operator=(const Plan&);
+
+    Node m_root;
+    const vector<Request>& m_requests;
+  };
+
+  size_t typeSize(int type)
+  {
+    switch (type) {
+    case NX_INT16:
+    case NX_UINT16:
+      return 2;
+    case NX_INT32:
+    case NX_UINT32:
+    case NX_FLOAT32:
+      return 4;
+    case NX_INT64:
+    case NX_UINT64:
+    case NX_FLOAT64:
+      return 8;
+    default:
+      return 1;
+    }
+  }
+
+  bool isNumber(int type)
+  {
+    switch (type) {
+    case NX_INT8:
+    case NX_UINT8:
+    case NX_INT16:
+    case NX_UINT16:
+    case NX_INT32:
+    case NX_UINT32:
+    case NX_INT64:
+    case NX_UINT64:
+    case NX_FLOAT32:
+    case NX_FLOAT64:
+      return true;
+    default:
+      return false;
+    }
+  }
+
+  bool isReduction(Operation operation)
+  {
+    switch (operation) {
+    case SUM:
+    case MIN:
+    case MAX:
+    case MEAN:
+    case STDDEV:
+    case NONZERO:
+    case HISTOGRAM:
+      return true;
+    default:
+      return false;
+    }
+  }
+
+  /*
+   * Sums of a block are kept in the widest type of the same kind, which is
+   * exact for the small integers and lets the loop stay in integers.
+   */
+  template <typename NumT> struct Sum { typedef double type; };
+  template <> struct Sum<int8_t> { typedef int64_t type; };
+  template <> struct Sum<uint8_t> { typedef uint64_t type; };
+  template <> struct Sum<int16_t> { typedef int64_t type; };
+  template <> struct Sum<uint16_t> { typedef uint64_t type; };
+  template <> struct Sum<int32_t> { typedef int64_t type; };
+  template <> struct Sum<uint32_t> { typedef uint64_t type; };
+
+  /*
+   * The kernels below keep four independent partial results, so that the
+   * compiler can hold them in one vector register and is not held back by
+   * the order of floating point additions.
+   */
+  template <typename NumT>
+  typename Sum<NumT>::type blockSum(const NumT* values, size_t count)
+  {
+    typedef typename Sum<NumT>::type SumT;
+    SumT s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+      s0 += values[i];
+      s1 += values[i + 1];
+      s2 += values[i + 2];
+      s3 += values[i + 3];
+    }
+    for (; i < count; i++) {
+      s0 += values[i];
+    }
+    return (s0 + s1) + (s2 + s3);
+  }
+
+  template <typename NumT>
+  double blockSquares(const NumT* values, size_t count, double mean)
+  {
+    double s0 = 0., s1 = 0., s2 = 0., s3 = 0.;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+      double d0 = static_cast<double>(values[i]) - mean;
+      double d1 = static_cast<double>(values[i + 1]) - mean;
+      double d2 = static_cast<double>(values[i + 2]) - mean;
+      double d3 = static_cast<double>(values[i + 3]) - mean;
+      s0 += d0 * d0;
+      s1 += d1 * d1;
+      s2 += d2 * d2;
+      s3 += d3 * d3;
+    }
+    for (; i < count; i++) {
+      double d = static_cast<double>(values[i]) - mean;
+      s0 += d * d;
+    }
+    return (s0 + s1) + (s2 + s3);
+  }
+
+  template <typename NumT>
+  void blockExtremes(const NumT* values, size_t count, NumT& low, NumT& high)
+  {
+    NumT lo = values[0], hi = values[0];
+    for (size_t i = 1; i < count; i++) {
+      lo = values[i] < lo ? values[i] : lo;
+      hi = values[i] > hi ? values[i] : hi;
+    }
+    low = lo;
+    high = hi;
+  }
+
+  template <typename NumT>
+  size_t blockNonzero(const NumT* values, size_t count)
+  {
+    size_t n = 0;
+    for (size_t i = 0; i < count; i++) {
+      n += values[i] != 0;
+    }
+    return n;
+  }
+
+  struct Histogram {
+    int64_t bins;
+    double low;
+    double high;
+    vector<int64_t> counts;
+  };
+
+  template <typename NumT>
+  void blockHistogram(const NumT* values, size_t count, Histogram& histogram)
+  {
+    double scale = static_cast<double>(histogram.bins)
+      / (histogram.high - histogram.low);
+    size_t last = static_cast<size_t>(histogram.bins - 1);
+    for (size_t i = 0; i < count; i++) {
+      double x = static_cast<double>(values[i]);
+      if (x >= histogram.low && x <= histogram.high) {
+        size_t bin = static_cast<size_t>((x - histogram.low) * scale);
+        histogram.counts[bin < last ? bin : last]++;
+      }
+    }
+  }
+
+  /*
+   * All reductions asked of one object, worked out in one pass over its
+   * blocks. Mean and variance of the blocks are merged as by Chan et al.,
+   * which stays accurate however many blocks there are.
+   */
+  class Reduction {
+  public:
+    Reduction() : m_sums(false), m_extremes(false), m_moments(false),
+                  m_nonzeros(false), m_count(0), m_sum(0.), m_min(0.),
+                  m_max(0.), m_mean(0.), m_squares(0.), m_nonzero(0)
+    {
+    }
+
+    void want(const Request& request)
+    {
+      switch (request.operation) {
+      case SUM:
+      case MEAN:
+        m_sums = true;
+        break;
+      case MIN:
+      case MAX:
+        m_extremes = true;
+        break;
+      case STDDEV:
+        m_moments = true;
+        break;
+      case NONZERO:
+        m_nonzeros = true;
+        break;
+      case HISTOGRAM:
+        if (find(request) == NULL) {
+          Histogram histogram;
+          histogram.bins = request.element;
+          histogram.low = request.low;
+          histogram.high = request.high;
+          histogram.counts.assign(static_cast<size_t>(request.element), 0);
+          m_histograms.push_back(histogram);
+        }
+        break;
+      default:
+        break;
+      }
+    }
+
+    void add(int type, const void* data, size_t count)
+    {
+      switch (type) {
+      case NX_INT8:
+        add(static_cast<const int8_t*>(data), count);
+        break;
+      case NX_UINT8:
+        add(static_cast<const uint8_t*>(data), count);
+        break;
+      case NX_INT16:
+        add(static_cast<const int16_t*>(data), count);
+        break;
+      case NX_UINT16:
+        add(static_cast<const uint16_t*>(data), count);
+        break;
+      case NX_INT32:
+        add(static_cast<const int32_t*>(data), count);
+        break;
+      case NX_UINT32:
+        add(static_cast<const uint32_t*>(data), count);
+        break;
+      case NX_INT64:
+        add(static_cast<const int64_t*>(data), count);
+        break;
+      case NX_UINT64:
+        add(static_cast<const uint64_t*>(data), count);
+        break;
+      case NX_FLOAT32:
+        add(static_cast<const float*>(data), count);
+        break;
+      case NX_FLOAT64:
+        add(static_cast<const double*>(data), count);
+        break;
+      default:
+        break;
+      }
+    }
+
+    void result(const Request& request, Value& value) const
+    {
+      value.ok = true;
+      switch (request.operation) {
+      case SUM:
+        value.number = m_sum;
+        break;
+      case MIN:
+        value.number = m_min;
+        break;
+      case MAX:
+        value.number = m_max;
+        break;
+      case MEAN:
+        value.number = m_sum / static_cast<double>(m_count);
+        break;
+      case STDDEV:
+        value.number = std::sqrt(m_squares / static_cast<double>(m_count));
+        break;
+      case NONZERO:
+        value.number = static_cast<double>(m_nonzero);
+        break;
+      case HISTOGRAM: {
+        const Histogram* histogram = find(request);
+        const char* counts =
+          reinterpret_cast<const char*>(&histogram->counts[0]);
+        value.type = INT64;
+        value.dims.assign(1, histogram->bins);
+        value.data.assign(counts, counts
+                          + histogram->counts.size() * sizeof(int64_t));
+        break;
+      }
+      default:
+        value.ok = false;
+        break;
+      }
+    }
+
+  private:
+    const Histogram* find(const Request& request) const
+    {
+      for (size_t i = 0; i < m_histograms.size(); i++) {
+        if (m_histograms[i].bins == request.element
+            && m_histograms[i].low == request.low
+            && m_histograms[i].high == request.high) {
+          return &m_histograms[i];
+        }
+      }
+      return NULL;
+    }
+
+    template <typename NumT>
+    void add(const NumT* values, size_t count)
+    {
+      if (count == 0) {
+        return;
+      }
+      if (m_extremes) {
+        NumT low, high;
+        blockExtremes(values, count, low, high);
+        if (m_count == 0 || static_cast<double>(low) < m_min) {
+          m_min = static_cast<double>(low);
+        }
+        if (m_count == 0 || static_cast<double>(high) > m_max) {
+          m_max = static_cast<double>(high);
+        }
+      }
+      if (m_sums || m_moments) {
+        double sum = static_cast<double>(blockSum(values, count));
+        m_sum += sum;
+        if (m_moments) {
+          double n = static_cast<double>(count);
+          double mean = sum / n;
+          double squares = blockSquares(values, count, mean);
+          double total = static_cast<double>(m_count) + n;
+          double delta = mean - m_mean;
+          m_squares += squares
+            + delta * delta * static_cast<double>(m_count) * n / total;
+          m_mean += delta * n / total;
+        }
+      }
+      if (m_nonzeros) {
+        m_nonzero += blockNonzero(values, count);
+      }
+      for (size_t i = 0; i < m_histograms.size(); i++) {
+        blockHistogram(values, count, m_histograms[i]);
+      }
+      m_count += count;
+    }
+
+    bool m_sums;
+    bool m_extremes;
+    bool m_moments;
+    bool m_nonzeros;
+    size_t m_count;
+    double m_sum;
+    double m_min;
+    double m_max;
+    double m_mean;
+    double m_squares;
+    size_t m_nonzero;
+    vector<Histogram> m_histograms;
+  };
+
+#ifdef NX_EXTRACT_THREADS
+  /*
+   * Reduces one block on a second thread while the caller reads the next.
+   * Reading holds the lock of the NeXus library, reducing does not, so the
+   * two overlap. The caller alternates between two buffers while add
+   * returns true: a block is only handed over once the one before it is
+   * done.
+   */
+  class Overlap {
+  public:
+    Overlap(Reduction& reduction, int type, bool enabled) :
+      m_reduction(reduction), m_type(type), m_data(NULL), m_count(0),
+      m_stop(false), m_running(false)
+    {
+      pthread_mutex_init(&m_lock, NULL);
+      pthread_cond_init(&m_changed, NULL);
+      if (enabled) {
+        m_running = pthread_create(&m_thread, NULL, run, this) == 0;
+      }
+    }
+
+    ~Overlap()
+    {
+      if (m_running) {
+        pthread_mutex_lock(&m_lock);
+        while (m_data != NULL) {
+          pthread_cond_wait(&m_changed, &m_lock);
+        }
+        m_stop = true;
+        pthread_cond_broadcast(&m_changed);
+        pthread_mutex_unlock(&m_lock);
+        pthread_join(m_thread, NULL);
+      }
+      pthread_cond_destroy(&m_changed);
+      pthread_mutex_destroy(&m_lock);
+    }
+
+    bool add(const void* data, size_t count)
+    {
+      if (!m_running) {
+        m_reduction.add(m_type, data, count);
+        return false;
+      }
+      pthread_mutex_lock(&m_lock);
+      while (m_data != NULL) {
+        pthread_cond_wait(&m_changed, &m_lock);
+      }
+      m_data = data;
+      m_count = count;
+      pthread_cond_broadcast(&m_changed);
+      pthread_mutex_unlock(&m_lock);
+      return true;
+    }
+
+  private:
+    Overlap(const Overlap&);
+    Overlap& operator=(const Overlap&);
+
+    static void* run(void* arg)
+    {
+      Overlap* self = static_cast<Overlap*>(arg);
+      pthread_mutex_lock(&self->m_lock);
+      for (;;) {
+        while (self->m_data == NULL && !self->m_stop) {
+          pthread_cond_wait(&self->m_changed, &self->m_lock);
+        }
+        if (self->m_data == NULL) {
+          break;
+        }
+        pthread_mutex_unlock(&self->m_lock);
+        self->m_reduction.add(self->m_type, self->m_data, self->m_count);
+        pthread_mutex_lock(&self->m_lock);
+        self->m_data = NULL;
+        pthread_cond_broadcast(&self->m_changed);
+      }
+      pthread_mutex_unlock(&self->m_lock);
+      return NULL;
+    }
+
+    Reduction& m_reduction;
+    int m_type;
+    const void* m_data;
+    size_t m_count;
+    bool m_stop;
+    bool m_running;
+    pthread_t m_thread;
+    pthread_mutex_t m_lock;
+    pthread_cond_t m_changed;
+  };
+#else
+  class Overlap {
+  public:
+    Overlap(Reduction& reduction, int type, bool) :
+      m_reduction(reduction), m_type(type)
+    {
+    }
+
+    bool add(const void* data, size_t count)
+    {
+      m_reduction.add(m_type, data, count);
+      return false;
+    }
+
+  private:
+    Reduction& m_reduction;
+    int m_type;
+  };
+#endif
+
+  /*
+   * Everything read from one object: its type, dimensions and, once a
+   * request needs it, its value.
+   */
+  struct Object {
+    bool ok;
+    int type;
+    vector<int64_t> dims;
+    vector<char> data;
+    bool loaded;
+
+    Object() : ok(false), type(NX_CHAR), loaded(false)
+    {
+    }
+
+    size_t count() const
+    {
+      size_t n = 1;
+      for (size_t i = 0; i < dims.size(); i++) {
+        n *= static_cast<size_t>(dims[i]);
+      }
+      return n;
+    }
+
+    void allocate()
+    {
+      /* one more for the NUL of strings */
+      data.assign(count() * typeSize(type) + 1, 0);
+    }
+  };
+
+  class Walker {
+  public:
+    Walker(NXhandle handle, const Plan& plan, Result& result) :
+      m_handle(handle), m_plan(plan), m_result(result)
+    {
+    }
+
+    void group(const Node& node, const string& path)
+    {
+      if (!node.requests.empty()) {
+        requests(node, path, true);
+      }
+      if (node.children.empty()) {
+        return;
+      }
+
+      vector<std::pair<string, string> > entries;
+      NXname name, nxclass;
+      int type;
+      if (NXinitgroupdir(m_handle) == NX_OK) {
+        while (NXgetnextentry(m_handle, name, nxclass, &type) == NX_OK) {
+          entries.push_back(std::make_pair(string(name), string(nxclass)));
+        }
+      }
+
+      for (map<string, Node*>::const_iterator it = node.children.begin();
+           it != node.children.end(); ++it) {
+        const string& element = it->first;
+        const Node& child = *it->second;
+        if (element.size() > 2 && element[0] == '{'
+            && element[element.size() - 1] == '}') {
+          string nxclass = element.substr(1, element.size() - 2);
+          bool matched = false;
+          for (size_t i = 0; i < entries.size(); i++) {
+            if (entries[i].second == nxclass) {
+              matched = true;
+              enter(child, path, entries[i].first, entries[i].second);
+            }
+          }
+          if (!matched) {
+            fail(child, join(path, element),
+                 "no group of class " + nxclass);
+          }
+        } else {
+          size_t i;
+          for (i = 0; i < entries.size(); i++) {
+            if (entries[i].first == element) {
+              break;
+            }
+          }
+          if (i < entries.size()) {
+            enter(child, path, entries[i].first, entries[i].second);
+          } else {
+            fail(child, join(path, element), "not found");
+          }
+        }
+      }
+    }
+
+  private:
+    static string join(const string& path, const string& name)
+    {
+      return path == "/" ? path + name : path + "/" + name;
+    }
+
+    void enter(const Node& node, const string& parent, const string& name,
+               const string& nxclass)
+    {
+      string path = join(parent, name);
+      NXname c_name;
+      strncpy(c_name, name.c_str(), sizeof(c_name) - 1);
+      c_name[sizeof(c_name) - 1] = '\0';
+
+      if (nxclass == "SDS") {
+        if (NXopendata(m_handle, c_name) != NX_OK) {
+          fail(node, path, "cannot open the field");
+          return;
+        }
+        if (!node.requests.empty()) {
+          requests(node, path, false);
+        }
+        for (map<string, Node*>::const_iterator it = node.children.begin();
+             it != node.children.end(); ++it) {
+          fail(*it->second, join(path, it->first), "not found in a field");
+        }
+        NXclosedata(m_handle);
+      } else {
+        NXname c_class;
+        strncpy(c_class, nxclass.c_str(), sizeof(c_class) - 1);
+        c_class[sizeof(c_class) - 1] = '\0';
+        if (NXopengroup(m_handle, c_name, c_class) != NX_OK) {
+          fail(node, path, "cannot open the group");
+          return;
+        }
+        group(node, path);
+        NXclosegroup(m_handle);
+      }
+    }
+
+    void fail(const Node& node, const string& path, const string& error)
+    {
+      for (size_t i = 0; i < node.requests.size(); i++) {
+        Value value;
+        value.path = path;
+        value.error = path + ": " + error;
+        m_result.values[node.requests[i]].push_back(value);
+      }
+      for (map<string, Node*>::const_iterator it = node.children.begin();
+           it != node.children.end(); ++it) {
+        fail(*it->second, join(path, it->first), error);
+      }
+    }
+
+    /* the requests for the group or field just opened */
+    void requests(const Node& node, const string& path, bool isGroup)
+    {
+      map<string, Object> attributes;
+      bool listed = false;
+      Object field;
+      vector<Value> values(node.requests.size());
+      vector<size_t> reductions;
+      Reduction reduction;
+
+      for (size_t i = 0; i < node.requests.size(); i++) {
+        const Request& request = m_plan.requests()[node.requests[i]];
+        Value& value = values[i];
+        value.path = path;
+
+        if (!request.attribute.empty()) {
+          if (!listed) {
+            listAttributes(attributes);
+            listed = true;
+          }
+          map<string, Object>::iterator it =
+            attributes.find(request.attribute);
+          if (it == attributes.end()) {
+            value.error = path + ": no attribute " + request.attribute;
+          } else if (operate(request, it->second, value, request.attribute)
+                     && load(it->second, request.attribute)) {
+            /* attributes are small enough to reduce at once */
+            Reduction single;
+            single.want(request);
+            single.add(it->second.type, &it->second.data[0],
+                       it->second.count());
+            single.result(request, value);
+          } else if (!value.ok && value.error.empty()) {
+            value.error = path + ": cannot read attribute "
+              + request.attribute;
+          }
+        } else if (isGroup) {
+          int items;
+          NXname name, nxclass;
+          if (request.operation != COUNT) {
+            value.error = path + ": is a group";
+          } else if (NXgetgroupinfo(m_handle, &items, name, nxclass)
+                     != NX_OK) {
+            value.error = path + ": cannot read the group";
+          } else {
+            value.ok = true;
+            value.number = items;
+          }
+        } else {
+          if (!field.ok && field.dims.empty()) {
+            info(node, field);
+          }
+          if (!field.ok) {
+            value.error = path + ": cannot read the field information";
+          } else if (operate(request, field, value, "")) {
+            reduction.want(request);
+            reductions.push_back(i);
+          } else if (!value.ok && value.error.empty()) {
+            value.error = path + ": cannot read the data";
+          }
+        }
+      }
+
+      /* the reductions of the field share one pass over its data */
+      if (!reductions.empty()) {
+        bool ok = stream(field, reduction);
+        for (size_t i = 0; i < reductions.size(); i++) {
+          const Request& request =
+            m_plan.requests()[node.requests[reductions[i]]];
+          if (ok) {
+            reduction.result(request, values[reductions[i]]);
+          } else {
+            values[reductions[i]].error = path + ": cannot read the data";
+          }
+        }
+      }
+
+      for (size_t i = 0; i < node.requests.size(); i++) {
+        m_result.values[node.requests[i]].push_back(values[i]);
+      }
+    }
+
+    /*
+     * The type and dimensions of the open field. Its value is read at once
+     * if a request needs all of it, so that the reductions use it too.
+     */
+    void info(const Node& node, Object& field)
+    {
+      int rank;
+      int64_t dims[NX_MAXRANK];
+      if (NXgetinfo64(m_handle, &rank, dims, &field.type) != NX_OK) {
+        field.dims.push_back(0);
+        return;
+      }
+      field.ok = true;
+      field.dims.assign(dims, dims + rank);
+      for (size_t i = 0; i < node.requests.size(); i++) {
+        const Request& request = m_plan.requests()[node.requests[i]];
+        if (request.attribute.empty()
+            && (request.operation == VALUE
+                || (field.type == NX_CHAR && request.operation != COUNT
+                    && request.operation != DIMS))) {
+          load(field, "");
+          return;
+        }
+      }
+    }
+
+    void listAttributes(map<string, Object>& attributes)
+    {
+      NXname name;
+      int rank, type, dim[NX_MAXRANK];
+
+      if (NXinitattrdir(m_handle) != NX_OK) {
+        return;
+      }
+      while (NXgetnextattra(m_handle, name, &rank, dim, &type) == NX_OK) {
+        Object& attribute = attributes[name];
+        attribute.ok = true;
+        attribute.type = type;
+        attribute.dims.assign(dim, dim + rank);
+      }
+    }
+
+    /* reads the value of the field, or attribute if name is not empty */
+    bool load(Object& object, const string& name)
+    {
+      if (object.loaded) {
+        return true;
+      }
+      object.allocate();
+      if (name.empty()) {
+        if (NXgetdata(m_handle, &object.data[0]) != NX_OK) {
+          return false;
+        }
+      } else {
+        NXname c_name;
+        strncpy(c_name, name.c_str(), sizeof(c_name) - 1);
+        c_name[sizeof(c_name) - 1] = '\0';
+        if (NXgetattra(m_handle, c_name, &object.data[0]) != NX_OK) {
+          return false;
+        }
+      }
+      object.loaded = true;
+      return true;
+    }
+
+    /* reads one element of the open field */
+    bool loadElement(const Object& field, int64_t element,
+                     vector<char>& data)
+    {
+      int rank = static_cast<int>(field.dims.size());
+      int64_t start[NX_MAXRANK], size[NX_MAXRANK];
+      for (int i = rank - 1; i >= 0; i--) {
+        start[i] = element % field.dims[i];
+        size[i] = 1;
+        element /= field.dims[i];
+      }
+      data.assign(typeSize(field.type), 0);
+      if (rank == 0) {
+        return NXgetdata(m_handle, &data[0]) == NX_OK;
+      }
+      return NXgetslab64(m_handle, &data[0], start, size) == NX_OK;
+    }
+
+    /*
+     * Feeds the open field to the reduction block by block. The field is
+     * split at the first dimension whose slices fit in a block. Where the
+     * field is chunked, blocks are whole chunks in every dimension up to
+     * the split, so that no chunk is decoded twice; such a block is at
+     * least one row of chunks, even if that is larger than the block size.
+     */
+    bool stream(Object& field, Reduction& reduction)
+    {
+      size_t count = field.count();
+      size_t size = typeSize(field.type);
+      int rank = static_cast<int>(field.dims.size());
+
+      if (field.loaded || rank == 0 || count * size <= m_plan.blockSize) {
+        if (!load(field, "")) {
+          return false;
+        }
+        reduction.add(field.type, &field.data[0], count);
+        return true;
+      }
+
+      int chunkRank;
+      int64_t chunk[NX_MAXRANK];
+      if (NXgetchunkdims64(m_handle, &chunkRank, chunk) != NX_OK
+          || chunkRank != rank) {
+        chunkRank = 0;
+      }
+      int split = 0;
+      size_t slice = count / static_cast<size_t>(field.dims[0]);
+      while (split < rank - 1 && slice * size > m_plan.blockSize) {
+        split++;
+        slice /= static_cast<size_t>(field.dims[split]);
+      }
+
+      /* the indices read together in the dimensions before split */
+      int64_t width[NX_MAXRANK];
+      size_t band = 1;
+      for (int i = 0; i < split; i++) {
+        width[i] = 1;
+        if (chunkRank > 0) {
+          width[i] = chunk[i] < field.dims[i] ? chunk[i] : field.dims[i];
+        }
+        band *= static_cast<size_t>(width[i]);
+      }
+      int64_t step =
+        static_cast<int64_t>(m_plan.blockSize / (band * slice * size));
+      if (chunkRank > 0) {
+        step = step < chunk[split] ? chunk[split] : step - step % chunk[split];
+      }
+      if (step < 1) {
+        step = 1;
+      }
+      if (step > field.dims[split]) {
+        step = field.dims[split];
+      }
+
+      int64_t start[NX_MAXRANK], extent[NX_MAXRANK];
+      for (int i = 0; i < rank; i++) {
+        start[i] = 0;
+        extent[i] = field.dims[i];
+      }
+      vector<char> buffers[2];
+      buffers[0].resize(band * static_cast<size_t>(step) * slice * size);
+      if (m_plan.overlap) {
+        buffers[1].resize(buffers[0].size());
+      }
+      int current = 0;
+      Overlap overlap(reduction, field.type, m_plan.overlap);
+
+      for (;;) {
+        size_t n = slice;
+        for (int i = 0; i <= split; i++) {
+          extent[i] = field.dims[i] - start[i];
+          int64_t most = i < split ? width[i] : step;
+          if (extent[i] > most) {
+            extent[i] = most;
+          }
+          n *= static_cast<size_t>(extent[i]);
+        }
+        void* data = &buffers[current][0];
+        if (NXgetslab64(m_handle, data, start, extent) != NX_OK) {
+          return false;
+        }
+        if (overlap.add(data, n)) {
+          current = 1 - current;
+        }
+
+        /* the next block, counting through the dimensions before split */
+        start[split] += extent[split];
+        int i = split;
+        while (i > 0 && start[i] >= field.dims[i]) {
+          start[i] = 0;
+          i--;
+          start[i] += width[i];
+        }
+        if (start[i] >= field.dims[i]) {
+          return true;
+        }
+      }
+    }
+
+    /*
+     * Works out the request on the object, or returns true for a reduction
+     * of a number, which the caller does once the object is read.
+     */
+    bool operate(const Request& request, Object& object, Value& value,
+                 const string& name)
+    {
+      value.type = static_cast<NXnumtype>(object.type);
+      value.dims = object.dims;
+      size_t count = object.count();
+
+      if (request.operation == DIMS) {
+        value.ok = true;
+        return false;
+      }
+      if (request.operation == COUNT) {
+        value.ok = true;
+        value.number = static_cast<double>(count);
+        return false;
+      }
+
+      size_t size = typeSize(object.type);
+      if (object.type == NX_CHAR || request.operation == VALUE) {
+        if (!load(object, name)) {
+          return false;
+        }
+        /* the data of strings keeps its NUL */
+        size_t length = count * size;
+        if (object.type == NX_CHAR) {
+          length = strlen(&object.data[0]) + 1;
+        }
+        value.data.assign(object.data.begin(), object.data.begin() + length);
+        value.ok = true;
+      } else if (request.operation == ELEMENT) {
+        if (request.element < 0
+            || static_cast<size_t>(request.element) >= count) {
+          std::ostringstream error;
+          error << value.path << ": no element " << request.element;
+          value.error = error.str();
+        } else if (object.loaded || !name.empty()) {
+          if (!load(object, name)) {
+            return false;
+          }
+          size_t offset = static_cast<size_t>(request.element) * size;
+          value.data.assign(object.data.begin() + offset,
+                            object.data.begin() + offset + size);
+          value.ok = true;
+        } else if (loadElement(object, request.element, value.data)) {
+          value.ok = true;
+        }
+      } else if (count == 0) {
+        value.error = value.path + ": has no elements";
+      } else if (!isNumber(object.type)) {
+        value.error = value.path + ": is not a number";
+      } else if (request.operation == HISTOGRAM
+                 && (request.element < 1 || !(request.low < request.high))) {
+        value.error = value.path
+          + ": a histogram needs bins and a range from low to high";
+      } else {
+        return isReduction(request.operation);
+      }
+      return false;
+    }
+
+    NXhandle m_handle;
+    const Plan& m_plan;
+    Result& m_result;
+  };
+
+  Result extractFile(const Plan& plan, size_t index, const string& filename)
+  {
+    Result result;
+    NXhandle handle;
+    NXaccess access = NXACC_READ;
+
+    result.index = index;
+    result.filename = filename;
+    result.ok = false;
+    result.values.resize(plan.requests().size());
+
+    /* with a fresh index the snapshot costs less than opening paths */
+    if (NXcheckindex(filename.c_str()) == NX_OK) {
+      access = static_cast<NXaccess>(NXACC_READ | NXACC_SNAPSHOT);
+    }
+    if (NXopen(filename.c_str(), access, &handle) != NX_OK) {
+      result.error = "cannot open " + filename;
+      return result;
+    }
+    result.ok = true;
+    Walker(handle, plan, result).group(plan.root(), "/");
+    NXclose(&handle);
+    return result;
+  }
+
+#ifdef NX_EXTRACT_THREADS
+  /*
+   * Workers take the files in order, but never run further ahead of the
+   * handler than the window, so that memory stays bounded however long the
+   * list of files.
+   */
+  struct Pool {
+    const Plan* plan;
+    const vector<string>* filenames;
+    vector<Result*> done;
+    size_t next;
+    size_t handled;
+    size_t window;
+    bool cancel;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+  };
+
+  void* worker(void* arg)
+  {
+    Pool* pool = static_cast<Pool*>(arg);
+
+    for (;;) {
+      pthread_mutex_lock(&pool->lock);
+      while (!pool->cancel && pool->next < pool->filenames->size()
+             && pool->next >= pool->handled + pool->window) {
+        pthread_cond_wait(&pool->changed, &pool->lock);
+      }
+      if (pool->cancel || pool->next >= pool->filenames->size()) {
+        pthread_mutex_unlock(&pool->lock);
+        return NULL;
+      }
+      size_t index = pool->next++;
+      pthread_mutex_unlock(&pool->lock);
+
+      Result* result = new Result(extractFile(*pool->plan, index,
+                                              (*pool->filenames)[index]));
+
+      pthread_mutex_lock(&pool->lock);
+      pool->done[index] = result;
+      pthread_cond_broadcast(&pool->changed);
+      pthread_mutex_unlock(&pool->lock);
+    }
+  }
+#endif
+}
+
+Extractor::Extractor() : m_threads(2), m_blockSize(8 << 20)
+{
+}
+
+size_t Extractor::add(const Request& request)
+{
+  map<Request, size_t>::const_iterator it = m_index.find(request);
+  if (it != m_index.end()) {
+    return it->second;
+  }
+  m_index[request] = m_requests.size();
+  m_requests.push_back(request);
+  return m_requests.size() - 1;
+}
+
+size_t Extractor::add(const string& path, const string& attribute,
+                      Operation operation, int64_t element, double low,
+                      double high)
+{
+  return add(Request(path, attribute, operation, element, low, high));
+}
+
+size_t Extractor::size() const
+{
+  return m_requests.size();
+}
+
+const vector<Request>& Extractor::getRequests() const
+{
+  return m_requests;
+}
+
+void Extractor::setThreads(int threads)
+{
+  m_threads = threads > 0 ? threads : 1;
+}
+
+void Extractor::setBlockSize(size_t bytes)
+{
+  m_blockSize = bytes > 0 ? bytes : 1;
+}
+
+Result Extractor::extract(const string& filename) const
+{
+  Plan plan(m_requests, m_blockSize, m_threads > 1);
+  return extractFile(plan, 0, filename);
+}
+
+void Extractor::run(const vector<string>& filenames, Handler& handler) const
+{
+  Plan plan(m_requests, m_blockSize, m_threads > 1);
+  size_t threads = static_cast<size_t>(m_threads);
+  if (threads > filenames.size()) {
+    threads = filenames.size();
+  }
+
+#ifdef NX_EXTRACT_THREADS
+  if (threads > 1) {
+    Pool pool;
+    vector<pthread_t> workers;
+    pool.plan = &plan;
+    pool.filenames = &filenames;
+    pool.done.assign(filenames.size(), static_cast<Result*>(NULL));
+    pool.next = 0;
+    pool.handled = 0;
+    pool.window = 4 * threads;
+    pool.cancel = false;
+    pthread_mutex_init(&pool.lock, NULL);
+    pthread_cond_init(&pool.changed, NULL);
+    for (size_t i = 0; i < threads; i++) {
+      pthread_t thread;
+      if (pthread_create(&thread, NULL, worker, &pool) == 0) {
+        workers.push_back(thread);
+      }
+    }
+
+    try {
+      for (size_t i = 0; i < filenames.size(); i++) {
+        Result* result;
+        if (workers.empty()) {
+          result = new Result(extractFile(plan, i, filenames[i]));
+        } else {
+          pthread_mutex_lock(&pool.lock);
+          while (pool.done[i] == NULL) {
+            pthread_cond_wait(&pool.changed, &pool.lock);
+          }
+          result = pool.done[i];
+          pool.done[i] = NULL;
+          pthread_mutex_unlock(&pool.lock);
+        }
+        try {
+          handler.process(*result);
+        } catch (...) {
+          delete result;
+          throw;
+        }
+        delete result;
+
+        pthread_mutex_lock(&pool.lock);
+        pool.handled = i + 1;
+        pthread_cond_broadcast(&pool.changed);
+        pthread_mutex_unlock(&pool.lock);
+      }
+    } catch (...) {
+      pthread_mutex_lock(&pool.lock);
+      pool.cancel = true;
+      pthread_cond_broadcast(&pool.changed);
+      pthread_mutex_unlock(&pool.lock);
+      for (size_t i = 0; i < workers.size(); i++) {
+        pthread_join(workers[i], NULL);
+      }
+      for (size_t i = 0; i < pool.done.size(); i++) {
+        delete pool.done[i];
+      }
+      pthread_cond_destroy(&pool.changed);
+      pthread_mutex_destroy(&pool.lock);
+      throw;
+    }
+
+    for (size_t i = 0; i < workers.size(); i++) {
+      pthread_join(workers[i], NULL);
+    }
+    pthread_cond_destroy(&pool.changed);
+    pthread_mutex_destroy(&pool.lock);
+    return;
+  }
+#endif
+
+  for (size_t i = 0; i < filenames.size(); i++) {
+    handler.process(extractFile(plan, i, filenames[i]));
+  }
+}
+
+}
+}
@@ -0,0 +1,234 @@
+#ifndef NEXUS_EXTRACT_HPP
+#define NEXUS_EXTRACT_HPP
+//
+//  NeXus - Neutron & X-ray Common Data Format
+//
+//  Extraction of the same values from many NeXus files
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free
+//  Software Foundation, Inc., 59 Temple Place, Suite 330, Boston,
+//  MA  02111-1307  USA
+//
+//  For further information, see http://www.nexusformat.org/
+//
+
+/**
+ * \file NeXusExtract.hpp
+ * Reading a list of values out of a list of files, as catalog and summary
+ * programs do.
+ * \defgroup cpp_extract Extraction from many files
+ * \ingroup cpp_main
+ */
+
+#include <map>
+#include <string>
+#include <vector>
+#include "NeXusFile.hpp"
+
+namespace NeXus {
+namespace Extract {
+  /**
+   * What to make of the value at the path of a request.
+   * \li VALUE the value as it is in the file.
+   * \li ELEMENT the element Request::element of the value, counted as if
+   *     it was one dimensional.
+   * \li SUM, MIN, MAX, MEAN, STDDEV the sum, smallest and largest element,
+   *     mean and standard deviation of the elements, in Value::number.
+   * \li COUNT the number of elements of a field or attribute, or the number
+   *     of entries of a group, in Value::number.
+   * \li DIMS only the type and dimensions, without reading the value.
+   * \li NONZERO the number of elements which are not zero, in Value::number.
+   * \li HISTOGRAM the number of elements in each of Request::element equal
+   *     bins from Request::low to Request::high, as NX_INT64 in Value::data.
+   *     The last bin includes Request::high, elements outside are left out.
+   *
+   * The reductions read a field block by block, see Extractor::setBlockSize,
+   * and all reductions of one field are done in the same pass. Character
+   * values are a single string: every operation but COUNT and DIMS gives the
+   * whole string.
+   * \ingroup cpp_extract
+   */
+  enum Operation {
+    VALUE,
+    ELEMENT,
+    SUM,
+    MIN,
+    MAX,
+    MEAN,
+    STDDEV,
+    COUNT,
+    DIMS,
+    NONZERO,
+    HISTOGRAM
+  };
+
+  /**
+   * A value to read from every file.
+   *
+   * The path is absolute. An element written as {NXclass} stands for every
+   * group of that class at that level, so "/{NXentry}/title" reads the title
+   * of every entry.
+   * \ingroup cpp_extract
+   */
+  struct NXDLL_EXPORT Request {
+    /** path to a group or field */
+    std::string path;
+    /** name of an attribute of the object at path, empty for the field */
+    std::string attribute;
+    /** what to make of the value */
+    Operation operation;
+    /** the element for ELEMENT, the number of bins for HISTOGRAM */
+    int64_t element;
+    /** the range of HISTOGRAM */
+    double low;
+    double high;
+
+    Request(const std::string& path, const std::string& attribute = "",
+            Operation operation = VALUE, int64_t element = 0,
+            double low = 0., double high = 0.);
+    bool operator<(const Request& other) const;
+  };
+
+  /**
+   * The value read for one request from one object of a file.
+   * \ingroup cpp_extract
+   */
+  struct NXDLL_EXPORT Value {
+    /** false if the value could not be read, error says why */
+    bool ok;
+    std::string error;
+    /** the path of the object, with the {NXclass} elements resolved */
+    std::string path;
+    NXnumtype type;
+    std::vector<int64_t> dims;
+    /** for VALUE, ELEMENT and HISTOGRAM, strings end with a NUL */
+    std::vector<char> data;
+    /** for the reductions and COUNT */
+    double number;
+
+    Value();
+  };
+
+  /**
+   * What was read from one file.
+   * \ingroup cpp_extract
+   */
+  struct NXDLL_EXPORT Result {
+    /** position of the file in the list given to Extractor::run */
+    size_t index;
+    std::string filename;
+    /** false if the file could not be opened, error says why */
+    bool ok;
+    std::string error;
+    /**
+     * One list for each request, in the order of Extractor::add, with a
+     * Value for every object the path matched. There is at least one Value
+     * for each request of a file that could be opened.
+     */
+    std::vector<std::vector<Value> > values;
+  };
+
+  /**
+   * Receives the results of Extractor::run.
+   * \ingroup cpp_extract
+   */
+  class NXDLL_EXPORT Handler {
+  public:
+    virtual ~Handler();
+    /**
+     * Called once for every file, in the order of the list of files and
+     * on the thread that called Extractor::run. Exceptions thrown here stop
+     * the run and are passed on to the caller of Extractor::run.
+     */
+    virtual void process(const Result& result) = 0;
+  };
+
+  /**
+   * Reads the same requests from every file of a list.
+   *
+   * The requests are sorted into a tree of their paths, so that a group
+   * shared by several paths is listed and opened once per file and a field
+   * read by several requests is read once. Files are read on a pool of
+   * threads, calls to the NeXus library are serialised by it, and the
+   * results are handed back in the order of the files. Files with a fresh
+   * index written by NXmakeindex are opened with NXACC_SNAPSHOT.
+   * \ingroup cpp_extract
+   */
+  class NXDLL_EXPORT Extractor {
+  public:
+    Extractor();
+
+    /**
+     * Add a request, the same request added twice is read once.
+     *
+     * \return the index of the request in Result::values
+     */
+    size_t add(const Request& request);
+
+    /**
+     * \copydoc add(const Request&)
+     */
+    size_t add(const std::string& path, const std::string& attribute = "",
+               Operation operation = VALUE, int64_t element = 0,
+               double low = 0., double high = 0.);
+
+    /**
+     * \return the number of different requests added
+     */
+    size_t size() const;
+
+    /**
+     * \return the requests, in the order of Result::values
+     */
+    const std::vector<Request>& getRequests() const;
+
+    /**
+     * Set the number of files read at the same time, which defaults to two.
+     * The NeXus library serialises its calls, so more threads only pay off
+     * where the reductions and the handler take longer than the reading.
+     * With more than one thread a field reduced in several blocks is also
+     * reduced on a second thread while the next block is read.
+     */
+    void setThreads(int threads);
+
+    /**
+     * Set the size in bytes of the blocks the reductions read, 8 MiB by
+     * default. Blocks are whole chunks where the field is chunked, so a
+     * block is at least one row of chunks. A field read for VALUE is read
+     * whole however large.
+     */
+    void setBlockSize(size_t bytes);
+
+    /**
+     * Read the requests from one file.
+     */
+    Result extract(const std::string& filename) const;
+
+    /**
+     * Read the requests from every file and pass the results to the
+     * handler, file by file.
+     */
+    void run(const std::vector<std::string>& filenames,
+             Handler& handler) const;
+
+  private:
+    std::vector<Request> m_requests;
+    std::map<Request, size_t> m_index;
+    int m_threads;
+    size_t m_blockSize;
+  };
+}
+}
+
+#endif
@@ -148,13 +148,14 @@ static int check_char_too_big[1 - sizeof(char) + ARRAY_OFFSET]; // error if char
 
 namespace {
 
-static void inner_malloc(void* & data, const std::vector<int64_t>& dims, NXnumtype type) {
+static void inner_malloc(void* & data, const std::vector<int64_t>& dims, NXnumtype type,
+                         int options = 0) {
   int rank = dims.size();
   int64_t c_dims[NX_MAXRANK];
   for (int i = 0; i < rank; i++) {
     c_dims[i] = dims[i];
   }
-  NXstatus status = NXmalloc64(&data, rank, c_dims, type);
+  NXstatus status = NXmalloc64ex(&data, rank, c_dims, type, options);
   if (status != NX_OK) {
     throw Exception("NXmalloc failed", status);
   }
@@ -182,6 +183,15 @@ File::File(const char *filename, const NXaccess access) : m_close_handle (true)
   this->initOpenFile(string(filename), access);
 }
 
+File::File(const void *buffer, size_t size, const NXaccess access) : m_close_handle (true) {
+  NXstatus status = NXopenbuffer(buffer, size, access, &(this->m_file_id));
+  if (status != NX_OK) {
+    stringstream msg;
+    msg << "NXopenbuffer(" << size << " bytes, "  << access << ") failed";
+    throw Exception(msg.str(), status);
+  }
+}
+
 void File::initOpenFile(const string& filename, const NXaccess access) {
   if (filename.empty()) {
     throw Exception("Filename specified is empty constructor");
@@ -222,6 +232,20 @@ void File::flush() {
   }
 }
 
+void File::startSWMR() {
+  NXstatus status = NXstartswmr(this->m_file_id);
+  if (status != NX_OK) {
+    throw Exception("NXstartswmr failed", status);
+  }
+}
+
+void File::refresh() {
+  NXstatus status = NXrefresh(this->m_file_id);
+  if (status != NX_OK) {
+    throw Exception("NXrefresh failed", status);
+  }
+}
+
 void File::makeGroup(const string& name, const string& class_name, bool open_group) {
   if (name.empty()) {
     throw Exception("Supplied empty name to makeGroup");
@@ -491,6 +515,101 @@ void File::makeCompData(const string& name, const NXnumtype type,
   }
 }
 
+void File::makeVirtualData(const string& name, const NXnumtype type,
+                           const vector<int64_t>& dims,
+                           const vector<VirtualSource>& sources,
+                           bool open_data) {
+  // error check the parameters
+  if (name.empty()) {
+    throw Exception("Supplied empty name to makeVirtualData");
+  }
+  if (dims.empty() || dims.size() > NX_MAXRANK) {
+    stringstream msg;
+    msg << "Supplied dims rank=" << dims.size() << " to makeVirtualData";
+    throw Exception(msg.str());
+  }
+  vector<NXvirtualsource> c_sources(sources.size());
+  for (size_t i = 0; i < sources.size(); i++) {
+    if (sources[i].start.size() != dims.size()
+        || sources[i].size.size() != dims.size()) {
+      stringstream msg;
+      msg << "Region of " << sources[i].filename << ":" << sources[i].path
+          << " must have the rank " << dims.size() << " in makeVirtualData";
+      throw Exception(msg.str());
+    }
+    c_sources[i].filename = sources[i].filename.c_str();
+    c_sources[i].path = sources[i].path.c_str();
+    for (size_t j = 0; j < dims.size(); j++) {
+      c_sources[i].start[j] = sources[i].start[j];
+      c_sources[i].size[j] = sources[i].size[j];
+    }
+  }
+
+  // do the work
+  NXstatus status = NXmakevirtual64(this->m_file_id, name.c_str(),
+                                    static_cast<int>(type), dims.size(),
+                                    const_cast<int64_t *>(&(dims[0])),
+                                    c_sources.size(),
+                                    c_sources.empty() ? NULL : &(c_sources[0]));
+
+  // report errors
+  if (status != NX_OK) {
+    stringstream msg;
+    msg << "NXmakevirtual64(" << name << ", " << type << ", " << dims.size()
+        << ", " << toString(dims) << ", " << sources.size() << ") failed";
+    throw Exception(msg.str(), status);
+  }
+  if (open_data) {
+    this->openData(name);
+  }
+}
+
+void File::makeVirtualTiles(const string& name, const NXnumtype type,
+                            const vector<string>& files, const string& path,
+                            const vector<int64_t>& source_dims,
+                            const vector<int64_t>& tiles, bool open_data) {
+  if (source_dims.size() != tiles.size()) {
+    stringstream msg;
+    msg << "Supplied source_dims rank=" << source_dims.size()
+        << " must match supplied tiles rank=" << tiles.size()
+        << " in makeVirtualTiles";
+    throw Exception(msg.str());
+  }
+  size_t rank = tiles.size();
+  size_t ntile = 1;
+  vector<int64_t> dims(rank);
+  for (size_t j = 0; j < rank; j++) {
+    dims[j] = source_dims[j] * tiles[j];
+    ntile *= static_cast<size_t>(tiles[j]);
+  }
+  if (files.size() != ntile) {
+    stringstream msg;
+    msg << "Supplied " << files.size() << " files for " << ntile
+        << " tiles in makeVirtualTiles";
+    throw Exception(msg.str());
+  }
+
+  // the last dimension runs fastest
+  vector<VirtualSource> sources(ntile);
+  vector<int64_t> index(rank, 0);
+  for (size_t i = 0; i < ntile; i++) {
+    sources[i].filename = files[i];
+    sources[i].path = path;
+    sources[i].size = source_dims;
+    sources[i].start.resize(rank);
+    for (size_t j = 0; j < rank; j++) {
+      sources[i].start[j] = index[j] * source_dims[j];
+    }
+    for (size_t j = rank; j-- > 0; ) {
+      if (++index[j] < tiles[j]) {
+        break;
+      }
+      index[j] = 0;
+    }
+  }
+  this->makeVirtualData(name, type, dims, sources, open_data);
+}
+
 template <typename NumT>
 void File::writeCompData(const string & name, const vector<NumT> & value,
                        const vector<int> & dims, const NXcompression comp,
@@ -802,7 +921,7 @@ std::vector<NumT> * File::getData() {
 
   // allocate memory to put the data into
   void * temp;
-  inner_malloc(temp, info.dims, info.type);
+  inner_malloc(temp, info.dims, info.type, NXMALLOC_NOINIT);
 
   // fetch the data
   this->getData(temp);
@@ -1014,6 +1133,22 @@ string File::getStrData() {
   return res;
 }
 
+void File::getData(vector<string>& data) {
+  int64_t count;
+  int64_t *offsets;
+  char *buffer;
+  NXstatus status = NXgetstrings(this->m_file_id, &count, &offsets, &buffer);
+  if (status != NX_OK) {
+    throw Exception("NXgetstrings failed", status);
+  }
+  data.resize(static_cast<size_t>(count));
+  for (int64_t i = 0; i < count; i++) {
+    data[i].assign(buffer + offsets[i], offsets[i + 1] - offsets[i] - 1);
+  }
+  NXfree(reinterpret_cast<void **>(&offsets));
+  NXfree(reinterpret_cast<void **>(&buffer));
+}
+
 Info File::getInfo() {
   //vector<int> & dims, NXnumtype & type) {
   int64_t dims[NX_MAXRANK];
@@ -1105,6 +1240,169 @@ void File::getSlab(void* data, const vector<int64_t>& start,
   }
 }
 
+void File::getSlabs(const vector<void*>& data,
+                    const vector<vector<int64_t> >& start,
+                    const vector<vector<int64_t> >& size) {
+  if (start.size() != data.size() || size.size() != data.size()) {
+    stringstream msg;
+    msg << "In getSlabs number of buffers=" << data.size()
+        << " must match number of starts=" << start.size()
+        << " and number of sizes=" << size.size();
+    throw Exception(msg.str());
+  }
+  if (data.empty()) {
+    return;
+  }
+  vector<const int64_t*> start_ptr(data.size());
+  vector<const int64_t*> size_ptr(data.size());
+  for (size_t i = 0; i < data.size(); i++) {
+    if (data[i] == NULL) {
+      throw Exception("Supplied null pointer to getSlabs");
+    }
+    if (start[i].empty() || start[i].size() != size[i].size()) {
+      stringstream msg;
+      msg << "In getSlabs slab " << i << " start rank=" << start[i].size()
+          << " must match size rank=" << size[i].size();
+      throw Exception(msg.str());
+    }
+    start_ptr[i] = &(start[i][0]);
+    size_ptr[i] = &(size[i][0]);
+  }
+
+  NXstatus status = NXgetslabs64(this->m_file_id, static_cast<int>(data.size()),
+                                 &(start_ptr[0]), &(size_ptr[0]),
+                                 const_cast<void **>(&(data[0])));
+  if (status != NX_OK) {
+    stringstream msg;
+    msg << "NXgetslabs64(" << data.size() << " slabs) failed";
+    throw Exception(msg.str(), status);
+  }
+}
+
+template <typename NumT>
+void File::getSlabs(vector<vector<NumT> >& data,
+                    const vector<vector<int64_t> >& start,
+                    const vector<vector<int64_t> >& size) {
+  Info info = this->getInfo();
+  if (info.type != getType<NumT>()) {
+    throw Exception("NXgetslabs64 failed - invalid vector type");
+  }
+  if (size.size() != start.size()) {
+    stringstream msg;
+    msg << "In getSlabs number of starts=" << start.size()
+        << " must match number of sizes=" << size.size();
+    throw Exception(msg.str());
+  }
+
+  // size every vector for its slab
+  data.resize(size.size());
+  vector<void*> buffers(size.size());
+  NumT dummy;
+  for (size_t i = 0; i < size.size(); i++) {
+    int64_t length = 1;
+    for (vector<int64_t>::const_iterator it = size[i].begin();
+         it != size[i].end(); it++) {
+      length *= *it;
+    }
+    data[i].resize(static_cast<size_t>(length));
+    buffers[i] = data[i].empty() ? static_cast<void*>(&dummy)
+                                 : static_cast<void*>(&(data[i][0]));
+  }
+
+  this->getSlabs(buffers, start, size);
+}
+
+void File::getFrames(int64_t first, int64_t count, int depth,
+                     NXframecallback callback, void* userdata) {
+  if (callback == NULL) {
+    throw Exception("Supplied null callback to getFrames");
+  }
+  NXstatus status = NXgetframes64(this->m_file_id, first, count, depth,
+                                  callback, userdata);
+  if (status != NX_OK) {
+    stringstream msg;
+    msg << "NXgetframes64(" << first << ", " << count << ", " << depth
+        << ") failed";
+    throw Exception(msg.str(), status);
+  }
+}
+
+void File::putChunk(const vector<int64_t>& offset, const vector<char>& data,
+                    unsigned int filterMask) {
+  if (offset.empty()) {
+    throw Exception("Supplied empty offset to putChunk");
+  }
+  if (data.empty()) {
+    throw Exception("Supplied empty data to putChunk");
+  }
+  NXstatus status = NXputchunk64(this->m_file_id, &(offset[0]), filterMask,
+                                 &(data[0]), data.size());
+  if (status != NX_OK) {
+    stringstream msg;
+    msg << "NXputchunk64(" << toString(offset) << ", " << data.size()
+        << " bytes) failed";
+    throw Exception(msg.str(), status);
+  }
+}
+
+unsigned int File::getChunk(const vector<int64_t>& offset,
+                            vector<char>& data) {
+  if (offset.empty()) {
+    throw Exception("Supplied empty offset to getChunk");
+  }
+  int64_t nbytes = 0;
+  unsigned int filterMask = 0;
+  NXstatus status = NXgetchunk64(this->m_file_id, &(offset[0]), NULL, NULL,
+                                 &nbytes);
+  if (status == NX_OK) {
+    data.resize(static_cast<size_t>(nbytes));
+    if (nbytes > 0) {
+      status = NXgetchunk64(this->m_file_id, &(offset[0]), &filterMask,
+                            &(data[0]), &nbytes);
+    }
+  }
+  if (status != NX_OK) {
+    stringstream msg;
+    msg << "NXgetchunk64(" << toString(offset) << ") failed";
+    throw Exception(msg.str(), status);
+  }
+  return filterMask;
+}
+
+int64_t File::getChunkCount() {
+  int64_t nchunks;
+  NXstatus status = NXgetchunkcount64(this->m_file_id, &nchunks);
+  if (status != NX_OK) {
+    throw Exception("NXgetchunkcount64 failed", status);
+  }
+  return nchunks;
+}
+
+ChunkInfo File::getChunkInfo(int64_t index) {
+  Info info = this->getInfo();
+  ChunkInfo chunk;
+  chunk.offset.resize(info.dims.size());
+  NXstatus status = NXgetchunkinfo64(this->m_file_id, index,
+                                     &(chunk.offset[0]), &chunk.filterMask,
+                                     &chunk.size);
+  if (status != NX_OK) {
+    stringstream msg;
+    msg << "NXgetchunkinfo64(" << index << ") failed";
+    throw Exception(msg.str(), status);
+  }
+  return chunk;
+}
+
+vector<int64_t> File::getChunkDims() {
+  int rank;
+  int64_t chunk[NX_MAXRANK];
+  NXstatus status = NXgetchunkdims64(this->m_file_id, &rank, chunk);
+  if (status != NX_OK) {
+    throw Exception("NXgetchunkdims64 failed", status);
+  }
+  return vector<int64_t>(chunk, chunk + rank);
+}
+
 AttrInfo File::getNextAttr() {
   //string & name, int & length, NXnumtype type) {
   char name[NX_MAXNAMELEN];
@@ -1358,33 +1656,21 @@ const string File::makeCurrentPath(const string currpath, const string subpath)
 	return temp.str();
 }
 
-void File::walkFileForTypeMap(const string path, const string class_name, TypeMap& tmap) {
-	if (!path.empty()) {
-		tmap.insert(std::make_pair(class_name, path));
-	}
-	map<string, string> dirents = this->getEntries();
-	map<string, string>::iterator pos;
-	for (pos = dirents.begin(); pos != dirents.end(); ++pos) {
-		if (pos->second == "SDS") {
-			tmap.insert(std::make_pair(pos->second, this->makeCurrentPath(path, pos->first)));
-		}
-		else if (pos->second == "CDF0.0") {
-			// Do nothing with this
-			;
-		}
-		else {
-			this->openGroup(pos->first, pos->second);
-			this->walkFileForTypeMap(this->makeCurrentPath(path, pos->first), pos->second, tmap);
-		}
-	}
-	this->closeGroup();
+static int addToTypeMap(const NXvisitinfo *info, void *userdata) {
+	TypeMap *tmap = static_cast<TypeMap *>(userdata);
+	tmap->insert(std::make_pair(string(info->nxclass), string(info->path)));
+	return 0;
 }
 
 TypeMap *File::getTypeMap() {
 	TypeMap *tmap = new TypeMap();
 	// Ensure that we're at the top of the file.
 	this->openPath("/");
-	this->walkFileForTypeMap("", "", *tmap);
+	NXstatus status = NXvisit(this->m_file_id, 0, addToTypeMap, tmap);
+	if (status != NX_OK) {
+		delete tmap;
+		throw Exception("NXvisit failed", status);
+	}
 	return tmap;
 }
 
@@ -1404,6 +1690,207 @@ void File::free(NumT*& data)
     inner_free((void*&)data);
 }
 
+ObjectHandle::ObjectHandle(File& file, const string& path) : m_object(NULL) {
+  if (path.empty()) {
+    throw Exception("Supplied empty path to open an object");
+  }
+  NXstatus status = NXobjopen(file.m_file_id, path.c_str(), &(this->m_object));
+  if (status != NX_OK) {
+    throw Exception("NXobjopen(" + path + ") failed", status);
+  }
+}
+
+ObjectHandle::~ObjectHandle() {
+  NXobjclose(&(this->m_object));
+}
+
+void ObjectHandle::close() {
+  if (this->m_object != NULL) {
+    NXstatus status = NXobjclose(&(this->m_object));
+    if (status != NX_OK) {
+      throw Exception("NXobjclose failed", status);
+    }
+  }
+}
+
+NXobject ObjectHandle::handle() {
+  if (this->m_object == NULL) {
+    throw Exception("ObjectHandle is closed");
+  }
+  return this->m_object;
+}
+
+void ObjectHandle::putAttr(const string& name, const string& value) {
+  if (name.empty()) {
+    throw Exception("Supplied empty name to putAttr");
+  }
+  string my_value(value);
+  if (my_value.empty())
+    my_value = " "; // Make a default "space" to avoid errors.
+  NXstatus status = NXobjputattr(this->handle(), name.c_str(), &(my_value[0]),
+                                 static_cast<int>(my_value.size()), NX_CHAR);
+  if (status != NX_OK) {
+    throw Exception("NXobjputattr(" + name + ") failed", status);
+  }
+}
+
+void ObjectHandle::putAttr(const string& name, const char* value) {
+  if (value == NULL) {
+    throw Exception("Specified value as null to putAttr");
+  }
+  this->putAttr(name, string(value));
+}
+
+template <typename NumT>
+void ObjectHandle::putAttr(const string& name, const NumT value) {
+  if (name.empty()) {
+    throw Exception("Supplied empty name to putAttr");
+  }
+  NXstatus status = NXobjputattr(this->handle(), name.c_str(), &value, 1,
+                                 getType<NumT>());
+  if (status != NX_OK) {
+    throw Exception("NXobjputattr(" + name + ") failed", status);
+  }
+}
+
+template <>
+NXDLL_EXPORT void ObjectHandle::getAttr(const string& name, string& value) {
+  char c_name[NX_MAXNAMELEN];
+  vector<char> buffer(2001, '\0'); ///< @todo need to find correct length of attribute
+  int length = static_cast<int>(buffer.size());
+  int type = NX_CHAR;
+  strncpy(c_name, name.c_str(), NX_MAXNAMELEN - 1);
+  c_name[NX_MAXNAMELEN - 1] = '\0';
+  NXstatus status = NXobjgetattr(this->handle(), c_name, &(buffer[0]),
+                                 &length, &type);
+  if (status != NX_OK) {
+    throw Exception("NXobjgetattr(" + name + ") failed", status);
+  }
+  if (type != NX_CHAR) {
+    throw Exception("NXobjgetattr(" + name + ") is not a string");
+  }
+  value = string(&(buffer[0]));
+}
+
+template <typename NumT>
+void ObjectHandle::getAttr(const string& name, NumT& value) {
+  char c_name[NX_MAXNAMELEN];
+  int length = 1;
+  int type = getType<NumT>();
+  strncpy(c_name, name.c_str(), NX_MAXNAMELEN - 1);
+  c_name[NX_MAXNAMELEN - 1] = '\0';
+  NXstatus status = NXobjgetattr(this->handle(), c_name, &value, &length,
+                                 &type);
+  if (status != NX_OK) {
+    throw Exception("NXobjgetattr(" + name + ") failed", status);
+  }
+  if (type != getType<NumT>()) {
+    stringstream msg;
+    msg << "NXobjgetattr(" << name << ") changed type [" << getType<NumT>()
+        << "->" << type << "]";
+    throw Exception(msg.str());
+  }
+}
+
+DatasetHandle::DatasetHandle(File& file, const string& path) : ObjectHandle(file, path) {
+}
+
+Info DatasetHandle::getInfo() {
+  int64_t dims[NX_MAXRANK];
+  int type;
+  int rank;
+  NXstatus status = NXobjgetinfo64(this->handle(), &rank, dims, &type);
+  if (status != NX_OK) {
+    throw Exception("NXobjgetinfo64 failed", status);
+  }
+  Info info;
+  info.type = static_cast<NXnumtype>(type);
+  for (int i = 0; i < rank; i++) {
+    info.dims.push_back(dims[i]);
+  }
+  return info;
+}
+
+template <typename NumT>
+void DatasetHandle::getData(vector<NumT>& data) {
+  Info info = this->getInfo();
+  if (info.type != getType<NumT>()) {
+    throw Exception("NXobjgetslab64 failed - invalid vector type");
+  }
+  vector<int64_t> start(info.dims.size(), 0);
+  this->getSlab(data, start, info.dims);
+}
+
+void DatasetHandle::getSlab(void* data, const vector<int64_t>& start,
+                      const vector<int64_t>& size) {
+  if (data == NULL) {
+    throw Exception("Supplied null pointer to getSlab");
+  }
+  if (start.empty() || start.size() != size.size()) {
+    stringstream msg;
+    msg << "In getSlab start rank=" << start.size() << " must match size rank="
+        << size.size();
+    throw Exception(msg.str());
+  }
+  NXstatus status = NXobjgetslab64(this->handle(), data, &(start[0]),
+                                   &(size[0]));
+  if (status != NX_OK) {
+    stringstream msg;
+    msg << "NXobjgetslab64(data, " << toString(start) << ", "
+        << toString(size) << ") failed";
+    throw Exception(msg.str(), status);
+  }
+}
+
+template <typename NumT>
+void DatasetHandle::getSlab(vector<NumT>& data, const vector<int64_t>& start,
+                      const vector<int64_t>& size) {
+  int64_t length = 1;
+  for (vector<int64_t>::const_iterator it = size.begin();
+       it != size.end(); it++) {
+    length *= *it;
+  }
+  // need to use resize() rather than reserve() so vector length gets set
+  data.resize(length);
+  if (length > 0) {
+    this->getSlab(&(data[0]), start, size);
+  }
+}
+
+void DatasetHandle::putSlab(const void* data, const vector<int64_t>& start,
+                      const vector<int64_t>& size) {
+  if (data == NULL) {
+    throw Exception("Data specified as null in putSlab");
+  }
+  if (start.empty() || start.size() != size.size()) {
+    stringstream msg;
+    msg << "Supplied start rank=" << start.size()
+        << " must match supplied size rank=" << size.size()
+        << " in putSlab";
+    throw Exception(msg.str());
+  }
+  NXstatus status = NXobjputslab64(this->handle(), data, &(start[0]),
+                                   &(size[0]));
+  if (status != NX_OK) {
+    stringstream msg;
+    msg << "NXobjputslab64(data, " << toString(start) << ", "
+        << toString(size) << ") failed";
+    throw Exception(msg.str(), status);
+  }
+}
+
+template <typename NumT>
+void DatasetHandle::putSlab(const vector<NumT>& data, const vector<int64_t>& start,
+                      const vector<int64_t>& size) {
+  if (data.empty()) {
+    throw Exception("Supplied empty data to putSlab");
+  }
+  this->putSlab(&(data[0]), start, size);
+}
+
+GroupHandle::GroupHandle(File& file, const string& path) : ObjectHandle(file, path) {
+}
+
 }
 
 /* ---------------------------------------------------------------- */
@@ -1792,6 +2279,51 @@ NXDLL_EXPORT void File::getData(vector<uint64_t>& data);
 template
 NXDLL_EXPORT void File::getData(vector<char>& data);
 
+template
+NXDLL_EXPORT void File::getSlabs(vector<vector<float> >& data,
+                               const vector<vector<int64_t> >& start,
+                               const vector<vector<int64_t> >& size);
+template
+NXDLL_EXPORT void File::getSlabs(vector<vector<double> >& data,
+                               const vector<vector<int64_t> >& start,
+                               const vector<vector<int64_t> >& size);
+template
+NXDLL_EXPORT void File::getSlabs(vector<vector<int8_t> >& data,
+                               const vector<vector<int64_t> >& start,
+                               const vector<vector<int64_t> >& size);
+template
+NXDLL_EXPORT void File::getSlabs(vector<vector<uint8_t> >& data,
+                               const vector<vector<int64_t> >& start,
+                               const vector<vector<int64_t> >& size);
+template
+NXDLL_EXPORT void File::getSlabs(vector<vector<int16_t> >& data,
+                               const vector<vector<int64_t> >& start,
+                               const vector<vector<int64_t> >& size);
+template
+NXDLL_EXPORT void File::getSlabs(vector<vector<uint16_t> >& data,
+                               const vector<vector<int64_t> >& start,
+                               const vector<vector<int64_t> >& size);
+template
+NXDLL_EXPORT void File::getSlabs(vector<vector<int32_t> >& data,
+                               const vector<vector<int64_t> >& start,
+                               const vector<vector<int64_t> >& size);
+template
+NXDLL_EXPORT void File::getSlabs(vector<vector<uint32_t> >& data,
+                               const vector<vector<int64_t> >& start,
+                               const vector<vector<int64_t> >& size);
+template
+NXDLL_EXPORT void File::getSlabs(vector<vector<int64_t> >& data,
+                               const vector<vector<int64_t> >& start,
+                               const vector<vector<int64_t> >& size);
+template
+NXDLL_EXPORT void File::getSlabs(vector<vector<uint64_t> >& data,
+                               const vector<vector<int64_t> >& start,
+                               const vector<vector<int64_t> >& size);
+template
+NXDLL_EXPORT void File::getSlabs(vector<vector<char> >& data,
+                               const vector<vector<int64_t> >& start,
+                               const vector<vector<int64_t> >& size);
+
 template
 NXDLL_EXPORT void File::readData(const std::string & dataName, vector<float>& data);
 template
@@ -1896,3 +2428,118 @@ template
 NXDLL_EXPORT void File::free(float*& data);
 template
 NXDLL_EXPORT void File::free(double*& data);
+
+template
+NXDLL_EXPORT void ObjectHandle::putAttr(const string& name, const float value);
+template
+NXDLL_EXPORT void ObjectHandle::putAttr(const string& name, const double value);
+template
+NXDLL_EXPORT void ObjectHandle::putAttr(const string& name, const int8_t value);
+template
+NXDLL_EXPORT void ObjectHandle::putAttr(const string& name, const uint8_t value);
+template
+NXDLL_EXPORT void ObjectHandle::putAttr(const string& name, const int16_t value);
+template
+NXDLL_EXPORT void ObjectHandle::putAttr(const string& name, const uint16_t value);
+template
+NXDLL_EXPORT void ObjectHandle::putAttr(const string& name, const int32_t value);
+template
+NXDLL_EXPORT void ObjectHandle::putAttr(const string& name, const uint32_t value);
+template
+NXDLL_EXPORT void ObjectHandle::putAttr(const string& name, const int64_t value);
+template
+NXDLL_EXPORT void ObjectHandle::putAttr(const string& name, const uint64_t value);
+template
+NXDLL_EXPORT void ObjectHandle::putAttr(const string& name, const char value);
+
+template
+NXDLL_EXPORT void ObjectHandle::getAttr(const string& name, float& value);
+template
+NXDLL_EXPORT void ObjectHandle::getAttr(const string& name, double& value);
+template
+NXDLL_EXPORT void ObjectHandle::getAttr(const string& name, int8_t& value);
+template
+NXDLL_EXPORT void ObjectHandle::getAttr(const string& name, uint8_t& value);
+template
+NXDLL_EXPORT void ObjectHandle::getAttr(const string& name, int16_t& value);
+template
+NXDLL_EXPORT void ObjectHandle::getAttr(const string& name, uint16_t& value);
+template
+NXDLL_EXPORT void ObjectHandle::getAttr(const string& name, int32_t& value);
+template
+NXDLL_EXPORT void ObjectHandle::getAttr(const string& name, uint32_t& value);
+template
+NXDLL_EXPORT void ObjectHandle::getAttr(const string& name, int64_t& value);
+template
+NXDLL_EXPORT void ObjectHandle::getAttr(const string& name, uint64_t& value);
+template
+NXDLL_EXPORT void ObjectHandle::getAttr(const string& name, char& value);
+
+template
+NXDLL_EXPORT void DatasetHandle::getData(vector<float>& data);
+template
+NXDLL_EXPORT void DatasetHandle::getData(vector<double>& data);
+template
+NXDLL_EXPORT void DatasetHandle::getData(vector<int8_t>& data);
+template
+NXDLL_EXPORT void DatasetHandle::getData(vector<uint8_t>& data);
+template
+NXDLL_EXPORT void DatasetHandle::getData(vector<int16_t>& data);
+template
+NXDLL_EXPORT void DatasetHandle::getData(vector<uint16_t>& data);
+template
+NXDLL_EXPORT void DatasetHandle::getData(vector<int32_t>& data);
+template
+NXDLL_EXPORT void DatasetHandle::getData(vector<uint32_t>& data);
+template
+NXDLL_EXPORT void DatasetHandle::getData(vector<int64_t>& data);
+template
+NXDLL_EXPORT void DatasetHandle::getData(vector<uint64_t>& data);
+template
+NXDLL_EXPORT void DatasetHandle::getData(vector<char>& data);
+
+template
+NXDLL_EXPORT void DatasetHandle::getSlab(vector<float>& data, const vector<int64_t>& start, const vector<int64_t>& size);
+template
+NXDLL_EXPORT void DatasetHandle::getSlab(vector<double>& data, const vector<int64_t>& start, const vector<int64_t>& size);
+template
+NXDLL_EXPORT void DatasetHandle::getSlab(vector<int8_t>& data, const vector<int64_t>& start, const vector<int64_t>& size);
+template
+NXDLL_EXPORT void DatasetHandle::getSlab(vector<uint8_t>& data, const vector<int64_t>& start, const vector<int64_t>& size);
+template
+NXDLL_EXPORT void DatasetHandle::getSlab(vector<int16_t>& data, const vector<int64_t>& start, const vector<int64_t>& size);
+template
+NXDLL_EXPORT void DatasetHandle::getSlab(vector<uint16_t>& data, const vector<int64_t>& start, const vector<int64_t>& size);
+template
+NXDLL_EXPORT void DatasetHandle::getSlab(vector<int32_t>& data, const vector<int64_t>& start, const vector<int64_t>& size);
+template
+NXDLL_EXPORT void DatasetHandle::getSlab(vector<uint32_t>& data, const vector<int64_t>& start, const vector<int64_t>& size);
+template
+NXDLL_EXPORT void DatasetHandle::getSlab(vector<int64_t>& data, const vector<int64_t>& start, const vector<int64_t>& size);
+template
+NXDLL_EXPORT void DatasetHandle::getSlab(vector<uint64_t>& data, const vector<int64_t>& start, const vector<int64_t>& size);
+template
+NXDLL_EXPORT void DatasetHandle::getSlab(vector<char>& data, const vector<int64_t>& start, const vector<int64_t>& size);
+
+template
+NXDLL_EXPORT void DatasetHandle::putSlab(const vector<float>& data, const vector<int64_t>& start, const vector<int64_t>& size);
+template
+NXDLL_EXPORT void DatasetHandle::putSlab(const vector<double>& data, const vector<int64_t>& start, const vector<int64_t>& size);
+template
+NXDLL_EXPORT void DatasetHandle::putSlab(const vector<int8_t>& data, const vector<int64_t>& start, const vector<int64_t>& size);
+template
+NXDLL_EXPORT void DatasetHandle::putSlab(const vector<uint8_t>& data, const vector<int64_t>& start, const vector<int64_t>& size);
+template
+NXDLL_EXPORT void DatasetHandle::putSlab(const vector<int16_t>& data, const vector<int64_t>& start, const vector<int64_t>& size);
+template
+NXDLL_EXPORT void DatasetHandle::putSlab(const vector<uint16_t>& data, const vector<int64_t>& start, const vector<int64_t>& size);
+template
+NXDLL_EXPORT void DatasetHandle::putSlab(const vector<int32_t>& data, const vector<int64_t>& start, const vector<int64_t>& size);
+template
+NXDLL_EXPORT void DatasetHandle::putSlab(const vector<uint32_t>& data, const vector<int64_t>& start, const vector<int64_t>& size);
+template
+NXDLL_EXPORT void DatasetHandle::putSlab(const vector<int64_t>& data, const vector<int64_t>& start, const vector<int64_t>& size);
+template
+NXDLL_EXPORT void DatasetHandle::putSlab(const vector<uint64_t>& data, const vector<int64_t>& start, const vector<int64_t>& size);
+template
+NXDLL_EXPORT void DatasetHandle::putSlab(const vector<char>& data, const vector<int64_t>& start, const vector<int64_t>& size);
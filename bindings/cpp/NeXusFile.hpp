@@ -102,6 +102,28 @@ namespace NeXus {
     std::string name;
   };
 
+  /** Information about a stored chunk of a dataset. */
+  struct ChunkInfo{
+    /** The index of the first element of the chunk. */
+    std::vector<int64_t> offset;
+    /** Bit n set means filter n was not applied to the chunk. */
+    unsigned int filterMask;
+    /** The stored size of the chunk in bytes. */
+    int64_t size;
+  };
+
+  /** A region of a virtual field and the field it is read from. */
+  struct VirtualSource{
+    /** The file holding the source field, "." for the same file. */
+    std::string filename;
+    /** The absolute path of the source field in that file. */
+    std::string path;
+    /** The index of the first element of the region. */
+    std::vector<int64_t> start;
+    /** The size of the region, the number of elements of the source. */
+    std::vector<int64_t> size;
+  };
+
   /**
    * The Object that allows access to the information in the file.
    * \ingroup cpp_core
@@ -113,6 +135,8 @@ namespace NeXus {
     NXhandle m_file_id;
     /** should be close handle on exit */
     bool m_close_handle;
+    /** Objects are opened through the C-API handle. */
+    friend class ObjectHandle;
 
   public:
     /**
@@ -141,15 +165,6 @@ namespace NeXus {
      */
     void initAttrDir();
 
-    /**
-     * Function to walk the file tree and fill in the TypeMap.
-     *
-     * \param path the current path in the file
-     * \param class_name the current NX class name
-     * \param tmap the typemap being constructed
-     */
-    void walkFileForTypeMap(const std::string path, const std::string class_name, TypeMap &tmap);
-
     /**
      * Function to append new path to current one.
      * \param currpath the current path to append to
@@ -182,6 +197,16 @@ namespace NeXus {
      */
     File(const char *filename, const NXaccess access = NXACC_READ);
 
+    /**
+     * Open a file held in memory, see NXopenbuffer(). The buffer is
+     * copied and can be released once the constructor returns.
+     *
+     * \param buffer The complete contents of an HDF-5 or XML file.
+     * \param size The size of the buffer in bytes.
+     * \param access NXACC_READ or NXACC_RDWR, changes stay in memory.
+     */
+    File(const void *buffer, size_t size, const NXaccess access = NXACC_READ);
+
     /**
      * Use an existing handle returned from NXopen()
      *
@@ -199,6 +224,19 @@ namespace NeXus {
     /** Flush the file. */
     void flush();
 
+    /**
+     * Switch a file opened with NXACC_CREATE5|NXACC_SWMR_WRITE to
+     * single-writer/multiple-reader writing, once all groups, datasets
+     * and attributes are created.
+     */
+    void startSWMR();
+
+    /**
+     * Update the open dataset with what a SWMR writer appended since it
+     * was opened. The file has to be opened with NXACC_READ|NXACC_SWMR_READ.
+     */
+    void refresh();
+
     template<typename NumT>
     void malloc(NumT*& data, const Info& info);
 
@@ -420,6 +458,43 @@ namespace NeXus {
                       const std::vector<int64_t>& dims, const NXcompression comp,
                       const std::vector<int64_t>& bufsize, bool open_data = false);
 
+    /**
+     * Create a virtual field, which reads its regions from other fields
+     * without copying them. The field is read only.
+     *
+     * \param name The name of the field to create.
+     * \param type The primitive type of the field and of its sources.
+     * \param dims The dimensions of the field.
+     * \param sources The regions of the field and where they come from.
+     * \param open_data Whether or not to open the field after creating it.
+     */
+    void makeVirtualData(const std::string& name, const NXnumtype type,
+                         const std::vector<int64_t>& dims,
+                         const std::vector<VirtualSource>& sources,
+                         bool open_data = false);
+
+    /**
+     * Create a virtual field tiled from fields of the same path and shape
+     * in several files, such as the modules of a detector. The files are
+     * taken in row-major order of the tiles, the field has the dimensions
+     * source_dims[i] * tiles[i]. Frames written to one file each are
+     * stacked with source_dims [1, ny, nx] and tiles [n, 1, 1].
+     *
+     * \param name The name of the field to create.
+     * \param type The primitive type of the field and of its sources.
+     * \param files The files holding the tiles.
+     * \param path The absolute path of the tile in each file.
+     * \param source_dims The dimensions of one tile.
+     * \param tiles The number of tiles along each dimension.
+     * \param open_data Whether or not to open the field after creating it.
+     */
+    void makeVirtualTiles(const std::string& name, const NXnumtype type,
+                          const std::vector<std::string>& files,
+                          const std::string& path,
+                          const std::vector<int64_t>& source_dims,
+                          const std::vector<int64_t>& tiles,
+                          bool open_data = false);
+
     /**
      * \copydoc writeCompData(const std::string & name,
      *                        const std::vector<NumT> & value,
@@ -630,6 +705,15 @@ namespace NeXus {
     template <typename NumT>
     void getData(std::vector<NumT>& data);
 
+    /**
+     * Put all strings of the currently open data into the supplied
+     * vector, which is resized to hold them. See NXgetstrings for the
+     * data understood as strings.
+     *
+     * \param data Where to put the strings.
+     */
+    void getData(std::vector<std::string>& data);
+
     /** Get data and coerce into an int vector.
      *
      * @throw Exception if the data is actually a float or
@@ -725,6 +809,83 @@ namespace NeXus {
     void getSlab(void* data, const std::vector<int64_t>& start,
                  const std::vector<int64_t>& size);
 
+    /**
+     * Get several sections of data from the file in one call.
+     *
+     * \param data The pointers to insert each section into.
+     * \param start The offsets into the file's data block, one per section.
+     * \param size The sizes of the blocks to read, one per section.
+     */
+    void getSlabs(const std::vector<void*>& data,
+                  const std::vector<std::vector<int64_t> >& start,
+                  const std::vector<std::vector<int64_t> >& size);
+
+    /**
+     * Get several sections of data from the file in one call. Each
+     * vector in data is resized to hold its section.
+     *
+     * \param data The vectors to put the sections into.
+     * \param start The offsets into the file's data block, one per section.
+     * \param size The sizes of the blocks to read, one per section.
+     * \tparam NumT numeric data type of \a data
+     */
+    template <typename NumT>
+    void getSlabs(std::vector<std::vector<NumT> >& data,
+                  const std::vector<std::vector<int64_t> >& start,
+                  const std::vector<std::vector<int64_t> >& size);
+
+    /**
+     * Read the open data frame by frame along its first dimension, reading
+     * ahead on a background thread. See NXgetframes64 for details.
+     *
+     * \param first The index of the first frame to read.
+     * \param count The number of frames to read.
+     * \param depth The number of frames to read ahead, 0 reads synchronously.
+     * \param callback Called with every frame, returns non zero to stop.
+     * \param userdata Passed unchanged to callback.
+     */
+    void getFrames(int64_t first, int64_t count, int depth,
+                   NXframecallback callback, void* userdata);
+
+    /**
+     * Write one chunk of the open data exactly as given, bypassing the
+     * compression filters. See NXputchunk64 for details.
+     *
+     * \param offset The index of the first element of the chunk.
+     * \param data The stored bytes of the chunk.
+     * \param filterMask Bit n set means filter n was not applied to data.
+     */
+    void putChunk(const std::vector<int64_t>& offset,
+                  const std::vector<char>& data, unsigned int filterMask = 0);
+
+    /**
+     * Read one chunk of the open data as stored, without decompressing it.
+     *
+     * \param offset The index of the first element of the chunk.
+     * \param data Resized to hold the stored bytes of the chunk, empty for
+     * chunks which have never been written.
+     * \return The filter mask stored with the chunk.
+     */
+    unsigned int getChunk(const std::vector<int64_t>& offset,
+                          std::vector<char>& data);
+
+    /**
+     * \return The number of chunks stored for the open data.
+     */
+    int64_t getChunkCount();
+
+    /**
+     * \param index The number of the chunk, below getChunkCount().
+     * \return The position, filter mask and size of the chunk.
+     */
+    ChunkInfo getChunkInfo(int64_t index);
+
+    /**
+     * \return The chunk dimensions of the open data, empty if it is not
+     * chunked.
+     */
+    std::vector<int64_t> getChunkDims();
+
     /**
      * \return Information about all attributes on the data that is
      * currently open.
@@ -855,6 +1016,175 @@ namespace NeXus {
     TypeMap *getTypeMap();
   };
 
+  /**
+   * A group or field which stays open independently of the position in the
+   * File it belongs to, see NXobjopen. Any number of objects can be open at
+   * the same time. Objects must be destroyed or closed before the File.
+   * \ingroup cpp_core
+   */
+  class NXDLL_EXPORT ObjectHandle
+  {
+  private:
+    /** The handle for the C-API. */
+    NXobject m_object;
+
+    /** Objects can not be copied. */
+    ObjectHandle(const ObjectHandle&);
+    /** Objects can not be assigned. */
+    ObjectHandle& operator=(const ObjectHandle&);
+
+  protected:
+    /**
+     * Open the object at path.
+     *
+     * \param file The file the object belongs to.
+     * \param path The path to the object, absolute or relative to the open
+     * group of file.
+     */
+    ObjectHandle(File& file, const std::string& path);
+
+    /** \return The handle for the C-API. */
+    NXobject handle();
+
+  public:
+    /** Destructor. This closes the object. */
+    virtual ~ObjectHandle();
+
+    /** Close the object before it is destroyed. */
+    void close();
+
+    /**
+     * Put a string attribute on the object.
+     *
+     * \param name Name of the attribute to add.
+     * \param value The attribute value.
+     */
+    void putAttr(const std::string& name, const std::string& value);
+
+    /**
+     * Put a string attribute on the object.
+     *
+     * \param name Name of the attribute to add.
+     * \param value The attribute value.
+     */
+    void putAttr(const std::string& name, const char* value);
+
+    /**
+     * Put a numeric attribute on the object.
+     *
+     * \param name Name of the attribute to add.
+     * \param value The attribute value.
+     * \tparam NumT numeric data type of \a value
+     */
+    template <typename NumT>
+    void putAttr(const std::string& name, const NumT value);
+
+    /**
+     * Get the value of an attribute of the object.
+     *
+     * \param name Name of attribute to read.
+     * \param value The read attribute value.
+     * \tparam NumT numeric data type of \a value, or std::string
+     */
+    template <typename NumT>
+    void getAttr(const std::string& name, NumT& value);
+  };
+
+  /**
+   * A field which stays open, for reading and writing several fields in turn
+   * without opening and closing them on every access.
+   * \ingroup cpp_core
+   */
+  class NXDLL_EXPORT DatasetHandle : public ObjectHandle
+  {
+  public:
+    /**
+     * Open the field at path.
+     *
+     * \param file The file the field belongs to.
+     * \param path The path to the field, absolute or relative to the open
+     * group of file.
+     */
+    DatasetHandle(File& file, const std::string& path);
+
+    /**
+     * \return The type and dimensions of the field.
+     */
+    Info getInfo();
+
+    /**
+     * Read all of the field.
+     *
+     * \param data The vector to put the data in, resized as needed.
+     * \tparam NumT numeric data type of \a data
+     */
+    template <typename NumT>
+    void getData(std::vector<NumT>& data);
+
+    /**
+     * Read a subset of the field.
+     *
+     * \param data The buffer to put the data in.
+     * \param start The index of the first element to read.
+     * \param size The extent of the subset in each dimension.
+     */
+    void getSlab(void* data, const std::vector<int64_t>& start,
+                 const std::vector<int64_t>& size);
+
+    /**
+     * Read a subset of the field.
+     *
+     * \param data The vector to put the data in, resized as needed.
+     * \param start The index of the first element to read.
+     * \param size The extent of the subset in each dimension.
+     * \tparam NumT numeric data type of \a data
+     */
+    template <typename NumT>
+    void getSlab(std::vector<NumT>& data, const std::vector<int64_t>& start,
+                 const std::vector<int64_t>& size);
+
+    /**
+     * Write a subset of the field.
+     *
+     * \param data The data to write.
+     * \param start The index of the first element to write.
+     * \param size The extent of the subset in each dimension.
+     */
+    void putSlab(const void* data, const std::vector<int64_t>& start,
+                 const std::vector<int64_t>& size);
+
+    /**
+     * Write a subset of the field.
+     *
+     * \param data The data to write.
+     * \param start The index of the first element to write.
+     * \param size The extent of the subset in each dimension.
+     * \tparam NumT numeric data type of \a data
+     */
+    template <typename NumT>
+    void putSlab(const std::vector<NumT>& data,
+                 const std::vector<int64_t>& start,
+                 const std::vector<int64_t>& size);
+  };
+
+  /**
+   * A group which stays open, for reading and writing its attributes
+   * without moving the position in the file.
+   * \ingroup cpp_core
+   */
+  class NXDLL_EXPORT GroupHandle : public ObjectHandle
+  {
+  public:
+    /**
+     * Open the group at path.
+     *
+     * \param file The file the group belongs to.
+     * \param path The path to the group, absolute or relative to the open
+     * group of file.
+     */
+    GroupHandle(File& file, const std::string& path);
+  };
+
   /**
    * This function returns the NXnumtype given a concrete number.
    * \tparam NumT numeric data type of \a number to check
@@ -32,6 +32,7 @@ include(CheckTypeSize)
 include(CheckIncludeFile)
 include(CheckIncludeFiles)
 include(CheckLibraryExists)
+include(CheckStructHasMember)
 
 #------------------------------------------------------------------------------
 # need this only in the case of C++ bindings
@@ -68,6 +69,14 @@ CHECK_INCLUDE_FILE(inttypes.h HAVE_INTTYPES_H)
 CHECK_INCLUDE_FILE(stdint.h HAVE_STDINT_H)
 CHECK_INCLUDE_FILE(dlfcn.h HAVE_DLFCN_H)
 
+#------------------------------------------------------------------------------
+# Check for the nanoseconds of file times
+#------------------------------------------------------------------------------
+CHECK_STRUCT_HAS_MEMBER("struct stat" st_mtim sys/stat.h
+                        HAVE_STRUCT_STAT_ST_MTIM)
+CHECK_STRUCT_HAS_MEMBER("struct stat" st_mtimespec sys/stat.h
+                        HAVE_STRUCT_STAT_ST_MTIMESPEC)
+
 if (SIZEOF_LONG_LONG_INT EQUAL 8)
 	set(PRINTF_INT64 "lld")
 	set(PRINTF_UINT64 "llu")
@@ -55,6 +55,7 @@
 #else
 #include <stdint.h>
 #endif /* __cplusplus */
+#include <stddef.h>
 
 /* NeXus HDF45 */
 #define NEXUS_VERSION   "4.4.1"                /* major.minor.patch */
@@ -62,9 +63,15 @@
 #define CONSTCHAR       const char
 
 typedef void* NXhandle;         /* really a pointer to a NexusFile structure */
+typedef void* NXobject;         /* an independently open group or dataset, see NXobjopen */
 typedef int NXstatus;
 typedef char NXname[128];
 
+/**
+ * Called by NXgetframes64 for every frame read. Return 0 to continue, anything else to stop.
+ */
+typedef int (*NXframecallback)(void* frame, int64_t index, void* userdata);
+
 /* 
  * Any new NXaccess_mode options should be numbered in 2^n format 
  * (8, 16, 32, etc) so that they can be bit masked and tested easily.
@@ -89,15 +96,74 @@ typedef char NXname[128];
  * \li NXACC_CREATE5 create a NeXus HDF-5 file.
  * \li NXACC_CREATEXML create a NeXus XML file.
  * \li NXACC_CHECKNAMESYNTAX Check names conform to NeXus allowed characters.
+ * \li NXACC_SWMR_WRITE with NXACC_CREATE5, create an HDF-5 file in the latest file
+ * format, ready for #NXstartswmr. With NXACC_RDWR, open such a file and start
+ * single-writer/multiple-reader (SWMR) writing right away.
+ * \li NXACC_SWMR_READ with NXACC_READ, read an HDF-5 file while a SWMR writer is
+ * still appending to it, see #NXrefresh.
+ * \li NXACC_CORE keep the whole HDF-5 file in memory while it is open, and write it
+ * back to the file on close if it was opened for writing. XML files are always
+ * kept in memory.
+ * \li NXACC_CORE_NOSTORE like NXACC_CORE, but never write the file, e.g. for
+ * scratch files in tests.
+ * \li NXACC_HINT_HDF4, NXACC_HINT_HDF5, NXACC_HINT_XML with NXACC_READ or NXACC_RDWR,
+ * open the file as this format without probing it first, and without searching
+ * NX_LOAD_PATH. Opening fails if the file is in another format.
+ * \li NXACC_SNAPSHOT with NXACC_READ, read the whole tree with its attributes when
+ * opening, and answer all navigation and attribute calls from memory. Only data reads
+ * go to the file. Changes to the file by others after opening are not seen. An up to
+ * date index written by #NXmakeindex is read instead of the tree.
+ * \li NXACC_INDEX with NXACC_RDWR or a create mode, write an index of the file beside
+ * it when it is closed, see #NXmakeindex.
  */
 typedef enum {NXACC_READ=1, NXACC_RDWR=2, NXACC_CREATE=3, NXACC_CREATE4=4, 
-	      NXACC_CREATE5=5, NXACC_CREATEXML=6, NXACC_TABLE=8, NXACC_NOSTRIP=128, NXACC_CHECKNAMESYNTAX=256 } NXaccess_mode;
+	      NXACC_CREATE5=5, NXACC_CREATEXML=6, NXACC_TABLE=8, NXACC_NOSTRIP=128, NXACC_CHECKNAMESYNTAX=256,
+	      NXACC_SWMR_WRITE=512, NXACC_SWMR_READ=1024, NXACC_CORE=2048, NXACC_CORE_NOSTORE=4096,
+	      NXACC_HINT_HDF4=8192, NXACC_HINT_HDF5=16384, NXACC_HINT_XML=32768,
+	      NXACC_SNAPSHOT=65536, NXACC_INDEX=131072 } NXaccess_mode;
 
 /**
  * A combination of options from #NXaccess_mode
  */
 typedef int NXaccess;
 
+/** \enum NXfile_options
+ * HDF-5 file format options for new files, see #NXsetfileoptions.
+ * \li NXFILE_LATEST_FORMAT create files in the latest HDF-5 file format.
+ * \li NXFILE_CREATION_ORDER track and index the creation order of the links in groups
+ * and of attributes; NXgetnextentry then lists groups in creation order.
+ * \li NXFILE_DENSE_ATTRIBUTES move attributes to indexed dense storage once an object
+ * has more than a set number of them.
+ * \li NXFILE_AGGREGATE_METADATA allocate metadata in larger blocks.
+ */
+typedef enum {NXFILE_LATEST_FORMAT=1, NXFILE_CREATION_ORDER=2, NXFILE_DENSE_ATTRIBUTES=4,
+	      NXFILE_AGGREGATE_METADATA=8 } NXfile_options;
+
+/** \enum NXmalloc_options
+ * Options for #NXmalloc64ex and #NXbufpoolcreate.
+ * \li NXMALLOC_NOINIT leave the memory uninitialized instead of clearing it, for buffers
+ * filled right away by reading. Character data is cleared anyway.
+ * \li NXMALLOC_HUGEPAGES ask for huge pages for large buffers, where the system has them.
+ */
+typedef enum {NXMALLOC_NOINIT=1, NXMALLOC_HUGEPAGES=2} NXmalloc_options;
+
+/**
+ * A pool of reusable data buffers, see #NXbufpoolcreate.
+ */
+typedef struct NXbufpool_s *NXbufpool;
+
+/** \enum NXvisit_options
+ * Options for #NXvisit.
+ * \li NXVISIT_WITH_ATTRIBUTES report the attributes of every object as well.
+ * \li NXVISIT_ATTRIBUTE_VALUES with NXVISIT_WITH_ATTRIBUTES, read the attributes as well.
+ */
+typedef enum {NXVISIT_WITH_ATTRIBUTES=1, NXVISIT_ATTRIBUTE_VALUES=2} NXvisit_options;
+
+/** \enum NXvisit_kind
+ * The kinds of objects #NXvisit reports.
+ */
+typedef enum {NXVISIT_GROUP=1, NXVISIT_DATASET=2, NXVISIT_ATTRIBUTE=3} NXvisit_kind;
+
 typedef struct {
                 char *iname;
                 int   type;
@@ -180,6 +246,37 @@ typedef struct {
                 int linkType;          /* HDF5: 0 for group link, 1 for SDS link */
                } NXlink;
 
+/**
+ * One source of a virtual dataset, see #NXmakevirtual64. The whole source
+ * dataset is mapped, so it must have as many elements as the region.
+ */
+typedef struct {
+                const char *filename;    /* file holding the source, "." for the same file */
+                const char *path;        /* absolute path of the source dataset */
+                int64_t start[NX_MAXRANK]; /* first element of the region in the virtual dataset */
+                int64_t size[NX_MAXRANK];  /* size of the region in each dimension */
+               } NXvirtualsource;
+
+/**
+ * An object reported by #NXvisit. The strings are valid during the callback only.
+ */
+typedef struct {
+                const char *path;        /* absolute path, of the owner for an attribute */
+                const char *name;        /* name of the object */
+                const char *nxclass;     /* NX_class of a group, "SDS" for a dataset */
+                int kind;                /* one of NXvisit_kind */
+                int type;                /* NeXus data type of a dataset or attribute */
+                int rank;                /* as from NXgetinfo64 or NXgetattrainfo */
+                int64_t dims[NX_MAXRANK];
+                const void *value;       /* of an attribute with NXVISIT_ATTRIBUTE_VALUES, as from
+                                            NXgetattra, strings terminated by a NUL */
+               } NXvisitinfo;
+
+/**
+ * Called by #NXvisit for every object, return 0 to go on or anything else to stop.
+ */
+typedef int (*NXvisitfunc)(const NXvisitinfo* info, void* userdata);
+
 #define NXMAXSTACK 50
 
 #define CONCAT(__a,__b) __a##__b        /* token concatenation */
@@ -192,6 +289,7 @@ typedef struct {
 
 #    define NXopen              MANGLE(nxiopen)
 #    define NXreopen            MANGLE(nxireopen)
+#    define NXopenbuffer        MANGLE(nxiopenbuffer)
 #    define NXclose             MANGLE(nxiclose)
 #    define NXmakegroup         MANGLE(nximakegroup)
 #    define NXopengroup         MANGLE(nxiopengroup)
@@ -203,6 +301,7 @@ typedef struct {
 #    define NXmakedata64        MANGLE(nximakedata64)
 #    define NXcompmakedata      MANGLE(nxicompmakedata)
 #    define NXcompmakedata64    MANGLE(nxicompmakedata64)
+#    define NXmakevirtual64     MANGLE(nximakevirtual64)
 #    define NXcompress          MANGLE(nxicompress)
 #    define NXopendata          MANGLE(nxiopendata)
 #    define NXclosedata         MANGLE(nxiclosedata)
@@ -217,8 +316,18 @@ typedef struct {
 #    define NXopensourcegroup   MANGLE(nxiopensourcegroup)
 #    define NXmalloc            MANGLE(nximalloc)
 #    define NXmalloc64          MANGLE(nximalloc64)
+#    define NXmallocex          MANGLE(nximallocex)
+#    define NXmalloc64ex        MANGLE(nximalloc64ex)
+#    define NXbufpoolcreate     MANGLE(nxibufpoolcreate)
+#    define NXbufpoolget        MANGLE(nxibufpoolget)
+#    define NXbufpoolrelease    MANGLE(nxibufpoolrelease)
+#    define NXbufpooldestroy    MANGLE(nxibufpooldestroy)
 #    define NXfree              MANGLE(nxifree)
 #    define NXflush             MANGLE(nxiflush)
+#    define NXstartswmr         MANGLE(nxistartswmr)
+#    define NXrefresh           MANGLE(nxirefresh)
+#    define NXsetcollective     MANGLE(nxisetcollective)
+#    define NXopenmpi           MANGLE(nxiopenmpi)
 
 #    define NXgetinfo           MANGLE(nxigetinfo)
 #    define NXgetinfo64         MANGLE(nxigetinfo64)
@@ -226,9 +335,26 @@ typedef struct {
 #    define NXgetrawinfo64      MANGLE(nxigetrawinfo64)
 #    define NXgetnextentry      MANGLE(nxigetnextentry)
 #    define NXgetdata           MANGLE(nxigetdata)
+#    define NXgetstrings        MANGLE(nxigetstrings)
 
 #    define NXgetslab           MANGLE(nxigetslab)
 #    define NXgetslab64         MANGLE(nxigetslab64)
+#    define NXgetslabs64        MANGLE(nxigetslabs64)
+#    define NXgetslab64s        MANGLE(nxigetslab64s)
+#    define NXgetpoints64       MANGLE(nxigetpoints64)
+#    define NXgetframes64       MANGLE(nxigetframes64)
+#    define NXputchunk64        MANGLE(nxiputchunk64)
+#    define NXgetchunk64        MANGLE(nxigetchunk64)
+#    define NXgetchunkcount64   MANGLE(nxigetchunkcount64)
+#    define NXgetchunkinfo64    MANGLE(nxigetchunkinfo64)
+#    define NXgetchunkdims64    MANGLE(nxigetchunkdims64)
+#    define NXobjopen           MANGLE(nxiobjopen)
+#    define NXobjclose          MANGLE(nxiobjclose)
+#    define NXobjgetinfo64      MANGLE(nxiobjgetinfo64)
+#    define NXobjgetslab64      MANGLE(nxiobjgetslab64)
+#    define NXobjputslab64      MANGLE(nxiobjputslab64)
+#    define NXobjgetattr        MANGLE(nxiobjgetattr)
+#    define NXobjputattr        MANGLE(nxiobjputattr)
 #    define NXgetnextattr       MANGLE(nxigetnextattr)
 #    define NXgetattr           MANGLE(nxigetattr)
 #    define NXgetnextattra      MANGLE(nxigetnextattra)
@@ -240,8 +366,12 @@ typedef struct {
 #    define NXsameID            MANGLE(nxisameid)
 #    define NXinitgroupdir      MANGLE(nxiinitgroupdir)
 #    define NXinitattrdir       MANGLE(nxiinitattrdir)
+#    define NXvisit             MANGLE(nxivisit)
+#    define NXmakeindex         MANGLE(nximakeindex)
+#    define NXcheckindex        MANGLE(nxicheckindex)
 #    define NXsetnumberformat   MANGLE(nxisetnumberformat)
 #    define NXsetcache          MANGLE(nxisetcache)
+#    define NXsetfileoptions    MANGLE(nxisetfileoptions)
 #    define NXinquirefile       MANGLE(nxiinquirefile) 
 #    define NXisexternalgroup   MANGLE(nxiisexternalgroup)
 #    define NXisexternaldataset   MANGLE(nxiisexternaldataset)
@@ -292,11 +422,68 @@ extern  NXstatus  NXopen(CONSTCHAR * filename, NXaccess access_method, NXhandle*
 
   /** 
    * Opens an existing NeXus file a second time for e.g. access from another thread.
+   * The new handle starts at the root of the file and navigates independently of
+   * the original one. For XML files the new handle shares the tree parsed by NXopen
+   * instead of reading the file again; changes made through one handle are seen by
+   * all of them, and the tree is freed when the last of them is closed.
+   * Supported for HDF-5 and XML files.
+   * \param pOrigHandle A handle returned by NXopen.
+   * \param pNewHandle Set to the new handle, to be closed with NXclose.
    * \return NX_OK on success, NX_ERROR in the case of an error.   
    * \ingroup c_init
    */
 extern  NXstatus  NXreopen(NXhandle pOrigHandle, NXhandle* pNewHandle);
 
+  /**
+   * Open a NeXus file held in memory, e.g. as received over the network, without
+   * writing it to disk. HDF-5 and XML files are recognised by their content. The
+   * contents are copied, so the buffer can be released once NXopenbuffer returns.
+   * Changes made through a handle opened with NXACC_RDWR stay in memory.
+   * \param buffer The complete contents of the file.
+   * \param size The size of buffer in bytes.
+   * \param access_method NXACC_READ or NXACC_RDWR.
+   * \param pHandle Set to the new handle, to be closed with NXclose.
+   * \return NX_OK on success, NX_ERROR in the case of an error.
+   * \ingroup c_init
+   */
+extern  NXstatus  NXopenbuffer(const void* buffer, size_t size, NXaccess access_method, NXhandle* pHandle);
+
+#ifdef MPI_VERSION
+  /**
+   * Open an HDF-5 file for parallel access by all processes of an MPI communicator,
+   * through MPI-IO. Only available when the library is built with ENABLE_MPI against
+   * a parallel HDF5, and declared when mpi.h is included before napi.h.
+   * All processes have to create, open and close groups, datasets and attributes
+   * together and in the same order, with the same arguments. Each can then read or
+   * write its own slabs, see #NXsetcollective. Datasets written in parallel should
+   * be created with their final size: extending one to the end of the slab of each
+   * process gives different sizes on different processes.
+   * \param filename The name of the file to open, the same on all processes.
+   * \param access_method NXACC_CREATE5, NXACC_RDWR or NXACC_READ.
+   * \param comm The processes sharing the file.
+   * \param info Hints for MPI-IO, or MPI_INFO_NULL.
+   * \param pHandle Set to the new handle, to be closed with NXclose by all processes.
+   * \return NX_OK on success, NX_ERROR in the case of an error.
+   * \ingroup c_init
+   */
+extern  NXstatus  NXopenmpi(CONSTCHAR *filename, NXaccess access_method, MPI_Comm comm, MPI_Info info, NXhandle* pHandle);
+#endif
+
+  /**
+   * Set the HDF-5 file format options for files created with NXACC_CREATE5 from now
+   * on, and for the groups and datasets later made in them. Files created before, or
+   * opened with NXACC_RDWR, are not affected. The default is no options, which gives
+   * files readable by HDF5 1.8.
+   * \param options A combination of #NXfile_options, 0 for none.
+   * \param attrMaxCompact With NXFILE_DENSE_ATTRIBUTES, the number of attributes an
+   * object keeps in compact storage, 0 for dense storage from the first one.
+   * \param metaBlockSize With NXFILE_AGGREGATE_METADATA, the size in bytes of the
+   * blocks metadata is allocated in, 0 for 64 KiB.
+   * \return NX_OK on success, NX_ERROR in the case of an error.
+   * \ingroup c_init
+   */
+extern  NXstatus  NXsetfileoptions(int options, int attrMaxCompact, long metaBlockSize);
+
   /**
    * close a NeXus file
    * \param pHandle A NeXus file handle as returned from NXopen. pHandle is invalid after this 
@@ -314,6 +501,42 @@ extern  NXstatus  NXclose(NXhandle* pHandle);
    */
 extern  NXstatus  NXflush(NXhandle* pHandle);
 
+  /**
+   * Switch a file created with NXACC_CREATE5|NXACC_SWMR_WRITE to single-writer/
+   * multiple-reader (SWMR) writing. Create all groups, datasets and attributes first:
+   * from now on only data can be written, and datasets with unlimited dimensions
+   * extended. Readers which open the file with NXACC_READ|NXACC_SWMR_READ see the new
+   * data after each #NXflush of the writer. Needs HDF5 1.10 or newer.
+   * \param handle A NeXus file handle as initialized by NXopen.
+   * \return NX_OK on success, NX_ERROR in the case of an error.
+   * \ingroup c_init
+   */
+extern  NXstatus  NXstartswmr(NXhandle handle);
+
+  /**
+   * Update the open dataset from the file, so that #NXgetinfo64 and reads see data
+   * appended by a SWMR writer since it was opened. The file has to be opened with
+   * NXACC_READ|NXACC_SWMR_READ. The new extent can become visible before the writer
+   * flushed the data appended to it; until then that part reads as fill values.
+   * Only supported for HDF-5 files.
+   * \param handle A NeXus file handle as initialized by NXopen.
+   * \return NX_OK on success, NX_ERROR in the case of an error.
+   * \ingroup c_readwrite
+   */
+extern  NXstatus  NXrefresh(NXhandle handle);
+
+  /**
+   * Choose how NXputdata, NXputslab64, NXgetdata and NXgetslab64 move data for a file
+   * opened with #NXopenmpi. Collective transfers are made by all processes together,
+   * each with its own slab, and let MPI-IO merge them into large requests. Independent
+   * transfers, the default, can be made by any process alone.
+   * \param handle A NeXus file handle as initialized by NXopenmpi.
+   * \param collective 1 for collective transfers, 0 for independent ones.
+   * \return NX_OK on success, NX_ERROR in the case of an error.
+   * \ingroup c_readwrite
+   */
+extern  NXstatus  NXsetcollective(NXhandle handle, int collective);
+
   /**
    * NeXus groups are NeXus way of structuring information into a hierarchy. 
    * This function creates a group but does not open it.
@@ -423,6 +646,25 @@ extern  NXstatus  NXcompmakedata (NXhandle handle, CONSTCHAR* label, int datatyp
   */
 extern  NXstatus NXcompmakedata64 (NXhandle handle, CONSTCHAR* label, int datatype, int rank, int64_t dim[], int comp_typ, int64_t chunk_size[]);
 
+  /**
+   * Create a virtual dataset, stitched together from datasets in this or other files
+   * without copying their data. Readers see one array; regions no source maps to read
+   * as zero. The sources need not exist yet when the dataset is created. Relative
+   * file names are looked for as HDF5 does, in the directory of this file among others.
+   * The dataset is NOT opened. Only supported for HDF-5 files, with HDF5 1.10 or newer.
+   * \param handle A NeXus file handle as initialized by NXopen.
+   * \param label The name of the dataset
+   * \param datatype The data type of this data set, not NX_CHAR.
+   * \param rank The number of dimensions of the dataset.
+   * \param dim An array of size rank holding the size of the dataset in each dimension.
+   * \param nsource The number of sources.
+   * \param source The sources and the regions they fill, with rank entries in start
+   * and size each.
+   * \return NX_OK on success, NX_ERROR in the case of an error.
+   * \ingroup c_readwrite
+   */
+extern  NXstatus NXmakevirtual64 (NXhandle handle, CONSTCHAR* label, int datatype, int rank, int64_t dim[], int nsource, const NXvirtualsource source[]);
+
 
   /**
    * Switch compression on. This routine is superceded by NXcompmakedata and thus 
@@ -569,6 +811,23 @@ extern  NXstatus  NXopensourcegroup(NXhandle handle);
    */
 extern  NXstatus  NXgetdata(NXhandle handle, void* data);
 
+  /**
+   * Read all strings of the currently open dataset at once, as an array of strings rather
+   * than the single concatenated string #NXgetdata returns. For HDF-5 files this works for
+   * variable and fixed length strings of any rank, with a single read. For other file formats
+   * a two dimensional NX_CHAR dataset is taken as one string per row, a one dimensional one
+   * as a single string.
+   * \param handle A NeXus file handle as initialized by NXopen.
+   * \param count Set to the number of strings.
+   * \param offsets Set to an array of count+1 offsets into buffer: string i starts at
+   * offsets[i] and is offsets[i+1]-offsets[i]-1 characters long. Release with #NXfree.
+   * \param buffer Set to the strings, one after the other, each terminated by a NUL.
+   * Release with #NXfree.
+   * \return NX_OK on success, NX_ERROR in the case of an error.
+   * \ingroup c_readwrite
+   */
+extern  NXstatus  NXgetstrings(NXhandle handle, int64_t* count, int64_t** offsets, char** buffer);
+
   /**
    * Retrieve information about the curretly open dataset.
    * \param handle A NeXus file handle as initialized by NXopen.
@@ -619,6 +878,223 @@ extern  NXstatus  NXgetslab(NXhandle handle, void* data, const int start[], cons
    */
 extern  NXstatus  NXgetslab64(NXhandle handle, void* data, const int64_t start[], const int64_t size[]);
 
+  /**
+   * Read several subsets of the open dataset in one call. This is equivalent to calling
+   * NXgetslab64 once per subset, but drivers which support it (HDF-5) combine all subsets
+   * into a single selection and read them with one I/O request.
+   * \param handle A NeXus file handle as initialized by NXopen.
+   * \param nslab The number of subsets to read.
+   * \param start An array of nslab pointers, each to an array of start indices for one subset.
+   * \param size An array of nslab pointers, each to an array of sizes for one subset.
+   * \param data An array of nslab pointers to the memory areas where to copy each subset to.
+   * Each area must be large enough to accomodate its subset.
+   * \return NX_OK on success, NX_ERROR in the case of an error.
+   * \ingroup c_readwrite
+   */
+extern  NXstatus  NXgetslabs64(NXhandle handle, int nslab, const int64_t* start[], const int64_t* size[], void* data[]);
+
+  /**
+   * Read a strided subset of data from file into memory. Along each dimension i,
+   * size[i] blocks of block[i] elements are read, the first element of block k
+   * being at start[i] + k * stride[i]. The data is stored densely in memory, with
+   * size[i] * block[i] elements along dimension i.
+   * \param handle A NeXus file handle as initialized by NXopen.
+   * \param data A pointer to the memory data where to copy the data too. The pointer must point
+   * to a memory area large enough to accomodate the size of the data read.
+   * \param start An array holding the start indices where to start reading the data subset.
+   * \param size An array holding the number of blocks to read for each dimension.
+   * \param stride An array holding the distance between blocks for each dimension, or NULL for 1.
+   * \param block An array holding the size of a block for each dimension, or NULL for 1.
+   * \return NX_OK on success, NX_ERROR in the case of an error.
+   * \ingroup c_readwrite
+   */
+extern  NXstatus  NXgetslab64s(NXhandle handle, void* data, const int64_t start[], const int64_t size[], const int64_t stride[], const int64_t block[]);
+
+  /**
+   * Read a list of single elements from file into memory.
+   * \param handle A NeXus file handle as initialized by NXopen.
+   * \param data A pointer to the memory area for npoints elements, which are stored
+   * in the order given in coords.
+   * \param npoints The number of elements to read.
+   * \param coords The indices of the elements, rank indices per element one after the other.
+   * \return NX_OK on success, NX_ERROR in the case of an error.
+   * \ingroup c_readwrite
+   */
+extern  NXstatus  NXgetpoints64(NXhandle handle, void* data, int64_t npoints, const int64_t coords[]);
+
+  /**
+   * Read the open dataset frame by frame, a frame being one index along the first dimension.
+   * While the callback processes a frame, the next depth frames are read ahead on a background
+   * thread, so that reading and decompression overlap with the processing. At most depth + 1
+   * frames are held in memory. Builds without thread support read synchronously.
+   * The callback runs in the calling thread; it must not use handle, but may use other
+   * NeXus handles.
+   * \param handle A NeXus file handle as initialized by NXopen.
+   * \param first The index of the first frame to read.
+   * \param count The number of frames to read.
+   * \param depth The number of frames to read ahead; 0 reads synchronously.
+   * \param callback The function called for every frame, in order. The frame buffer is only
+   * valid until the callback returns. A non zero return value cancels the remaining frames.
+   * \param userdata Passed unchanged to callback.
+   * \return NX_OK on success or cancellation, NX_ERROR in the case of an error.
+   * \ingroup c_readwrite
+   */
+extern  NXstatus  NXgetframes64(NXhandle handle, int64_t first, int64_t count, int depth, NXframecallback callback, void* userdata);
+
+  /**
+   * Write one chunk of the open dataset exactly as given, bypassing the filter
+   * pipeline. This lets data compressed elsewhere, e.g. by a detector, go to disk
+   * without being decompressed and compressed again. The dataset must be chunked,
+   * as created by #NXcompmakedata64, and data must be what the dataset's filters
+   * would have produced for the chunk. Unlimited dimensions are extended to hold
+   * the whole chunk. Only supported for HDF-5 files (HDF5 1.10.5 or newer).
+   * \param handle A NeXus file handle as initialized by NXopen.
+   * \param offset The index of the first element of the chunk, a multiple of the
+   * chunk dimensions.
+   * \param filter_mask Bit n set means filter n of the pipeline was not applied
+   * to data. 0 for chunks which went through all filters.
+   * \param data The stored bytes of the chunk.
+   * \param nbytes The number of bytes in data.
+   * \return NX_OK on success, NX_ERROR in the case of an error.
+   * \ingroup c_readwrite
+   */
+extern  NXstatus  NXputchunk64(NXhandle handle, const int64_t offset[], unsigned int filter_mask, const void* data, int64_t nbytes);
+
+  /**
+   * Read one chunk of the open dataset as stored in the file, without decoding it.
+   * Only supported for HDF-5 files (HDF5 1.10.5 or newer).
+   * \param handle A NeXus file handle as initialized by NXopen.
+   * \param offset The index of the first element of the chunk, a multiple of the
+   * chunk dimensions.
+   * \param filter_mask Set to the filter mask stored with the chunk, may be NULL.
+   * \param data The buffer to read the chunk into, or NULL to only get its size.
+   * \param nbytes On input the size of data in bytes, on output the stored size of the
+   * chunk. A chunk which has never been written has size 0.
+   * \return NX_OK on success, NX_ERROR in the case of an error or if data is too small.
+   * \ingroup c_readwrite
+   */
+extern  NXstatus  NXgetchunk64(NXhandle handle, const int64_t offset[], unsigned int* filter_mask, void* data, int64_t* nbytes);
+
+  /**
+   * Get the number of chunks stored for the open dataset.
+   * \param handle A NeXus file handle as initialized by NXopen.
+   * \param nchunks Set to the number of chunks written so far.
+   * \return NX_OK on success, NX_ERROR in the case of an error.
+   * \ingroup c_readwrite
+   */
+extern  NXstatus  NXgetchunkcount64(NXhandle handle, int64_t* nchunks);
+
+  /**
+   * Get the position and stored size of a chunk of the open dataset. Together with
+   * #NXgetchunkcount64 this lists all chunks, in the order in which they are indexed
+   * in the file.
+   * \param handle A NeXus file handle as initialized by NXopen.
+   * \param index The number of the chunk, from 0 to the chunk count - 1.
+   * \param offset Set to the index of the first element of the chunk, rank values.
+   * \param filter_mask Set to the filter mask stored with the chunk, may be NULL.
+   * \param nbytes Set to the stored size of the chunk in bytes, may be NULL.
+   * \return NX_OK on success, NX_ERROR in the case of an error.
+   * \ingroup c_readwrite
+   */
+extern  NXstatus  NXgetchunkinfo64(NXhandle handle, int64_t index, int64_t offset[], unsigned int* filter_mask, int64_t* nbytes);
+
+  /**
+   * Get the chunk dimensions of the open dataset, so that reads can be laid out along
+   * chunk boundaries and each chunk is decoded once. Unlike the other chunk functions
+   * this is no error for contiguous datasets or file formats without chunks: rank is
+   * then set to 0.
+   * \param handle A NeXus file handle as initialized by NXopen.
+   * \param rank Set to the rank of the chunks, or 0 if the dataset is not chunked.
+   * \param chunk Set to the chunk dimensions, NX_MAXRANK values.
+   * \return NX_OK on success, NX_ERROR in the case of an error.
+   * \ingroup c_readwrite
+   */
+extern  NXstatus  NXgetchunkdims64(NXhandle handle, int* rank, int64_t chunk[]);
+
+  /**
+   * Open a group or dataset as an object of its own. Unlike #NXopendata, this does
+   * not move the position of handle, and any number of objects can be open at the
+   * same time. Reads and writes through an object go straight to it, so a loop over
+   * several datasets does not have to open and close each of them per iteration.
+   * Objects must be closed with #NXobjclose before the file is closed, or before
+   * the group is closed through which an external file was entered.
+   * Supported for HDF-5 and XML files.
+   * \param handle A NeXus file handle as initialized by NXopen.
+   * \param path The path to the group or dataset, absolute or relative to the
+   * currently open group.
+   * \param object Set to the new object.
+   * \return NX_OK on success, NX_ERROR in the case of an error.
+   * \ingroup c_readwrite
+   */
+extern  NXstatus  NXobjopen(NXhandle handle, CONSTCHAR* path, NXobject* object);
+
+  /**
+   * Close an object opened with #NXobjopen.
+   * \param object The object to close, set to NULL on return.
+   * \return NX_OK on success, NX_ERROR in the case of an error.
+   * \ingroup c_readwrite
+   */
+extern  NXstatus  NXobjclose(NXobject* object);
+
+  /**
+   * Get the rank, dimensions and type of a dataset object, as #NXgetinfo64 does
+   * for the open dataset. Character data is not trimmed.
+   * \param object A dataset opened with #NXobjopen.
+   * \param rank Set to the rank of the data.
+   * \param dimension Set to the dimensions of the data, rank values.
+   * \param datatype Set to the NeXus data type of the data.
+   * \return NX_OK on success, NX_ERROR in the case of an error.
+   * \ingroup c_readwrite
+   */
+extern  NXstatus  NXobjgetinfo64(NXobject object, int* rank, int64_t dimension[], int* datatype);
+
+  /**
+   * Read a subset of a dataset object, as #NXgetslab64 does for the open dataset.
+   * \param object A dataset opened with #NXobjopen.
+   * \param data The buffer to read the subset into.
+   * \param start The index of the first element of the subset, rank values.
+   * \param size The extent of the subset in each dimension, rank values.
+   * \return NX_OK on success, NX_ERROR in the case of an error.
+   * \ingroup c_readwrite
+   */
+extern  NXstatus  NXobjgetslab64(NXobject object, void* data, const int64_t start[], const int64_t size[]);
+
+  /**
+   * Write a subset of a dataset object, as #NXputslab64 does for the open dataset.
+   * \param object A dataset opened with #NXobjopen.
+   * \param data The data to write.
+   * \param start The index of the first element of the subset, rank values.
+   * \param size The extent of the subset in each dimension, rank values.
+   * \return NX_OK on success, NX_ERROR in the case of an error.
+   * \ingroup c_readwrite
+   */
+extern  NXstatus  NXobjputslab64(NXobject object, const void* data, const int64_t start[], const int64_t size[]);
+
+  /**
+   * Read an attribute of an object, as #NXgetattr does for the open group or dataset.
+   * \param object A group or dataset opened with #NXobjopen.
+   * \param name The name of the attribute.
+   * \param data The buffer to read the attribute into.
+   * \param datalen On input the size of data in elements, on output the length of
+   * the attribute.
+   * \param iType On input the requested type, on output the type of the attribute.
+   * \return NX_OK on success, NX_ERROR in the case of an error.
+   * \ingroup c_readwrite
+   */
+extern  NXstatus  NXobjgetattr(NXobject object, char* name, void* data, int* datalen, int* iType);
+
+  /**
+   * Write an attribute of an object, as #NXputattr does for the open group or dataset.
+   * \param object A group or dataset opened with #NXobjopen.
+   * \param name The name of the attribute.
+   * \param data The value of the attribute.
+   * \param datalen The length of the attribute, 1 for numbers.
+   * \param iType The NeXus data type of the attribute.
+   * \return NX_OK on success, NX_ERROR in the case of an error.
+   * \ingroup c_readwrite
+   */
+extern  NXstatus  NXobjputattr(NXobject object, CONSTCHAR* name, const void* data, int datalen, int iType);
+
 /**
    * Iterate over global, group or dataset attributes depending on the currently open group or 
    * dataset. In order to search attributes multiple calls to #NXgetnextattr are performed in a loop 
@@ -745,6 +1221,48 @@ extern  NXstatus  NXinitgroupdir(NXhandle handle);
    */
 extern  NXstatus  NXinitattrdir(NXhandle handle);
 
+  /**
+   * Visit every group and dataset below the current group, at any depth, calling back for
+   * each with its class, type and dimensions. This replaces a recursive walk with
+   * #NXgetnextentry, #NXopengroup and #NXgetinfo64 and, for HDF-5 files, needs no opening
+   * and closing through the API. The current group itself is not reported, but with
+   * NXVISIT_WITH_ATTRIBUTES its attributes come first, then the attributes of each object
+   * right after it. The NX_class attribute of groups is not reported as an attribute.
+   * An object reached through several links is reported once for each, with what is below
+   * it, in the order of #NXgetnextentry. Links back to a group above are not followed.
+   * Datasets of variable length strings report their shape without the string length.
+   * No dataset may be open, the current group is the same afterwards.
+   * \param handle A NeXus file handle as initialized by NXopen.
+   * \param flags A combination of #NXvisit_options.
+   * \param callback Called for every object, returning anything but 0 stops the visit.
+   * \param userdata Passed on to callback.
+   * \return NX_OK when everything was visited, NX_EOD when the callback stopped the visit,
+   * NX_ERROR in the case of an error.
+   * \ingroup c_navigation
+   */
+extern  NXstatus  NXvisit(NXhandle handle, int flags, NXvisitfunc callback, void* userdata);
+
+  /**
+   * Write an index of a file beside it, to filename with ".nxindex" appended. The index
+   * holds what #NXvisit reports with all attribute values, and the size, inode and
+   * modification and change times, to the nanosecond, of the file. A file opened with NXACC_READ|NXACC_SNAPSHOT reads its index instead
+   * of walking its tree, unless the file has changed since. The index is written to a
+   * temporary file first and then renamed, so readers never see half an index.
+   * \param filename The name of the NeXus file, which must not be open for writing.
+   * \return NX_OK on success, NX_ERROR in the case of an error.
+   * \ingroup c_metadata
+   */
+extern  NXstatus  NXmakeindex(CONSTCHAR *filename);
+
+  /**
+   * Check whether the index of a file, see #NXmakeindex, is there and up to date.
+   * \param filename The name of the NeXus file.
+   * \return NX_OK if the index can be used, NX_EOD if there is none or the file has
+   * changed since it was written.
+   * \ingroup c_metadata
+   */
+extern  NXstatus  NXcheckindex(CONSTCHAR *filename);
+
   /**
    * Sets the format for number printing. This call has only an effect when using the XML physical file 
    * format. 
@@ -837,6 +1355,67 @@ extern  NXstatus  NXmalloc(void** data, int rank, const int dimensions[], int da
    */ 
 extern  NXstatus  NXmalloc64(void** data, int rank, const int64_t dimensions[], int datatype);
 
+  /**
+   * Like #NXmalloc64, but the memory is aligned to 64 bytes, for vectorized code. It is
+   * not aligned on Windows, where aligned memory cannot be released with #NXfree.
+   * \param data A pointer to a pointer which will be initialized with a pointer to a suitably sized memory area.
+   * \param rank the rank of the data.
+   * \param dimensions An array holding the size of the data in each dimension.
+   * \param datatype The NeXus data type of the data.
+   * \param options A combination of #NXmalloc_options, 0 to clear the memory as #NXmalloc64 does.
+   * \return NX_OK when allocation succeeds, NX_ERROR in the case of an error.
+   * \ingroup c_memory
+   */
+extern  NXstatus  NXmalloc64ex(void** data, int rank, const int64_t dimensions[], int datatype, int options);
+
+  /**
+   * @copydoc NXmalloc64ex()
+   */
+extern  NXstatus  NXmallocex(void** data, int rank, const int dimensions[], int datatype, int options);
+
+  /**
+   * Create a pool of data buffers, for reading many datasets of the same or similar sizes
+   * without allocating memory each time. Buffers come from the pool with #NXbufpoolget
+   * and go back to it with #NXbufpoolrelease. A pool is not locked, use one per thread.
+   * \param pool Set to the new pool.
+   * \param options A combination of #NXmalloc_options for the buffers, as for #NXmalloc64ex.
+   * \return NX_OK on success, NX_ERROR in the case of an error.
+   * \ingroup c_memory
+   */
+extern  NXstatus  NXbufpoolcreate(NXbufpool* pool, int options);
+
+  /**
+   * Get a buffer suitably sized for the dataset characteristics specified from a pool.
+   * A free buffer of the pool is reused if one is large enough, otherwise a new one is
+   * allocated. Reused buffers are cleared only if the pool was not created with
+   * NXMALLOC_NOINIT.
+   * \param pool The pool, from #NXbufpoolcreate.
+   * \param data Set to the buffer.
+   * \param rank the rank of the data.
+   * \param dimensions An array holding the size of the data in each dimension.
+   * \param datatype The NeXus data type of the data.
+   * \return NX_OK on success, NX_ERROR in the case of an error.
+   * \ingroup c_memory
+   */
+extern  NXstatus  NXbufpoolget(NXbufpool pool, void** data, int rank, const int64_t dimensions[], int datatype);
+
+  /**
+   * Give a buffer from #NXbufpoolget back to its pool for reuse.
+   * \param pool The pool the buffer came from.
+   * \param data The buffer. It must not be used afterwards.
+   * \return NX_OK on success, NX_ERROR in the case of an error.
+   * \ingroup c_memory
+   */
+extern  NXstatus  NXbufpoolrelease(NXbufpool pool, void* data);
+
+  /**
+   * Release a pool and all its buffers, including those still handed out.
+   * \param pool The pool, set to NULL.
+   * \return NX_OK on success, NX_ERROR in the case of an error.
+   * \ingroup c_memory
+   */
+extern  NXstatus  NXbufpooldestroy(NXbufpool* pool);
+
 
   /**
    * Utility function to return NeXus version
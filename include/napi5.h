@@ -15,7 +15,15 @@ extern  NXstatus  NX5open(CONSTCHAR *filename, NXaccess access_method, NXhandle*
 extern  NXstatus  NX5reopen(NXhandle pOrigHandle, NXhandle* pNewHandle);
 
 extern  NXstatus  NX5close(NXhandle* pHandle);
+extern  NXstatus  NX5openbuffer(const void* buffer, size_t size, NXaccess access_method, NXhandle* pHandle);
 extern  NXstatus  NX5flush(NXhandle* pHandle);
+extern  NXstatus  NX5startswmr(NXhandle handle);
+extern  NXstatus  NX5refresh(NXhandle handle);
+extern  NXstatus  NX5setcollective(NXhandle handle, int collective);
+extern  void      NX5threadinit(void);
+#ifdef H5_HAVE_PARALLEL
+extern  NXstatus  NX5openmpi(CONSTCHAR *filename, NXaccess access_method, MPI_Comm comm, MPI_Info info, NXhandle* pHandle);
+#endif
   
 extern  NXstatus  NX5makegroup (NXhandle handle, CONSTCHAR *name, CONSTCHAR* NXclass);
 extern  NXstatus  NX5opengroup (NXhandle handle, CONSTCHAR *name, CONSTCHAR* NXclass);
@@ -23,6 +31,7 @@ extern  NXstatus  NX5closegroup(NXhandle handle);
   
 extern  NXstatus  NX5makedata64 (NXhandle handle, CONSTCHAR* label, int datatype, int rank, int64_t dim[]);
 extern  NXstatus  NX5compmakedata64 (NXhandle handle, CONSTCHAR* label, int datatype, int rank, int64_t dim[], int comp_typ, int64_t bufsize[]);
+extern  NXstatus  NX5makevirtual64 (NXhandle handle, CONSTCHAR* label, int datatype, int rank, int64_t dim[], int nsource, const NXvirtualsource source[]);
 extern  NXstatus  NX5compress (NXhandle handle, int compr_type);
 extern  NXstatus  NX5opendata (NXhandle handle, CONSTCHAR* label);
 extern  NXstatus  NX5closedata(NXhandle handle);
@@ -37,9 +46,23 @@ extern  NXstatus  NX5printlink(NXhandle handle, NXlink* pLink);
 
 extern  NXstatus  NX5getdata(NXhandle handle, void* data);
 extern  NXstatus  NX5getinfo64(NXhandle handle, int* rank, int64_t dimension[], int* datatype);
+extern  NXstatus  NX5getstrings(NXhandle handle, int64_t* count, int64_t** offsets, char** buffer);
 extern  NXstatus  NX5getnextentry(NXhandle handle, NXname name, NXname nxclass, int* datatype);
+extern  NXstatus  NX5visit(NXhandle handle, int flags, NXvisitfunc callback, void* userdata);
 
 extern  NXstatus  NX5getslab64(NXhandle handle, void* data, const int64_t start[], const int64_t size[]);
+extern  NXstatus  NX5getslabs64(NXhandle handle, int nslab, const int64_t* start[], const int64_t* size[], void* data[]);
+extern  NXstatus  NX5getslab64s(NXhandle handle, void* data, const int64_t start[], const int64_t size[], const int64_t stride[], const int64_t block[]);
+extern  NXstatus  NX5getpoints64(NXhandle handle, void* data, int64_t npoints, const int64_t coords[]);
+extern  NXstatus  NX5putchunk64(NXhandle handle, const int64_t offset[], unsigned int filter_mask, const void* data, int64_t nbytes);
+extern  NXstatus  NX5getchunk64(NXhandle handle, const int64_t offset[], unsigned int* filter_mask, void* data, int64_t* nbytes);
+extern  NXstatus  NX5getchunkcount64(NXhandle handle, int64_t* nchunks);
+extern  NXstatus  NX5getchunkinfo64(NXhandle handle, int64_t index, int64_t offset[], unsigned int* filter_mask, int64_t* nbytes);
+extern  NXstatus  NX5getchunkdims64(NXhandle handle, int* rank, int64_t chunk[]);
+extern  NXstatus  NX5objopen(NXhandle handle, CONSTCHAR* path, void** object);
+extern  NXstatus  NX5objclose(NXhandle handle, void* object);
+extern  NXstatus  NX5objenter(NXhandle handle, void* object);
+extern  NXstatus  NX5objleave(NXhandle handle, void* object);
 extern  NXstatus  NX5getnextattr(NXhandle handle, NXname pName, int *iLength, int *iType);
 extern  NXstatus  NX5getattr(NXhandle handle, char* name, void* data, int* iDataLen, int* iType);
 extern  NXstatus  NX5getattrinfo(NXhandle handle, int* no_items);
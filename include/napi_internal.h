@@ -123,11 +123,15 @@ extern  NXstatus  NXsetcache(long newVal);
         NXstatus ( *nxreopen)(NXhandle pOrigHandle, NXhandle* pNewHandle);
         NXstatus ( *nxclose)(NXhandle* pHandle);
         NXstatus ( *nxflush)(NXhandle* pHandle);
+        NXstatus ( *nxstartswmr)(NXhandle handle);
+        NXstatus ( *nxrefresh)(NXhandle handle);
+        NXstatus ( *nxsetcollective)(NXhandle handle, int collective);
         NXstatus ( *nxmakegroup) (NXhandle handle, CONSTCHAR *name, CONSTCHAR* NXclass);
         NXstatus ( *nxopengroup) (NXhandle handle, CONSTCHAR *name, CONSTCHAR* NXclass);
         NXstatus ( *nxclosegroup)(NXhandle handle);
         NXstatus ( *nxmakedata64) (NXhandle handle, CONSTCHAR* label, int datatype, int rank, int64_t dim[]);
         NXstatus ( *nxcompmakedata64) (NXhandle handle, CONSTCHAR* label, int datatype, int rank, int64_t dim[], int comp_typ, int64_t bufsize[]);
+        NXstatus ( *nxmakevirtual64) (NXhandle handle, CONSTCHAR* label, int datatype, int rank, int64_t dim[], int nsource, const NXvirtualsource source[]);
         NXstatus ( *nxcompress) (NXhandle handle, int compr_type);
         NXstatus ( *nxopendata) (NXhandle handle, CONSTCHAR* label);
         NXstatus ( *nxclosedata)(NXhandle handle);
@@ -140,8 +144,22 @@ extern  NXstatus  NXsetcache(long newVal);
         NXstatus ( *nxmakenamedlink)(NXhandle handle, CONSTCHAR *newname, NXlink* pLink);
         NXstatus ( *nxgetdata)(NXhandle handle, void* data);
         NXstatus ( *nxgetinfo64)(NXhandle handle, int* rank, int64_t dimension[], int* datatype);
+        NXstatus ( *nxgetstrings)(NXhandle handle, int64_t* count, int64_t** offsets, char** buffer);
+        NXstatus ( *nxvisit)(NXhandle handle, int flags, NXvisitfunc callback, void* userdata);
         NXstatus ( *nxgetnextentry)(NXhandle handle, NXname name, NXname nxclass, int* datatype);
         NXstatus ( *nxgetslab64)(NXhandle handle, void* data, const int64_t start[], const int64_t size[]);
+        NXstatus ( *nxgetslabs64)(NXhandle handle, int nslab, const int64_t* start[], const int64_t* size[], void* data[]);
+        NXstatus ( *nxgetslab64s)(NXhandle handle, void* data, const int64_t start[], const int64_t size[], const int64_t stride[], const int64_t block[]);
+        NXstatus ( *nxgetpoints64)(NXhandle handle, void* data, int64_t npoints, const int64_t coords[]);
+        NXstatus ( *nxputchunk64)(NXhandle handle, const int64_t offset[], unsigned int filter_mask, const void* data, int64_t nbytes);
+        NXstatus ( *nxgetchunk64)(NXhandle handle, const int64_t offset[], unsigned int* filter_mask, void* data, int64_t* nbytes);
+        NXstatus ( *nxgetchunkcount64)(NXhandle handle, int64_t* nchunks);
+        NXstatus ( *nxgetchunkinfo64)(NXhandle handle, int64_t index, int64_t offset[], unsigned int* filter_mask, int64_t* nbytes);
+        NXstatus ( *nxgetchunkdims64)(NXhandle handle, int* rank, int64_t chunk[]);
+        NXstatus ( *nxobjopen)(NXhandle handle, CONSTCHAR* path, void** object);
+        NXstatus ( *nxobjclose)(NXhandle handle, void* object);
+        NXstatus ( *nxobjenter)(NXhandle handle, void* object);
+        NXstatus ( *nxobjleave)(NXhandle handle, void* object);
         NXstatus ( *nxgetnextattr)(NXhandle handle, NXname pName, int *iLength, int *iType);
         NXstatus ( *nxgetnextattra)(NXhandle handle, NXname pName, int *rank, int dim[], int *iType);
         NXstatus ( *nxgetattr)(NXhandle handle, char* name, void* data, int* iDataLen, int* iType);
@@ -160,9 +178,13 @@ extern  NXstatus  NXsetcache(long newVal);
         NXstatus ( *nxnativeisexternallink)(NXhandle handle, CONSTCHAR* name, char* url, int urllen);
         int stripFlag;
         int checkNameSyntax;
+        int writeIndex;
   } NexusFunction, *pNexusFunction;
   /*---------------------*/
   extern long nx_cacheSize;
+  extern int nx_fileOptions;
+  extern int nx_attrMaxCompact;
+  extern long nx_metaBlockSize;
 
 #ifdef __cplusplus
 };
@@ -48,6 +48,14 @@ extern NXstatus  NXUreadhistogram(NXhandle file_id, const char* data_name, void*
 
 extern NXstatus  NXUsetcompress(NXhandle file_id, int comp_type, int comp_size);
 
+/*
+ * The NXUfind functions search the currently open group, with no data item open.
+ * They return NX_OK when found and NX_EOD when not, NX_ERROR is kept for bad requests
+ * and files, e.g. an axis beyond the rank of the signal. Every group searched is listed
+ * once into an index kept with the handle, so repeated searches do not touch the
+ * file; changes made through the handle drop the index. Axis numbers count from 1
+ * in C order.
+ */
 extern NXstatus  NXUfindgroup(NXhandle file_id, const char* group_name, char* group_class);
 
 extern NXstatus  NXUfindclass(NXhandle file_id, const char* group_class, char* group_name, int find_index);
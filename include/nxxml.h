@@ -25,6 +25,8 @@
 extern  NXstatus  NXXopen(CONSTCHAR *filename, 
 					    NXaccess access_method, 
 					    NXhandle* pHandle);
+extern  NXstatus  NXXreopen(NXhandle pOrigHandle, NXhandle* pNewHandle);
+extern  NXstatus  NXXopenbuffer(const void* buffer, size_t size, NXaccess access_method, NXhandle* pHandle);
 extern  NXstatus  NXXclose(NXhandle* pHandle);
 extern  NXstatus  NXXflush(NXhandle* pHandle);
 
@@ -52,6 +54,15 @@ NXstatus  NXXputslab64 (NXhandle fid, const void *data,
 				   const int64_t iStart[], const int64_t iSize[]);
 NXstatus  NXXgetslab64 (NXhandle fid, void *data, 
 				   const int64_t iStart[], const int64_t iSize[]);
+NXstatus  NXXgetslab64s (NXhandle fid, void *data,
+				   const int64_t iStart[], const int64_t iSize[],
+				   const int64_t iStride[], const int64_t iBlock[]);
+NXstatus  NXXgetpoints64 (NXhandle fid, void *data,
+				   int64_t npoints, const int64_t coords[]);
+NXstatus  NXXobjopen(NXhandle fid, CONSTCHAR *path, void **object);
+NXstatus  NXXobjclose(NXhandle fid, void *object);
+NXstatus  NXXobjenter(NXhandle fid, void *object);
+NXstatus  NXXobjleave(NXhandle fid, void *object);
 NXstatus  NXXputattr (NXhandle fid, CONSTCHAR *name, const void *data, 
 				   int datalen, int iType);
 NXstatus  NXXgetattr (NXhandle fid, char *name, 
@@ -31,10 +31,14 @@
 #include <time.h>
 #include <stdarg.h>
 
+#include <nxconfig.h>
+#ifdef WITH_MPI
+#include <mpi.h>		/* before napi.h, which declares NXopenmpi then */
+#endif
 #include <napi.h>
 #include <napi_internal.h>
-#include <nxconfig.h>
 #include "nxstack.h"
+#include "nxsnapshot.h"
 
 /*---------------------------------------------------------------------
  Recognized and handled napimount URLS
@@ -63,6 +67,19 @@
 
 #include "nx_stptok.h"
 
+#ifndef _WIN32
+#include <sys/mman.h>		/* madvise */
+#endif
+
+/* alignment of NXmalloc64ex buffers, and the huge page size asked for */
+#define NX_ALIGNMENT 64
+#define NX_HUGEPAGE_SIZE (2 * 1024 * 1024)
+
+#if defined(_WIN32) || HAVE_LIBPTHREAD
+/* called on the first locked call made on each thread */
+static void nxithreadinit(void);
+#endif
+
 #if defined(_WIN32)
 /*
  *  HDF5 on windows does not do locking for multiple threads conveniently so we will implement it ourselves.
@@ -75,11 +92,16 @@ static CRITICAL_SECTION nx_critical;
 static int nxilock()
 {
 	static int first_call = 1;
+	static THREAD_LOCAL int thread_seen = 0;
 	if (first_call) {
 		first_call = 0;
 		InitializeCriticalSection(&nx_critical);
 	}
 	EnterCriticalSection(&nx_critical);
+	if (!thread_seen) {
+		thread_seen = 1;
+		nxithreadinit();
+	}
 	return NX_OK;
 }
 
@@ -115,6 +137,7 @@ static void nx_pthread_init()
 static int nxilock()
 {
 	static pthread_once_t once_control = PTHREAD_ONCE_INIT;
+	static THREAD_LOCAL int thread_seen = 0;
 	if (pthread_once(&once_control, nx_pthread_init) != 0) {
 		NXReportError("pthread_once failed");
 		return NX_ERROR;
@@ -123,6 +146,10 @@ static int nxilock()
 		NXReportError("pthread_mutex_lock failed");
 		return NX_ERROR;
 	}
+	if (!thread_seen) {
+		thread_seen = 1;
+		nxithreadinit();
+	}
 	return NX_OK;
 }
 
@@ -256,6 +283,28 @@ NXstatus NXsetcache(long newVal)
 	return NX_ERROR;
 }
 
+/*------------------------------------------------------------------------
+  HDF-5 file format options for new files
+  -------------------------------------------------------------------------*/
+int nx_fileOptions = 0;
+int nx_attrMaxCompact = 8;	/* HDF-5 default */
+long nx_metaBlockSize = 65536;
+
+NXstatus NXsetfileoptions(int options, int attrMaxCompact, long metaBlockSize)
+{
+	if (attrMaxCompact < 0 || metaBlockSize < 0 ||
+	    (options & ~(NXFILE_LATEST_FORMAT | NXFILE_CREATION_ORDER |
+			 NXFILE_DENSE_ATTRIBUTES |
+			 NXFILE_AGGREGATE_METADATA)) != 0) {
+		NXReportError("ERROR: invalid arguments to NXsetfileoptions");
+		return NX_ERROR;
+	}
+	nx_fileOptions = options;
+	nx_attrMaxCompact = attrMaxCompact;
+	nx_metaBlockSize = (metaBlockSize > 0) ? metaBlockSize : 65536;
+	return NX_OK;
+}
+
 #ifdef WITH_MXML
 /*-----------------------------------------------------------------------*/
 static NXstatus NXisXML(CONSTCHAR * filename)
@@ -396,25 +445,84 @@ extern void NXMEnableErrorReporting()
 #endif
 #ifdef WITH_MXML
 #include "nxxml.h"
+#endif
+
+/*----------------------------------------------------------------------*/
+#if defined(_WIN32) || HAVE_LIBPTHREAD
+static void nxithreadinit(void)
+{
+#ifdef WITH_HDF5
+	NX5threadinit();
+#endif
+}
 #endif
   /* ---------------------------------------------------------------------- 
 
      Definition of NeXus API
 
      --------------------------------------------------------------------- */
+/* the format of a file image by its signature: 1 HDF-4, 2 HDF-5, 3 XML */
+static int determineBufferType(const void *buffer, size_t size)
+{
+	static const char hdf5sig[8] = { '\211', 'H', 'D', 'F', '\r', '\n',
+		'\032', '\n'
+	};
+	static const char hdf4sig[4] = { '\016', '\003', '\023', '\001' };
+	const char *pc = (const char *)buffer;
+	size_t offset;
+
+	/* the HDF-5 superblock may follow a user block of 512, 1024, ... bytes */
+	for (offset = 0; offset + sizeof(hdf5sig) <= size;
+	     offset = offset == 0 ? 512 : 2 * offset) {
+		if (memcmp(pc + offset, hdf5sig, sizeof(hdf5sig)) == 0) {
+			return 2;
+		}
+	}
+	if (size >= sizeof(hdf4sig) && memcmp(pc, hdf4sig, sizeof(hdf4sig)) == 0) {
+		return 1;
+	}
+	for (offset = 0; offset < size && isspace((unsigned char)pc[offset]);
+	     offset++) ;
+	if (size - offset >= 5 && strncmp(pc + offset, "<?xml", 5) == 0) {
+		return 3;
+	}
+	return 0;
+}
+
 static int determineFileTypeImpl(CONSTCHAR * filename)
 {
 	FILE *fd = NULL;
+	char head[64];
+	size_t length;
 	int iRet;
 
 	/*
-	   this is for reading, check for existence first
+	   this is for reading, check for existence first. The signature at the
+	   start of the file settles most cases without asking the libraries,
+	   which open the file once more each.
 	 */
-	fd = fopen(filename, "r");
+	fd = fopen(filename, "rb");
 	if (fd == NULL) {
 		return -1;
 	}
+	length = fread(head, 1, sizeof(head), fd);
 	fclose(fd);
+	iRet = determineBufferType(head, length);
+#ifdef WITH_HDF5
+	if (iRet == 2) {
+		return 2;
+	}
+#endif
+#ifdef WITH_HDF4
+	if (iRet == 1) {
+		return 1;
+	}
+#endif
+#ifdef WITH_MXML
+	if (iRet == 3) {
+		return 3;
+	}
+#endif
 #ifdef WITH_HDF5
 	iRet = H5Fis_hdf5((const char *)filename);
 	if (iRet > 0) {
@@ -485,6 +593,7 @@ static NXstatus NXinternalopenImpl(CONSTCHAR * userfilename, NXaccess am,
 {
 	int hdf_type = 0;
 	int iRet = 0;
+	int hint;
 	NXhandle hdf5_handle = NULL;
 	pNexusFunction fHandle = NULL;
 	NXstatus retstat = NX_ERROR;
@@ -520,6 +629,22 @@ static NXstatus NXinternalopenImpl(CONSTCHAR * userfilename, NXaccess am,
 		fHandle->checkNameSyntax = 1;
 		am = (NXaccess) (am & ~NXACC_CHECKNAMESYNTAX);
 	}
+	fHandle->writeIndex = 0;
+	if (am & NXACC_INDEX) {
+		if (my_am == NXACC_READ) {
+			NXReportError
+			    ("ERROR: NXACC_INDEX needs a file opened for writing");
+			free(fHandle);
+			return NX_ERROR;
+		}
+		fHandle->writeIndex = 1;
+		am = (NXaccess) (am & ~NXACC_INDEX);
+	}
+	/*
+	   a format hint replaces looking for the file and probing it
+	 */
+	hint = am & (NXACC_HINT_HDF4 | NXACC_HINT_HDF5 | NXACC_HINT_XML);
+	am = (NXaccess) (am & ~hint);
 
 	if (my_am == NXACC_CREATE) {
 		/* HDF4 will be used ! */
@@ -537,6 +662,19 @@ static NXstatus NXinternalopenImpl(CONSTCHAR * userfilename, NXaccess am,
 		/* XML will be used ! */
 		hdf_type = 3;
 		filename = strdup(userfilename);
+	} else if (hint != 0) {
+		if (hint == NXACC_HINT_HDF4) {
+			hdf_type = 1;
+		} else if (hint == NXACC_HINT_HDF5) {
+			hdf_type = 2;
+		} else if (hint == NXACC_HINT_XML) {
+			hdf_type = 3;
+		} else {
+			NXReportError("ERROR: more than one file format hint");
+			free(fHandle);
+			return NX_ERROR;
+		}
+		filename = strdup(userfilename);
 	} else {
 		filename = locateNexusFileInPath((char *)userfilename);
 		if (filename == NULL) {
@@ -568,6 +706,19 @@ static NXstatus NXinternalopenImpl(CONSTCHAR * userfilename, NXaccess am,
 		NXReportError("Out of memory in NeXus-API");
 		return NX_ERROR;
 	}
+	if ((am & (NXACC_SWMR_WRITE | NXACC_SWMR_READ)) && hdf_type != 2) {
+		NXReportError("ERROR: SWMR access is only available for HDF-5 files");
+		free(filename);
+		free(fHandle);
+		return NX_ERROR;
+	}
+	if ((am & (NXACC_CORE | NXACC_CORE_NOSTORE)) && hdf_type == 1) {
+		NXReportError
+		    ("ERROR: in-memory files are only available for HDF-5 and XML");
+		free(filename);
+		free(fHandle);
+		return NX_ERROR;
+	}
 
 	if (hdf_type == 1) {
 		/* HDF4 type */
@@ -642,7 +793,34 @@ static NXstatus NXinternalopenImpl(CONSTCHAR * userfilename, NXaccess am,
 static NXstatus NXinternalopen(CONSTCHAR * userfilename, NXaccess am,
 			       pFileStack fileStack)
 {
-	return LOCKED_CALL(NXinternalopenImpl(userfilename, am, fileStack));
+	pNexusFunction fHandle;
+	NXhandle hfil;
+	NXstatus status;
+
+	if (!(am & NXACC_SNAPSHOT)) {
+		return LOCKED_CALL(NXinternalopenImpl
+				   (userfilename, am, fileStack));
+	}
+	if ((am & NXACCMASK_REMOVEFLAGS) != NXACC_READ) {
+		NXReportError("ERROR: NXACC_SNAPSHOT needs NXACC_READ");
+		return NX_ERROR;
+	}
+	status = LOCKED_CALL(NXinternalopenImpl(userfilename,
+						(NXaccess) (am &
+							    ~NXACC_SNAPSHOT),
+						fileStack));
+	if (status != NX_OK) {
+		return status;
+	}
+	status = NXsnapshotopen(fileStack);
+	if (status != NX_OK) {
+		fHandle = peekFileOnStack(fileStack);
+		hfil = fHandle->pNexusData;
+		LOCKED_CALL(fHandle->nxclose(&hfil));
+		free(fHandle);
+		popFileStack(fileStack);
+	}
+	return status;
 }
 
 NXstatus NXreopen(NXhandle pOrigHandle, NXhandle * pNewHandle)
@@ -661,19 +839,32 @@ NXstatus NXreopen(NXhandle pOrigHandle, NXhandle * pNewHandle)
 	if (fileStackDepth(origFileStack) > 0) {
 		NXReportError
 		    ("ERROR: handle stack referes to many files - cannot reopen");
+		killFileStack(newFileStack);
 		return NX_ERROR;
 	}
 	fOrigHandle = peekFileOnStack(origFileStack);
 	if (fOrigHandle->nxreopen == NULL) {
 		NXReportError
 		    ("ERROR: NXreopen not implemented for this underlying file format");
+		killFileStack(newFileStack);
 		return NX_ERROR;
 	}
 	fNewHandle = (NexusFunction *) malloc(sizeof(NexusFunction));
+	if (fNewHandle == NULL) {
+		NXReportError("ERROR: no memory to create filestack");
+		killFileStack(newFileStack);
+		return NX_ERROR;
+	}
 	memcpy(fNewHandle, fOrigHandle, sizeof(NexusFunction));
-	LOCKED_CALL(fNewHandle->
-		    nxreopen(fOrigHandle->pNexusData,
-			     &(fNewHandle->pNexusData)));
+	/* the index is written when the handle which asked for it is closed */
+	fNewHandle->writeIndex = 0;
+	if (LOCKED_CALL(fNewHandle->
+			nxreopen(fOrigHandle->pNexusData,
+				 &(fNewHandle->pNexusData))) != NX_OK) {
+		free(fNewHandle);
+		killFileStack(newFileStack);
+		return NX_ERROR;
+	}
 	pushFileStack(newFileStack, fNewHandle,
 		      peekFilenameOnStack(origFileStack));
 	*pNewHandle = newFileStack;
@@ -682,17 +873,170 @@ NXstatus NXreopen(NXhandle pOrigHandle, NXhandle * pNewHandle)
 
 /* ------------------------------------------------------------------------- */
 
+static NXstatus NXopenbufferImpl(const void *buffer, size_t size,
+				 NXaccess am, pFileStack fileStack)
+{
+	NXhandle handle = NULL;
+	pNexusFunction fHandle = NULL;
+	NXstatus retstat = NX_ERROR;
+	char filename[64];
+	int hdf_type;
+
+	if (am != NXACC_READ && am != NXACC_RDWR) {
+		NXReportError
+		    ("ERROR: NXopenbuffer needs NXACC_READ or NXACC_RDWR");
+		return NX_ERROR;
+	}
+	hdf_type = determineBufferType(buffer, size);
+	if (hdf_type != 2 && hdf_type != 3) {
+		NXReportError
+		    ("ERROR: buffer holds no HDF-5 or XML NeXus file");
+		return NX_ERROR;
+	}
+	fHandle = (pNexusFunction) malloc(sizeof(NexusFunction));
+	if (fHandle == NULL) {
+		NXReportError("ERROR: no memory to create Function structure");
+		return NX_ERROR;
+	}
+	memset(fHandle, 0, sizeof(NexusFunction));	/* so any functions we miss are NULL */
+	fHandle->stripFlag = 1;
+
+	if (hdf_type == 2) {
+#ifdef WITH_HDF5
+		retstat = NX5openbuffer(buffer, size, am, &handle);
+		if (retstat == NX_OK) {
+			fHandle->pNexusData = handle;
+			NX5assignFunctions(fHandle);
+		}
+#else
+		NXReportError
+		    ("ERROR: Attempt to open HDF5 file when not linked with HDF5");
+#endif				/* HDF5 */
+	} else {
+#ifdef WITH_MXML
+		retstat = NXXopenbuffer(buffer, size, am, &handle);
+		if (retstat == NX_OK) {
+			fHandle->pNexusData = handle;
+			NXXassignFunctions(fHandle);
+		}
+#else
+		NXReportError
+		    ("ERROR: Attempt to open XML file when not linked with XML");
+#endif
+	}
+	if (retstat != NX_OK) {
+		free(fHandle);
+		return retstat;
+	}
+	/* there is no file, name it after the buffer for error messages */
+	sprintf(filename, "memory:%p", buffer);
+	pushFileStack(fileStack, fHandle, filename);
+	return NX_OK;
+}
+
+NXstatus NXopenbuffer(const void *buffer, size_t size, NXaccess am,
+		      NXhandle * gHandle)
+{
+	int status;
+	pFileStack fileStack = NULL;
+
+	*gHandle = NULL;
+	if (buffer == NULL) {
+		NXReportError("ERROR: NXopenbuffer needs a buffer");
+		return NX_ERROR;
+	}
+	fileStack = makeFileStack();
+	if (fileStack == NULL) {
+		NXReportError("ERROR: no memory to create filestack");
+		return NX_ERROR;
+	}
+	status = LOCKED_CALL(NXopenbufferImpl(buffer, size, am, fileStack));
+	if (status == NX_OK) {
+		*gHandle = fileStack;
+	} else {
+		killFileStack(fileStack);
+	}
+	return status;
+}
+
+/* ------------------------------------------------------------------------- */
+
+#ifdef WITH_MPI
+/* parallel access is HDF-5 only, there is nothing to probe */
+static NXstatus NXopenmpiImpl(CONSTCHAR * filename, NXaccess am,
+			      MPI_Comm comm, MPI_Info info,
+			      pFileStack fileStack)
+{
+	NXhandle handle = NULL;
+	pNexusFunction fHandle = NULL;
+	NXstatus retstat;
+
+	fHandle = (pNexusFunction) malloc(sizeof(NexusFunction));
+	if (fHandle == NULL) {
+		NXReportError("ERROR: no memory to create Function structure");
+		return NX_ERROR;
+	}
+	memset(fHandle, 0, sizeof(NexusFunction));	/* so any functions we miss are NULL */
+	fHandle->stripFlag = 1;
+	if (am & NXACC_NOSTRIP) {
+		fHandle->stripFlag = 0;
+	}
+	if (am & NXACC_CHECKNAMESYNTAX) {
+		fHandle->checkNameSyntax = 1;
+	}
+	am = (NXaccess) (am & ~(NXACC_NOSTRIP | NXACC_CHECKNAMESYNTAX |
+				NXACC_HINT_HDF5));
+	retstat = NX5openmpi(filename, am, comm, info, &handle);
+	if (retstat != NX_OK) {
+		free(fHandle);
+		return retstat;
+	}
+	fHandle->pNexusData = handle;
+	NX5assignFunctions(fHandle);
+	pushFileStack(fileStack, fHandle, (char *)filename);
+	return NX_OK;
+}
+
+NXstatus NXopenmpi(CONSTCHAR * filename, NXaccess am, MPI_Comm comm,
+		   MPI_Info info, NXhandle * gHandle)
+{
+	int status;
+	pFileStack fileStack = NULL;
+
+	*gHandle = NULL;
+	fileStack = makeFileStack();
+	if (fileStack == NULL) {
+		NXReportError("ERROR: no memory to create filestack");
+		return NX_ERROR;
+	}
+	status =
+	    LOCKED_CALL(NXopenmpiImpl(filename, am, comm, info, fileStack));
+	if (status == NX_OK) {
+		*gHandle = fileStack;
+	} else {
+		killFileStack(fileStack);
+	}
+	return status;
+}
+
+/* ------------------------------------------------------------------------- */
+#endif				/* WITH_MPI */
+
 NXstatus NXclose(NXhandle * fid)
 {
 	NXhandle hfil;
 	int status;
 	pFileStack fileStack = NULL;
 	pNexusFunction pFunc = NULL;
+	char *indexfile = NULL;
 	if (*fid == NULL) {
 		return NX_OK;
 	}
 	fileStack = (pFileStack) * fid;
 	pFunc = peekFileOnStack(fileStack);
+	if (pFunc->writeIndex) {
+		indexfile = strdup(peekFilenameOnStack(fileStack));
+	}
 	hfil = pFunc->pNexusData;
 	status = LOCKED_CALL(pFunc->nxclose(&hfil));
 	pFunc->pNexusData = hfil;
@@ -702,6 +1046,12 @@ NXstatus NXclose(NXhandle * fid)
 		killFileStack(fileStack);
 		*fid = NULL;
 	}
+	if (indexfile != NULL) {
+		if (status == NX_OK) {
+			status = NXmakeindex(indexfile);
+		}
+		free(indexfile);
+	}
 	/* we can't set fid to NULL always as the handle points to a stack of files for external file support */
 	/* 
 	   Fortify_CheckAllMemory();
@@ -716,6 +1066,7 @@ NXstatus NXmakegroup(NXhandle fid, CONSTCHAR * name, CONSTCHAR * nxclass)
 {
 	char buffer[256];
 	pNexusFunction pFunc = handleToNexusFunc(fid);
+	dropIndexOnStack((pFileStack) fid);
 	if (pFunc->checkNameSyntax
 	    && (nxclass !=
 		NULL) /* && !strncmp("NX", nxclass, 2) */ &&!validNXName(name,
@@ -867,6 +1218,7 @@ NXstatus NXmakedata64(NXhandle fid, CONSTCHAR * name, int datatype,
 {
 	char buffer[256];
 	pNexusFunction pFunc = handleToNexusFunc(fid);
+	dropIndexOnStack((pFileStack) fid);
 	if (pFunc->checkNameSyntax && !validNXName(name, 0)) {
 		sprintf(buffer,
 			"ERROR: invalid characters in dataset name \"%s\"",
@@ -902,6 +1254,7 @@ NXstatus NXcompmakedata64(NXhandle fid, CONSTCHAR * name, int datatype,
 {
 	char buffer[256];
 	pNexusFunction pFunc = handleToNexusFunc(fid);
+	dropIndexOnStack((pFileStack) fid);
 	if (pFunc->checkNameSyntax && !validNXName(name, 0)) {
 		sprintf(buffer,
 			"ERROR: invalid characters in dataset name \"%s\"",
@@ -917,6 +1270,32 @@ NXstatus NXcompmakedata64(NXhandle fid, CONSTCHAR * name, int datatype,
 
   /* --------------------------------------------------------------------- */
 
+NXstatus NXmakevirtual64(NXhandle fid, CONSTCHAR * name, int datatype,
+			 int rank, int64_t dimensions[], int nsource,
+			 const NXvirtualsource source[])
+{
+	char buffer[256];
+	pNexusFunction pFunc = handleToNexusFunc(fid);
+	if (pFunc->nxmakevirtual64 == NULL) {
+		NXReportError
+		    ("ERROR: virtual datasets are not supported for this file format");
+		return NX_ERROR;
+	}
+	dropIndexOnStack((pFileStack) fid);
+	if (pFunc->checkNameSyntax && !validNXName(name, 0)) {
+		sprintf(buffer,
+			"ERROR: invalid characters in dataset name \"%s\"",
+			name);
+		NXReportError(buffer);
+		return NX_ERROR;
+	}
+	return LOCKED_CALL(pFunc->
+			   nxmakevirtual64(pFunc->pNexusData, name, datatype,
+					   rank, dimensions, nsource, source));
+}
+
+  /* --------------------------------------------------------------------- */
+
 NXstatus NXcompress(NXhandle fid, int compress_type)
 {
 	pNexusFunction pFunc = handleToNexusFunc(fid);
@@ -1005,6 +1384,7 @@ NXstatus NXclosedata(NXhandle fid)
 NXstatus NXputdata(NXhandle fid, const void *data)
 {
 	pNexusFunction pFunc = handleToNexusFunc(fid);
+	dropIndexOnStack((pFileStack) fid);
 	return LOCKED_CALL(pFunc->nxputdata(pFunc->pNexusData, data));
 }
 
@@ -1015,6 +1395,7 @@ NXstatus NXputattr(NXhandle fid, CONSTCHAR * name, const void *data,
 {
 	char buffer[256];
 	pNexusFunction pFunc = handleToNexusFunc(fid);
+	dropIndexOnStack((pFileStack) fid);
 	if (datalen > 1 && iType != NX_CHAR) {
 		NXReportError
 		    ("NXputattr: numeric arrays are not allowed as attributes - only character strings and single numbers");
@@ -1053,6 +1434,7 @@ NXstatus NXputslab64(NXhandle fid, const void *data, const int64_t iStart[],
 		     const int64_t iSize[])
 {
 	pNexusFunction pFunc = handleToNexusFunc(fid);
+	dropIndexOnStack((pFileStack) fid);
 	return LOCKED_CALL(pFunc->
 			   nxputslab64(pFunc->pNexusData, data, iStart, iSize));
 }
@@ -1070,6 +1452,7 @@ NXstatus NXgetdataID(NXhandle fid, NXlink * sRes)
 NXstatus NXmakelink(NXhandle fid, NXlink * sLink)
 {
 	pNexusFunction pFunc = handleToNexusFunc(fid);
+	dropIndexOnStack((pFileStack) fid);
 	return LOCKED_CALL(pFunc->nxmakelink(pFunc->pNexusData, sLink));
 }
 
@@ -1079,6 +1462,7 @@ NXstatus NXmakenamedlink(NXhandle fid, CONSTCHAR * newname, NXlink * sLink)
 {
 	char buffer[256];
 	pNexusFunction pFunc = handleToNexusFunc(fid);
+	dropIndexOnStack((pFileStack) fid);
 	if (pFunc->checkNameSyntax && !validNXName(newname, 0)) {
 		sprintf(buffer, "ERROR: invalid characters in link name \"%s\"",
 			newname);
@@ -1120,6 +1504,46 @@ NXstatus NXflush(NXhandle * pHandle)
 	return status;
 }
 
+  /*----------------------------------------------------------------------*/
+
+NXstatus NXstartswmr(NXhandle fid)
+{
+	pNexusFunction pFunc = handleToNexusFunc(fid);
+	if (pFunc->nxstartswmr == NULL) {
+		NXReportError
+		    ("ERROR: SWMR writing is not supported for this file format");
+		return NX_ERROR;
+	}
+	return LOCKED_CALL(pFunc->nxstartswmr(pFunc->pNexusData));
+}
+
+  /*----------------------------------------------------------------------*/
+
+NXstatus NXrefresh(NXhandle fid)
+{
+	pNexusFunction pFunc = handleToNexusFunc(fid);
+	if (pFunc->nxrefresh == NULL) {
+		NXReportError
+		    ("ERROR: refreshing datasets is not supported for this file format");
+		return NX_ERROR;
+	}
+	return LOCKED_CALL(pFunc->nxrefresh(pFunc->pNexusData));
+}
+
+  /*----------------------------------------------------------------------*/
+
+NXstatus NXsetcollective(NXhandle fid, int collective)
+{
+	pNexusFunction pFunc = handleToNexusFunc(fid);
+	if (pFunc->nxsetcollective == NULL) {
+		NXReportError
+		    ("ERROR: collective transfers are not supported for this file format");
+		return NX_ERROR;
+	}
+	return LOCKED_CALL(pFunc->nxsetcollective(pFunc->pNexusData,
+						   collective));
+}
+
   /*-------------------------------------------------------------------------*/
 
 NXstatus NXmalloc(void **data, int rank, const int dimensions[], int datatype)
@@ -1131,50 +1555,250 @@ NXstatus NXmalloc(void **data, int rank, const int dimensions[], int datatype)
 	return status;
 }
 
-NXstatus NXmalloc64(void **data, int rank,
-		    const int64_t dimensions[], int datatype)
+NXstatus NXmallocex(void **data, int rank, const int dimensions[], int datatype,
+		    int options)
+{
+	int status;
+	int64_t *dims64 = dupDimsArray((int *)dimensions, rank);
+	status = NXmalloc64ex(data, rank, dims64, datatype, options);
+	free(dims64);
+	return status;
+}
+
+/* the size in bytes of a dataset, with room for a terminating NUL */
+static NXstatus NXdatasize(int rank, const int64_t dimensions[], int datatype,
+			   size_t * size)
 {
 	int i;
-	size_t size = 1;
-	*data = NULL;
+	*size = 1;
 	for (i = 0; i < rank; i++) {
-		size *= (size_t) dimensions[i];
+		*size *= (size_t) dimensions[i];
 	}
 	if ((datatype == NX_CHAR) || (datatype == NX_INT8)
 	    || (datatype == NX_UINT8)) {
 		/* allow for terminating \0 */
-		size += 2;
+		*size += 2;
 	} else if ((datatype == NX_INT16) || (datatype == NX_UINT16)) {
-		size *= 2;
+		*size *= 2;
 	} else if ((datatype == NX_INT32) || (datatype == NX_UINT32)
 		   || (datatype == NX_FLOAT32)) {
-		size *= 4;
+		*size *= 4;
 	} else if ((datatype == NX_INT64) || (datatype == NX_UINT64)) {
-		size *= 8;
+		*size *= 8;
 	} else if (datatype == NX_FLOAT64) {
-		size *= 8;
+		*size *= 8;
 	} else {
 		NXReportError("ERROR: NXmalloc - unknown data type in array");
 		return NX_ERROR;
 	}
-	*data = (void *)malloc(size);
-	memset(*data, 0, size);
 	return NX_OK;
 }
 
-  /*-------------------------------------------------------------------------*/
-
-NXstatus NXfree(void **data)
+NXstatus NXmalloc64(void **data, int rank,
+		    const int64_t dimensions[], int datatype)
 {
-	if (data == NULL) {
-		NXReportError("ERROR: passing NULL to NXfree");
-		return NX_ERROR;
-	}
-	if (*data == NULL) {
-		NXReportError("ERROR: passing already freed pointer to NXfree");
+	size_t size;
+	*data = NULL;
+	if (NXdatasize(rank, dimensions, datatype, &size) != NX_OK) {
 		return NX_ERROR;
 	}
-	free(*data);
+	*data = (void *)malloc(size);
+	memset(*data, 0, size);
+	return NX_OK;
+}
+
+/*
+ * memory released with free(), so NXfree works for it: aligned with
+ * posix_memalign where there is one, to huge pages for large blocks if
+ * asked for and the system has transparent huge pages
+ */
+static void *NXalignedalloc(size_t size, int options)
+{
+#ifndef _WIN32
+	void *data = NULL;
+	size_t alignment = NX_ALIGNMENT;
+#if defined(MADV_HUGEPAGE)
+	if ((options & NXMALLOC_HUGEPAGES) && size >= NX_HUGEPAGE_SIZE) {
+		alignment = NX_HUGEPAGE_SIZE;
+	}
+#endif
+	if (posix_memalign(&data, alignment, size) != 0) {
+		return NULL;
+	}
+#if defined(MADV_HUGEPAGE)
+	if (alignment == NX_HUGEPAGE_SIZE) {
+		madvise(data, size - size % NX_HUGEPAGE_SIZE, MADV_HUGEPAGE);
+	}
+#endif
+	return data;
+#else
+	/* _aligned_malloc would need _aligned_free */
+	return malloc(size);
+#endif
+}
+
+/*
+ * clears what the options ask for; character data always, it relies
+ * on the terminating NUL and is small
+ */
+static void NXclearbuffer(void *data, size_t size, int datatype,
+			  int options)
+{
+	if (!(options & NXMALLOC_NOINIT) || datatype == NX_CHAR) {
+		memset(data, 0, size);
+	} else if (datatype == NX_INT8 || datatype == NX_UINT8) {
+		memset((char *)data + size - 2, 0, 2);
+	}
+}
+
+NXstatus NXmalloc64ex(void **data, int rank,
+		      const int64_t dimensions[], int datatype, int options)
+{
+	size_t size;
+	*data = NULL;
+	if (NXdatasize(rank, dimensions, datatype, &size) != NX_OK) {
+		return NX_ERROR;
+	}
+	*data = NXalignedalloc(size, options);
+	if (*data == NULL) {
+		NXReportError("ERROR: NXmalloc64ex - out of memory");
+		return NX_ERROR;
+	}
+	NXclearbuffer(*data, size, datatype, options);
+	return NX_OK;
+}
+
+  /*-------------------------------------------------------------------------*/
+
+/*
+ * a buffer pool hands out the smallest free buffer large enough and
+ * keeps at most NXBUFPOOL_KEEP free buffers for later
+ */
+#define NXBUFPOOL_KEEP 8
+
+typedef struct {
+	void *data;
+	size_t size;
+	int used;
+} NXpoolbuffer;
+
+struct NXbufpool_s {
+	int options;
+	int nbuf;
+	int maxbuf;
+	NXpoolbuffer *buf;
+};
+
+NXstatus NXbufpoolcreate(NXbufpool * pool, int options)
+{
+	*pool = (NXbufpool) calloc(1, sizeof(struct NXbufpool_s));
+	if (*pool == NULL) {
+		NXReportError("ERROR: NXbufpoolcreate - out of memory");
+		return NX_ERROR;
+	}
+	(*pool)->options = options;
+	return NX_OK;
+}
+
+NXstatus NXbufpoolget(NXbufpool pool, void **data, int rank,
+		      const int64_t dimensions[], int datatype)
+{
+	size_t size;
+	int i, best = -1;
+	NXpoolbuffer *buf;
+
+	*data = NULL;
+	if (NXdatasize(rank, dimensions, datatype, &size) != NX_OK) {
+		return NX_ERROR;
+	}
+	for (i = 0; i < pool->nbuf; i++) {
+		if (!pool->buf[i].used && pool->buf[i].size >= size
+		    && (best < 0 || pool->buf[i].size < pool->buf[best].size)) {
+			best = i;
+		}
+	}
+	if (best < 0) {
+		if (pool->nbuf == pool->maxbuf) {
+			buf = (NXpoolbuffer *) realloc(pool->buf,
+						       (pool->maxbuf + 8) *
+						       sizeof(NXpoolbuffer));
+			if (buf == NULL) {
+				NXReportError
+				    ("ERROR: NXbufpoolget - out of memory");
+				return NX_ERROR;
+			}
+			pool->buf = buf;
+			pool->maxbuf += 8;
+		}
+		best = pool->nbuf;
+		pool->buf[best].data = NXalignedalloc(size, pool->options);
+		if (pool->buf[best].data == NULL) {
+			NXReportError("ERROR: NXbufpoolget - out of memory");
+			return NX_ERROR;
+		}
+		pool->buf[best].size = size;
+		pool->nbuf++;
+	}
+	pool->buf[best].used = 1;
+	NXclearbuffer(pool->buf[best].data, size, datatype, pool->options);
+	*data = pool->buf[best].data;
+	return NX_OK;
+}
+
+NXstatus NXbufpoolrelease(NXbufpool pool, void *data)
+{
+	int i, nfree = 0, found = -1;
+
+	for (i = 0; i < pool->nbuf; i++) {
+		if (pool->buf[i].data == data && pool->buf[i].used) {
+			found = i;
+		} else if (!pool->buf[i].used) {
+			nfree++;
+		}
+	}
+	if (found < 0) {
+		NXReportError
+		    ("ERROR: NXbufpoolrelease - buffer not in use from this pool");
+		return NX_ERROR;
+	}
+	if (nfree < NXBUFPOOL_KEEP) {
+		pool->buf[found].used = 0;
+	} else {
+		free(pool->buf[found].data);
+		pool->buf[found] = pool->buf[--pool->nbuf];
+	}
+	return NX_OK;
+}
+
+NXstatus NXbufpooldestroy(NXbufpool * pool)
+{
+	int i;
+	if (pool == NULL || *pool == NULL) {
+		NXReportError("ERROR: passing NULL to NXbufpooldestroy");
+		return NX_ERROR;
+	}
+	for (i = 0; i < (*pool)->nbuf; i++) {
+		free((*pool)->buf[i].data);
+	}
+	free((*pool)->buf);
+	free(*pool);
+	*pool = NULL;
+	return NX_OK;
+}
+
+  /*-------------------------------------------------------------------------*/
+
+NXstatus NXfree(void **data)
+{
+	if (data == NULL) {
+		NXReportError("ERROR: passing NULL to NXfree");
+		return NX_ERROR;
+	}
+	if (*data == NULL) {
+		NXReportError("ERROR: passing already freed pointer to NXfree");
+		return NX_ERROR;
+	}
+	free(*data);
 	*data = NULL;
 	return NX_OK;
 }
@@ -1252,6 +1876,79 @@ NXstatus NXgetdata(NXhandle fid, void *data)
 	return status;
 }
 
+/*---------------------------------------------------------------------------*/
+
+/*
+ * for formats without a string array read of their own: rows of a
+ * character array, each ending at its first NUL
+ */
+static NXstatus NXgetstringrows(pNexusFunction pFunc, int64_t * count,
+				int64_t ** offsets, char **buffer)
+{
+	int status, type, rank;
+	int64_t iDim[NX_MAXRANK], nrow, width, i, len;
+	char *data, *row, *nul, *end;
+
+	status = LOCKED_CALL(pFunc->nxgetinfo64(pFunc->pNexusData, &rank,
+						iDim, &type));
+	if (status != NX_OK)
+		return status;
+	if (type != NX_CHAR || rank < 1 || rank > 2) {
+		NXReportError("ERROR: dataset does not hold strings");
+		return NX_ERROR;
+	}
+	nrow = rank == 2 ? iDim[0] : 1;
+	width = iDim[rank - 1];
+	data = (char *)calloc((size_t) (nrow * width + 1), 1);
+	if (data == NULL) {
+		NXReportError("ERROR: out of memory reading strings");
+		return NX_ERROR;
+	}
+	status = LOCKED_CALL(pFunc->nxgetdata(pFunc->pNexusData, data));
+	if (status != NX_OK) {
+		free(data);
+		return status;
+	}
+	*offsets = (int64_t *) malloc((size_t) (nrow + 1) * sizeof(int64_t));
+	*buffer = end = (char *)malloc((size_t) (nrow * (width + 1) + 1));
+	if (*offsets == NULL || *buffer == NULL) {
+		free(*offsets);
+		free(*buffer);
+		*offsets = NULL;
+		*buffer = NULL;
+		free(data);
+		NXReportError("ERROR: out of memory reading strings");
+		return NX_ERROR;
+	}
+	for (i = 0; i < nrow; i++) {
+		row = data + i * width;
+		nul = (char *)memchr(row, '\0', (size_t) width);
+		len = nul != NULL ? (int64_t) (nul - row) : width;
+		(*offsets)[i] = (int64_t) (end - *buffer);
+		memcpy(end, row, (size_t) len);
+		end += len;
+		*end++ = '\0';
+	}
+	(*offsets)[nrow] = (int64_t) (end - *buffer);
+	*count = nrow;
+	free(data);
+	return NX_OK;
+}
+
+NXstatus NXgetstrings(NXhandle fid, int64_t * count, int64_t ** offsets,
+		      char **buffer)
+{
+	pNexusFunction pFunc = handleToNexusFunc(fid);
+	*count = 0;
+	*offsets = NULL;
+	*buffer = NULL;
+	if (pFunc->nxgetstrings == NULL) {
+		return NXgetstringrows(pFunc, count, offsets, buffer);
+	}
+	return LOCKED_CALL(pFunc->nxgetstrings(pFunc->pNexusData, count,
+					       offsets, buffer));
+}
+
 /*---------------------------------------------------------------------------*/
 NXstatus NXgetrawinfo64(NXhandle fid, int *rank,
 			int64_t dimension[], int *iType)
@@ -1341,6 +2038,495 @@ NXstatus NXgetslab64(NXhandle fid, void *data,
 			   nxgetslab64(pFunc->pNexusData, data, iStart, iSize));
 }
 
+/*------------------------------------------------------------------------
+  Drivers without a native multi-slab read get a loop over nxgetslab64.
+  The loop runs under the lock so the subsets are read from a consistent
+  dataset state.
+  -------------------------------------------------------------------------*/
+static NXstatus NXIgetslabs64(pNexusFunction pFunc, int nslab,
+			      const int64_t * iStart[], const int64_t * iSize[],
+			      void *data[])
+{
+	int i;
+
+	if (pFunc->nxgetslabs64 != NULL) {
+		return pFunc->nxgetslabs64(pFunc->pNexusData, nslab, iStart,
+					   iSize, data);
+	}
+	for (i = 0; i < nslab; i++) {
+		if (pFunc->nxgetslab64(pFunc->pNexusData, data[i], iStart[i],
+				       iSize[i]) != NX_OK) {
+			return NX_ERROR;
+		}
+	}
+	return NX_OK;
+}
+
+NXstatus NXgetslabs64(NXhandle fid, int nslab, const int64_t * iStart[],
+		      const int64_t * iSize[], void *data[])
+{
+	pNexusFunction pFunc = handleToNexusFunc(fid);
+	if (nslab < 0 || (nslab > 0 && (iStart == NULL || iSize == NULL
+					|| data == NULL))) {
+		NXReportError("ERROR: invalid arguments to NXgetslabs64");
+		return NX_ERROR;
+	}
+	if (nslab == 0) {
+		return NX_OK;
+	}
+	return LOCKED_CALL(NXIgetslabs64(pFunc, nslab, iStart, iSize, data));
+}
+
+/*------------------------------------------------------------------------*/
+static size_t NXItypesize(int datatype)
+{
+	switch (datatype) {
+	case NX_CHAR:
+	case NX_INT8:
+	case NX_UINT8:
+		return 1;
+	case NX_INT16:
+	case NX_UINT16:
+		return 2;
+	case NX_INT32:
+	case NX_UINT32:
+	case NX_FLOAT32:
+		return 4;
+	case NX_INT64:
+	case NX_UINT64:
+	case NX_FLOAT64:
+		return 8;
+	}
+	return 0;
+}
+
+/*------------------------------------------------------------------------
+  Strided reads for drivers which only know plain slabs: every block
+  along the last dimension is read with its own nxgetslab64, so only the
+  requested elements are transferred.
+  -------------------------------------------------------------------------*/
+static NXstatus NXIgetslab64s(pNexusFunction pFunc, void *data,
+			      const int64_t iStart[], const int64_t iSize[],
+			      const int64_t iStride[], const int64_t iBlock[])
+{
+	int64_t fStart[NX_MAXRANK], fSize[NX_MAXRANK], dim[NX_MAXRANK];
+	int64_t idx[NX_MAXRANK], stride, block, k;
+	int i, rank, type, last;
+	size_t elsize;
+	char *ptr = (char *)data;
+
+	if (pFunc->nxgetinfo64(pFunc->pNexusData, &rank, dim, &type) != NX_OK) {
+		return NX_ERROR;
+	}
+	elsize = NXItypesize(type);
+	if (elsize == 0 || rank < 1) {
+		NXReportError("ERROR: NXgetslab64s - unsupported dataset");
+		return NX_ERROR;
+	}
+	last = rank - 1;
+	for (i = 0; i < rank; i++) {
+		if (iSize[i] == 0 || (iBlock != NULL && iBlock[i] == 0)) {
+			return NX_OK;
+		}
+		idx[i] = 0;
+		fSize[i] = 1;
+	}
+	stride = (iStride == NULL) ? 1 : iStride[last];
+	block = (iBlock == NULL) ? 1 : iBlock[last];
+	for (;;) {
+		for (i = 0; i < last; i++) {
+			int64_t b = (iBlock == NULL) ? 1 : iBlock[i];
+			int64_t s = (iStride == NULL) ? 1 : iStride[i];
+			fStart[i] = iStart[i] + (idx[i] / b) * s + idx[i] % b;
+		}
+		if (stride == block) {
+			/* blocks along the last dimension touch, read them in one go */
+			fStart[last] = iStart[last];
+			fSize[last] = iSize[last] * block;
+			if (pFunc->nxgetslab64(pFunc->pNexusData, ptr, fStart,
+					       fSize) != NX_OK) {
+				return NX_ERROR;
+			}
+			ptr += (size_t) fSize[last] * elsize;
+		} else {
+			fSize[last] = block;
+			for (k = 0; k < iSize[last]; k++) {
+				fStart[last] = iStart[last] + k * stride;
+				if (pFunc->nxgetslab64(pFunc->pNexusData, ptr,
+						       fStart, fSize) != NX_OK) {
+					return NX_ERROR;
+				}
+				ptr += (size_t) block *elsize;
+			}
+		}
+		for (i = last - 1; i >= 0; i--) {
+			int64_t b = (iBlock == NULL) ? 1 : iBlock[i];
+			if (++idx[i] < iSize[i] * b) {
+				break;
+			}
+			idx[i] = 0;
+		}
+		if (i < 0) {
+			break;
+		}
+	}
+	return NX_OK;
+}
+
+NXstatus NXgetslab64s(NXhandle fid, void *data, const int64_t iStart[],
+		      const int64_t iSize[], const int64_t iStride[],
+		      const int64_t iBlock[])
+{
+	pNexusFunction pFunc = handleToNexusFunc(fid);
+	if (pFunc->nxgetslab64s != NULL) {
+		return LOCKED_CALL(pFunc->
+				   nxgetslab64s(pFunc->pNexusData, data, iStart,
+						iSize, iStride, iBlock));
+	}
+	return LOCKED_CALL(NXIgetslab64s(pFunc, data, iStart, iSize, iStride,
+					 iBlock));
+}
+
+/*------------------------------------------------------------------------
+  Point reads for drivers which only know plain slabs: one element each
+  -------------------------------------------------------------------------*/
+static NXstatus NXIgetpoints64(pNexusFunction pFunc, void *data,
+			       int64_t npoints, const int64_t coords[])
+{
+	int64_t dim[NX_MAXRANK], ones[NX_MAXRANK], p;
+	int i, rank, type;
+	size_t elsize;
+
+	if (pFunc->nxgetinfo64(pFunc->pNexusData, &rank, dim, &type) != NX_OK) {
+		return NX_ERROR;
+	}
+	elsize = NXItypesize(type);
+	if (elsize == 0) {
+		NXReportError("ERROR: NXgetpoints64 - unknown data type");
+		return NX_ERROR;
+	}
+	for (i = 0; i < rank; i++) {
+		ones[i] = 1;
+	}
+	for (p = 0; p < npoints; p++) {
+		if (pFunc->nxgetslab64(pFunc->pNexusData,
+				       (char *)data + (size_t) p * elsize,
+				       coords + p * rank, ones) != NX_OK) {
+			return NX_ERROR;
+		}
+	}
+	return NX_OK;
+}
+
+NXstatus NXgetpoints64(NXhandle fid, void *data, int64_t npoints,
+		       const int64_t coords[])
+{
+	pNexusFunction pFunc = handleToNexusFunc(fid);
+	if (npoints < 0 || (npoints > 0 && coords == NULL)) {
+		NXReportError("ERROR: invalid arguments to NXgetpoints64");
+		return NX_ERROR;
+	}
+	if (npoints == 0) {
+		return NX_OK;
+	}
+	if (pFunc->nxgetpoints64 != NULL) {
+		return LOCKED_CALL(pFunc->
+				   nxgetpoints64(pFunc->pNexusData, data,
+						 npoints, coords));
+	}
+	return LOCKED_CALL(NXIgetpoints64(pFunc, data, npoints, coords));
+}
+
+/*------------------------------------------------------------------------
+  Direct chunk access, only for drivers which store chunks themselves
+  -------------------------------------------------------------------------*/
+static NXstatus NXInochunks(void)
+{
+	NXReportError
+	    ("ERROR: direct chunk access is not supported for this file format");
+	return NX_ERROR;
+}
+
+NXstatus NXputchunk64(NXhandle fid, const int64_t offset[],
+		      unsigned int filter_mask, const void *data,
+		      int64_t nbytes)
+{
+	pNexusFunction pFunc = handleToNexusFunc(fid);
+	dropIndexOnStack((pFileStack) fid);
+	if (offset == NULL || data == NULL || nbytes < 0) {
+		NXReportError("ERROR: invalid arguments to NXputchunk64");
+		return NX_ERROR;
+	}
+	if (pFunc->nxputchunk64 == NULL) {
+		return NXInochunks();
+	}
+	return LOCKED_CALL(pFunc->
+			   nxputchunk64(pFunc->pNexusData, offset, filter_mask,
+					data, nbytes));
+}
+
+NXstatus NXgetchunk64(NXhandle fid, const int64_t offset[],
+		      unsigned int *filter_mask, void *data, int64_t * nbytes)
+{
+	pNexusFunction pFunc = handleToNexusFunc(fid);
+	if (offset == NULL || nbytes == NULL || (data != NULL && *nbytes < 0)) {
+		NXReportError("ERROR: invalid arguments to NXgetchunk64");
+		return NX_ERROR;
+	}
+	if (pFunc->nxgetchunk64 == NULL) {
+		return NXInochunks();
+	}
+	return LOCKED_CALL(pFunc->
+			   nxgetchunk64(pFunc->pNexusData, offset, filter_mask,
+					data, nbytes));
+}
+
+NXstatus NXgetchunkcount64(NXhandle fid, int64_t * nchunks)
+{
+	pNexusFunction pFunc = handleToNexusFunc(fid);
+	if (nchunks == NULL) {
+		NXReportError("ERROR: invalid arguments to NXgetchunkcount64");
+		return NX_ERROR;
+	}
+	if (pFunc->nxgetchunkcount64 == NULL) {
+		return NXInochunks();
+	}
+	return LOCKED_CALL(pFunc->nxgetchunkcount64(pFunc->pNexusData, nchunks));
+}
+
+NXstatus NXgetchunkinfo64(NXhandle fid, int64_t index, int64_t offset[],
+			  unsigned int *filter_mask, int64_t * nbytes)
+{
+	pNexusFunction pFunc = handleToNexusFunc(fid);
+	if (offset == NULL || index < 0) {
+		NXReportError("ERROR: invalid arguments to NXgetchunkinfo64");
+		return NX_ERROR;
+	}
+	if (pFunc->nxgetchunkinfo64 == NULL) {
+		return NXInochunks();
+	}
+	return LOCKED_CALL(pFunc->
+			   nxgetchunkinfo64(pFunc->pNexusData, index, offset,
+					    filter_mask, nbytes));
+}
+
+NXstatus NXgetchunkdims64(NXhandle fid, int *rank, int64_t chunk[])
+{
+	pNexusFunction pFunc = handleToNexusFunc(fid);
+	if (rank == NULL || chunk == NULL) {
+		NXReportError("ERROR: invalid arguments to NXgetchunkdims64");
+		return NX_ERROR;
+	}
+	/* formats without chunks store every dataset contiguously */
+	if (pFunc->nxgetchunkdims64 == NULL) {
+		*rank = 0;
+		return NX_OK;
+	}
+	return LOCKED_CALL(pFunc->nxgetchunkdims64(pFunc->pNexusData, rank,
+						   chunk));
+}
+
+/*------------------------------------------------------------------------
+  Object handles. The driver keeps the object open by itself and swaps
+  it into its cursor for the duration of a call, so the usual cursor
+  functions do the work and the position of the handle is left alone.
+  -------------------------------------------------------------------------*/
+typedef struct {
+	NXhandle fid;
+	pNexusFunction pFunc;
+	void *pObject;
+} NXobjectImpl, *pNXobjectImpl;
+
+NXstatus NXobjopen(NXhandle fid, CONSTCHAR * path, NXobject * object)
+{
+	pNexusFunction pFunc = handleToNexusFunc(fid);
+	pNXobjectImpl self;
+
+	if (path == NULL || object == NULL) {
+		NXReportError("ERROR: invalid arguments to NXobjopen");
+		return NX_ERROR;
+	}
+	*object = NULL;
+	if (pFunc->nxobjopen == NULL) {
+		NXReportError
+		    ("ERROR: object handles are not supported for this file format");
+		return NX_ERROR;
+	}
+	self = (pNXobjectImpl) malloc(sizeof(NXobjectImpl));
+	if (self == NULL) {
+		NXReportError("ERROR: no memory for NeXus object");
+		return NX_ERROR;
+	}
+	if (LOCKED_CALL(pFunc->nxobjopen(pFunc->pNexusData, path,
+					 &self->pObject)) != NX_OK) {
+		free(self);
+		return NX_ERROR;
+	}
+	self->fid = fid;
+	self->pFunc = pFunc;
+	*object = self;
+	return NX_OK;
+}
+
+NXstatus NXobjclose(NXobject * object)
+{
+	pNXobjectImpl self;
+	NXstatus status;
+
+	if (object == NULL || *object == NULL) {
+		return NX_OK;
+	}
+	self = (pNXobjectImpl) * object;
+	status = LOCKED_CALL(self->pFunc->nxobjclose(self->pFunc->pNexusData,
+						     self->pObject));
+	free(self);
+	*object = NULL;
+	return status;
+}
+
+static NXstatus NXIobjgetinfo64(pNXobjectImpl self, int *rank,
+				int64_t dimension[], int *iType)
+{
+	pNexusFunction pFunc = self->pFunc;
+	NXstatus status;
+
+	if (pFunc->nxobjenter(pFunc->pNexusData, self->pObject) != NX_OK) {
+		return NX_ERROR;
+	}
+	status = pFunc->nxgetinfo64(pFunc->pNexusData, rank, dimension, iType);
+	pFunc->nxobjleave(pFunc->pNexusData, self->pObject);
+	return status;
+}
+
+NXstatus NXobjgetinfo64(NXobject object, int *rank, int64_t dimension[],
+			int *iType)
+{
+	if (object == NULL) {
+		NXReportError("ERROR: invalid arguments to NXobjgetinfo64");
+		return NX_ERROR;
+	}
+	*rank = 0;
+	return LOCKED_CALL(NXIobjgetinfo64((pNXobjectImpl) object, rank,
+					   dimension, iType));
+}
+
+static NXstatus NXIobjgetslab64(pNXobjectImpl self, void *data,
+				const int64_t iStart[], const int64_t iSize[])
+{
+	pNexusFunction pFunc = self->pFunc;
+	NXstatus status;
+
+	if (pFunc->nxobjenter(pFunc->pNexusData, self->pObject) != NX_OK) {
+		return NX_ERROR;
+	}
+	status = pFunc->nxgetslab64(pFunc->pNexusData, data, iStart, iSize);
+	pFunc->nxobjleave(pFunc->pNexusData, self->pObject);
+	return status;
+}
+
+NXstatus NXobjgetslab64(NXobject object, void *data, const int64_t iStart[],
+			const int64_t iSize[])
+{
+	if (object == NULL) {
+		NXReportError("ERROR: invalid arguments to NXobjgetslab64");
+		return NX_ERROR;
+	}
+	return LOCKED_CALL(NXIobjgetslab64((pNXobjectImpl) object, data,
+					   iStart, iSize));
+}
+
+static NXstatus NXIobjputslab64(pNXobjectImpl self, const void *data,
+				const int64_t iStart[], const int64_t iSize[])
+{
+	pNexusFunction pFunc = self->pFunc;
+	NXstatus status;
+
+	if (pFunc->nxobjenter(pFunc->pNexusData, self->pObject) != NX_OK) {
+		return NX_ERROR;
+	}
+	status = pFunc->nxputslab64(pFunc->pNexusData, data, iStart, iSize);
+	pFunc->nxobjleave(pFunc->pNexusData, self->pObject);
+	return status;
+}
+
+NXstatus NXobjputslab64(NXobject object, const void *data,
+			const int64_t iStart[], const int64_t iSize[])
+{
+	pNXobjectImpl self = (pNXobjectImpl) object;
+	if (self == NULL) {
+		NXReportError("ERROR: invalid arguments to NXobjputslab64");
+		return NX_ERROR;
+	}
+	dropIndexOnStack((pFileStack) self->fid);
+	return LOCKED_CALL(NXIobjputslab64(self, data, iStart, iSize));
+}
+
+static NXstatus NXIobjgetattr(pNXobjectImpl self, char *name, void *data,
+			      int *datalen, int *iType)
+{
+	pNexusFunction pFunc = self->pFunc;
+	NXstatus status;
+
+	if (pFunc->nxobjenter(pFunc->pNexusData, self->pObject) != NX_OK) {
+		return NX_ERROR;
+	}
+	status = pFunc->nxgetattr(pFunc->pNexusData, name, data, datalen,
+				  iType);
+	pFunc->nxobjleave(pFunc->pNexusData, self->pObject);
+	return status;
+}
+
+NXstatus NXobjgetattr(NXobject object, char *name, void *data, int *datalen,
+		      int *iType)
+{
+	if (object == NULL) {
+		NXReportError("ERROR: invalid arguments to NXobjgetattr");
+		return NX_ERROR;
+	}
+	return LOCKED_CALL(NXIobjgetattr((pNXobjectImpl) object, name, data,
+					 datalen, iType));
+}
+
+static NXstatus NXIobjputattr(pNXobjectImpl self, CONSTCHAR * name,
+			      const void *data, int datalen, int iType)
+{
+	pNexusFunction pFunc = self->pFunc;
+	NXstatus status;
+
+	if (pFunc->nxobjenter(pFunc->pNexusData, self->pObject) != NX_OK) {
+		return NX_ERROR;
+	}
+	status = pFunc->nxputattr(pFunc->pNexusData, name, data, datalen,
+				  iType);
+	pFunc->nxobjleave(pFunc->pNexusData, self->pObject);
+	return status;
+}
+
+NXstatus NXobjputattr(NXobject object, CONSTCHAR * name, const void *data,
+		      int datalen, int iType)
+{
+	char buffer[256];
+	pNXobjectImpl self = (pNXobjectImpl) object;
+	if (self == NULL) {
+		NXReportError("ERROR: invalid arguments to NXobjputattr");
+		return NX_ERROR;
+	}
+	dropIndexOnStack((pFileStack) self->fid);
+	if (datalen > 1 && iType != NX_CHAR) {
+		NXReportError
+		    ("NXobjputattr: numeric arrays are not allowed as attributes - only character strings and single numbers");
+		return NX_ERROR;
+	}
+	if (self->pFunc->checkNameSyntax && !validNXName(name, 0)) {
+		sprintf(buffer,
+			"ERROR: invalid characters in attribute name \"%s\"",
+			name);
+		NXReportError(buffer);
+		return NX_ERROR;
+	}
+	return LOCKED_CALL(NXIobjputattr(self, name, data, datalen, iType));
+}
+
   /*-------------------------------------------------------------------------*/
 
 NXstatus NXgetnextattr(NXhandle fileid, NXname pName, int *iLength, int *iType)
@@ -1431,6 +2617,176 @@ NXstatus NXinitgroupdir(NXhandle fid)
 	return LOCKED_CALL(pFunc->nxinitgroupdir(pFunc->pNexusData));
 }
 
+/*----------------------------------------------------------------------*/
+
+/*
+ * for formats without a visit of their own: the attributes of the open
+ * group or dataset, through the attribute directory
+ */
+static NXstatus NXvisitattrs(NXhandle fid, const char *path, int flags,
+			     NXvisitfunc callback, void *userdata)
+{
+	NXvisitinfo info;
+	NXname name;
+	void *value = NULL;
+	int i, rank, dims[NX_MAXRANK], type, status, stop;
+
+	memset(&info, 0, sizeof(info));
+	info.kind = NXVISIT_ATTRIBUTE;
+	info.path = path;
+	info.name = name;
+	NXinitattrdir(fid);
+	while ((status = NXgetnextattra(fid, name, &rank, dims, &type)) == NX_OK) {
+		if (strcmp(name, "NX_class") == 0) {
+			continue;
+		}
+		info.type = type;
+		info.rank = rank;
+		for (i = 0; i < rank; i++) {
+			info.dims[i] = dims[i];
+		}
+		if (flags & NXVISIT_ATTRIBUTE_VALUES) {
+			/* cleared, so strings end in a NUL */
+			if (NXmalloc64(&value, rank, info.dims, type) != NX_OK) {
+				return NX_ERROR;
+			}
+			if (NXgetattra(fid, name, value) != NX_OK) {
+				NXfree(&value);
+				return NX_ERROR;
+			}
+			info.value = value;
+		}
+		stop = callback(&info, userdata);
+		if (value != NULL) {
+			NXfree(&value);
+		}
+		if (stop != 0) {
+			return NX_EOD;
+		}
+	}
+	return status == NX_EOD ? NX_OK : status;
+}
+
+typedef struct {
+	NXname name;
+	NXname nxclass;
+} NXvisitentry;
+
+/*
+ * for formats without a visit of their own: the entries of the open group
+ * are listed first, as opening one of them ends the group directory
+ */
+static NXstatus NXvisitgroup(NXhandle fid, const char *path, int flags,
+			     NXvisitfunc callback, void *userdata)
+{
+	NXvisitentry *entries = NULL, *entry, *more;
+	NXvisitinfo info;
+	char child[NX_MAXPATHLEN];
+	int i, n = 0, size = 0, type, status;
+
+	NXinitgroupdir(fid);
+	while (1) {
+		if (n == size) {
+			size = size > 0 ? 2 * size : 64;
+			more = (NXvisitentry *) realloc(entries,
+							size *
+							sizeof(NXvisitentry));
+			if (more == NULL) {
+				free(entries);
+				NXReportError
+				    ("ERROR: NXvisit - out of memory");
+				return NX_ERROR;
+			}
+			entries = more;
+		}
+		entry = entries + n;
+		status = NXgetnextentry(fid, entry->name, entry->nxclass, &type);
+		if (status != NX_OK) {
+			break;
+		}
+		if (strcmp(entry->nxclass, "CDF0.0") != 0) {
+			n++;
+		}
+	}
+	if (status == NX_EOD) {
+		status = NX_OK;
+	}
+
+	for (i = 0; i < n && status == NX_OK; i++) {
+		entry = entries + i;
+		snprintf(child, sizeof(child), "%s/%s", path, entry->name);
+		memset(&info, 0, sizeof(info));
+		info.path = child;
+		info.name = entry->name;
+		info.nxclass = entry->nxclass;
+		if (strcmp(entry->nxclass, "SDS") == 0) {
+			info.kind = NXVISIT_DATASET;
+			status = NXopendata(fid, entry->name);
+			if (status != NX_OK) {
+				break;
+			}
+			status = NXgetinfo64(fid, &info.rank, info.dims,
+					     &info.type);
+			if (status == NX_OK) {
+				status = callback(&info, userdata) != 0 ?
+				    NX_EOD : NX_OK;
+			}
+			if (status == NX_OK
+			    && (flags & NXVISIT_WITH_ATTRIBUTES)) {
+				status = NXvisitattrs(fid, child, flags,
+						      callback, userdata);
+			}
+			NXclosedata(fid);
+		} else {
+			info.kind = NXVISIT_GROUP;
+			status = NXopengroup(fid, entry->name, entry->nxclass);
+			if (status != NX_OK) {
+				break;
+			}
+			status = callback(&info, userdata) != 0 ? NX_EOD : NX_OK;
+			if (status == NX_OK
+			    && (flags & NXVISIT_WITH_ATTRIBUTES)) {
+				status = NXvisitattrs(fid, child, flags,
+						      callback, userdata);
+			}
+			if (status == NX_OK) {
+				status = NXvisitgroup(fid, child, flags,
+						      callback, userdata);
+			}
+			NXclosegroup(fid);
+		}
+	}
+	free(entries);
+	return status;
+}
+
+NXstatus NXvisit(NXhandle fid, int flags, NXvisitfunc callback,
+		 void *userdata)
+{
+	pNexusFunction pFunc = handleToNexusFunc(fid);
+	char path[NX_MAXPATHLEN];
+	int status;
+
+	if (pFunc->nxvisit != NULL) {
+		return LOCKED_CALL(pFunc->nxvisit(pFunc->pNexusData, flags,
+						  callback, userdata));
+	}
+	if (NXgetpath(fid, path, sizeof(path)) != NX_OK) {
+		return NX_ERROR;
+	}
+	if (strcmp(path, "/") == 0) {
+		path[0] = '\0';
+	}
+	if (flags & NXVISIT_WITH_ATTRIBUTES) {
+		status = NXvisitattrs(fid, strlen(path) > 0 ? path : "/",
+				      flags, callback, userdata);
+		if (status != NX_OK) {
+			return status;
+		}
+	}
+	return NXvisitgroup(fid, path, flags, callback, userdata);
+}
+
 /*----------------------------------------------------------------------*/
 NXstatus NXinquirefile(NXhandle handle, char *filename,
 		       int filenameBufferLength)
@@ -1559,6 +2915,7 @@ NXstatus NXlinkexternal(NXhandle fid, CONSTCHAR * name, CONSTCHAR * nxclass,
 	int status, type = NX_CHAR, length = 1024, urllen;
 	char nxurl[1024], exfile[512], expath[512];
 	pNexusFunction pFunc = handleToNexusFunc(fid);
+	dropIndexOnStack((pFileStack) fid);
 
 	// in HDF5 we support external linking natively
 	if (pFunc->nxnativeexternallink != NULL) {
@@ -1609,6 +2966,7 @@ NXstatus NXlinkexternaldataset(NXhandle fid, CONSTCHAR * name, CONSTCHAR * url)
 	int rank = 1;
 	int64_t dims[1] = { 1 };
 
+	dropIndexOnStack((pFileStack) fid);
 	//TODO cut and paste
 
 	// in HDF5 we support external linking natively
@@ -1944,6 +3302,7 @@ NXstatus NXgetpath(NXhandle fid, char *path, int pathlen)
 NXstatus  NXputattra(NXhandle handle, CONSTCHAR* name, const void* data, const int rank, const int dim[], const int iType)
 {
 	pNexusFunction pFunc = handleToNexusFunc(handle);
+	dropIndexOnStack((pFileStack) handle);
 	return LOCKED_CALL(pFunc->nxputattra(pFunc->pNexusData, name, data, rank, dim, iType));
 }
 NXstatus  NXgetnextattra(NXhandle handle, NXname pName, int *rank, int dim[], int *iType)
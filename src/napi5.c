@@ -42,6 +42,22 @@
 #if !H5_VERSION_GE(1,8,0)
 #error HDF5 Version must be 1.8.0 or higher
 #endif
+#if H5_VERSION_GE(1,8,9)
+#define NX5_FILE_IMAGE 1
+#endif
+#if H5_VERSION_GE(1,10,0)
+#define NX5_SWMR 1
+#define NX5_VIRTUAL 1
+#endif
+#if H5_VERSION_GE(1,10,5)
+#define NX5_DIRECT_CHUNKS 1
+#endif
+#endif
+#ifdef WITH_MPI
+#ifndef H5_HAVE_PARALLEL
+#error ENABLE_MPI needs an HDF5 library built with parallel support
+#endif
+#define NX5_MPI 1
 #endif
 
 #ifdef _MSC_VER
@@ -49,6 +65,7 @@
 #endif				/* _MSC_VER */
 
 #define NX_UNKNOWN_GROUP ""	/* for when no NX_class attr */
+#define NX5_CORE_INCREMENT (1024*1024)	/* growth of in-memory files */
 
 extern void *NXpData;
 
@@ -73,6 +90,9 @@ typedef struct __NexusFile5 {
 	char name_ref[1024];
 	char name_tmp[1024];
 	char iAccess[2];
+	int iOptions;		/* NXfile_options for new groups and datasets */
+	int iAttrMaxCompact;
+	hid_t iXfer;		/* data transfer properties, see NX5setcollective */
 } NexusFile5, *pNexusFile5;
 
 /* forward declaration of NX5closegroup in order to get rid of a nasty warning */
@@ -91,6 +111,109 @@ static pNexusFile5 NXI5assert(NXhandle fid)
 	return pRes;
 }
 
+/*--------------------------------------------------------------------
+  A thread safe HDF library keeps the automatic error printing per
+  thread, so a file opened on one thread printed HDF diagnostics when it
+  was used on another. This turns the printing off on a new thread,
+  unless the application installed a handler of its own there.
+  --------------------------------------------------------------------*/
+void NX5threadinit(void)
+{
+	H5E_auto2_t func = NULL, default_func = NULL;
+	void *client_data = NULL;
+	hid_t stack;
+
+	/* a new error stack starts out with the library's own handler */
+	stack = H5Ecreate_stack();
+	if (stack < 0) {
+		return;
+	}
+	H5Eget_auto2(stack, &default_func, &client_data);
+	H5Eclose_stack(stack);
+	if (H5Eget_auto2(H5E_DEFAULT, &func, &client_data) >= 0
+	    && func == default_func) {
+		H5Eset_auto2(H5E_DEFAULT, NULL, NULL);
+	}
+}
+
+/*--------------------------------------------------------------------*/
+
+/*
+ * creation properties of the given class with the file options applied,
+ * links says if the object holds links, i.e. is a group or the file
+ */
+static hid_t NXI5createplist(pNexusFile5 pFile, hid_t plistClass, int links)
+{
+	hid_t plist;
+	unsigned int maxCompact;
+
+	plist = H5Pcreate(plistClass);
+	if (plist < 0) {
+		return plist;
+	}
+	/* NX5getnextattr iterates dense attributes in creation order */
+	if (pFile->iOptions & (NXFILE_CREATION_ORDER | NXFILE_DENSE_ATTRIBUTES)) {
+		H5Pset_attr_creation_order(plist, H5P_CRT_ORDER_TRACKED |
+					   H5P_CRT_ORDER_INDEXED);
+	}
+	if (links && (pFile->iOptions & NXFILE_CREATION_ORDER)) {
+		H5Pset_link_creation_order(plist, H5P_CRT_ORDER_TRACKED |
+					   H5P_CRT_ORDER_INDEXED);
+	}
+	if (pFile->iOptions & NXFILE_DENSE_ATTRIBUTES) {
+		maxCompact = (unsigned int)pFile->iAttrMaxCompact;
+		H5Pset_attr_phase_change(plist, maxCompact, maxCompact * 3 / 4);
+	}
+	return plist;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* the index to list a group by, creation order where it is indexed */
+static H5_index_t NXI5linkindex(hid_t grp)
+{
+	hid_t gcpl;
+	unsigned int flags = 0;
+
+	gcpl = H5Gget_create_plist(grp);
+	if (gcpl >= 0) {
+		H5Pget_link_creation_order(gcpl, &flags);
+		H5Pclose(gcpl);
+	}
+	return (flags & H5P_CRT_ORDER_INDEXED) ? H5_INDEX_CRT_ORDER :
+	    H5_INDEX_NAME;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* whether the NeXus_version attribute of root is the one of this library */
+static int NXI5versioncurrent(hid_t root)
+{
+	hid_t attr, atype;
+	char version[32];
+	int current = 0;
+
+	if (H5Aexists(root, "NeXus_version") <= 0) {
+		return 0;
+	}
+	attr = H5Aopen(root, "NeXus_version", H5P_DEFAULT);
+	if (attr < 0) {
+		return 0;
+	}
+	atype = H5Aget_type(attr);
+	if (H5Tget_class(atype) == H5T_STRING && !H5Tis_variable_str(atype)
+	    && H5Tget_size(atype) == strlen(NEXUS_VERSION)) {
+		memset(version, 0, sizeof(version));
+		if (H5Aread(attr, atype, version) >= 0
+		    && strcmp(version, NEXUS_VERSION) == 0) {
+			current = 1;
+		}
+	}
+	H5Tclose(atype);
+	H5Aclose(attr);
+	return current;
+}
+
 /*--------------------------------------------------------------------*/
 
 static void NXI5KillDir(pNexusFile5 self)
@@ -232,13 +355,20 @@ NXstatus NX5reopen(NXhandle pOrigHandle, NXhandle * pNewHandle)
 		return NX_ERROR;
 	}
 	strcpy(pNew->iAccess, pOrig->iAccess);
+	pNew->iOptions = pOrig->iOptions;
+	pNew->iAttrMaxCompact = pOrig->iAttrMaxCompact;
 	pNew->iNXID = NX5SIGNATURE;
 	pNew->iStack5[0].iVref = 0;	/* root! */
 	*pNewHandle = (NXhandle) pNew;
 	return NX_OK;
 }
 
-NXstatus NX5open(CONSTCHAR * filename, NXaccess am, NXhandle * pHandle)
+/*
+ * opens or creates a file with the file access properties fapl, which
+ * select the driver; the caller keeps fapl
+ */
+static NXstatus NXI5open(CONSTCHAR * filename, NXaccess am, hid_t fapl,
+			 NXhandle * pHandle)
 {
 	hid_t attr1, aid1, aid2, iVID;
 	pNexusFile5 pNew = NULL;
@@ -246,7 +376,9 @@ NXstatus NX5open(CONSTCHAR * filename, NXaccess am, NXhandle * pHandle)
 	char *time_buffer = NULL;
 	char version_nr[10];
 	unsigned int vers_major, vers_minor, vers_release, am1;
-	hid_t fapl = -1;
+	unsigned int swmr_flags = 0;
+	NXaccess swmr, core;
+	hid_t fcpl = H5P_DEFAULT;
 	int mdc_nelmts;
 	size_t rdcc_nelmts;
 	size_t rdcc_nbytes;
@@ -264,8 +396,32 @@ NXstatus NX5open(CONSTCHAR * filename, NXaccess am, NXhandle * pHandle)
 		return NX_ERROR;
 	}
 
-	/* mask of any options for now */
+	/* mask of any options but SWMR and in-memory files for now */
+	swmr = (NXaccess) (am & (NXACC_SWMR_WRITE | NXACC_SWMR_READ));
+	core = (NXaccess) (am & (NXACC_CORE | NXACC_CORE_NOSTORE));
 	am = (NXaccess) (am & NXACCMASK_REMOVEFLAGS);
+	if ((swmr == NXACC_SWMR_WRITE && am != NXACC_CREATE5
+	     && am != NXACC_RDWR) || (swmr == NXACC_SWMR_READ
+				      && am != NXACC_READ)
+	    || swmr == (NXACC_SWMR_WRITE | NXACC_SWMR_READ)) {
+		NXReportError
+		    ("ERROR: SWMR writing needs NXACC_CREATE5 or NXACC_RDWR, SWMR reading NXACC_READ");
+		return NX_ERROR;
+	}
+	if (swmr != 0 && core != 0) {
+		NXReportError("ERROR: SWMR access needs a file on disk");
+		return NX_ERROR;
+	}
+#ifdef NX5_SWMR
+	if (swmr == NXACC_SWMR_READ) {
+		swmr_flags = H5F_ACC_SWMR_READ;
+	}
+#else
+	if (swmr != 0) {
+		NXReportError("ERROR: SWMR access needs HDF5 1.10 or newer");
+		return NX_ERROR;
+	}
+#endif
 
 	/* turn off the automatic HDF error handling */
 	H5Eset_auto(H5E_DEFAULT, NULL, NULL);
@@ -283,7 +439,6 @@ NXstatus NX5open(CONSTCHAR * filename, NXaccess am, NXhandle * pHandle)
 
 	/* start HDF5 interface */
 	if (am == NXACC_CREATE5) {
-		fapl = H5Pcreate(H5P_FILE_ACCESS);
 		H5Pget_cache(fapl, &mdc_nelmts, &rdcc_nelmts, &rdcc_nbytes,
 			     &rdcc_w0);
 		rdcc_nbytes = (size_t) nx_cacheSize;
@@ -291,19 +446,47 @@ NXstatus NX5open(CONSTCHAR * filename, NXaccess am, NXhandle * pHandle)
 			     rdcc_w0);
 		H5Pset_fclose_degree(fapl, H5F_CLOSE_STRONG);
 		am1 = H5F_ACC_TRUNC;
-		pNew->iFID = H5Fcreate(filename, am1, H5P_DEFAULT, fapl);
+		pNew->iOptions = nx_fileOptions;
+		pNew->iAttrMaxCompact = nx_attrMaxCompact;
+		if (pNew->iOptions & NXFILE_LATEST_FORMAT) {
+			H5Pset_libver_bounds(fapl, H5F_LIBVER_LATEST,
+					     H5F_LIBVER_LATEST);
+		}
+		if (pNew->iOptions & NXFILE_AGGREGATE_METADATA) {
+			H5Pset_meta_block_size(fapl,
+					       (hsize_t) nx_metaBlockSize);
+		}
+		/* the root group is set up by the file creation properties */
+		if (pNew->iOptions != 0) {
+			fcpl = NXI5createplist(pNew, H5P_FILE_CREATE, 1);
+		}
 	} else {
 		if (am == NXACC_READ) {
 			am1 = H5F_ACC_RDONLY;
 		} else {
 			am1 = H5F_ACC_RDWR;
 		}
-		fapl = H5Pcreate(H5P_FILE_ACCESS);
 		H5Pset_fclose_degree(fapl, H5F_CLOSE_STRONG);
-		pNew->iFID = H5Fopen(filename, am1, fapl);
 	}
-	if (fapl != -1) {
-		H5Pclose(fapl);
+#ifdef NX5_SWMR
+	/* SWMR writing works on files in the latest format only */
+	if (swmr == NXACC_SWMR_WRITE) {
+		H5Pset_libver_bounds(fapl, H5F_LIBVER_LATEST,
+				     H5F_LIBVER_LATEST);
+	}
+#endif
+	/* the file is read into memory, and written back on close if wanted */
+	if (core != 0) {
+		H5Pset_fapl_core(fapl, NX5_CORE_INCREMENT,
+				 (core & NXACC_CORE_NOSTORE) ? 0 : 1);
+	}
+	if (am1 == H5F_ACC_TRUNC) {
+		pNew->iFID = H5Fcreate(filename, am1, fcpl, fapl);
+	} else {
+		pNew->iFID = H5Fopen(filename, am1 | swmr_flags, fapl);
+	}
+	if (fcpl != H5P_DEFAULT) {
+		H5Pclose(fcpl);
 	}
 	if (pNew->iFID <= 0) {
 		sprintf(pBuffer, "ERROR: cannot open file: %s", filename);
@@ -318,6 +501,11 @@ NXstatus NX5open(CONSTCHAR * filename, NXaccess am, NXhandle * pHandle)
  */
 	if (am1 != H5F_ACC_RDONLY) {
 		iVID = H5Gopen(pNew->iFID, "/", H5P_DEFAULT);
+	}
+	/* rewriting an unchanged version only dirties the file metadata */
+	if (am1 == H5F_ACC_RDWR && NXI5versioncurrent(iVID)) {
+		H5Gclose(iVID);
+	} else if (am1 != H5F_ACC_RDONLY) {
 		aid2 = H5Screate(H5S_SCALAR);
 		aid1 = H5Tcopy(H5T_C_S1);
 		H5Tset_size(aid1, strlen(NEXUS_VERSION));
@@ -390,6 +578,20 @@ NXstatus NX5open(CONSTCHAR * filename, NXaccess am, NXhandle * pHandle)
 		H5Aclose(attr1);
 	/*----------- file time */
 		time_buffer = NXIformatNeXusTime();
+#ifdef NX5_MPI
+		/* all processes have to write the same value, that of the first */
+		if (time_buffer != NULL && H5Pget_driver(fapl) == H5FD_MPIO) {
+			MPI_Comm comm;
+			MPI_Info info;
+			if (H5Pget_fapl_mpio(fapl, &comm, &info) >= 0) {
+				MPI_Bcast(time_buffer, 64, MPI_CHAR, 0, comm);
+				MPI_Comm_free(&comm);
+				if (info != MPI_INFO_NULL) {
+					MPI_Info_free(&info);
+				}
+			}
+		}
+#endif
 		if (time_buffer != NULL) {
 			aid2 = H5Screate(H5S_SCALAR);
 			aid1 = H5Tcopy(H5T_C_S1);
@@ -418,6 +620,16 @@ NXstatus NX5open(CONSTCHAR * filename, NXaccess am, NXhandle * pHandle)
 		}
 		H5Gclose(iVID);
 	}
+#ifdef NX5_SWMR
+	/* an existing file has its layout already, new ones see NX5startswmr */
+	if (swmr == NXACC_SWMR_WRITE && am1 == H5F_ACC_RDWR
+	    && H5Fstart_swmr_write(pNew->iFID) < 0) {
+		NXReportError("ERROR: cannot start SWMR writing");
+		H5Fclose(pNew->iFID);
+		free(pNew);
+		return NX_ERROR;
+	}
+#endif
 	/* Set HDFgroup access mode */
 	if (am1 == H5F_ACC_RDONLY) {
 		strcpy(pNew->iAccess, "r");
@@ -430,6 +642,95 @@ NXstatus NX5open(CONSTCHAR * filename, NXaccess am, NXhandle * pHandle)
 	return NX_OK;
 }
 
+NXstatus NX5open(CONSTCHAR * filename, NXaccess am, NXhandle * pHandle)
+{
+	hid_t fapl;
+	NXstatus status;
+
+	fapl = H5Pcreate(H5P_FILE_ACCESS);
+	status = NXI5open(filename, am, fapl, pHandle);
+	H5Pclose(fapl);
+	return status;
+}
+
+  /* ------------------------------------------------------------------------- */
+
+#ifdef NX5_MPI
+NXstatus NX5openmpi(CONSTCHAR * filename, NXaccess am, MPI_Comm comm,
+		    MPI_Info info, NXhandle * pHandle)
+{
+	hid_t fapl;
+	NXstatus status;
+
+	*pHandle = NULL;
+	if (am != NXACC_CREATE5 && am != NXACC_RDWR && am != NXACC_READ) {
+		NXReportError
+		    ("ERROR: NXopenmpi needs NXACC_CREATE5, NXACC_RDWR or NXACC_READ");
+		return NX_ERROR;
+	}
+	fapl = H5Pcreate(H5P_FILE_ACCESS);
+	if (H5Pset_fapl_mpio(fapl, comm, info) < 0) {
+		NXReportError("ERROR: cannot set up MPI-IO");
+		H5Pclose(fapl);
+		return NX_ERROR;
+	}
+	status = NXI5open(filename, am, fapl, pHandle);
+	H5Pclose(fapl);
+	return status;
+}
+
+  /* ------------------------------------------------------------------------- */
+#endif				/* NX5_MPI */
+
+NXstatus NX5openbuffer(const void *buffer, size_t size, NXaccess am,
+		       NXhandle * pHandle)
+{
+#ifdef NX5_FILE_IMAGE
+	pNexusFile5 pNew = NULL;
+	hid_t fapl;
+	char name[64];
+
+	*pHandle = NULL;
+	H5Eset_auto(H5E_DEFAULT, NULL, NULL);
+	pNew = (pNexusFile5) malloc(sizeof(NexusFile5));
+	if (!pNew) {
+		NXReportError
+		    ("ERROR: not enough memory to create file structure");
+		return NX_ERROR;
+	}
+	memset(pNew, 0, sizeof(NexusFile5));
+
+	/* the core driver works on a copy of the image, never on a file */
+	fapl = H5Pcreate(H5P_FILE_ACCESS);
+	H5Pset_fclose_degree(fapl, H5F_CLOSE_STRONG);
+	H5Pset_fapl_core(fapl, NX5_CORE_INCREMENT, 0);
+	if (H5Pset_file_image(fapl, (void *)buffer, size) < 0) {
+		NXReportError("ERROR: cannot copy the file image");
+		H5Pclose(fapl);
+		free(pNew);
+		return NX_ERROR;
+	}
+	sprintf(name, "memory:%p", buffer);
+	pNew->iFID = H5Fopen(name, am == NXACC_READ ? H5F_ACC_RDONLY :
+			     H5F_ACC_RDWR, fapl);
+	H5Pclose(fapl);
+	if (pNew->iFID <= 0) {
+		NXReportError("ERROR: buffer holds no valid HDF-5 file");
+		free(pNew);
+		return NX_ERROR;
+	}
+	strcpy(pNew->iAccess, am == NXACC_READ ? "r" : "w");
+	pNew->iNXID = NX5SIGNATURE;
+	pNew->iStack5[0].iVref = 0;	/* root! */
+	*pHandle = (NXhandle) pNew;
+	return NX_OK;
+#else
+	*pHandle = NULL;
+	NXReportError("ERROR: opening files in memory needs HDF5 1.8.9 or newer");
+	return NX_ERROR;
+#endif
+}
+
   /* ------------------------------------------------------------------------- */
 
 NXstatus NX5close(NXhandle * fid)
@@ -439,6 +740,19 @@ NXstatus NX5close(NXhandle * fid)
 
 	pFile = NXI5assert(*fid);
 
+	/*
+	   the dataspace and type of an open dataset are not file objects,
+	   H5Fclose leaves them open and every later call pays for them
+	 */
+	if (pFile->iCurrentD != 0) {
+		H5Sclose(pFile->iCurrentS);
+		H5Tclose(pFile->iCurrentT);
+		H5Dclose(pFile->iCurrentD);
+		pFile->iCurrentD = 0;
+	}
+	if (pFile->iXfer != H5P_DEFAULT) {
+		H5Pclose(pFile->iXfer);
+	}
 	iRet = 0;
 	/*
 	   printf("HDF5 object count before close: %d\n",
@@ -483,7 +797,7 @@ NXstatus NX5makegroup(NXhandle fid, CONSTCHAR * name, CONSTCHAR * nxclass)
 {
 	pNexusFile5 pFile;
 	herr_t iRet;
-	hid_t iVID;
+	hid_t iVID, gcpl;
 	hid_t attr1, aid1, aid2;
 	char pBuffer[1024] = "";
 
@@ -494,9 +808,11 @@ NXstatus NX5makegroup(NXhandle fid, CONSTCHAR * name, CONSTCHAR * nxclass)
 	} else {
 		snprintf(pBuffer, 1023, "/%s/%s", pFile->name_ref, name);
 	}
+	gcpl = NXI5createplist(pFile, H5P_GROUP_CREATE, 1);
 	iRet =
 	    H5Gcreate(pFile->iFID, (const char *)pBuffer, H5P_DEFAULT,
-		      H5P_DEFAULT, H5P_DEFAULT);
+		      gcpl, H5P_DEFAULT);
+	H5Pclose(gcpl);
 	if (iRet < 0) {
 		NXReportError("ERROR: could not create Group");
 		return NX_ERROR;
@@ -523,16 +839,6 @@ NXstatus NX5makegroup(NXhandle fid, CONSTCHAR * name, CONSTCHAR * nxclass)
 	return NX_OK;
 }
 
-  /*------------------------------------------------------------------------*/
-
-herr_t attr_check(hid_t loc_id, const char *member_name,
-		  const H5A_info_t * unused, void *opdata)
-{
-	char attr_name[8 + 1];	/* need to leave space for \0 as well */
-
-	strcpy(attr_name, "NX_class");
-	return strstr(member_name, attr_name) ? 1 : 0;
-}
 
   /*------------------------------------------------------------------------*/
 NXstatus NX5opengroup(NXhandle fid, CONSTCHAR * name, CONSTCHAR * nxclass)
@@ -562,15 +868,13 @@ NXstatus NX5opengroup(NXhandle fid, CONSTCHAR * name, CONSTCHAR * nxclass)
 	strcpy(pFile->name_ref, pBuffer);
 
 	if ((nxclass != NULL) && (strcmp(nxclass, NX_UNKNOWN_GROUP) != 0)) {
-		/* check group attribute */
-		iRet =
-		    H5Aiterate(pFile->iCurrentG, H5_INDEX_CRT_ORDER,
-			       H5_ITER_INC, 0, attr_check, NULL);
+		/* check group attribute, a lookup by name is indexed */
+		iRet = H5Aexists(pFile->iCurrentG, "NX_class");
 		if (iRet < 0) {
 			NXReportError
 			    ("ERROR: iterating through attribute list");
 			return NX_ERROR;
-		} else if (iRet == 1) {
+		} else if (iRet > 0) {
 			/* group attribute was found */
 		} else {
 			/* no group attribute available */
@@ -810,7 +1114,7 @@ NXstatus NX5compmakedata64(NXhandle fid, CONSTCHAR * name,
 		compress_type = NX_COMP_LZW;
 	}
 	if (compress_type == NX_COMP_LZW) {
-		cparms = H5Pcreate(H5P_DATASET_CREATE);
+		cparms = NXI5createplist(pFile, H5P_DATASET_CREATE, 0);
 		iNew = H5Pset_chunk(cparms, rank, chunkdims);
 		if (iNew < 0) {
 			NXReportError("ERROR: size of chunks could not be set");
@@ -822,7 +1126,7 @@ NXstatus NX5compmakedata64(NXhandle fid, CONSTCHAR * name,
 				 dataspace, H5P_DEFAULT, cparms, H5P_DEFAULT);
 	} else if (compress_type == NX_COMP_NONE) {
 		if (unlimiteddim) {
-			cparms = H5Pcreate(H5P_DATASET_CREATE);
+			cparms = NXI5createplist(pFile, H5P_DATASET_CREATE, 0);
 			iNew = H5Pset_chunk(cparms, rank, chunkdims);
 			if (iNew < 0) {
 				NXReportError
@@ -834,13 +1138,15 @@ NXstatus NX5compmakedata64(NXhandle fid, CONSTCHAR * name,
 				      dataspace, H5P_DEFAULT, cparms,
 				      H5P_DEFAULT);
 		} else {
+			cparms =
+			    NXI5createplist(pFile, H5P_DATASET_CREATE, 0);
 			iRet =
 			    H5Dcreate(pFile->iCurrentG, (char *)name, datatype1,
-				      dataspace, H5P_DEFAULT, H5P_DEFAULT,
+				      dataspace, H5P_DEFAULT, cparms,
 				      H5P_DEFAULT);
 		}
 	} else if (compress_type == NX_CHUNK) {
-		cparms = H5Pcreate(H5P_DATASET_CREATE);
+		cparms = NXI5createplist(pFile, H5P_DATASET_CREATE, 0);
 		iNew = H5Pset_chunk(cparms, rank, chunkdims);
 		if (iNew < 0) {
 			NXReportError("ERROR: size of chunks could not be set");
@@ -852,9 +1158,10 @@ NXstatus NX5compmakedata64(NXhandle fid, CONSTCHAR * name,
 	} else {
 		NXReportError
 		    ("HDF5 doesn't support selected compression method! Dataset created without compression");
+		cparms = NXI5createplist(pFile, H5P_DATASET_CREATE, 0);
 		iRet =
 		    H5Dcreate(pFile->iCurrentG, (char *)name, datatype1,
-			      dataspace, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+			      dataspace, H5P_DEFAULT, cparms, H5P_DEFAULT);
 	}
 	if (iRet < 0) {
 		NXReportError("ERROR: creating chunked dataset failed");
@@ -908,6 +1215,105 @@ NXstatus NX5makedata64(NXhandle fid, CONSTCHAR * name, int datatype,
 
   /* --------------------------------------------------------------------- */
 
+NXstatus NX5makevirtual64(NXhandle fid, CONSTCHAR * name, int datatype,
+			  int rank, int64_t dimensions[], int nsource,
+			  const NXvirtualsource source[])
+{
+#ifdef NX5_VIRTUAL
+	pNexusFile5 pFile;
+	hid_t type, vspace, sspace, dcpl, iNew;
+	hsize_t mydim[H5S_MAX_RANK], start[H5S_MAX_RANK], size[H5S_MAX_RANK];
+	char pBuffer[256];
+	int i, j;
+
+	pFile = NXI5assert(fid);
+	if (pFile->iCurrentG <= 0) {
+		sprintf(pBuffer, "ERROR: no group open for makedata on %s",
+			name);
+		NXReportError(pBuffer);
+		return NX_ERROR;
+	}
+	if (rank <= 0 || rank > H5S_MAX_RANK) {
+		sprintf(pBuffer, "ERROR: invalid rank specified %s", name);
+		NXReportError(pBuffer);
+		return NX_ERROR;
+	}
+	if (datatype == NX_CHAR) {
+		NXReportError("ERROR: virtual datasets of NX_CHAR are not supported");
+		return NX_ERROR;
+	}
+	type = nxToHDF5Type(datatype);
+	if (type < 0) {
+		return NX_ERROR;
+	}
+	for (i = 0; i < rank; i++) {
+		if (dimensions[i] <= 0) {
+			NXReportError
+			    ("ERROR: virtual datasets need fixed dimensions");
+			return NX_ERROR;
+		}
+		mydim[i] = (hsize_t) dimensions[i];
+	}
+
+	vspace = H5Screate_simple(rank, mydim, NULL);
+	dcpl = NXI5createplist(pFile, H5P_DATASET_CREATE, 0);
+	for (j = 0; j < nsource; j++) {
+		for (i = 0; i < rank; i++) {
+			if (source[j].start[i] < 0 || source[j].size[i] <= 0
+			    || source[j].start[i] + source[j].size[i] >
+			    dimensions[i]) {
+				sprintf(pBuffer,
+					"ERROR: region of virtual source %d is outside %s",
+					j, name);
+				NXReportError(pBuffer);
+				H5Pclose(dcpl);
+				H5Sclose(vspace);
+				return NX_ERROR;
+			}
+			start[i] = (hsize_t) source[j].start[i];
+			size[i] = (hsize_t) source[j].size[i];
+		}
+		/*
+		   the source dataset may have another rank, only the number
+		   of elements has to match; its extent replaces this one when
+		   it is opened
+		 */
+		sspace = H5Screate_simple(rank, size, NULL);
+		H5Sselect_hyperslab(vspace, H5S_SELECT_SET, start, NULL, size,
+				    NULL);
+		iNew = H5Pset_virtual(dcpl, vspace, source[j].filename,
+				      source[j].path, sspace);
+		H5Sclose(sspace);
+		if (iNew < 0) {
+			sprintf(pBuffer, "ERROR: cannot map %s:%s into %s",
+				source[j].filename, source[j].path, name);
+			NXReportError(pBuffer);
+			H5Pclose(dcpl);
+			H5Sclose(vspace);
+			return NX_ERROR;
+		}
+	}
+	H5Sselect_all(vspace);
+	iNew = H5Dcreate(pFile->iCurrentG, (char *)name, type, vspace,
+			 H5P_DEFAULT, dcpl, H5P_DEFAULT);
+	H5Pclose(dcpl);
+	H5Sclose(vspace);
+	if (iNew < 0) {
+		sprintf(pBuffer, "ERROR: cannot create virtual dataset %s",
+			name);
+		NXReportError(pBuffer);
+		return NX_ERROR;
+	}
+	H5Dclose(iNew);
+	return NX_OK;
+#else
+	NXReportError("ERROR: virtual datasets need HDF5 1.10 or newer");
+	return NX_ERROR;
+#endif
+}
+
+  /* --------------------------------------------------------------------- */
+
 NXstatus NX5compress(NXhandle fid, int compress_type)
 {
 	printf
@@ -1018,7 +1424,7 @@ NXstatus NX5putdata(NXhandle fid, const void *data)
 	} else {
 		iRet =
 		    H5Dwrite(pFile->iCurrentD, pFile->iCurrentT, H5S_ALL,
-			     H5S_ALL, H5P_DEFAULT, data);
+			     H5S_ALL, pFile->iXfer, data);
 		if (iRet < 0) {
 			snprintf(pError, sizeof(pError) - 1,
 				 "ERROR: failure to write data");
@@ -1176,7 +1582,7 @@ NXstatus NX5putslab64(NXhandle fid, const void *data, const int64_t iStart[],
 		}
 		/* write slab */
 		iRet = H5Dwrite(pFile->iCurrentD, pFile->iCurrentT, dataspace,
-				filespace, H5P_DEFAULT, data);
+				filespace, pFile->iXfer, data);
 		if (iRet < 0) {
 			NXReportError("ERROR: writing slab failed");
 		}
@@ -1195,7 +1601,7 @@ NXstatus NX5putslab64(NXhandle fid, const void *data, const int64_t iStart[],
 		}
 		/* write slab */
 		iRet = H5Dwrite(pFile->iCurrentD, pFile->iCurrentT, dataspace,
-				pFile->iCurrentS, H5P_DEFAULT, data);
+				pFile->iCurrentS, pFile->iXfer, data);
 		if (iRet < 0) {
 			NXReportError("ERROR: writing slab failed");
 		}
@@ -1393,6 +1799,86 @@ NXstatus NX5flush(NXhandle * pHandle)
 
   /*-------------------------------------------------------------------------*/
 
+NXstatus NX5startswmr(NXhandle fid)
+{
+#ifdef NX5_SWMR
+	pNexusFile5 pFile;
+
+	pFile = NXI5assert(fid);
+	if (H5Fstart_swmr_write(pFile->iFID) < 0) {
+		NXReportError
+		    ("ERROR: cannot start SWMR writing, create the file with NXACC_SWMR_WRITE");
+		return NX_ERROR;
+	}
+	return NX_OK;
+#else
+	NXReportError("ERROR: SWMR access needs HDF5 1.10 or newer");
+	return NX_ERROR;
+#endif
+}
+
+  /*-------------------------------------------------------------------------*/
+
+NXstatus NX5refresh(NXhandle fid)
+{
+#ifdef NX5_SWMR
+	pNexusFile5 pFile;
+
+	pFile = NXI5assert(fid);
+	if (pFile->iCurrentD == 0) {
+		NXReportError("ERROR: no dataset open");
+		return NX_ERROR;
+	}
+	if (H5Drefresh(pFile->iCurrentD) < 0) {
+		NXReportError("ERROR: cannot refresh dataset");
+		return NX_ERROR;
+	}
+	/* the extent may have grown */
+	H5Sclose(pFile->iCurrentS);
+	pFile->iCurrentS = H5Dget_space(pFile->iCurrentD);
+	return NX_OK;
+#else
+	NXReportError("ERROR: SWMR access needs HDF5 1.10 or newer");
+	return NX_ERROR;
+#endif
+}
+
+  /*-------------------------------------------------------------------------*/
+
+NXstatus NX5setcollective(NXhandle fid, int collective)
+{
+#ifdef NX5_MPI
+	pNexusFile5 pFile;
+	hid_t fapl;
+	int parallel;
+
+	pFile = NXI5assert(fid);
+	fapl = H5Fget_access_plist(pFile->iFID);
+	parallel = fapl >= 0 && H5Pget_driver(fapl) == H5FD_MPIO;
+	if (fapl >= 0) {
+		H5Pclose(fapl);
+	}
+	if (!parallel) {
+		NXReportError("ERROR: file was not opened with NXopenmpi");
+		return NX_ERROR;
+	}
+	if (pFile->iXfer == H5P_DEFAULT) {
+		pFile->iXfer = H5Pcreate(H5P_DATASET_XFER);
+	}
+	if (H5Pset_dxpl_mpio(pFile->iXfer, collective ? H5FD_MPIO_COLLECTIVE :
+			     H5FD_MPIO_INDEPENDENT) < 0) {
+		NXReportError("ERROR: cannot set the transfer mode");
+		return NX_ERROR;
+	}
+	return NX_OK;
+#else
+	NXReportError("ERROR: collective transfers need a build with ENABLE_MPI");
+	return NX_ERROR;
+#endif
+}
+
+  /*-------------------------------------------------------------------------*/
+
   /* Operator function. */
 
 herr_t nxgroup_info(hid_t loc_id, const char *name, const H5L_info_t * statbuf,
@@ -1534,6 +2020,7 @@ NXstatus NX5getgroupinfo(NXhandle fid, int *iN, NXname pName, NXname pClass)
 			H5Tset_size(atype, sizeof(data));
 			readStringAttributeN(attr_id, data, sizeof(data));
 			strcpy(pClass, data);
+			H5Tclose(atype);
 			H5Aclose(attr_id);
 		}
 		pFile->iNX = 0;
@@ -1674,6 +2161,7 @@ NXstatus NX5getnextentry(NXhandle fid, NXname name, NXname nxclass,
 	char ph_name[1024];
 	info_type op_data;
 	herr_t iRet_iNX = -1;
+	H5G_info_t ginfo;
 	char pBuffer[256];
 
 	pFile = NXI5assert(fid);
@@ -1688,38 +2176,26 @@ NXstatus NX5getnextentry(NXhandle fid, NXname name, NXname nxclass,
 		strcpy(pFile->name_ref, "/");
 	}
 	grp = H5Gopen(pFile->iFID, pFile->name_ref, H5P_DEFAULT);
-	// index can be wrong here
-	iRet =
-	    H5Literate(grp, H5_INDEX_NAME, H5_ITER_INC, &idx, nxgroup_info,
-		       &op_data);
-	H5Gclose(grp);
+	/*
+	   a lookup by position, unlike an iteration started at idx, is a
+	   B-tree search in groups which index the creation order
+	 */
+	iRet = -1;
+	if (H5Lget_name_by_idx(grp, ".", NXI5linkindex(grp), H5_ITER_INC, idx,
+			       ph_name, sizeof(ph_name), H5P_DEFAULT) >= 0) {
+		iRet = nxgroup_info(grp, ph_name, NULL, &op_data);
+	}
 	strcpy(nxclass, NX_UNKNOWN_GROUP);
 
 	/*
-	   figure out the number of items in the current group. We need this in order to
-	   find out if we are at the end of the search. 
+	   past the end of the group the lookup fails. Only then compare with
+	   the number of links, counting them for every entry made listing a
+	   group quadratic in its size.
 	 */
-	if (pFile->iCurrentG == 0) {
-		// if pFile->iCurrentG == 0 would not pFile->name_ref be "/" already, so we could skip that if statement ?
-		pFile->iNX = 0;
-		grp = H5Gopen(pFile->iFID, "/", H5P_DEFAULT);
-		iRet_iNX =
-		    H5Literate(grp, H5_INDEX_NAME, H5_ITER_INC, 0, group_info1,
-			       &pFile->iNX);
-		H5Gclose(grp);
-	} else {
-		pFile->iNX = 0;
-		grp = H5Gopen(pFile->iFID, pFile->name_ref, H5P_DEFAULT);
-		// index can be wrong here
-		iRet_iNX =
-		    H5Literate(grp, H5_INDEX_NAME, H5_ITER_INC, 0, group_info1,
-			       &pFile->iNX);
-		H5Gclose(grp);
-	}
-	if (idx == pFile->iNX) {
-		// why 2?
+	if (iRet <= 0 && H5Gget_info(grp, &ginfo) >= 0 && idx >= ginfo.nlinks) {
 		iRet_iNX = 2;
 	}
+	H5Gclose(grp);
 
 	if (iRet > 0) {
 		pFile->iStack5[pFile->iStackPtr].iCurrentIDX++;
@@ -1807,13 +2283,35 @@ NXstatus NX5getnextentry(NXhandle fid, NXname name, NXname nxclass,
 
    /*-------------------------------------------------------------------------*/
 
+/*
+ * concatenates n strings read as variable length into data, in one pass;
+ * strings HDF5 returned as NULL count as empty
+ */
+static void NXI5joinstrings(char *data, char **strings, hssize_t n)
+{
+	hssize_t i;
+	size_t len;
+
+	for (i = 0; i < n; ++i) {
+		if (strings[i] != NULL) {
+			len = strlen(strings[i]);
+			memcpy(data, strings[i], len);
+			data += len;
+		}
+	}
+	*data = '\0';
+}
+
+   /*-------------------------------------------------------------------------*/
+
 NXstatus NX5getdata(NXhandle fid, void *data)
 {
 	pNexusFile5 pFile;
-	int i, iStart[H5S_MAX_RANK], status;
+	int iStart[H5S_MAX_RANK], status;
 	hid_t memtype_id;
 	H5T_class_t tclass;
 	hsize_t ndims, dims[H5S_MAX_RANK];
+	hssize_t npoints;
 	char **vstrdata = NULL;
 
 	pFile = NXI5assert(fid);
@@ -1838,7 +2336,7 @@ NXstatus NX5getdata(NXhandle fid, void *data)
 			char *strdata = calloc(512, sizeof(char));
 			status =
 			    H5Dread(pFile->iCurrentD, datatype, H5S_ALL,
-				    H5S_ALL, H5P_DEFAULT, &strdata);
+				    H5S_ALL, pFile->iXfer, &strdata);
 			if (status >= 0)
 				strncpy(data, strdata, strlen(strdata));
 			free(strdata);
@@ -1847,7 +2345,7 @@ NXstatus NX5getdata(NXhandle fid, void *data)
 			H5Sselect_all(filespace);
 			status =
 			    H5Dread(pFile->iCurrentD, datatype, memtype_id,
-				    filespace, H5P_DEFAULT, data);
+				    filespace, pFile->iXfer, data);
 			H5Sclose(memtype_id);
 		}
 
@@ -1862,18 +2360,15 @@ NXstatus NX5getdata(NXhandle fid, void *data)
 	/* map datatypes of other plateforms */
 	tclass = H5Tget_class(pFile->iCurrentT);
 	if (H5Tis_variable_str(pFile->iCurrentT)) {
-		vstrdata = (char **)malloc((size_t) dims[0] * sizeof(char *));
+		npoints = H5Sget_simple_extent_npoints(pFile->iCurrentS);
+		vstrdata = (char **)malloc((size_t) npoints * sizeof(char *));
 		memtype_id = H5Tcopy(H5T_C_S1);
 		H5Tset_size(memtype_id, H5T_VARIABLE);
 		status = H5Dread(pFile->iCurrentD, memtype_id,
-				 H5S_ALL, H5S_ALL, H5P_DEFAULT, vstrdata);
+				 H5S_ALL, H5S_ALL, pFile->iXfer, vstrdata);
 		((char *)data)[0] = '\0';
 		if (status >= 0) {
-			for (i = 0; i < dims[0]; ++i) {
-				if (vstrdata[i] != NULL) {
-					strcat((char *)data, vstrdata[i]);
-				}
-			}
+			NXI5joinstrings((char *)data, vstrdata, npoints);
 		}
 		H5Dvlen_reclaim(memtype_id, pFile->iCurrentS, H5P_DEFAULT,
 				vstrdata);
@@ -1881,11 +2376,11 @@ NXstatus NX5getdata(NXhandle fid, void *data)
 		H5Tclose(memtype_id);
 	} else if (tclass == H5T_STRING) {
 		status = H5Dread(pFile->iCurrentD, pFile->iCurrentT,
-				 H5S_ALL, H5S_ALL, H5P_DEFAULT, data);
+				 H5S_ALL, H5S_ALL, pFile->iXfer, data);
 	} else {
 		memtype_id = h5MemType(pFile->iCurrentT);
 		status = H5Dread(pFile->iCurrentD, memtype_id,
-				 H5S_ALL, H5S_ALL, H5P_DEFAULT, data);
+				 H5S_ALL, H5S_ALL, pFile->iXfer, data);
 	}
 	if (status < 0) {
 		NXReportError("ERROR: failed to transfer dataset");
@@ -1896,11 +2391,171 @@ NXstatus NX5getdata(NXhandle fid, void *data)
 
    /*-------------------------------------------------------------------------*/
 
+NXstatus NX5getstrings(NXhandle fid, int64_t * count, int64_t ** offsets,
+		       char **buffer)
+{
+	pNexusFile5 pFile;
+	hid_t memtype_id;
+	hssize_t npoints, i;
+	size_t width = 0, total = 0, len;
+	char **vstrdata = NULL, *fixed = NULL, *end, *nul;
+	int64_t *offs;
+	herr_t status;
+	htri_t is_vlen_str;
+
+	pFile = NXI5assert(fid);
+	*count = 0;
+	*offsets = NULL;
+	*buffer = NULL;
+	if (pFile->iCurrentD == 0) {
+		NXReportError("ERROR: no dataset open");
+		return NX_ERROR;
+	}
+	if (H5Tget_class(pFile->iCurrentT) != H5T_STRING) {
+		NXReportError("ERROR: dataset does not hold strings");
+		return NX_ERROR;
+	}
+	/* one element for scalar dataspaces too */
+	npoints = H5Sget_simple_extent_npoints(pFile->iCurrentS);
+	if (npoints < 0) {
+		NXReportError("ERROR: unable to read dims");
+		return NX_ERROR;
+	}
+
+	/* everything is read with one H5Dread, the lengths come with it */
+	is_vlen_str = H5Tis_variable_str(pFile->iCurrentT);
+	if (is_vlen_str) {
+		memtype_id = H5Tcopy(H5T_C_S1);
+		H5Tset_size(memtype_id, H5T_VARIABLE);
+		vstrdata = (char **)calloc((size_t) npoints + 1, sizeof(char *));
+		if (vstrdata == NULL) {
+			NXReportError("ERROR: out of memory reading strings");
+			H5Tclose(memtype_id);
+			return NX_ERROR;
+		}
+		status = H5Dread(pFile->iCurrentD, memtype_id, H5S_ALL, H5S_ALL,
+				 pFile->iXfer, vstrdata);
+		if (status >= 0) {
+			for (i = 0; i < npoints; i++) {
+				if (vstrdata[i] != NULL)
+					total += strlen(vstrdata[i]);
+			}
+		}
+	} else {
+		memtype_id = H5Tcopy(pFile->iCurrentT);
+		width = H5Tget_size(memtype_id);
+		fixed = (char *)malloc((size_t) npoints * width + 1);
+		if (fixed == NULL) {
+			NXReportError("ERROR: out of memory reading strings");
+			H5Tclose(memtype_id);
+			return NX_ERROR;
+		}
+		status = H5Dread(pFile->iCurrentD, memtype_id, H5S_ALL, H5S_ALL,
+				 pFile->iXfer, fixed);
+		total = (size_t) npoints *width;
+	}
+	if (status < 0) {
+		NXReportError("ERROR: failed to transfer dataset");
+		if (is_vlen_str)
+			free(vstrdata);
+		free(fixed);
+		H5Tclose(memtype_id);
+		return NX_ERROR;
+	}
+
+	/* pack them behind each other, each one terminated */
+	offs = (int64_t *) malloc(((size_t) npoints + 1) * sizeof(int64_t));
+	end = (char *)malloc(total + (size_t) npoints + 1);
+	if (offs == NULL || end == NULL) {
+		NXReportError("ERROR: out of memory reading strings");
+		free(offs);
+		free(end);
+		if (is_vlen_str) {
+			H5Dvlen_reclaim(memtype_id, pFile->iCurrentS,
+					H5P_DEFAULT, vstrdata);
+			free(vstrdata);
+		}
+		free(fixed);
+		H5Tclose(memtype_id);
+		return NX_ERROR;
+	}
+	*offsets = offs;
+	*buffer = end;
+	for (i = 0; i < npoints; i++) {
+		offs[i] = (int64_t) (end - *buffer);
+		if (is_vlen_str) {
+			len = 0;
+			if (vstrdata[i] != NULL) {
+				len = strlen(vstrdata[i]);
+				memcpy(end, vstrdata[i], len);
+			}
+		} else {
+			/* fixed length strings end at the first NUL, if any */
+			nul = memchr(fixed + i * width, '\0', width);
+			len = nul != NULL ? (size_t) (nul - (fixed + i * width))
+			    : width;
+			memcpy(end, fixed + i * width, len);
+		}
+		end += len;
+		*end++ = '\0';
+	}
+	offs[npoints] = (int64_t) (end - *buffer);
+	*count = (int64_t) npoints;
+
+	if (is_vlen_str) {
+		H5Dvlen_reclaim(memtype_id, pFile->iCurrentS, H5P_DEFAULT,
+				vstrdata);
+		free(vstrdata);
+	}
+	free(fixed);
+	H5Tclose(memtype_id);
+	return NX_OK;
+}
+
+   /*-------------------------------------------------------------------------*/
+
+/*
+ * the length of the longest of the n variable length strings of the open
+ * dataset, with one plain read: H5Dvlen_get_buf_size costs more and fails
+ * on scalar dataspaces with some HDF5 versions
+ */
+static NXstatus NXI5vlenmaxlen(pNexusFile5 pFile, hssize_t n, hsize_t * max)
+{
+	hid_t memtype_id;
+	char **vstrdata;
+	hssize_t i;
+	size_t len, maxlen = 0;
+
+	vstrdata = (char **)calloc(n > 0 ? (size_t) n : 1, sizeof(char *));
+	if (vstrdata == NULL) {
+		NXReportError("ERROR: out of memory reading string lengths");
+		return NX_ERROR;
+	}
+	memtype_id = H5Tcopy(H5T_C_S1);
+	H5Tset_size(memtype_id, H5T_VARIABLE);
+	if (H5Dread(pFile->iCurrentD, memtype_id, H5S_ALL, H5S_ALL,
+		    pFile->iXfer, vstrdata) >= 0) {
+		for (i = 0; i < n; i++) {
+			len = vstrdata[i] != NULL ? strlen(vstrdata[i]) : 0;
+			if (len > maxlen)
+				maxlen = len;
+		}
+		H5Dvlen_reclaim(memtype_id, pFile->iCurrentS, H5P_DEFAULT,
+				vstrdata);
+	}
+	free(vstrdata);
+	H5Tclose(memtype_id);
+	*max = (hsize_t) maxlen;
+	return NX_OK;
+}
+
+   /*-------------------------------------------------------------------------*/
+
 NXstatus NX5getinfo64(NXhandle fid, int *rank, int64_t dimension[], int *iType)
 {
 	pNexusFile5 pFile;
 	int i, iRank, mType;
-	hsize_t myDim[H5S_MAX_RANK], vlen_bytes = 0, total_dims_size = 1;
+	hsize_t myDim[H5S_MAX_RANK], total_dims_size = 1;
 	H5T_class_t tclass;
 
 	pFile = NXI5assert(fid);
@@ -1927,10 +2582,11 @@ NXstatus NX5getinfo64(NXhandle fid, int *rank, int64_t dimension[], int *iType)
 	*iType = (int)mType;
 	if (tclass == H5T_STRING && myDim[iRank - 1] == 1) {
 		if (H5Tis_variable_str(pFile->iCurrentT)) {
-			/* this would not work for ragged arrays */
-			H5Dvlen_get_buf_size(pFile->iCurrentD, pFile->iCurrentT,
-					     pFile->iCurrentS, &vlen_bytes);
-			myDim[iRank - 1] = vlen_bytes / total_dims_size;
+			/* the longest, so ragged arrays fit as well */
+			if (NXI5vlenmaxlen(pFile, (hssize_t) total_dims_size,
+					   &myDim[iRank - 1]) != NX_OK) {
+				return NX_ERROR;
+			}
 		} else {
 			myDim[iRank - 1] = H5Tget_size(pFile->iCurrentT);
 		}
@@ -1981,7 +2637,7 @@ NXstatus NX5getslab64(NXhandle fid, void *data, const int64_t iStart[],
 		H5Sselect_all(filespace);
 		iRet =
 		    H5Dread(pFile->iCurrentD, memtype_id, memspace, filespace,
-			    H5P_DEFAULT, data);
+			    pFile->iXfer, data);
 		H5Sclose(filespace);
 	} else {
 
@@ -2029,19 +2685,18 @@ NXstatus NX5getslab64(NXhandle fid, void *data, const int64_t iStart[],
 		if (mtype == NX_CHAR) {
 			iRet =
 			    H5Dread(pFile->iCurrentD, memtype_id, H5S_ALL,
-				    H5S_ALL, H5P_DEFAULT, tmp_data);
+				    H5S_ALL, pFile->iXfer, tmp_data);
 			data1 = tmp_data + myStart[0];
 			strncpy((char *)data, data1, (size_t) iSize[0]);
 			free(tmp_data);
 		} else {
 			iRet =
 			    H5Dread(pFile->iCurrentD, memtype_id, memspace,
-				    pFile->iCurrentS, H5P_DEFAULT, data);
+				    pFile->iCurrentS, pFile->iXfer, data);
 		}
 	}
 	/* cleanup */
 	H5Sclose(memspace);
-	H5Tclose(tclass);
 
 	if (iRet < 0) {
 		NXReportError("ERROR: reading slab failed");
@@ -2050,6 +2705,732 @@ NXstatus NX5getslab64(NXhandle fid, void *data, const int64_t iStart[],
 	return NX_OK;
 }
 
+   /*-------------------------------------------------------------------------
+     Read many slabs in one driver call. When the slabs lie close together
+     their bounding box is read with a single H5Dread and the slabs are
+     copied out of it in memory. Otherwise the slabs are read one by one,
+     but without the per call type lookup and dataspace setup of
+     NX5getslab64. Combined OR and point selections were measured to be
+     slower than either strategy with HDF5 1.8/1.10.
+     -------------------------------------------------------------------------*/
+
+#define NX5_SLABS_MAX_BBOX (16*1024*1024)	/* bytes */
+#define NX5_SLABS_BBOX_FILL 8	/* max bounding box to slab volume ratio */
+
+static void NX5copyslab(char *dest, const char *bbox, int iRank,
+			const hsize_t bboxStart[], const hsize_t bboxSize[],
+			const int64_t iStart[], const int64_t iSize[],
+			size_t elsize)
+{
+	hsize_t idx[H5S_MAX_RANK], offset;
+	size_t rowbytes;
+	int j;
+
+	rowbytes = (size_t) iSize[iRank - 1] * elsize;
+	for (j = 0; j < iRank; j++) {
+		idx[j] = 0;
+	}
+	do {
+		offset = 0;
+		for (j = 0; j < iRank; j++) {
+			offset = offset * bboxSize[j] +
+			    (hsize_t) iStart[j] + idx[j] - bboxStart[j];
+		}
+		memcpy(dest, bbox + offset * elsize, rowbytes);
+		dest += rowbytes;
+		for (j = iRank - 2; j >= 0; j--) {
+			if (++idx[j] < (hsize_t) iSize[j]) {
+				break;
+			}
+			idx[j] = 0;
+		}
+	} while (j >= 0);
+}
+
+NXstatus NX5getslabs64(NXhandle fid, int nslab, const int64_t * iStart[],
+		       const int64_t * iSize[], void *data[])
+{
+	pNexusFile5 pFile;
+	hsize_t myDim[H5S_MAX_RANK], myStart[H5S_MAX_RANK];
+	hsize_t mySize[H5S_MAX_RANK], bboxStart[H5S_MAX_RANK], bboxSize[H5S_MAX_RANK];
+	hsize_t npoints, nslabpoints, nbbox;
+	hid_t memspace = -1, memtype_id;
+	herr_t iRet = 0;
+	size_t elsize;
+	char *bbox;
+	int i, j, iRank, first, newspace;
+
+	pFile = NXI5assert(fid);
+	/* check if there is an Dataset open */
+	if (pFile->iCurrentD == 0) {
+		NXReportError("ERROR: no dataset open");
+		return NX_ERROR;
+	}
+	iRank = H5Sget_simple_extent_ndims(pFile->iCurrentS);
+	if (iRank == 0 || H5Tget_class(pFile->iCurrentT) == H5T_STRING) {
+		for (i = 0; i < nslab; i++) {
+			if (NX5getslab64(fid, data[i], iStart[i], iSize[i]) !=
+			    NX_OK) {
+				return NX_ERROR;
+			}
+		}
+		return NX_OK;
+	}
+	memtype_id = h5MemType(pFile->iCurrentT);
+	if (memtype_id < 0) {
+		return NX_ERROR;
+	}
+	elsize = H5Tget_size(memtype_id);
+	H5Sget_simple_extent_dims(pFile->iCurrentS, myDim, NULL);
+
+	/* validate the slabs, find their bounding box and volume */
+	npoints = 0;
+	first = 1;
+	for (i = 0; i < nslab; i++) {
+		nslabpoints = 1;
+		for (j = 0; j < iRank; j++) {
+			if (iStart[i][j] < 0 || iSize[i][j] < 0 ||
+			    (hsize_t) (iStart[i][j] + iSize[i][j]) > myDim[j]) {
+				NXReportError
+				    ("ERROR: slab exceeds dataset dimensions");
+				return NX_ERROR;
+			}
+			nslabpoints *= (hsize_t) iSize[i][j];
+		}
+		if (nslabpoints == 0) {
+			continue;
+		}
+		for (j = 0; j < iRank; j++) {
+			hsize_t lo = (hsize_t) iStart[i][j];
+			hsize_t hi = lo + (hsize_t) iSize[i][j];
+			if (first || lo < bboxStart[j]) {
+				if (!first) {
+					bboxSize[j] += bboxStart[j] - lo;
+				}
+				bboxStart[j] = lo;
+			}
+			if (first || hi > bboxStart[j] + bboxSize[j]) {
+				bboxSize[j] = hi - bboxStart[j];
+			}
+		}
+		first = 0;
+		npoints += nslabpoints;
+	}
+	if (npoints == 0) {
+		return NX_OK;
+	}
+	nbbox = 1;
+	for (j = 0; j < iRank; j++) {
+		nbbox *= bboxSize[j];
+	}
+
+	if (nbbox * elsize <= NX5_SLABS_MAX_BBOX &&
+	    nbbox <= NX5_SLABS_BBOX_FILL * npoints) {
+		bbox = (char *)malloc((size_t) nbbox * elsize);
+		if (bbox == NULL) {
+			NXReportError("ERROR: out of memory reading slabs");
+			return NX_ERROR;
+		}
+		iRet = H5Sselect_hyperslab(pFile->iCurrentS, H5S_SELECT_SET,
+					   bboxStart, NULL, bboxSize, NULL);
+		if (iRet >= 0) {
+			memspace = H5Screate_simple(iRank, bboxSize, NULL);
+			iRet = H5Dread(pFile->iCurrentD, memtype_id, memspace,
+				       pFile->iCurrentS, H5P_DEFAULT, bbox);
+			H5Sclose(memspace);
+		}
+		if (iRet < 0) {
+			NXReportError("ERROR: reading slabs failed");
+			free(bbox);
+			return NX_ERROR;
+		}
+		for (i = 0; i < nslab; i++) {
+			for (j = 0; j < iRank; j++) {
+				if (iSize[i][j] == 0) {
+					break;
+				}
+			}
+			if (j == iRank) {
+				NX5copyslab((char *)data[i], bbox, iRank,
+					    bboxStart, bboxSize, iStart[i],
+					    iSize[i], elsize);
+			}
+		}
+		free(bbox);
+		return NX_OK;
+	}
+
+	/* sparse slabs: one read each, sharing the memory dataspace */
+	for (i = 0; i < nslab && iRet >= 0; i++) {
+		newspace = (memspace < 0);
+		nslabpoints = 1;
+		for (j = 0; j < iRank; j++) {
+			if (!newspace && mySize[j] != (hsize_t) iSize[i][j]) {
+				newspace = 1;
+			}
+			myStart[j] = (hsize_t) iStart[i][j];
+			mySize[j] = (hsize_t) iSize[i][j];
+			nslabpoints *= mySize[j];
+		}
+		if (nslabpoints == 0) {
+			continue;
+		}
+		if (newspace) {
+			if (memspace >= 0) {
+				H5Sclose(memspace);
+			}
+			memspace = H5Screate_simple(iRank, mySize, NULL);
+		}
+		iRet = H5Sselect_hyperslab(pFile->iCurrentS, H5S_SELECT_SET,
+					   myStart, NULL, mySize, NULL);
+		if (iRet >= 0) {
+			iRet = H5Dread(pFile->iCurrentD, memtype_id, memspace,
+				       pFile->iCurrentS, H5P_DEFAULT, data[i]);
+		}
+	}
+	if (memspace >= 0) {
+		H5Sclose(memspace);
+	}
+	if (iRet < 0) {
+		NXReportError("ERROR: reading slabs failed");
+		return NX_ERROR;
+	}
+	return NX_OK;
+}
+
+   /*-------------------------------------------------------------------------*/
+
+NXstatus NX5getslab64s(NXhandle fid, void *data, const int64_t iStart[],
+		       const int64_t iSize[], const int64_t iStride[],
+		       const int64_t iBlock[])
+{
+	pNexusFile5 pFile;
+	hsize_t myStart[H5S_MAX_RANK], myCount[H5S_MAX_RANK];
+	hsize_t myStride[H5S_MAX_RANK], myBlock[H5S_MAX_RANK];
+	hsize_t mySize[H5S_MAX_RANK];
+	hid_t memspace, memtype_id;
+	herr_t iRet;
+	int i, iRank, trivial = 1;
+
+	pFile = NXI5assert(fid);
+	/* check if there is an Dataset open */
+	if (pFile->iCurrentD == 0) {
+		NXReportError("ERROR: no dataset open");
+		return NX_ERROR;
+	}
+	iRank = H5Sget_simple_extent_ndims(pFile->iCurrentS);
+	for (i = 0; i < iRank; i++) {
+		myStart[i] = (hsize_t) iStart[i];
+		myCount[i] = (hsize_t) iSize[i];
+		myStride[i] = (iStride == NULL) ? 1 : (hsize_t) iStride[i];
+		myBlock[i] = (iBlock == NULL) ? 1 : (hsize_t) iBlock[i];
+		mySize[i] = myCount[i] * myBlock[i];
+		if (myStride[i] != 1 || myBlock[i] != 1) {
+			trivial = 0;
+		}
+		if (mySize[i] == 0) {
+			return NX_OK;
+		}
+	}
+	if (trivial) {
+		return NX5getslab64(fid, data, iStart, iSize);
+	}
+	if (H5Tget_class(pFile->iCurrentT) == H5T_STRING) {
+		NXReportError("ERROR: strided reads of strings are not supported");
+		return NX_ERROR;
+	}
+	memtype_id = h5MemType(pFile->iCurrentT);
+	if (memtype_id < 0) {
+		return NX_ERROR;
+	}
+
+	iRet = H5Sselect_hyperslab(pFile->iCurrentS, H5S_SELECT_SET, myStart,
+				   myStride, myCount, myBlock);
+	if (iRet < 0) {
+		NXReportError("ERROR: selecting strided slab failed");
+		return NX_ERROR;
+	}
+	memspace = H5Screate_simple(iRank, mySize, NULL);
+	iRet = H5Dread(pFile->iCurrentD, memtype_id, memspace,
+		       pFile->iCurrentS, H5P_DEFAULT, data);
+	H5Sclose(memspace);
+	if (iRet < 0) {
+		NXReportError("ERROR: reading strided slab failed");
+		return NX_ERROR;
+	}
+	return NX_OK;
+}
+
+   /*-------------------------------------------------------------------------*/
+
+NXstatus NX5getpoints64(NXhandle fid, void *data, int64_t npoints,
+			const int64_t coords[])
+{
+	pNexusFile5 pFile;
+	hsize_t *coord, count;
+	hid_t memspace, memtype_id;
+	herr_t iRet;
+	int64_t i;
+	int iRank;
+
+	pFile = NXI5assert(fid);
+	/* check if there is an Dataset open */
+	if (pFile->iCurrentD == 0) {
+		NXReportError("ERROR: no dataset open");
+		return NX_ERROR;
+	}
+	if (H5Tget_class(pFile->iCurrentT) == H5T_STRING) {
+		NXReportError("ERROR: point reads of strings are not supported");
+		return NX_ERROR;
+	}
+	iRank = H5Sget_simple_extent_ndims(pFile->iCurrentS);
+	if (iRank == 0) {
+		NXReportError("ERROR: point reads need a dataset of rank >= 1");
+		return NX_ERROR;
+	}
+	memtype_id = h5MemType(pFile->iCurrentT);
+	if (memtype_id < 0) {
+		return NX_ERROR;
+	}
+
+	coord = (hsize_t *) malloc((size_t) (npoints * iRank) * sizeof(hsize_t));
+	if (coord == NULL) {
+		NXReportError("ERROR: out of memory reading points");
+		return NX_ERROR;
+	}
+	for (i = 0; i < npoints * iRank; i++) {
+		coord[i] = (hsize_t) coords[i];
+	}
+	iRet = H5Sselect_elements(pFile->iCurrentS, H5S_SELECT_SET,
+				  (size_t) npoints, coord);
+	free(coord);
+	if (iRet < 0) {
+		NXReportError("ERROR: selecting points failed");
+		return NX_ERROR;
+	}
+	count = (hsize_t) npoints;
+	memspace = H5Screate_simple(1, &count, NULL);
+	iRet = H5Dread(pFile->iCurrentD, memtype_id, memspace,
+		       pFile->iCurrentS, H5P_DEFAULT, data);
+	H5Sclose(memspace);
+	if (iRet < 0) {
+		NXReportError("ERROR: reading points failed");
+		return NX_ERROR;
+	}
+	return NX_OK;
+}
+
+   /*-------------------------------------------------------------------------
+     Direct chunk access: chunks are moved between memory and file exactly
+     as they are stored, bypassing the filter pipeline.
+     -------------------------------------------------------------------------*/
+
+#ifdef NX5_DIRECT_CHUNKS
+static int NX5chunkrank(pNexusFile5 pFile, hsize_t chunkdims[])
+{
+	hid_t cparms;
+	int rank = -1;
+
+	/* check if there is an Dataset open */
+	if (pFile->iCurrentD == 0) {
+		NXReportError("ERROR: no dataset open");
+		return -1;
+	}
+	cparms = H5Dget_create_plist(pFile->iCurrentD);
+	if (cparms < 0) {
+		NXReportError("ERROR: cannot get dataset creation properties");
+		return -1;
+	}
+	if (H5Pget_layout(cparms) == H5D_CHUNKED) {
+		rank = H5Pget_chunk(cparms, H5S_MAX_RANK, chunkdims);
+	} else {
+		NXReportError("ERROR: dataset is not chunked");
+	}
+	H5Pclose(cparms);
+	return rank;
+}
+
+static NXstatus NX5chunkoffset(const int64_t offset[], int rank,
+			       const hsize_t chunkdims[], const hsize_t dims[],
+			       const hsize_t maxdims[], hsize_t myOffset[])
+{
+	int i;
+
+	for (i = 0; i < rank; i++) {
+		if (offset[i] < 0 || (hsize_t) offset[i] % chunkdims[i] != 0) {
+			NXReportError
+			    ("ERROR: chunk offset is not on a chunk boundary");
+			return NX_ERROR;
+		}
+		if ((hsize_t) offset[i] >= dims[i] &&
+		    (maxdims == NULL || maxdims[i] != H5S_UNLIMITED)) {
+			NXReportError("ERROR: chunk offset beyond dataset");
+			return NX_ERROR;
+		}
+		myOffset[i] = (hsize_t) offset[i];
+	}
+	return NX_OK;
+}
+#endif				/* NX5_DIRECT_CHUNKS */
+
+NXstatus NX5putchunk64(NXhandle fid, const int64_t offset[],
+		       unsigned int filter_mask, const void *data,
+		       int64_t nbytes)
+{
+#ifdef NX5_DIRECT_CHUNKS
+	pNexusFile5 pFile;
+	hsize_t chunkdims[H5S_MAX_RANK], myOffset[H5S_MAX_RANK];
+	hsize_t thedims[H5S_MAX_RANK], maxdims[H5S_MAX_RANK];
+	hsize_t size[H5S_MAX_RANK];
+	int i, rank, extend = 0;
+
+	pFile = NXI5assert(fid);
+	rank = NX5chunkrank(pFile, chunkdims);
+	if (rank < 0) {
+		return NX_ERROR;
+	}
+	if (H5Sget_simple_extent_dims(pFile->iCurrentS, thedims, maxdims) < 0) {
+		NXReportError("ERROR: cannot get dimensions");
+		return NX_ERROR;
+	}
+	if (NX5chunkoffset(offset, rank, chunkdims, thedims, maxdims,
+			   myOffset) != NX_OK) {
+		return NX_ERROR;
+	}
+	/* unlimited dimensions grow to take the whole chunk */
+	for (i = 0; i < rank; i++) {
+		size[i] = thedims[i];
+		if (maxdims[i] == H5S_UNLIMITED &&
+		    myOffset[i] + chunkdims[i] > thedims[i]) {
+			size[i] = myOffset[i] + chunkdims[i];
+			extend = 1;
+		}
+	}
+	if (extend) {
+		if (H5Dset_extent(pFile->iCurrentD, size) < 0) {
+			NXReportError("ERROR: extending dataset for chunk failed");
+			return NX_ERROR;
+		}
+		H5Sclose(pFile->iCurrentS);
+		pFile->iCurrentS = H5Dget_space(pFile->iCurrentD);
+	}
+	if (H5Dwrite_chunk(pFile->iCurrentD, H5P_DEFAULT, filter_mask,
+			   myOffset, (size_t) nbytes, data) < 0) {
+		NXReportError("ERROR: writing chunk failed");
+		return NX_ERROR;
+	}
+	/*
+	   HDF5 1.10 caches a wrong filter mask for a chunk written with a non
+	   zero mask, so reading it through the filters fails until the dataset
+	   is opened again.
+	 */
+	if (filter_mask != 0 && pFile->iCurrentLD != NULL) {
+		H5Dclose(pFile->iCurrentD);
+		pFile->iCurrentD = H5Dopen(pFile->iCurrentG, pFile->iCurrentLD,
+					   H5P_DEFAULT);
+		if (pFile->iCurrentD < 0) {
+			NXReportError("ERROR: reopening dataset failed");
+			pFile->iCurrentD = 0;
+			return NX_ERROR;
+		}
+	}
+	return NX_OK;
+#else
+	NXReportError("ERROR: direct chunk access needs HDF5 1.10.5 or newer");
+	return NX_ERROR;
+#endif
+}
+
+   /*-------------------------------------------------------------------------*/
+
+NXstatus NX5getchunk64(NXhandle fid, const int64_t offset[],
+		       unsigned int *filter_mask, void *data, int64_t * nbytes)
+{
+#ifdef NX5_DIRECT_CHUNKS
+	pNexusFile5 pFile;
+	hsize_t chunkdims[H5S_MAX_RANK], myOffset[H5S_MAX_RANK];
+	hsize_t thedims[H5S_MAX_RANK], storage = 0;
+	uint32_t mask = 0;
+	int rank;
+
+	pFile = NXI5assert(fid);
+	rank = NX5chunkrank(pFile, chunkdims);
+	if (rank < 0) {
+		return NX_ERROR;
+	}
+	if (H5Sget_simple_extent_dims(pFile->iCurrentS, thedims, NULL) < 0) {
+		NXReportError("ERROR: cannot get dimensions");
+		return NX_ERROR;
+	}
+	if (NX5chunkoffset(offset, rank, chunkdims, thedims, NULL,
+			   myOffset) != NX_OK) {
+		return NX_ERROR;
+	}
+	if (H5Dget_chunk_storage_size(pFile->iCurrentD, myOffset, &storage) < 0) {
+		NXReportError("ERROR: cannot get chunk size");
+		return NX_ERROR;
+	}
+	if (data != NULL && storage > (hsize_t) * nbytes) {
+		NXReportError("ERROR: buffer too small for chunk");
+		*nbytes = (int64_t) storage;
+		return NX_ERROR;
+	}
+	*nbytes = (int64_t) storage;
+	/* chunks never written have no storage and nothing to read */
+	if (data == NULL || storage == 0) {
+		if (filter_mask != NULL) {
+			*filter_mask = 0;
+		}
+		return NX_OK;
+	}
+	if (H5Dread_chunk(pFile->iCurrentD, H5P_DEFAULT, myOffset, &mask,
+			  data) < 0) {
+		NXReportError("ERROR: reading chunk failed");
+		return NX_ERROR;
+	}
+	if (filter_mask != NULL) {
+		*filter_mask = mask;
+	}
+	return NX_OK;
+#else
+	NXReportError("ERROR: direct chunk access needs HDF5 1.10.5 or newer");
+	return NX_ERROR;
+#endif
+}
+
+   /*-------------------------------------------------------------------------*/
+
+NXstatus NX5getchunkcount64(NXhandle fid, int64_t * nchunks)
+{
+#ifdef NX5_DIRECT_CHUNKS
+	pNexusFile5 pFile;
+	hsize_t chunkdims[H5S_MAX_RANK], n;
+	hid_t filespace;
+	herr_t iRet;
+
+	pFile = NXI5assert(fid);
+	if (NX5chunkrank(pFile, chunkdims) < 0) {
+		return NX_ERROR;
+	}
+	/* older HDF5 1.10 do not take H5S_ALL here */
+	filespace = H5Dget_space(pFile->iCurrentD);
+	iRet = H5Dget_num_chunks(pFile->iCurrentD, filespace, &n);
+	H5Sclose(filespace);
+	if (iRet < 0) {
+		NXReportError("ERROR: cannot get number of chunks");
+		return NX_ERROR;
+	}
+	*nchunks = (int64_t) n;
+	return NX_OK;
+#else
+	NXReportError("ERROR: direct chunk access needs HDF5 1.10.5 or newer");
+	return NX_ERROR;
+#endif
+}
+
+   /*-------------------------------------------------------------------------*/
+
+NXstatus NX5getchunkinfo64(NXhandle fid, int64_t index, int64_t offset[],
+			   unsigned int *filter_mask, int64_t * nbytes)
+{
+#ifdef NX5_DIRECT_CHUNKS
+	pNexusFile5 pFile;
+	hsize_t chunkdims[H5S_MAX_RANK], myOffset[H5S_MAX_RANK], size;
+	haddr_t addr;
+	hid_t filespace;
+	herr_t iRet;
+	unsigned int mask;
+	int i, rank;
+
+	pFile = NXI5assert(fid);
+	rank = NX5chunkrank(pFile, chunkdims);
+	if (rank < 0) {
+		return NX_ERROR;
+	}
+	filespace = H5Dget_space(pFile->iCurrentD);
+	iRet = H5Dget_chunk_info(pFile->iCurrentD, filespace, (hsize_t) index,
+				 myOffset, &mask, &addr, &size);
+	H5Sclose(filespace);
+	if (iRet < 0) {
+		NXReportError("ERROR: cannot get chunk information");
+		return NX_ERROR;
+	}
+	for (i = 0; i < rank; i++) {
+		offset[i] = (int64_t) myOffset[i];
+	}
+	if (filter_mask != NULL) {
+		*filter_mask = mask;
+	}
+	if (nbytes != NULL) {
+		*nbytes = (int64_t) size;
+	}
+	return NX_OK;
+#else
+	NXReportError("ERROR: direct chunk access needs HDF5 1.10.5 or newer");
+	return NX_ERROR;
+#endif
+}
+
+NXstatus NX5getchunkdims64(NXhandle fid, int *rank, int64_t chunk[])
+{
+	pNexusFile5 pFile;
+	hsize_t chunkdims[H5S_MAX_RANK];
+	hid_t cparms;
+	int i;
+
+	pFile = NXI5assert(fid);
+	if (pFile->iCurrentD == 0) {
+		NXReportError("ERROR: no dataset open");
+		return NX_ERROR;
+	}
+	cparms = H5Dget_create_plist(pFile->iCurrentD);
+	if (cparms < 0) {
+		NXReportError("ERROR: cannot get dataset creation properties");
+		return NX_ERROR;
+	}
+	*rank = 0;
+	if (H5Pget_layout(cparms) == H5D_CHUNKED) {
+		*rank = H5Pget_chunk(cparms, NX_MAXRANK, chunkdims);
+		if (*rank < 0) {
+			*rank = 0;
+		}
+		for (i = 0; i < *rank; i++) {
+			chunk[i] = (int64_t) chunkdims[i];
+		}
+	}
+	H5Pclose(cparms);
+	return NX_OK;
+}
+
+/*-------------------------------------------------------------------------
+  Object handles keep their own group or dataset identifiers. While a call
+  runs on an object, the object stands in for the open group or dataset;
+  the identifiers it replaces are saved in the object meanwhile.
+  -------------------------------------------------------------------------*/
+typedef struct {
+	hid_t iObject;
+	hid_t iSpace;
+	hid_t iType;
+	int isGroup;
+	hid_t iSavedG;
+	hid_t iSavedD;
+	hid_t iSavedS;
+	hid_t iSavedT;
+} NX5object, *pNX5object;
+
+NXstatus NX5objclose(NXhandle fid, void *object)
+{
+	pNX5object pObj = (pNX5object) object;
+	herr_t iRet = 0;
+
+	NXI5assert(fid);
+	if (pObj->iSpace > 0) {
+		H5Sclose(pObj->iSpace);
+	}
+	if (pObj->iType > 0) {
+		H5Tclose(pObj->iType);
+	}
+	if (pObj->iObject > 0) {
+		iRet = H5Oclose(pObj->iObject);
+	}
+	free(pObj);
+	if (iRet < 0) {
+		NXReportError("ERROR: cannot end access to object");
+		return NX_ERROR;
+	}
+	return NX_OK;
+}
+
+NXstatus NX5objopen(NXhandle fid, CONSTCHAR * path, void **object)
+{
+	pNexusFile5 pFile;
+	pNX5object pObj;
+	hid_t loc;
+	H5I_type_t itype;
+	char pBuffer[256];
+
+	pFile = NXI5assert(fid);
+	if (path[0] == '/' || pFile->iCurrentG == 0) {
+		loc = pFile->iFID;
+	} else {
+		loc = pFile->iCurrentG;
+	}
+	pObj = (pNX5object) calloc(1, sizeof(NX5object));
+	if (pObj == NULL) {
+		NXReportError("ERROR: no memory for object");
+		return NX_ERROR;
+	}
+	pObj->iObject = H5Oopen(loc, path, H5P_DEFAULT);
+	if (pObj->iObject < 0) {
+		free(pObj);
+		snprintf(pBuffer, sizeof(pBuffer) - 1,
+			 "ERROR: object \"%s\" not found", path);
+		NXReportError(pBuffer);
+		return NX_ERROR;
+	}
+	itype = H5Iget_type(pObj->iObject);
+	if (itype == H5I_GROUP) {
+		pObj->isGroup = 1;
+	} else if (itype == H5I_DATASET) {
+		pObj->iType = H5Dget_type(pObj->iObject);
+		pObj->iSpace = H5Dget_space(pObj->iObject);
+		if (pObj->iType < 0 || pObj->iSpace < 0) {
+			NX5objclose(fid, pObj);
+			NXReportError("ERROR: error opening dataset");
+			return NX_ERROR;
+		}
+	} else {
+		NX5objclose(fid, pObj);
+		snprintf(pBuffer, sizeof(pBuffer) - 1,
+			 "ERROR: \"%s\" is neither a group nor a dataset",
+			 path);
+		NXReportError(pBuffer);
+		return NX_ERROR;
+	}
+	*object = pObj;
+	return NX_OK;
+}
+
+NXstatus NX5objenter(NXhandle fid, void *object)
+{
+	pNexusFile5 pFile;
+	pNX5object pObj = (pNX5object) object;
+
+	pFile = NXI5assert(fid);
+	pObj->iSavedG = pFile->iCurrentG;
+	pObj->iSavedD = pFile->iCurrentD;
+	pObj->iSavedS = pFile->iCurrentS;
+	pObj->iSavedT = pFile->iCurrentT;
+	if (pObj->isGroup) {
+		pFile->iCurrentG = pObj->iObject;
+		pFile->iCurrentD = 0;
+		pFile->iCurrentS = 0;
+		pFile->iCurrentT = 0;
+	} else {
+		pFile->iCurrentD = pObj->iObject;
+		pFile->iCurrentS = pObj->iSpace;
+		pFile->iCurrentT = pObj->iType;
+	}
+	return NX_OK;
+}
+
+NXstatus NX5objleave(NXhandle fid, void *object)
+{
+	pNexusFile5 pFile;
+	pNX5object pObj = (pNX5object) object;
+
+	pFile = NXI5assert(fid);
+	if (!pObj->isGroup) {
+		/* NX5putslab64 replaces the dataspace when it extends the dataset */
+		pObj->iSpace = pFile->iCurrentS;
+	}
+	pFile->iCurrentG = pObj->iSavedG;
+	pFile->iCurrentD = pObj->iSavedD;
+	pFile->iCurrentS = pObj->iSavedS;
+	pFile->iCurrentT = pObj->iSavedT;
+	return NX_OK;
+}
+
    /*-------------------------------------------------------------------------*/
 
    /* Operator function. */
@@ -2485,10 +3866,11 @@ NXstatus  NX5getnextattra(NXhandle handle, NXname pName, int *rank, int dim[], i
 NXstatus  NX5getattra(NXhandle handle, char* name, void* data)
 {
 	pNexusFile5 pFile;
-	int i, iStart[H5S_MAX_RANK], status, vid;
+	int iStart[H5S_MAX_RANK], status, vid;
 	hid_t memtype_id, filespace, datatype;
 	H5T_class_t tclass;
 	hsize_t ndims, dims[H5S_MAX_RANK];
+	hssize_t npoints;
 	htri_t is_vlen_str = 0; /* false */
 	char **vstrdata = NULL;
 
@@ -2521,6 +3903,8 @@ NXstatus  NX5getattra(NXhandle handle, char* name, void* data)
 
 		H5Sclose(filespace);
 		H5Tclose(datatype);
+		H5Aclose(pFile->iCurrentA);
+		pFile->iCurrentA = 0;
 		if (status < 0)
 			return NX_ERROR;
 		return NX_OK;
@@ -2530,6 +3914,10 @@ NXstatus  NX5getattra(NXhandle handle, char* name, void* data)
 	if (tclass == H5T_STRING && !is_vlen_str) {
 		char *datatmp = NULL;
 		status = readStringAttribute(pFile->iCurrentA, &datatmp);
+		H5Sclose(filespace);
+		H5Tclose(datatype);
+		H5Aclose(pFile->iCurrentA);
+		pFile->iCurrentA = 0;
 		if (status < 0)
 			return NX_ERROR;
 		strcpy(data, datatmp);
@@ -2540,20 +3928,16 @@ NXstatus  NX5getattra(NXhandle handle, char* name, void* data)
 	memset(iStart, 0, H5S_MAX_RANK * sizeof(int));
 	/* map datatypes of other plateforms */
 	if (is_vlen_str) {
-		vstrdata = (char **)malloc((size_t) dims[0] * sizeof(char *));
+		npoints = H5Sget_simple_extent_npoints(filespace);
+		vstrdata = (char **)malloc((size_t) npoints * sizeof(char *));
 		memtype_id = H5Tcopy(H5T_C_S1);
 		H5Tset_size(memtype_id, H5T_VARIABLE);
 		status = H5Aread(pFile->iCurrentA, memtype_id, vstrdata);
 		((char *)data)[0] = '\0';
 		if (status >= 0) {
-			for (i = 0; i < dims[0]; ++i) {
-				if (vstrdata[i] != NULL) {
-					strcat((char *)data, vstrdata[i]);
-				}
-			}
+			NXI5joinstrings((char *)data, vstrdata, npoints);
 		}
-		H5Dvlen_reclaim(memtype_id, pFile->iCurrentS, H5P_DEFAULT,
-				vstrdata);
+		H5Dvlen_reclaim(memtype_id, filespace, H5P_DEFAULT, vstrdata);
 		free(vstrdata);
 		H5Tclose(memtype_id);
 	} else if (tclass == H5T_STRING) {
@@ -2562,6 +3946,10 @@ NXstatus  NX5getattra(NXhandle handle, char* name, void* data)
 		memtype_id = h5MemType(datatype);
 		status = H5Aread(pFile->iCurrentA, memtype_id, data);
 	}
+	H5Sclose(filespace);
+	H5Tclose(datatype);
+	H5Aclose(pFile->iCurrentA);
+	pFile->iCurrentA = 0;
 	if (status < 0) {
 		NXReportError("ERROR: failed to read attribute");
 		return NX_ERROR;
@@ -2626,20 +4014,315 @@ NXstatus  NX5getattrainfo(NXhandle handle, NXname name, int *rank, int dim[], in
 	}
 	*rank = (int) myrank;
 
+	H5Tclose(attrt);
+	H5Sclose(filespace);
+	H5Aclose(pFile->iCurrentA);
+	pFile->iCurrentA = 0;
 	return NX_OK;
 }
 
+/*------------------------------------------------------------------------*/
+
+/* a group being visited, and the groups above it up to the start */
+typedef struct NXI5visitlevel {
+	unsigned long fileno;
+	haddr_t addr;
+	const char *path;	/* "" for the root */
+	struct NXI5visitlevel *up;
+} NXI5visitlevel;
+
+typedef struct {
+	int flags;
+	NXvisitfunc callback;
+	void *userdata;
+	NXI5visitlevel *level;
+	const char *path;	/* of the object whose attributes are visited */
+	int skipClass;		/* skip its NX_class attribute, it is a group */
+} NXI5visitdata;
+
+/*
+ * the shape of a dataset or attribute as NXgetinfo64 and NXgetattrainfo
+ * report it, except that variable length strings in datasets are not read
+ * to measure them
+ */
+static void NXI5shape(hid_t type, hid_t space, hid_t attr,
+		      NXvisitinfo * info)
+{
+	hsize_t dims[H5S_MAX_RANK + 1];
+	hssize_t i, n;
+	H5T_class_t tclass;
+	char **strings;
+	size_t len;
+	int rank;
+
+	tclass = H5Tget_class(type);
+	info->type = hdf5ToNXType(tclass, type);
+	rank = H5Sget_simple_extent_dims(space, dims, NULL);
+	if (rank < 0) {
+		rank = 0;
+	}
+	if (tclass == H5T_STRING && attr >= 0) {
+		/* attributes get a dimension for the string */
+		dims[rank++] = H5Tget_size(type);
+		if (H5Tis_variable_str(type)) {
+			n = H5Sget_simple_extent_npoints(space);
+			strings = (char **)calloc((size_t) n, sizeof(char *));
+			dims[rank - 1] = 0;
+			if (H5Aread(attr, type, strings) >= 0) {
+				for (i = 0; i < n; i++) {
+					len = strings[i] ? strlen(strings[i]) : 0;
+					if (len > dims[rank - 1]) {
+						dims[rank - 1] = len;
+					}
+				}
+				H5Dvlen_reclaim(type, space, H5P_DEFAULT,
+						strings);
+			}
+			free(strings);
+		}
+	} else if (rank == 0) {
+		dims[rank++] = 1;
+	}
+	if (tclass == H5T_STRING && attr < 0 && dims[rank - 1] == 1
+	    && !H5Tis_variable_str(type)) {
+		dims[rank - 1] = H5Tget_size(type);
+	}
+	info->rank = rank < NX_MAXRANK ? rank : NX_MAXRANK;
+	for (i = 0; i < info->rank; i++) {
+		info->dims[i] = (int64_t) dims[i];
+	}
+}
+
+/* the value of an attribute as NX5getattra reads it, strings terminated */
+static void *NXI5attrvalue(hid_t attr, hid_t type, hid_t space)
+{
+	hssize_t i, npoints;
+	hid_t memtype;
+	char **strings, *text = NULL;
+	void *data;
+	size_t len = 1;
+
+	npoints = H5Sget_simple_extent_npoints(space);
+	if (H5Tget_class(type) != H5T_STRING) {
+		memtype = h5MemType(type);
+		data = malloc((size_t) npoints * H5Tget_size(memtype));
+		if (data != NULL && H5Aread(attr, memtype, data) < 0) {
+			free(data);
+			data = NULL;
+		}
+		return data;
+	}
+	if (!H5Tis_variable_str(type)) {
+		if (readStringAttribute(attr, &text) < 0) {
+			free(text);
+			text = NULL;
+		}
+		return text;
+	}
+	strings = (char **)calloc((size_t) npoints, sizeof(char *));
+	memtype = H5Tcopy(H5T_C_S1);
+	H5Tset_size(memtype, H5T_VARIABLE);
+	if (H5Aread(attr, memtype, strings) >= 0) {
+		for (i = 0; i < npoints; i++) {
+			len += strings[i] != NULL ? strlen(strings[i]) : 0;
+		}
+		text = (char *)malloc(len);
+		NXI5joinstrings(text, strings, npoints);
+		H5Dvlen_reclaim(memtype, space, H5P_DEFAULT, strings);
+	}
+	H5Tclose(memtype);
+	free(strings);
+	return text;
+}
+
+static herr_t NXI5visitattr(hid_t loc_id, const char *name,
+			    const H5A_info_t * ainfo, void *op_data)
+{
+	NXI5visitdata *visit = (NXI5visitdata *) op_data;
+	NXvisitinfo info;
+	hid_t attr, type, space;
+	void *value = NULL;
+	herr_t iRet;
+
+	if (visit->skipClass && strcmp(name, "NX_class") == 0) {
+		return 0;
+	}
+	attr = H5Aopen(loc_id, name, H5P_DEFAULT);
+	if (attr < 0) {
+		return 0;
+	}
+	memset(&info, 0, sizeof(info));
+	info.kind = NXVISIT_ATTRIBUTE;
+	info.path = visit->path;
+	info.name = name;
+	type = H5Aget_type(attr);
+	space = H5Aget_space(attr);
+	NXI5shape(type, space, attr, &info);
+	if (visit->flags & NXVISIT_ATTRIBUTE_VALUES) {
+		info.value = value = NXI5attrvalue(attr, type, space);
+	}
+	H5Sclose(space);
+	H5Tclose(type);
+	H5Aclose(attr);
+	iRet = visit->callback(&info, visit->userdata) != 0 ? 1 : 0;
+	free(value);
+	return iRet;
+}
+
+static herr_t NXI5visitlink(hid_t grp, const char *name,
+			    const H5L_info_t * linfo, void *op_data);
+
+/* visits the links of a group in the order NXgetnextentry lists them */
+static herr_t NXI5visitgroup(hid_t grp, NXI5visitdata * visit,
+			     NXI5visitlevel * level)
+{
+	NXI5visitlevel *above;
+	H5O_info_t oinfo;
+	herr_t iRet;
+
+	if (H5Oget_info(grp, &oinfo) < 0) {
+		return -1;
+	}
+	level->fileno = oinfo.fileno;
+	level->addr = oinfo.addr;
+	/* a link to a group above leads round in circles */
+	for (above = level->up; above != NULL; above = above->up) {
+		if (above->fileno == level->fileno
+		    && above->addr == level->addr) {
+			return 0;
+		}
+	}
+	above = visit->level;
+	visit->level = level;
+	iRet = H5Literate(grp, NXI5linkindex(grp), H5_ITER_INC, NULL,
+			  NXI5visitlink, visit);
+	visit->level = above;
+	return iRet;
+}
+
+/* reports the object a link leads to, and what is below it */
+static herr_t NXI5visitlink(hid_t grp, const char *name,
+			    const H5L_info_t * linfo, void *op_data)
+{
+	NXI5visitdata *visit = (NXI5visitdata *) op_data;
+	NXI5visitlevel level;
+	NXvisitinfo info;
+	char path[NX_MAXPATHLEN], nxclass[NX_MAXNAMELEN];
+	hid_t obj, attr, type, space;
+	herr_t iRet;
+
+	/* dangling soft and external links lead nowhere */
+	obj = H5Oopen(grp, name, H5P_DEFAULT);
+	if (obj < 0) {
+		return 0;
+	}
+	snprintf(path, sizeof(path), "%s/%s", visit->level->path, name);
+	memset(&info, 0, sizeof(info));
+	info.path = path;
+	info.name = name;
+	switch (H5Iget_type(obj)) {
+	case H5I_GROUP:
+		info.kind = NXVISIT_GROUP;
+		strcpy(nxclass, NX_UNKNOWN_GROUP);
+		attr = H5Aopen_by_name(obj, ".", "NX_class", H5P_DEFAULT,
+				       H5P_DEFAULT);
+		if (attr >= 0) {
+			readStringAttributeN(attr, nxclass, sizeof(nxclass));
+			H5Aclose(attr);
+		}
+		info.nxclass = nxclass;
+		break;
+	case H5I_DATASET:
+		info.kind = NXVISIT_DATASET;
+		info.nxclass = "SDS";
+		type = H5Dget_type(obj);
+		space = H5Dget_space(obj);
+		NXI5shape(type, space, -1, &info);
+		H5Sclose(space);
+		H5Tclose(type);
+		break;
+	default:
+		/* named datatypes are not NeXus objects */
+		H5Oclose(obj);
+		return 0;
+	}
+
+	iRet = visit->callback(&info, visit->userdata) != 0 ? 1 : 0;
+	if (iRet == 0 && (visit->flags & NXVISIT_WITH_ATTRIBUTES)) {
+		visit->path = path;
+		visit->skipClass = info.kind == NXVISIT_GROUP;
+		iRet = H5Aiterate(obj, H5_INDEX_NAME, H5_ITER_INC, NULL,
+				  NXI5visitattr, visit);
+	}
+	if (iRet == 0 && info.kind == NXVISIT_GROUP) {
+		level.path = path;
+		level.up = visit->level;
+		iRet = NXI5visitgroup(obj, visit, &level);
+	}
+	H5Oclose(obj);
+	return iRet;
+}
+
+NXstatus NX5visit(NXhandle fid, int flags, NXvisitfunc callback,
+		  void *userdata)
+{
+	pNexusFile5 pFile;
+	NXI5visitdata visit;
+	NXI5visitlevel start;
+	char path[sizeof(((pNexusFile5) NULL)->name_ref) + 1];	/* "/" name_ref */
+	hid_t grp;
+	herr_t iRet = 0;
+
+	pFile = NXI5assert(fid);
+	if (pFile->iCurrentG == 0 || strcmp(pFile->name_ref, "/") == 0) {
+		strcpy(path, "");
+		grp = H5Gopen(pFile->iFID, "/", H5P_DEFAULT);
+	} else {
+		snprintf(path, sizeof(path), "/%s", pFile->name_ref);
+		grp = pFile->iCurrentG;
+	}
+	visit.flags = flags;
+	visit.callback = callback;
+	visit.userdata = userdata;
+	visit.level = NULL;
+	start.path = path;
+	start.up = NULL;
+
+	/* the attributes of the group itself come first */
+	if (flags & NXVISIT_WITH_ATTRIBUTES) {
+		visit.path = strlen(path) > 0 ? path : "/";
+		visit.skipClass = 1;
+		iRet = H5Aiterate(grp, H5_INDEX_NAME, H5_ITER_INC, NULL,
+				  NXI5visitattr, &visit);
+	}
+	if (iRet == 0) {
+		iRet = NXI5visitgroup(grp, &visit, &start);
+	}
+	if (grp != pFile->iCurrentG) {
+		H5Gclose(grp);
+	}
+	if (iRet < 0) {
+		NXReportError("ERROR: visiting the group failed");
+		return NX_ERROR;
+	}
+	return iRet > 0 ? NX_EOD : NX_OK;
+}
+
 /*------------------------------------------------------------------------*/
 void NX5assignFunctions(pNexusFunction fHandle)
 {
 	fHandle->nxclose = NX5close;
 	fHandle->nxreopen = NX5reopen;
 	fHandle->nxflush = NX5flush;
+	fHandle->nxstartswmr = NX5startswmr;
+	fHandle->nxrefresh = NX5refresh;
+	fHandle->nxsetcollective = NX5setcollective;
 	fHandle->nxmakegroup = NX5makegroup;
 	fHandle->nxopengroup = NX5opengroup;
 	fHandle->nxclosegroup = NX5closegroup;
 	fHandle->nxmakedata64 = NX5makedata64;
 	fHandle->nxcompmakedata64 = NX5compmakedata64;
+	fHandle->nxmakevirtual64 = NX5makevirtual64;
 	fHandle->nxcompress = NX5compress;
 	fHandle->nxopendata = NX5opendata;
 	fHandle->nxclosedata = NX5closedata;
@@ -2651,8 +4334,22 @@ void NX5assignFunctions(pNexusFunction fHandle)
 	fHandle->nxmakenamedlink = NX5makenamedlink;
 	fHandle->nxgetdata = NX5getdata;
 	fHandle->nxgetinfo64 = NX5getinfo64;
+	fHandle->nxgetstrings = NX5getstrings;
+	fHandle->nxvisit = NX5visit;
 	fHandle->nxgetnextentry = NX5getnextentry;
 	fHandle->nxgetslab64 = NX5getslab64;
+	fHandle->nxgetslabs64 = NX5getslabs64;
+	fHandle->nxgetslab64s = NX5getslab64s;
+	fHandle->nxgetpoints64 = NX5getpoints64;
+	fHandle->nxputchunk64 = NX5putchunk64;
+	fHandle->nxgetchunk64 = NX5getchunk64;
+	fHandle->nxgetchunkcount64 = NX5getchunkcount64;
+	fHandle->nxgetchunkinfo64 = NX5getchunkinfo64;
+	fHandle->nxgetchunkdims64 = NX5getchunkdims64;
+	fHandle->nxobjopen = NX5objopen;
+	fHandle->nxobjclose = NX5objclose;
+	fHandle->nxobjenter = NX5objenter;
+	fHandle->nxobjleave = NX5objleave;
 	fHandle->nxgetnextattr = NX5getnextattr;
 	fHandle->nxgetattr = NX5getattr;
 	fHandle->nxgetattrinfo = NX5getattrinfo;
@@ -25,12 +25,14 @@
 
  ----------------------------------------------------------------------------*/
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
 #include <string.h>
 #include <time.h>
 #include "napiu.h"
 #include "napi_internal.h"
+#include "nxstack.h"
 
 #define DO_GLOBAL(__name) \
 	if (__name != NULL) \
@@ -109,52 +111,599 @@ static int NXcompress_size = 0;
 	 return status;
  }
 
+/*-------------------------------------------------------------------------
+  The NXUfind functions below look things up in a per handle index of the
+  groups visited so far. A group is listed once, with the signal, axis,
+  primary and axes attributes and the shape of every data item; after that
+  lookups in it need no file access. Any change made through the handle
+  drops the whole index (see dropIndexOnStack in napi.c).
+  -------------------------------------------------------------------------*/
+#define NXU_INDEX_BUCKETS 64
+
+typedef struct {
+	NXname name;
+	NXname nxclass;		/* "SDS" for data items */
+	int signal;		/* 0 when there is no signal attribute */
+	int axis;		/* 0 when there is no axis attribute */
+	int primary;		/* 1 when there is no primary attribute */
+	char *axes;		/* NULL when there is no axes attribute */
+	int rank;
+	int type;
+	int64_t dims[NX_MAXRANK];
+} NXUentry;
+
+typedef struct __NXUgroup {
+	char *path;
+	NXname nxclass;
+	int nentries;
+	NXUentry *entries;
+	struct __NXUgroup *next;
+} NXUgroup, *pNXUgroup;
+
+typedef struct {
+	pNXUgroup buckets[NXU_INDEX_BUCKETS];
+} NXUindex, *pNXUindex;
+
+static unsigned int NXUhash(const char *path)
+{
+	unsigned int h = 5381;
+	while (*path != '\0') {
+		h = h * 33 + (unsigned char)*path++;
+	}
+	return h % NXU_INDEX_BUCKETS;
+}
+
+static void NXUfreeindex(void *data)
+{
+	pNXUindex index = (pNXUindex) data;
+	pNXUgroup group, next;
+	int i, j;
+
+	for (i = 0; i < NXU_INDEX_BUCKETS; i++) {
+		for (group = index->buckets[i]; group != NULL; group = next) {
+			next = group->next;
+			for (j = 0; j < group->nentries; j++) {
+				free(group->entries[j].axes);
+			}
+			free(group->entries);
+			free(group->path);
+			free(group);
+		}
+	}
+	free(index);
+}
+
+/* a dataset is open if NXgetinfo64 works */
+static int NXUisdataopen(NXhandle file_id)
+{
+	int rank, type, status;
+	int64_t dims[NX_MAXRANK];
+
+	NXMDisableErrorReporting();
+	status = NXgetinfo64(file_id, &rank, dims, &type);
+	NXMEnableErrorReporting();
+	return status == NX_OK;
+}
+
+/*
+  reads attribute name of the open group or data item. Numbers go to
+  value, strings to a newly allocated text; returns 0 if there is no
+  such attribute
+ */
+static int NXUreadattr(NXhandle file_id, const char *name, int *value,
+		       char **text)
+{
+	NXname aname;
+	int rank, type, dim[NX_MAXRANK], i, status;
+	size_t n = 1;
+	union {
+		int8_t i8;
+		uint8_t u8;
+		int16_t i16;
+		uint16_t u16;
+		int32_t i32;
+		uint32_t u32;
+		int64_t i64;
+		uint64_t u64;
+		float f32;
+		double f64;
+	} *number;
+	char *buffer;
+
+	strncpy(aname, name, sizeof(NXname) - 1);
+	aname[sizeof(NXname) - 1] = '\0';
+	NXMDisableErrorReporting();
+	status = NXgetattrainfo(file_id, aname, &rank, dim, &type);
+	NXMEnableErrorReporting();
+	if (status != NX_OK) {
+		return 0;
+	}
+	for (i = 0; i < rank; i++) {
+		n *= (size_t) dim[i];
+	}
+	buffer = (char *)malloc(n * sizeof(*number) + 1);
+	if (buffer == NULL) {
+		return 0;
+	}
+	memset(buffer, 0, n * sizeof(*number) + 1);
+	if (NXgetattra(file_id, aname, buffer) != NX_OK) {
+		free(buffer);
+		return 0;
+	}
+	if (type == NX_CHAR) {
+		if (text != NULL) {
+			*text = buffer;
+		} else {
+			*value = atoi(buffer);
+			free(buffer);
+		}
+		return 1;
+	}
+	number = (void *)buffer;
+	switch (type) {
+	case NX_INT8:
+		*value = number->i8;
+		break;
+	case NX_UINT8:
+		*value = number->u8;
+		break;
+	case NX_INT16:
+		*value = number->i16;
+		break;
+	case NX_UINT16:
+		*value = number->u16;
+		break;
+	case NX_INT32:
+		*value = number->i32;
+		break;
+	case NX_UINT32:
+		*value = (int)number->u32;
+		break;
+	case NX_INT64:
+		*value = (int)number->i64;
+		break;
+	case NX_UINT64:
+		*value = (int)number->u64;
+		break;
+	case NX_FLOAT32:
+		*value = (int)number->f32;
+		break;
+	case NX_FLOAT64:
+		*value = (int)number->f64;
+		break;
+	default:
+		free(buffer);
+		return 0;
+	}
+	free(buffer);
+	if (text != NULL) {
+		*text = NULL;
+	}
+	return 1;
+}
+
+/* lists the open group: names and classes first, then the data items */
+static pNXUgroup NXUscangroup(NXhandle file_id, const char *path)
+{
+	pNXUgroup group;
+	NXUentry *entry;
+	NXname name, nxclass;
+	int i, n, type, capacity = 16, status;
+	char *signal = NULL, *axes = NULL;
+
+	group = (pNXUgroup) calloc(1, sizeof(NXUgroup));
+	if (group == NULL) {
+		NXReportError("ERROR: out of memory indexing group");
+		return NULL;
+	}
+	group->path = strdup(path);
+	group->entries = (NXUentry *) malloc(capacity * sizeof(NXUentry));
+	if (group->path == NULL || group->entries == NULL) {
+		NXReportError("ERROR: out of memory indexing group");
+		goto error;
+	}
+	if (NXgetgroupinfo(file_id, &n, name, group->nxclass) != NX_OK
+	    || NXinitgroupdir(file_id) != NX_OK) {
+		goto error;
+	}
+	while ((status = NXgetnextentry(file_id, name, nxclass, &type)) == NX_OK) {
+		if (group->nentries == capacity) {
+			capacity *= 2;
+			entry = (NXUentry *) realloc(group->entries,
+						     capacity * sizeof(NXUentry));
+			if (entry == NULL) {
+				NXReportError("ERROR: out of memory indexing group");
+				goto error;
+			}
+			group->entries = entry;
+		}
+		entry = group->entries + group->nentries++;
+		memset(entry, 0, sizeof(NXUentry));
+		strcpy(entry->name, name);
+		strcpy(entry->nxclass, nxclass);
+		entry->primary = 1;
+	}
+	if (status == NX_ERROR) {
+		goto error;
+	}
+
+	for (i = 0; i < group->nentries; i++) {
+		entry = group->entries + i;
+		if (strcmp(entry->nxclass, "SDS") != 0) {
+			continue;
+		}
+		if (NXopendata(file_id, entry->name) != NX_OK) {
+			goto error;
+		}
+		status = NXgetinfo64(file_id, &entry->rank, entry->dims,
+				     &entry->type);
+		if (status == NX_OK) {
+			NXUreadattr(file_id, "signal", &entry->signal, NULL);
+			NXUreadattr(file_id, "axis", &entry->axis, NULL);
+			NXUreadattr(file_id, "primary", &entry->primary, NULL);
+			NXUreadattr(file_id, "axes", &n, &entry->axes);
+		}
+		if (NXclosedata(file_id) != NX_OK || status != NX_OK) {
+			goto error;
+		}
+	}
+
+	/* NeXus 2014 style: the NXdata group names its signal and axes */
+	NXUreadattr(file_id, "signal", &n, &signal);
+	NXUreadattr(file_id, "axes", &n, &axes);
+	for (i = 0; signal != NULL && i < group->nentries; i++) {
+		entry = group->entries + i;
+		if (strcmp(entry->name, signal) == 0
+		    && strcmp(entry->nxclass, "SDS") == 0) {
+			if (entry->signal == 0) {
+				entry->signal = 1;
+			}
+			if (entry->axes == NULL && axes != NULL) {
+				entry->axes = axes;
+				axes = NULL;
+			}
+			break;
+		}
+	}
+	free(signal);
+	free(axes);
+	return group;
+
+      error:
+	for (i = 0; i < group->nentries; i++) {
+		free(group->entries[i].axes);
+	}
+	free(group->entries);
+	free(group->path);
+	free(group);
+	return NULL;
+}
+
+/* the index of the open group, listing the group if needed */
+static pNXUgroup NXUgetgroup(NXhandle file_id)
+{
+	pFileStack fileStack = (pFileStack) file_id;
+	pNXUindex index;
+	pNXUgroup group;
+	char path[NX_MAXPATHLEN];
+	unsigned int h;
+
+	if (NXUisdataopen(file_id)) {
+		NXReportError("ERROR: close the data item before searching");
+		return NULL;
+	}
+	memset(path, 0, sizeof(path));
+	if (NXgetpath(file_id, path, sizeof(path)) != NX_OK) {
+		return NULL;
+	}
+	index = (pNXUindex) peekIndexOnStack(fileStack);
+	if (index == NULL) {
+		index = (pNXUindex) calloc(1, sizeof(NXUindex));
+		if (index == NULL) {
+			NXReportError("ERROR: out of memory indexing file");
+			return NULL;
+		}
+		setIndexOnStack(fileStack, index, NXUfreeindex);
+	}
+	h = NXUhash(path);
+	for (group = index->buckets[h]; group != NULL; group = group->next) {
+		if (strcmp(group->path, path) == 0) {
+			return group;
+		}
+	}
+	group = NXUscangroup(file_id, path);
+	if (group != NULL) {
+		group->next = index->buckets[h];
+		index->buckets[h] = group;
+	}
+	return group;
+}
+
+static NXUentry *NXUgetentry(pNXUgroup group, const char *name)
+{
+	int i;
+
+	for (i = 0; i < group->nentries; i++) {
+		if (strcmp(group->entries[i].name, name) == 0) {
+			return group->entries + i;
+		}
+	}
+	return NULL;
+}
+
+static void NXUcopyinfo(const NXUentry * entry, char *data_name,
+			int *data_rank, int *data_type, int data_dimensions[])
+{
+	int i;
+
+	if (data_name != NULL) {
+		strcpy(data_name, entry->name);
+	}
+	if (data_rank != NULL) {
+		*data_rank = entry->rank;
+	}
+	if (data_type != NULL) {
+		*data_type = entry->type;
+	}
+	for (i = 0; data_dimensions != NULL && i < entry->rank; i++) {
+		data_dimensions[i] = (int)entry->dims[i];
+	}
+}
+
 	/* !NXUfindgroup finds if a NeXus group of the specified name exists */
  NXstatus  NXUfindgroup(NXhandle file_id, const char* group_name, char* group_class)
  {
-	int status, n;
-	NXname vname, vclass;
-      status = NXgetgroupinfo(file_id, &n, vname, vclass);
-      if (status != NX_OK)
-	  {
-		  return status;
-	  }
-	 return NX_OK;
+	pNXUgroup group;
+	NXUentry *entry;
+	char pBuffer[256];
+
+	group = NXUgetgroup(file_id);
+	if (group == NULL) {
+		return NX_ERROR;
+	}
+	entry = NXUgetentry(group, group_name);
+	if (entry == NULL) {
+		return NX_EOD;
+	}
+	if (strcmp(entry->nxclass, "SDS") == 0) {
+		sprintf(pBuffer, "ERROR: %s is not a group", group_name);
+		NXReportError(pBuffer);
+		return NX_ERROR;
+	}
+	if (group_class != NULL) {
+		strcpy(group_class, entry->nxclass);
+	}
+	return NX_OK;
  }
 
+	/* NXUfindclass finds the find_index'th group of the specified class */
  NXstatus  NXUfindclass(NXhandle file_id, const char* group_class, char* group_name, int find_index)
  {
-	 return NX_OK;
+	pNXUgroup group;
+	int i, found = 0;
+
+	group = NXUgetgroup(file_id);
+	if (group == NULL) {
+		return NX_ERROR;
+	}
+	for (i = 0; i < group->nentries; i++) {
+		if (strcmp(group->entries[i].nxclass, group_class) == 0
+		    && ++found >= find_index) {
+			strcpy(group_name, group->entries[i].name);
+			return NX_OK;
+		}
+	}
+	return NX_EOD;
  }
 
 /* NXUfinddata finds if a NeXus data item is in the current group */
  NXstatus  NXUfinddata(NXhandle file_id, const char* data_name)
  {
-	 return NX_OK;
+	pNXUgroup group;
+	NXUentry *entry;
+	char pBuffer[256];
+
+	group = NXUgetgroup(file_id);
+	if (group == NULL) {
+		return NX_ERROR;
+	}
+	entry = NXUgetentry(group, data_name);
+	if (entry == NULL) {
+		return NX_EOD;
+	}
+	if (strcmp(entry->nxclass, "SDS") != 0) {
+		sprintf(pBuffer, "ERROR: %s is not a data item", data_name);
+		NXReportError(pBuffer);
+		return NX_ERROR;
+	}
+	return NX_OK;
  }
 
+/* NXUfindattr finds if an attribute exists on the open group or data item */
  NXstatus  NXUfindattr(NXhandle file_id, const char* attr_name)
  {
-	 return NX_OK;
+	NXname name;
+	int rank, dim[NX_MAXRANK], type, status;
+
+	status = NXinitattrdir(file_id);
+	if (status != NX_OK) {
+		return status;
+	}
+	while ((status = NXgetnextattra(file_id, name, &rank, dim, &type)) == NX_OK) {
+		if (strcmp(name, attr_name) == 0) {
+			return NX_OK;
+		}
+	}
+	return status;
  }
 
+/* NXUfindsignal finds the data item in the current group with the required signal */
  NXstatus  NXUfindsignal(NXhandle file_id, int signal, char* data_name, int* data_rank, int* data_type, int data_dimensions[])
  {
-	 return NX_OK;
+	pNXUgroup group;
+	int i;
+
+	group = NXUgetgroup(file_id);
+	if (group == NULL) {
+		return NX_ERROR;
+	}
+	for (i = 0; i < group->nentries; i++) {
+		if (strcmp(group->entries[i].nxclass, "SDS") == 0
+		    && group->entries[i].signal == signal) {
+			NXUcopyinfo(group->entries + i, data_name, data_rank,
+				    data_type, data_dimensions);
+			return NX_OK;
+		}
+	}
+	return NX_EOD;
  }
 
+/* NXUfindaxis finds the data item in the current group with the required axis */
  NXstatus  NXUfindaxis(NXhandle file_id, int axis, int primary, char* data_name, int* data_rank, int* data_type, int data_dimensions[])
  {
-	 return NX_OK;
+	pNXUgroup group;
+	NXUentry *signal = NULL, *entry;
+	char axisName[NX_MAXNAMELEN], *pPtr;
+	int i;
+	size_t length;
+
+	group = NXUgetgroup(file_id);
+	if (group == NULL) {
+		return NX_ERROR;
+	}
+	for (i = 0; i < group->nentries; i++) {
+		if (strcmp(group->entries[i].nxclass, "SDS") == 0
+		    && group->entries[i].signal == 1) {
+			signal = group->entries + i;
+			break;
+		}
+	}
+	if (signal == NULL) {
+		return NX_EOD;
+	}
+	if (axis < 1 || axis > signal->rank) {
+		NXReportError("ERROR: axis number greater than the data rank");
+		return NX_ERROR;
+	}
+
+	/* the signal lists its axes in C order, e.g. "[x,y]" or "x:y" */
+	if (signal->axes != NULL) {
+		pPtr = signal->axes;
+		for (i = 1; i <= axis; i++) {
+			pPtr += strspn(pPtr, "[], :");
+			length = strcspn(pPtr, "[], :");
+			if (length == 0 || length >= sizeof(axisName)) {
+				NXReportError
+				    ("ERROR: data attribute \"axes\" is not correctly defined");
+				return NX_ERROR;
+			}
+			memcpy(axisName, pPtr, length);
+			axisName[length] = '\0';
+			pPtr += length;
+		}
+		entry = NXUgetentry(group, axisName);
+		if (entry == NULL || strcmp(entry->nxclass, "SDS") != 0) {
+			NXReportError("ERROR: axis listed in \"axes\" not found");
+			return NX_ERROR;
+		}
+		NXUcopyinfo(entry, data_name, data_rank, data_type,
+			    data_dimensions);
+		return NX_OK;
+	}
+
+	/* otherwise look for the axis and primary attributes */
+	for (i = 0; i < group->nentries; i++) {
+		entry = group->entries + i;
+		if (strcmp(entry->nxclass, "SDS") == 0 && entry->axis == axis
+		    && entry->primary == primary) {
+			NXUcopyinfo(entry, data_name, data_rank, data_type,
+				    data_dimensions);
+			return NX_OK;
+		}
+	}
+	return NX_EOD;
  }
 
+/* NXUsearchgroup looks for data_id below the open group, leaving the group holding it open */
+static NXstatus NXUsearchgroup(NXhandle file_id, NXlink * group_id,
+			       NXlink * data_id, const char *group_class)
+{
+	pNXUgroup group;
+	NXUentry *entry;
+	NXlink new_id;
+	int i, status;
+
+	group = NXUgetgroup(file_id);
+	if (group == NULL) {
+		return NX_ERROR;
+	}
+	for (i = 0; i < group->nentries; i++) {
+		entry = group->entries + i;
+		if (strcmp(entry->nxclass, "SDS") == 0) {
+			if (group_class != NULL
+			    && strcmp(group_class, group->nxclass) != 0) {
+				continue;
+			}
+			if (NXopendata(file_id, entry->name) != NX_OK) {
+				return NX_ERROR;
+			}
+			status = NXgetdataID(file_id, &new_id);
+			if (status == NX_OK
+			    && NXsameID(file_id, &new_id, data_id) == NX_OK) {
+				return NX_OK;
+			}
+			if (NXclosedata(file_id) != NX_OK || status != NX_OK) {
+				return NX_ERROR;
+			}
+		} else if (strncmp(entry->nxclass, "NX", 2) == 0) {
+			if (NXopengroup(file_id, entry->name, entry->nxclass) !=
+			    NX_OK) {
+				return NX_ERROR;
+			}
+			/* skip the group where the search started */
+			status = NXgetgroupID(file_id, &new_id);
+			if (status == NX_OK
+			    && NXsameID(file_id, &new_id, group_id) != NX_OK) {
+				status = NXUsearchgroup(file_id, group_id,
+							data_id, group_class);
+				if (status != NX_EOD) {
+					return status;
+				}
+			}
+			if (NXclosegroup(file_id) != NX_OK) {
+				return NX_ERROR;
+			}
+		}
+	}
+	return NX_EOD;
+}
+
+/* NXUfindlink finds another link to the open data item and opens the group holding it */
  NXstatus  NXUfindlink(NXhandle file_id, NXlink* group_id, const char* group_class)
  {
-	 return NX_OK;
+	NXlink data_id;
+
+	if (NXgetdataID(file_id, &data_id) != NX_OK) {
+		return NX_ERROR;
+	}
+	if (NXclosedata(file_id) != NX_OK) {
+		return NX_ERROR;
+	}
+	if (NXgetgroupID(file_id, group_id) != NX_OK) {
+		return NX_ERROR;
+	}
+	/* start the search in the group one level up */
+	if (NXclosegroup(file_id) != NX_OK) {
+		return NX_ERROR;
+	}
+	return NXUsearchgroup(file_id, group_id, &data_id, group_class);
  }
 
+/* NXUresumelink reopens the original group from which NXUfindlink was called */
  NXstatus  NXUresumelink(NXhandle file_id, NXlink group_id)
  {
-	 return NX_OK;
+	if (NXUisdataopen(file_id) && NXclosedata(file_id) != NX_OK) {
+		return NX_ERROR;
+	}
+	return NXopenpath(file_id, group_id.targetPath);
  }
-
@@ -0,0 +1,260 @@
+/*
+  Frame by frame reading of a dataset with read-ahead on a background
+  thread. A frame is one index along the first dimension of the open
+  dataset. While the caller works on frame n, frames n+1 ... n+depth are
+  read (and decompressed) by the reader thread into a ring of buffers.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  For further information, see <http://www.nexusformat.org>
+*/
+#include <stdlib.h>
+#include <string.h>
+#include <napi.h>
+#include <napi_internal.h>
+#include <nxconfig.h>
+
+#if !defined(_WIN32) && HAVE_LIBPTHREAD
+#include <pthread.h>
+#define NX_FRAME_THREADS 1
+#endif
+
+typedef struct {
+	NXhandle handle;
+	int rank;
+	int64_t start[NX_MAXRANK];
+	int64_t size[NX_MAXRANK];
+	int64_t first;
+	int64_t count;
+	int nslots;
+	size_t framesize;
+	char *slots;
+	int64_t produced;	/* frames read so far */
+	int64_t consumed;	/* frames handed back by the callback */
+	int cancel;
+	int done;
+	NXstatus status;
+#ifdef NX_FRAME_THREADS
+	pthread_mutex_t lock;
+	pthread_cond_t changed;
+#endif
+} NXframeReader, *pNXframeReader;
+
+/*----------------------------------------------------------------------*/
+static size_t typeSize(int datatype)
+{
+	switch (datatype) {
+	case NX_CHAR:
+	case NX_INT8:
+	case NX_UINT8:
+		return 1;
+	case NX_INT16:
+	case NX_UINT16:
+		return 2;
+	case NX_INT32:
+	case NX_UINT32:
+	case NX_FLOAT32:
+		return 4;
+	case NX_INT64:
+	case NX_UINT64:
+	case NX_FLOAT64:
+		return 8;
+	}
+	return 0;
+}
+
+/*----------------------------------------------------------------------*/
+static NXstatus readFrame(pNXframeReader self, int64_t n)
+{
+	int64_t start[NX_MAXRANK];
+
+	memcpy(start, self->start, self->rank * sizeof(int64_t));
+	start[0] = self->first + n;
+	return NXgetslab64(self->handle,
+			   self->slots + (size_t) (n % self->nslots) *
+			   self->framesize, start, self->size);
+}
+
+/*----------------------------------------------------------------------*/
+static NXstatus readFramesSync(pNXframeReader self,
+			       NXframecallback callback, void *userdata)
+{
+	int64_t n;
+
+	self->nslots = 1;
+	for (n = 0; n < self->count; n++) {
+		if (readFrame(self, n) != NX_OK) {
+			return NX_ERROR;
+		}
+		if (callback(self->slots, self->first + n, userdata) != 0) {
+			break;
+		}
+	}
+	return NX_OK;
+}
+
+#ifdef NX_FRAME_THREADS
+/*----------------------------------------------------------------------*/
+static void *frameReaderThread(void *data)
+{
+	pNXframeReader self = (pNXframeReader) data;
+	int64_t n;
+	NXstatus status;
+
+	for (n = 0; n < self->count; n++) {
+		pthread_mutex_lock(&self->lock);
+		while (!self->cancel
+		       && self->produced - self->consumed >= self->nslots) {
+			pthread_cond_wait(&self->changed, &self->lock);
+		}
+		if (self->cancel) {
+			pthread_mutex_unlock(&self->lock);
+			break;
+		}
+		pthread_mutex_unlock(&self->lock);
+
+		/* the slot is ours until produced is advanced */
+		status = readFrame(self, n);
+
+		pthread_mutex_lock(&self->lock);
+		if (status != NX_OK) {
+			self->status = NX_ERROR;
+			pthread_mutex_unlock(&self->lock);
+			break;
+		}
+		self->produced++;
+		pthread_cond_broadcast(&self->changed);
+		pthread_mutex_unlock(&self->lock);
+	}
+
+	pthread_mutex_lock(&self->lock);
+	self->done = 1;
+	pthread_cond_broadcast(&self->changed);
+	pthread_mutex_unlock(&self->lock);
+	return NULL;
+}
+
+/*----------------------------------------------------------------------*/
+static NXstatus readFramesAsync(pNXframeReader self,
+				NXframecallback callback, void *userdata)
+{
+	pthread_t reader;
+	int64_t n;
+	int ret = 0, ready;
+
+	pthread_mutex_init(&self->lock, NULL);
+	pthread_cond_init(&self->changed, NULL);
+	if (pthread_create(&reader, NULL, frameReaderThread, self) != 0) {
+		pthread_cond_destroy(&self->changed);
+		pthread_mutex_destroy(&self->lock);
+		return readFramesSync(self, callback, userdata);
+	}
+
+	for (n = 0; n < self->count && ret == 0; n++) {
+		pthread_mutex_lock(&self->lock);
+		while (self->produced <= n && !self->done) {
+			pthread_cond_wait(&self->changed, &self->lock);
+		}
+		ready = (self->produced > n);
+		pthread_mutex_unlock(&self->lock);
+		if (!ready) {
+			break;
+		}
+
+		ret = callback(self->slots + (size_t) (n % self->nslots) *
+			       self->framesize, self->first + n, userdata);
+
+		pthread_mutex_lock(&self->lock);
+		self->consumed++;
+		pthread_cond_broadcast(&self->changed);
+		pthread_mutex_unlock(&self->lock);
+	}
+
+	pthread_mutex_lock(&self->lock);
+	self->cancel = 1;
+	pthread_cond_broadcast(&self->changed);
+	pthread_mutex_unlock(&self->lock);
+	pthread_join(reader, NULL);
+
+	pthread_cond_destroy(&self->changed);
+	pthread_mutex_destroy(&self->lock);
+	return self->status;
+}
+#endif				/* NX_FRAME_THREADS */
+
+/*----------------------------------------------------------------------*/
+NXstatus NXgetframes64(NXhandle handle, int64_t first, int64_t count,
+		       int depth, NXframecallback callback, void *userdata)
+{
+	NXframeReader reader;
+	int64_t dims[NX_MAXRANK];
+	int i, type;
+	NXstatus status;
+
+	if (callback == NULL || first < 0 || count < 0) {
+		NXReportError("ERROR: invalid arguments to NXgetframes64");
+		return NX_ERROR;
+	}
+	memset(&reader, 0, sizeof(NXframeReader));
+	if (NXgetinfo64(handle, &reader.rank, dims, &type) != NX_OK) {
+		return NX_ERROR;
+	}
+	if (first + count > dims[0]) {
+		NXReportError("ERROR: NXgetframes64 - frames beyond end of dataset");
+		return NX_ERROR;
+	}
+	reader.framesize = typeSize(type);
+	if (reader.framesize == 0) {
+		NXReportError("ERROR: NXgetframes64 - unknown data type");
+		return NX_ERROR;
+	}
+	for (i = 0; i < reader.rank; i++) {
+		reader.start[i] = 0;
+		reader.size[i] = dims[i];
+		if (i > 0) {
+			reader.framesize *= (size_t) dims[i];
+		}
+	}
+	reader.size[0] = 1;
+	if (count == 0) {
+		return NX_OK;
+	}
+	reader.handle = handle;
+	reader.first = first;
+	reader.count = count;
+	reader.status = NX_OK;
+	/* the frame in use by the callback plus depth frames read ahead */
+	reader.nslots = (depth > 0) ? depth + 1 : 1;
+	if (reader.nslots > count) {
+		reader.nslots = (int)count;
+	}
+	reader.slots = (char *)malloc(reader.nslots * reader.framesize);
+	if (reader.slots == NULL) {
+		NXReportError("ERROR: NXgetframes64 - out of memory");
+		return NX_ERROR;
+	}
+
+#ifdef NX_FRAME_THREADS
+	if (depth > 0 && count > 1) {
+		status = readFramesAsync(&reader, callback, userdata);
+	} else {
+		status = readFramesSync(&reader, callback, userdata);
+	}
+#else
+	status = readFramesSync(&reader, callback, userdata);
+#endif
+	free(reader.slots);
+	return status;
+}
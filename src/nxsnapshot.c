@@ -0,0 +1,1548 @@
+/*
+  A snapshot of the metadata of a file opened with NXACC_SNAPSHOT. The
+  whole tree, with group classes, dataset shapes and all attributes, is
+  read by one NXvisit when the file is opened. Navigation and attribute
+  calls are then answered from memory. The driver of the file follows
+  the current position, group by group, only when data is read, so a
+  program which walks the tree and reads a few datasets touches the file
+  for those datasets only.
+
+  The same tree can be written beside the file as an index, see
+  NXmakeindex, and is then read from there while the file is unchanged.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  For further information, see <http://www.nexusformat.org>
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <nxconfig.h>
+#include <napi.h>
+#include <napi_internal.h>
+#include "nxstack.h"
+#include "nxsnapshot.h"
+
+typedef struct {
+	char *name;
+	int type;
+	int rank;
+	int dims[NX_MAXRANK];
+	void *value;
+	size_t size;
+} NXsnapAttr, *pNXsnapAttr;
+
+typedef struct __NXsnapNode {
+	char *path;		/* absolute, "" for the root */
+	char *name;		/* the last part of path */
+	char *nxclass;		/* "SDS" for a dataset */
+	int type;
+	int rank;
+	int64_t dims[NX_MAXRANK];
+	struct __NXsnapNode **children;
+	int nchildren;
+	int maxchildren;
+	pNXsnapAttr attrs;
+	int nattrs;
+	int maxattrs;
+} NXsnapNode, *pNXsnapNode;
+
+typedef struct {
+	NexusFunction file;	/* the driver of the file */
+	pNXsnapNode root;
+	pNXsnapNode group[NXMAXSTACK];	/* the open groups, group[0] is the root */
+	int depth;
+	pNXsnapNode data;	/* the open dataset, NULL if none */
+	int entry;		/* next entry for NXgetnextentry */
+	int attr;		/* next attribute for NXgetnextattra */
+	/* where the driver of the file is, see syncFile */
+	pNXsnapNode fileGroup[NXMAXSTACK];
+	int fileDepth;
+	pNXsnapNode fileData;
+	/* while reading the tree */
+	pNXsnapNode last;
+	NXstatus status;
+} NXsnapshot, *pNXsnapshot;
+
+/*----------------------------------------------------------------------*/
+static size_t typeSize(int datatype)
+{
+	switch (datatype) {
+	case NX_CHAR:
+	case NX_INT8:
+	case NX_UINT8:
+		return 1;
+	case NX_INT16:
+	case NX_UINT16:
+		return 2;
+	case NX_INT32:
+	case NX_UINT32:
+	case NX_FLOAT32:
+		return 4;
+	case NX_INT64:
+	case NX_UINT64:
+	case NX_FLOAT64:
+		return 8;
+	}
+	return 0;
+}
+
+static int isDataset(pNXsnapNode node)
+{
+	return strcmp(node->nxclass, "SDS") == 0;
+}
+
+/*----------------------------------------------------------------------*/
+static void killNode(pNXsnapNode node)
+{
+	int i;
+
+	for (i = 0; i < node->nchildren; i++) {
+		killNode(node->children[i]);
+	}
+	for (i = 0; i < node->nattrs; i++) {
+		free(node->attrs[i].name);
+		free(node->attrs[i].value);
+	}
+	free(node->children);
+	free(node->attrs);
+	free(node->path);
+	free(node->nxclass);
+	free(node);
+}
+
+static pNXsnapNode makeNode(const char *path, const char *nxclass)
+{
+	pNXsnapNode node;
+
+	node = (pNXsnapNode) calloc(1, sizeof(NXsnapNode));
+	if (node == NULL) {
+		return NULL;
+	}
+	node->path = strdup(path);
+	node->nxclass = strdup(nxclass != NULL ? nxclass : "");
+	if (node->path == NULL || node->nxclass == NULL) {
+		killNode(node);
+		return NULL;
+	}
+	node->name = strrchr(node->path, '/');
+	node->name = node->name != NULL ? node->name + 1 : node->path;
+	return node;
+}
+
+static NXstatus addChild(pNXsnapNode parent, pNXsnapNode child)
+{
+	pNXsnapNode *children;
+
+	if (parent->nchildren == parent->maxchildren) {
+		parent->maxchildren =
+		    parent->maxchildren > 0 ? 2 * parent->maxchildren : 8;
+		children = (pNXsnapNode *) realloc(parent->children,
+						   parent->maxchildren *
+						   sizeof(pNXsnapNode));
+		if (children == NULL) {
+			return NX_ERROR;
+		}
+		parent->children = children;
+	}
+	parent->children[parent->nchildren++] = child;
+	return NX_OK;
+}
+
+static NXstatus addAttribute(pNXsnapNode node, const NXvisitinfo * info)
+{
+	pNXsnapAttr attr, attrs;
+	int i;
+
+	if (node->nattrs == node->maxattrs) {
+		node->maxattrs = node->maxattrs > 0 ? 2 * node->maxattrs : 4;
+		attrs = (pNXsnapAttr) realloc(node->attrs,
+					      node->maxattrs *
+					      sizeof(NXsnapAttr));
+		if (attrs == NULL) {
+			return NX_ERROR;
+		}
+		node->attrs = attrs;
+	}
+	attr = node->attrs + node->nattrs;
+	memset(attr, 0, sizeof(NXsnapAttr));
+	attr->name = strdup(info->name);
+	attr->type = info->type;
+	attr->rank = info->rank;
+	for (i = 0; i < info->rank; i++) {
+		attr->dims[i] = (int)info->dims[i];
+	}
+	if (info->type == NX_CHAR) {
+		attr->size = info->value != NULL ?
+		    strlen((const char *)info->value) + 1 : 1;
+	} else {
+		attr->size = typeSize(info->type);
+		for (i = 0; i < info->rank; i++) {
+			attr->size *= (size_t) info->dims[i];
+		}
+	}
+	attr->value = calloc(attr->size, 1);
+	if (attr->name == NULL || attr->value == NULL) {
+		free(attr->name);
+		free(attr->value);
+		return NX_ERROR;
+	}
+	if (info->value != NULL) {
+		memcpy(attr->value, info->value, attr->size);
+	}
+	node->nattrs++;
+	return NX_OK;
+}
+
+/*
+ * NXvisit callback filling the tree. Objects come parent first, and
+ * attributes right after their owner.
+ */
+static int addObject(const NXvisitinfo * info, void *userdata)
+{
+	pNXsnapshot self = (pNXsnapshot) userdata;
+	pNXsnapNode node;
+	size_t len;
+	int i;
+
+	if (info->kind == NXVISIT_ATTRIBUTE) {
+		node = strcmp(info->path, "/") == 0 ? self->root : self->last;
+		self->status = addAttribute(node, info);
+		return self->status != NX_OK;
+	}
+
+	/* the groups on the way to the parent are on the group stack */
+	len = (size_t) (strrchr(info->path, '/') - info->path);
+	while (self->depth > 0 && (strlen(self->group[self->depth]->path) != len
+				   || strncmp(self->group[self->depth]->path,
+					      info->path, len) != 0)) {
+		self->depth--;
+	}
+	node = makeNode(info->path, info->nxclass);
+	if (node == NULL || addChild(self->group[self->depth], node) != NX_OK) {
+		if (node != NULL) {
+			killNode(node);
+		}
+		self->status = NX_ERROR;
+		return 1;
+	}
+	if (info->kind == NXVISIT_DATASET) {
+		node->type = info->type;
+		node->rank = info->rank;
+		for (i = 0; i < info->rank; i++) {
+			node->dims[i] = info->dims[i];
+		}
+	} else {
+		if (self->depth + 1 >= NXMAXSTACK) {
+			NXReportError("ERROR: groups nested too deep for a snapshot");
+			self->status = NX_ERROR;
+			return 1;
+		}
+		self->group[++self->depth] = node;
+	}
+	self->last = node;
+	return 0;
+}
+
+/*----------------------------------------------------------------------*/
+
+/*
+ * moves the driver of the file to the current group and dataset, opening
+ * and closing only what differs from where it was left
+ */
+static NXstatus syncFile(pNXsnapshot self)
+{
+	pNexusFunction file = &self->file;
+	pNXsnapNode node;
+	int common = 0;
+
+	while (common < self->fileDepth && common < self->depth
+	       && self->fileGroup[common + 1] == self->group[common + 1]) {
+		common++;
+	}
+	if (self->fileData != NULL
+	    && (self->fileData != self->data || common < self->fileDepth)) {
+		file->nxclosedata(file->pNexusData);
+		self->fileData = NULL;
+	}
+	while (self->fileDepth > common) {
+		file->nxclosegroup(file->pNexusData);
+		self->fileDepth--;
+	}
+	while (self->fileDepth < self->depth) {
+		node = self->group[self->fileDepth + 1];
+		if (file->nxopengroup(file->pNexusData, node->name,
+				      node->nxclass) != NX_OK) {
+			return NX_ERROR;
+		}
+		self->fileGroup[++self->fileDepth] = node;
+	}
+	if (self->data != NULL && self->fileData == NULL) {
+		if (file->nxopendata(file->pNexusData, self->data->name) != NX_OK) {
+			return NX_ERROR;
+		}
+		self->fileData = self->data;
+	}
+	return NX_OK;
+}
+
+static pNXsnapNode findChild(pNXsnapNode group, CONSTCHAR * name)
+{
+	int i;
+
+	for (i = 0; i < group->nchildren; i++) {
+		if (strcmp(group->children[i]->name, name) == 0) {
+			return group->children[i];
+		}
+	}
+	return NULL;
+}
+
+/* the attributes belong to the open dataset, else to the current group */
+static pNXsnapAttr findAttribute(pNXsnapshot self, CONSTCHAR * name)
+{
+	pNXsnapNode owner;
+	int i;
+
+	owner = self->data != NULL ? self->data : self->group[self->depth];
+	for (i = 0; i < owner->nattrs; i++) {
+		if (strcmp(owner->attrs[i].name, name) == 0) {
+			return owner->attrs + i;
+		}
+	}
+	return NULL;
+}
+
+/*
+ * converts a single number, as HDF-5 would when reading an attribute as
+ * another type
+ */
+static void convertNumber(const void *from, int fromType, void *to,
+			  int toType)
+{
+	double d = 0;
+	int64_t i = 0;
+	int isFloat = 0;
+
+	switch (fromType) {
+	case NX_INT8:
+		i = *(const int8_t *)from;
+		break;
+	case NX_UINT8:
+		i = *(const uint8_t *)from;
+		break;
+	case NX_INT16:
+		i = *(const int16_t *)from;
+		break;
+	case NX_UINT16:
+		i = *(const uint16_t *)from;
+		break;
+	case NX_INT32:
+		i = *(const int32_t *)from;
+		break;
+	case NX_UINT32:
+		i = *(const uint32_t *)from;
+		break;
+	case NX_INT64:
+		i = *(const int64_t *)from;
+		break;
+	case NX_UINT64:
+		i = (int64_t) * (const uint64_t *)from;
+		break;
+	case NX_FLOAT32:
+		d = *(const float *)from;
+		isFloat = 1;
+		break;
+	case NX_FLOAT64:
+		d = *(const double *)from;
+		isFloat = 1;
+		break;
+	}
+	if (isFloat) {
+		i = (int64_t) d;
+	} else {
+		d = (double)i;
+	}
+	switch (toType) {
+	case NX_INT8:
+		*(int8_t *) to = (int8_t) i;
+		break;
+	case NX_UINT8:
+		*(uint8_t *) to = (uint8_t) i;
+		break;
+	case NX_INT16:
+		*(int16_t *) to = (int16_t) i;
+		break;
+	case NX_UINT16:
+		*(uint16_t *) to = (uint16_t) i;
+		break;
+	case NX_INT32:
+		*(int32_t *) to = (int32_t) i;
+		break;
+	case NX_UINT32:
+		*(uint32_t *) to = (uint32_t) i;
+		break;
+	case NX_INT64:
+		*(int64_t *) to = i;
+		break;
+	case NX_UINT64:
+		*(uint64_t *) to = (uint64_t) i;
+		break;
+	case NX_FLOAT32:
+		*(float *)to = (float)d;
+		break;
+	case NX_FLOAT64:
+		*(double *)to = d;
+		break;
+	}
+}
+
+/*------------------------------------------------------------------------
+  The driver functions. Everything that changes the file is refused.
+  ------------------------------------------------------------------------*/
+
+static NXstatus readOnly(void)
+{
+	NXReportError("ERROR: a file opened with NXACC_SNAPSHOT is read only");
+	return NX_ERROR;
+}
+
+static NXstatus NXSclose(NXhandle * pHandle)
+{
+	pNXsnapshot self = (pNXsnapshot) * pHandle;
+	NXstatus status;
+
+	status = self->file.nxclose(&self->file.pNexusData);
+	killNode(self->root);
+	free(self);
+	*pHandle = NULL;
+	return status;
+}
+
+static NXstatus NXSflush(NXhandle * pHandle)
+{
+	pNXsnapshot self = (pNXsnapshot) * pHandle;
+	return self->file.nxflush(&self->file.pNexusData);
+}
+
+static NXstatus NXSmakegroup(NXhandle handle, CONSTCHAR * name,
+			     CONSTCHAR * nxclass)
+{
+	return readOnly();
+}
+
+static NXstatus NXSmakedata64(NXhandle handle, CONSTCHAR * label,
+			      int datatype, int rank, int64_t dim[])
+{
+	return readOnly();
+}
+
+static NXstatus NXScompmakedata64(NXhandle handle, CONSTCHAR * label,
+				  int datatype, int rank, int64_t dim[],
+				  int comp_typ, int64_t bufsize[])
+{
+	return readOnly();
+}
+
+static NXstatus NXScompress(NXhandle handle, int compr_type)
+{
+	return readOnly();
+}
+
+static NXstatus NXSputdata(NXhandle handle, const void *data)
+{
+	return readOnly();
+}
+
+static NXstatus NXSputattr(NXhandle handle, CONSTCHAR * name,
+			   const void *data, int iDataLen, int iType)
+{
+	return readOnly();
+}
+
+static NXstatus NXSputattra(NXhandle handle, CONSTCHAR * name,
+			    const void *data, const int rank,
+			    const int dim[], const int iType)
+{
+	return readOnly();
+}
+
+static NXstatus NXSputslab64(NXhandle handle, const void *data,
+			     const int64_t start[], const int64_t size[])
+{
+	return readOnly();
+}
+
+static NXstatus NXSmakelink(NXhandle handle, NXlink * pLink)
+{
+	return readOnly();
+}
+
+static NXstatus NXSmakenamedlink(NXhandle handle, CONSTCHAR * newname,
+				 NXlink * pLink)
+{
+	return readOnly();
+}
+
+/*----------------------------------------------------------------------*/
+static NXstatus NXSopengroup(NXhandle handle, CONSTCHAR * name,
+			     CONSTCHAR * nxclass)
+{
+	pNXsnapshot self = (pNXsnapshot) handle;
+	pNXsnapNode node;
+	char pBuffer[1024];
+
+	node = findChild(self->group[self->depth], name);
+	if (node == NULL || isDataset(node)) {
+		snprintf(pBuffer, sizeof(pBuffer),
+			 "ERROR: group %s does not exist", name);
+		NXReportError(pBuffer);
+		return NX_ERROR;
+	}
+	if (nxclass != NULL && strlen(nxclass) > 0
+	    && strcmp(node->nxclass, nxclass) != 0) {
+		snprintf(pBuffer, sizeof(pBuffer),
+			 "ERROR: group class is not identical: \"%s\" != \"%s\"",
+			 node->nxclass, nxclass);
+		NXReportError(pBuffer);
+		return NX_ERROR;
+	}
+	if (self->depth + 1 >= NXMAXSTACK) {
+		NXReportError("ERROR: groups nested too deep");
+		return NX_ERROR;
+	}
+	self->group[++self->depth] = node;
+	self->data = NULL;
+	self->entry = 0;
+	self->attr = 0;
+	return NX_OK;
+}
+
+static NXstatus NXSclosegroup(NXhandle handle)
+{
+	pNXsnapshot self = (pNXsnapshot) handle;
+
+	/* closing the root is not an error */
+	if (self->depth > 0) {
+		self->depth--;
+	}
+	self->data = NULL;
+	self->entry = 0;
+	self->attr = 0;
+	return NX_OK;
+}
+
+static NXstatus NXSopendata(NXhandle handle, CONSTCHAR * name)
+{
+	pNXsnapshot self = (pNXsnapshot) handle;
+	pNXsnapNode node;
+	char pBuffer[256];
+
+	node = findChild(self->group[self->depth], name);
+	if (node == NULL || !isDataset(node)) {
+		snprintf(pBuffer, sizeof(pBuffer),
+			 "ERROR: dataset \"%s\" not found at this level", name);
+		NXReportError(pBuffer);
+		return NX_ERROR;
+	}
+	self->data = node;
+	self->attr = 0;
+	return NX_OK;
+}
+
+static NXstatus NXSclosedata(NXhandle handle)
+{
+	pNXsnapshot self = (pNXsnapshot) handle;
+
+	if (self->data == NULL) {
+		NXReportError("ERROR: no dataset open");
+		return NX_ERROR;
+	}
+	self->data = NULL;
+	self->attr = 0;
+	return NX_OK;
+}
+
+static NXstatus NXSgetinfo64(NXhandle handle, int *rank,
+			     int64_t dimension[], int *datatype)
+{
+	pNXsnapshot self = (pNXsnapshot) handle;
+	int i;
+
+	if (self->data == NULL) {
+		NXReportError("ERROR: no dataset open");
+		return NX_ERROR;
+	}
+	/*
+	   the length of variable length strings is only known by reading
+	   them, and NXgetdata sizes its buffer from this
+	 */
+	if (self->data->type == NX_CHAR) {
+		if (syncFile(self) != NX_OK) {
+			return NX_ERROR;
+		}
+		return self->file.nxgetinfo64(self->file.pNexusData, rank,
+					      dimension, datatype);
+	}
+	*rank = self->data->rank;
+	for (i = 0; i < self->data->rank; i++) {
+		dimension[i] = self->data->dims[i];
+	}
+	*datatype = self->data->type;
+	return NX_OK;
+}
+
+static NXstatus NXSgetnextentry(NXhandle handle, NXname name,
+				NXname nxclass, int *datatype)
+{
+	pNXsnapshot self = (pNXsnapshot) handle;
+	pNXsnapNode group = self->group[self->depth], node;
+
+	if (self->entry >= group->nchildren) {
+		self->entry = 0;
+		return NX_EOD;
+	}
+	node = group->children[self->entry++];
+	strncpy(name, node->name, sizeof(NXname) - 1);
+	name[sizeof(NXname) - 1] = '\0';
+	strncpy(nxclass, node->nxclass, sizeof(NXname) - 1);
+	nxclass[sizeof(NXname) - 1] = '\0';
+	if (isDataset(node)) {
+		*datatype = node->type;
+	}
+	return NX_OK;
+}
+
+static NXstatus NXSinitgroupdir(NXhandle handle)
+{
+	pNXsnapshot self = (pNXsnapshot) handle;
+	self->entry = 0;
+	return NX_OK;
+}
+
+static NXstatus NXSgetgroupinfo(NXhandle handle, int *no_items,
+				NXname name, NXname nxclass)
+{
+	pNXsnapshot self = (pNXsnapshot) handle;
+	pNXsnapNode group = self->group[self->depth];
+
+	if (self->depth == 0) {
+		strcpy(name, "root");
+		strcpy(nxclass, "NXroot");
+	} else {
+		strncpy(name, group->name, sizeof(NXname) - 1);
+		name[sizeof(NXname) - 1] = '\0';
+		strncpy(nxclass, group->nxclass, sizeof(NXname) - 1);
+		nxclass[sizeof(NXname) - 1] = '\0';
+	}
+	*no_items = group->nchildren;
+	return NX_OK;
+}
+
+/*----------------------------------------------------------------------*/
+static NXstatus NXSinitattrdir(NXhandle handle)
+{
+	pNXsnapshot self = (pNXsnapshot) handle;
+	self->attr = 0;
+	return NX_OK;
+}
+
+static NXstatus NXSgetattrinfo(NXhandle handle, int *no_items)
+{
+	pNXsnapshot self = (pNXsnapshot) handle;
+	pNXsnapNode owner;
+
+	owner = self->data != NULL ? self->data : self->group[self->depth];
+	*no_items = owner->nattrs;
+	return NX_OK;
+}
+
+static NXstatus NXSgetnextattra(NXhandle handle, NXname pName, int *rank,
+				int dim[], int *iType)
+{
+	pNXsnapshot self = (pNXsnapshot) handle;
+	pNXsnapNode owner;
+	pNXsnapAttr attr;
+	int i;
+
+	owner = self->data != NULL ? self->data : self->group[self->depth];
+	pName[0] = '\0';
+	if (self->attr >= owner->nattrs) {
+		return NX_EOD;
+	}
+	attr = owner->attrs + self->attr++;
+	strncpy(pName, attr->name, sizeof(NXname) - 1);
+	pName[sizeof(NXname) - 1] = '\0';
+	*rank = attr->rank;
+	for (i = 0; i < attr->rank; i++) {
+		dim[i] = attr->dims[i];
+	}
+	*iType = attr->type;
+	return NX_OK;
+}
+
+static NXstatus NXSgetnextattr(NXhandle handle, NXname pName, int *iLength,
+			       int *iType)
+{
+	int rank, dim[NX_MAXRANK], status;
+
+	status = NXSgetnextattra(handle, pName, &rank, dim, iType);
+	if (status != NX_OK) {
+		return status;
+	}
+	if (rank == 0 || (rank == 1 && dim[0] == 1)) {
+		*iLength = 1;
+		return NX_OK;
+	}
+	if (rank == 1 && *iType == NX_CHAR) {
+		*iLength = dim[0];
+		return NX_OK;
+	}
+	NXReportError("ERROR iterating through attributes found array attribute not understood by this api");
+	return NX_ERROR;
+}
+
+static NXstatus NXSgetattrainfo(NXhandle handle, NXname pName, int *rank,
+				int dim[], int *iType)
+{
+	pNXsnapAttr attr;
+	int i;
+
+	attr = findAttribute((pNXsnapshot) handle, pName);
+	if (attr == NULL) {
+		NXReportError("ERROR: unable to open attribute");
+		return NX_ERROR;
+	}
+	*rank = attr->rank;
+	for (i = 0; i < attr->rank; i++) {
+		dim[i] = attr->dims[i];
+	}
+	*iType = attr->type;
+	return NX_OK;
+}
+
+static NXstatus NXSgetattra(NXhandle handle, char *name, void *data)
+{
+	pNXsnapAttr attr;
+
+	attr = findAttribute((pNXsnapshot) handle, name);
+	if (attr == NULL) {
+		NXReportError("ERROR: unable to open attribute");
+		return NX_ERROR;
+	}
+	memcpy(data, attr->value, attr->size);
+	return NX_OK;
+}
+
+static NXstatus NXSgetattr(NXhandle handle, char *name, void *data,
+			   int *datalen, int *iType)
+{
+	pNXsnapAttr attr;
+	char pBuffer[256];
+
+	attr = findAttribute((pNXsnapshot) handle, name);
+	if (attr == NULL) {
+		snprintf(pBuffer, sizeof(pBuffer),
+			 "ERROR: attribute \"%s\" not found", name);
+		NXReportError(pBuffer);
+		return NX_ERROR;
+	}
+	if (*iType == NX_CHAR && attr->type == NX_CHAR) {
+		strncpy((char *)data, (const char *)attr->value, *datalen);
+		((char *)data)[*datalen - 1] = '\0';
+		*datalen = (int)strlen((char *)data);
+		return NX_OK;
+	}
+	if (attr->type != NX_CHAR && attr->size > typeSize(attr->type)) {
+		NXReportError("ERROR: attribute arrays not supported by this api");
+		return NX_ERROR;
+	}
+	if (attr->type == NX_CHAR || *iType == NX_CHAR
+	    || typeSize(*iType) == 0) {
+		snprintf(pBuffer, sizeof(pBuffer),
+			 "ERROR: could not read attribute data for \"%s\"",
+			 name);
+		NXReportError(pBuffer);
+		return NX_ERROR;
+	}
+	convertNumber(attr->value, attr->type, data, *iType);
+	*datalen = 1;
+	return NX_OK;
+}
+
+/*----------------------------------------------------------------------*/
+static int visitAttributes(pNXsnapNode node, int flags, NXvisitfunc callback,
+			   void *userdata)
+{
+	NXvisitinfo info;
+	int i, j;
+
+	for (i = 0; i < node->nattrs; i++) {
+		memset(&info, 0, sizeof(info));
+		info.kind = NXVISIT_ATTRIBUTE;
+		info.path = strlen(node->path) > 0 ? node->path : "/";
+		info.name = node->attrs[i].name;
+		info.type = node->attrs[i].type;
+		info.rank = node->attrs[i].rank;
+		for (j = 0; j < info.rank; j++) {
+			info.dims[j] = node->attrs[i].dims[j];
+		}
+		if (flags & NXVISIT_ATTRIBUTE_VALUES) {
+			info.value = node->attrs[i].value;
+		}
+		if (callback(&info, userdata) != 0) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static int visitChildren(pNXsnapNode group, int flags, NXvisitfunc callback,
+			 void *userdata)
+{
+	NXvisitinfo info;
+	pNXsnapNode node;
+	int i, j;
+
+	for (i = 0; i < group->nchildren; i++) {
+		node = group->children[i];
+		memset(&info, 0, sizeof(info));
+		info.path = node->path;
+		info.name = node->name;
+		info.nxclass = node->nxclass;
+		if (isDataset(node)) {
+			info.kind = NXVISIT_DATASET;
+			info.type = node->type;
+			info.rank = node->rank;
+			for (j = 0; j < node->rank; j++) {
+				info.dims[j] = node->dims[j];
+			}
+		} else {
+			info.kind = NXVISIT_GROUP;
+		}
+		if (callback(&info, userdata) != 0) {
+			return 1;
+		}
+		if ((flags & NXVISIT_WITH_ATTRIBUTES)
+		    && visitAttributes(node, flags, callback, userdata) != 0) {
+			return 1;
+		}
+		if (!isDataset(node)
+		    && visitChildren(node, flags, callback, userdata) != 0) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static NXstatus NXSvisit(NXhandle handle, int flags, NXvisitfunc callback,
+			 void *userdata)
+{
+	pNXsnapshot self = (pNXsnapshot) handle;
+	pNXsnapNode group = self->group[self->depth];
+
+	if ((flags & NXVISIT_WITH_ATTRIBUTES)
+	    && visitAttributes(group, flags, callback, userdata) != 0) {
+		return NX_EOD;
+	}
+	return visitChildren(group, flags, callback, userdata) != 0 ?
+	    NX_EOD : NX_OK;
+}
+
+/*------------------------------------------------------------------------
+  Data, links and external files are left to the driver of the file,
+  moved to the current position first.
+  ------------------------------------------------------------------------*/
+
+static NXstatus NXSgetdata(NXhandle handle, void *data)
+{
+	pNXsnapshot self = (pNXsnapshot) handle;
+	if (syncFile(self) != NX_OK) {
+		return NX_ERROR;
+	}
+	return self->file.nxgetdata(self->file.pNexusData, data);
+}
+
+static NXstatus NXSgetstrings(NXhandle handle, int64_t * count,
+			      int64_t ** offsets, char **buffer)
+{
+	pNXsnapshot self = (pNXsnapshot) handle;
+	if (syncFile(self) != NX_OK) {
+		return NX_ERROR;
+	}
+	return self->file.nxgetstrings(self->file.pNexusData, count, offsets,
+				       buffer);
+}
+
+static NXstatus NXSgetslab64(NXhandle handle, void *data,
+			     const int64_t start[], const int64_t size[])
+{
+	pNXsnapshot self = (pNXsnapshot) handle;
+	if (syncFile(self) != NX_OK) {
+		return NX_ERROR;
+	}
+	return self->file.nxgetslab64(self->file.pNexusData, data, start,
+				      size);
+}
+
+static NXstatus NXSgetslabs64(NXhandle handle, int nslab,
+			      const int64_t * start[],
+			      const int64_t * size[], void *data[])
+{
+	pNXsnapshot self = (pNXsnapshot) handle;
+	if (syncFile(self) != NX_OK) {
+		return NX_ERROR;
+	}
+	return self->file.nxgetslabs64(self->file.pNexusData, nslab, start,
+				       size, data);
+}
+
+static NXstatus NXSgetslab64s(NXhandle handle, void *data,
+			      const int64_t start[], const int64_t size[],
+			      const int64_t stride[], const int64_t block[])
+{
+	pNXsnapshot self = (pNXsnapshot) handle;
+	if (syncFile(self) != NX_OK) {
+		return NX_ERROR;
+	}
+	return self->file.nxgetslab64s(self->file.pNexusData, data, start,
+				       size, stride, block);
+}
+
+static NXstatus NXSgetpoints64(NXhandle handle, void *data, int64_t npoints,
+			       const int64_t coords[])
+{
+	pNXsnapshot self = (pNXsnapshot) handle;
+	if (syncFile(self) != NX_OK) {
+		return NX_ERROR;
+	}
+	return self->file.nxgetpoints64(self->file.pNexusData, data, npoints,
+					coords);
+}
+
+static NXstatus NXSgetchunk64(NXhandle handle, const int64_t offset[],
+			      unsigned int *filter_mask, void *data,
+			      int64_t * nbytes)
+{
+	pNXsnapshot self = (pNXsnapshot) handle;
+	if (syncFile(self) != NX_OK) {
+		return NX_ERROR;
+	}
+	return self->file.nxgetchunk64(self->file.pNexusData, offset,
+				       filter_mask, data, nbytes);
+}
+
+static NXstatus NXSgetchunkcount64(NXhandle handle, int64_t * nchunks)
+{
+	pNXsnapshot self = (pNXsnapshot) handle;
+	if (syncFile(self) != NX_OK) {
+		return NX_ERROR;
+	}
+	return self->file.nxgetchunkcount64(self->file.pNexusData, nchunks);
+}
+
+static NXstatus NXSgetchunkinfo64(NXhandle handle, int64_t index,
+				  int64_t offset[], unsigned int *filter_mask,
+				  int64_t * nbytes)
+{
+	pNXsnapshot self = (pNXsnapshot) handle;
+	if (syncFile(self) != NX_OK) {
+		return NX_ERROR;
+	}
+	return self->file.nxgetchunkinfo64(self->file.pNexusData, index,
+					   offset, filter_mask, nbytes);
+}
+
+static NXstatus NXSgetchunkdims64(NXhandle handle, int *rank,
+				  int64_t chunk[])
+{
+	pNXsnapshot self = (pNXsnapshot) handle;
+	if (syncFile(self) != NX_OK) {
+		return NX_ERROR;
+	}
+	return self->file.nxgetchunkdims64(self->file.pNexusData, rank, chunk);
+}
+
+static NXstatus NXSgetdataID(NXhandle handle, NXlink * pLink)
+{
+	pNXsnapshot self = (pNXsnapshot) handle;
+	if (syncFile(self) != NX_OK) {
+		return NX_ERROR;
+	}
+	return self->file.nxgetdataID(self->file.pNexusData, pLink);
+}
+
+static NXstatus NXSgetgroupID(NXhandle handle, NXlink * pLink)
+{
+	pNXsnapshot self = (pNXsnapshot) handle;
+	if (syncFile(self) != NX_OK) {
+		return NX_ERROR;
+	}
+	return self->file.nxgetgroupID(self->file.pNexusData, pLink);
+}
+
+static NXstatus NXSsameID(NXhandle handle, NXlink * pFirstID,
+			  NXlink * pSecondID)
+{
+	pNXsnapshot self = (pNXsnapshot) handle;
+	return self->file.nxsameID(self->file.pNexusData, pFirstID, pSecondID);
+}
+
+static NXstatus NXSprintlink(NXhandle handle, NXlink * link)
+{
+	pNXsnapshot self = (pNXsnapshot) handle;
+	return self->file.nxprintlink(self->file.pNexusData, link);
+}
+
+static NXstatus NXSnativeinquirefile(NXhandle handle, char *externalfile,
+				     const int filenamelength)
+{
+	pNXsnapshot self = (pNXsnapshot) handle;
+	return self->file.nxnativeinquirefile(self->file.pNexusData,
+					      externalfile, filenamelength);
+}
+
+static NXstatus NXSnativeisexternallink(NXhandle handle, CONSTCHAR * name,
+					char *url, int urllen)
+{
+	pNXsnapshot self = (pNXsnapshot) handle;
+	if (syncFile(self) != NX_OK) {
+		return NX_ERROR;
+	}
+	return self->file.nxnativeisexternallink(self->file.pNexusData, name,
+						 url, urllen);
+}
+
+/*------------------------------------------------------------------------
+  The index beside a file: a header with the stamp of the file, then one
+  record for everything NXvisit reports, in its order. Numbers are little
+  endian whatever the machine, strings are stored with their terminating
+  NUL.
+  ------------------------------------------------------------------------*/
+
+#define INDEXSUFFIX ".nxindex"
+#define INDEXMAGIC "NXINDEX2"
+#define NSTAMP 6
+
+#if defined(HAVE_STRUCT_STAT_ST_MTIM)
+#define MTIME_NSEC(st) ((st).st_mtim.tv_nsec)
+#define CTIME_NSEC(st) ((st).st_ctim.tv_nsec)
+#elif defined(HAVE_STRUCT_STAT_ST_MTIMESPEC)
+#define MTIME_NSEC(st) ((st).st_mtimespec.tv_nsec)
+#define CTIME_NSEC(st) ((st).st_ctimespec.tv_nsec)
+#else
+#define MTIME_NSEC(st) 0
+#define CTIME_NSEC(st) 0
+#endif
+
+typedef struct {
+	const char *data;
+	size_t length;
+	size_t pos;
+} NXindexReader;
+
+static char *indexName(CONSTCHAR * filename, const char *suffix)
+{
+	char *name;
+
+	name = (char *)malloc(strlen(filename) + strlen(INDEXSUFFIX) +
+			      strlen(suffix) + 1);
+	if (name != NULL) {
+		sprintf(name, "%s%s%s", filename, INDEXSUFFIX, suffix);
+	}
+	return name;
+}
+
+/*
+ * what tells that a file has changed since its index was written: values
+ * rewritten in place keep the size, and often the second of the
+ * modification time, but not its nanoseconds nor the change time; a file
+ * replaced by another one has a new inode
+ */
+static NXstatus fileStamp(CONSTCHAR * filename, int64_t stamp[NSTAMP])
+{
+	struct stat st;
+
+	if (stat(filename, &st) != 0) {
+		return NX_ERROR;
+	}
+	stamp[0] = (int64_t) st.st_size;
+	stamp[1] = (int64_t) st.st_mtime;
+	stamp[2] = (int64_t) MTIME_NSEC(st);
+	stamp[3] = (int64_t) st.st_ctime;
+	stamp[4] = (int64_t) CTIME_NSEC(st);
+	stamp[5] = (int64_t) st.st_ino;
+	return NX_OK;
+}
+
+static int sameStamp(const int64_t a[NSTAMP], const int64_t b[NSTAMP])
+{
+	int i;
+
+	for (i = 0; i < NSTAMP; i++) {
+		if (a[i] != b[i]) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+static void putNumber(FILE * fd, int64_t value, int nbytes)
+{
+	unsigned char buffer[8];
+	int i;
+
+	for (i = 0; i < nbytes; i++) {
+		buffer[i] = (unsigned char)(((uint64_t) value >> (8 * i)) & 0xff);
+	}
+	fwrite(buffer, 1, nbytes, fd);
+}
+
+static void putBytes(FILE * fd, const void *data, size_t length)
+{
+	putNumber(fd, (int64_t) length, 4);
+	if (length > 0) {
+		fwrite(data, 1, length, fd);
+	}
+}
+
+static void putString(FILE * fd, const char *text)
+{
+	putBytes(fd, text != NULL ? text : "",
+		 text != NULL ? strlen(text) + 1 : 1);
+}
+
+static int writeRecord(const NXvisitinfo * info, void *userdata)
+{
+	FILE *fd = (FILE *) userdata;
+	size_t length;
+	int i;
+
+	putNumber(fd, info->kind, 1);
+	putString(fd, info->path);
+	putString(fd, info->name);
+	putString(fd, info->nxclass);
+	putNumber(fd, info->type, 4);
+	putNumber(fd, info->rank, 4);
+	for (i = 0; i < info->rank; i++) {
+		putNumber(fd, info->dims[i], 8);
+	}
+	if (info->kind == NXVISIT_ATTRIBUTE && info->type == NX_CHAR) {
+		putString(fd, (const char *)info->value);
+	} else if (info->kind == NXVISIT_ATTRIBUTE && info->value != NULL) {
+		length = typeSize(info->type);
+		for (i = 0; i < info->rank; i++) {
+			length *= (size_t) info->dims[i];
+		}
+		putBytes(fd, info->value, length);
+	} else {
+		putBytes(fd, NULL, 0);
+	}
+	return ferror(fd) != 0;
+}
+
+static int getNumber(NXindexReader * in, int nbytes, int64_t * value)
+{
+	const unsigned char *buffer;
+	uint64_t v = 0;
+	int i;
+
+	if (in->length - in->pos < (size_t) nbytes) {
+		return 0;
+	}
+	buffer = (const unsigned char *)in->data + in->pos;
+	for (i = nbytes - 1; i >= 0; i--) {
+		v = (v << 8) | buffer[i];
+	}
+	/* sign extend the shorter numbers */
+	if (nbytes < 8 && (v >> (8 * nbytes - 1)) != 0) {
+		v |= ~(uint64_t) 0 << (8 * nbytes);
+	}
+	*value = (int64_t) v;
+	in->pos += nbytes;
+	return 1;
+}
+
+static int getBytes(NXindexReader * in, const void **data, size_t * length)
+{
+	int64_t n;
+
+	if (!getNumber(in, 4, &n) || n < 0
+	    || in->length - in->pos < (size_t) n) {
+		return 0;
+	}
+	*data = n > 0 ? in->data + in->pos : NULL;
+	*length = (size_t) n;
+	in->pos += (size_t) n;
+	return 1;
+}
+
+static int getString(NXindexReader * in, const char **text)
+{
+	const void *data;
+	size_t length;
+
+	if (!getBytes(in, &data, &length) || length == 0
+	    || ((const char *)data)[length - 1] != '\0') {
+		return 0;
+	}
+	*text = (const char *)data;
+	return 1;
+}
+
+/*
+ * reads the index into memory, checking that it was written for the file
+ * as it is now
+ */
+static char *readIndex(CONSTCHAR * filename, size_t * length)
+{
+	int64_t stamp[NSTAMP], now[NSTAMP];
+	NXindexReader in;
+	char *name, *data = NULL;
+	FILE *fd;
+	long size;
+	int i;
+
+	name = indexName(filename, "");
+	if (name == NULL) {
+		return NULL;
+	}
+	fd = fopen(name, "rb");
+	free(name);
+	if (fd == NULL) {
+		return NULL;
+	}
+	if (fseek(fd, 0, SEEK_END) == 0 && (size = ftell(fd)) > 0
+	    && fseek(fd, 0, SEEK_SET) == 0) {
+		data = (char *)malloc((size_t) size);
+		if (data != NULL && fread(data, 1, (size_t) size, fd)
+		    != (size_t) size) {
+			free(data);
+			data = NULL;
+		}
+	}
+	fclose(fd);
+	if (data == NULL) {
+		return NULL;
+	}
+	in.data = data;
+	in.length = (size_t) size;
+	in.pos = strlen(INDEXMAGIC);
+	if (in.length < in.pos || memcmp(data, INDEXMAGIC, in.pos) != 0) {
+		free(data);
+		return NULL;
+	}
+	for (i = 0; i < NSTAMP; i++) {
+		if (!getNumber(&in, 8, &stamp[i])) {
+			free(data);
+			return NULL;
+		}
+	}
+	if (fileStamp(filename, now) != NX_OK || !sameStamp(stamp, now)) {
+		free(data);
+		return NULL;
+	}
+	*length = in.length;
+	return data;
+}
+
+/* fills the tree from an index, returning NX_EOD if it is malformed */
+static NXstatus loadIndex(pNXsnapshot self, const char *data, size_t length)
+{
+	NXindexReader in;
+	NXvisitinfo info;
+	int64_t number;
+	size_t size, expected;
+	int i;
+
+	in.data = data;
+	in.length = length;
+	in.pos = strlen(INDEXMAGIC) + 8 * NSTAMP;
+	while (getNumber(&in, 1, &number)) {
+		if (number == 0) {
+			return NX_OK;
+		}
+		memset(&info, 0, sizeof(info));
+		info.kind = (int)number;
+		if (info.kind < NXVISIT_GROUP || info.kind > NXVISIT_ATTRIBUTE
+		    || !getString(&in, &info.path) || info.path[0] != '/'
+		    || !getString(&in, &info.name)
+		    || !getString(&in, &info.nxclass)
+		    || !getNumber(&in, 4, &number)) {
+			return NX_EOD;
+		}
+		info.type = (int)number;
+		if (!getNumber(&in, 4, &number) || number < 0
+		    || number > NX_MAXRANK) {
+			return NX_EOD;
+		}
+		info.rank = (int)number;
+		expected = typeSize(info.type);
+		for (i = 0; i < info.rank; i++) {
+			if (!getNumber(&in, 8, &info.dims[i])
+			    || info.dims[i] < 0) {
+				return NX_EOD;
+			}
+			expected *= (size_t) info.dims[i];
+		}
+		if (!getBytes(&in, &info.value, &size)) {
+			return NX_EOD;
+		}
+		if (info.kind != NXVISIT_ATTRIBUTE) {
+			expected = 0;
+		} else if (info.type == NX_CHAR) {
+			expected = size > 0
+			    && ((const char *)info.value)[size - 1] == '\0' ?
+			    size : size + 1;
+		}
+		if (size != expected) {
+			return NX_EOD;
+		}
+		if (addObject(&info, self) != 0) {
+			return NX_ERROR;
+		}
+	}
+	/* the end of the index came before the terminating record */
+	return NX_EOD;
+}
+
+NXstatus NXmakeindex(CONSTCHAR * filename)
+{
+	int64_t before[NSTAMP], after[NSTAMP];
+	char *name, *temporary, pBuffer[1024];
+	NXhandle fid = NULL;
+	NXstatus status;
+	FILE *fd;
+	int i;
+
+	name = indexName(filename, "");
+	temporary = indexName(filename, ".tmp");
+	if (name == NULL || temporary == NULL) {
+		free(name);
+		free(temporary);
+		NXReportError("ERROR: no memory for the index name");
+		return NX_ERROR;
+	}
+	if (fileStamp(filename, before) != NX_OK
+	    || NXopen(filename, NXACC_READ, &fid) != NX_OK) {
+		snprintf(pBuffer, sizeof(pBuffer),
+			 "ERROR: cannot index %s", filename);
+		NXReportError(pBuffer);
+		free(name);
+		free(temporary);
+		return NX_ERROR;
+	}
+	fd = fopen(temporary, "wb");
+	if (fd == NULL) {
+		snprintf(pBuffer, sizeof(pBuffer),
+			 "ERROR: cannot write index %s", temporary);
+		NXReportError(pBuffer);
+		NXclose(&fid);
+		free(name);
+		free(temporary);
+		return NX_ERROR;
+	}
+	fwrite(INDEXMAGIC, 1, strlen(INDEXMAGIC), fd);
+	for (i = 0; i < NSTAMP; i++) {
+		putNumber(fd, before[i], 8);
+	}
+	status = NXvisit(fid, NXVISIT_WITH_ATTRIBUTES |
+			 NXVISIT_ATTRIBUTE_VALUES, writeRecord, fd);
+	putNumber(fd, 0, 1);
+	if (fclose(fd) != 0 && status == NX_OK) {
+		status = NX_EOD;
+	}
+	NXclose(&fid);
+
+	/* an index of a file changed meanwhile would never be used */
+	if (status == NX_OK && (fileStamp(filename, after) != NX_OK
+				|| !sameStamp(after, before))) {
+		snprintf(pBuffer, sizeof(pBuffer),
+			 "ERROR: %s changed while it was indexed", filename);
+		NXReportError(pBuffer);
+		status = NX_ERROR;
+	} else if (status == NX_EOD) {
+		snprintf(pBuffer, sizeof(pBuffer),
+			 "ERROR: failed to write index %s", temporary);
+		NXReportError(pBuffer);
+		status = NX_ERROR;
+	}
+	if (status == NX_OK) {
+		/* rename does not replace files everywhere */
+		remove(name);
+		if (rename(temporary, name) != 0) {
+			snprintf(pBuffer, sizeof(pBuffer),
+				 "ERROR: cannot rename index to %s", name);
+			NXReportError(pBuffer);
+			status = NX_ERROR;
+		}
+	}
+	if (status != NX_OK) {
+		remove(temporary);
+	}
+	free(name);
+	free(temporary);
+	return status;
+}
+
+NXstatus NXcheckindex(CONSTCHAR * filename)
+{
+	char *data;
+	size_t length;
+
+	data = readIndex(filename, &length);
+	if (data == NULL) {
+		return NX_EOD;
+	}
+	free(data);
+	return NX_OK;
+}
+
+/*----------------------------------------------------------------------*/
+static void NXSassignFunctions(pNexusFunction fHandle, pNXsnapshot self)
+{
+	pNexusFunction file = &self->file;
+
+	/* only what the driver of the file has, napi.c checks for NULL */
+	memset(fHandle, 0, sizeof(NexusFunction));
+	fHandle->pNexusData = self;
+	fHandle->stripFlag = file->stripFlag;
+	fHandle->checkNameSyntax = file->checkNameSyntax;
+	fHandle->nxclose = NXSclose;
+	fHandle->nxflush = NXSflush;
+	fHandle->nxmakegroup = NXSmakegroup;
+	fHandle->nxopengroup = NXSopengroup;
+	fHandle->nxclosegroup = NXSclosegroup;
+	fHandle->nxmakedata64 = NXSmakedata64;
+	fHandle->nxcompmakedata64 = NXScompmakedata64;
+	fHandle->nxcompress = NXScompress;
+	fHandle->nxopendata = NXSopendata;
+	fHandle->nxclosedata = NXSclosedata;
+	fHandle->nxputdata = NXSputdata;
+	fHandle->nxputattr = NXSputattr;
+	fHandle->nxputattra = NXSputattra;
+	fHandle->nxputslab64 = NXSputslab64;
+	fHandle->nxgetdataID = NXSgetdataID;
+	fHandle->nxmakelink = NXSmakelink;
+	fHandle->nxmakenamedlink = NXSmakenamedlink;
+	fHandle->nxgetdata = NXSgetdata;
+	fHandle->nxgetinfo64 = NXSgetinfo64;
+	if (file->nxgetstrings != NULL) {
+		fHandle->nxgetstrings = NXSgetstrings;
+	}
+	fHandle->nxvisit = NXSvisit;
+	fHandle->nxgetnextentry = NXSgetnextentry;
+	fHandle->nxgetslab64 = NXSgetslab64;
+	if (file->nxgetslabs64 != NULL) {
+		fHandle->nxgetslabs64 = NXSgetslabs64;
+	}
+	if (file->nxgetslab64s != NULL) {
+		fHandle->nxgetslab64s = NXSgetslab64s;
+	}
+	if (file->nxgetpoints64 != NULL) {
+		fHandle->nxgetpoints64 = NXSgetpoints64;
+	}
+	if (file->nxgetchunk64 != NULL) {
+		fHandle->nxgetchunk64 = NXSgetchunk64;
+	}
+	if (file->nxgetchunkcount64 != NULL) {
+		fHandle->nxgetchunkcount64 = NXSgetchunkcount64;
+	}
+	if (file->nxgetchunkinfo64 != NULL) {
+		fHandle->nxgetchunkinfo64 = NXSgetchunkinfo64;
+	}
+	if (file->nxgetchunkdims64 != NULL) {
+		fHandle->nxgetchunkdims64 = NXSgetchunkdims64;
+	}
+	fHandle->nxgetnextattr = NXSgetnextattr;
+	fHandle->nxgetnextattra = NXSgetnextattra;
+	fHandle->nxgetattr = NXSgetattr;
+	fHandle->nxgetattra = NXSgetattra;
+	fHandle->nxgetattrainfo = NXSgetattrainfo;
+	fHandle->nxgetattrinfo = NXSgetattrinfo;
+	fHandle->nxgetgroupID = NXSgetgroupID;
+	fHandle->nxgetgroupinfo = NXSgetgroupinfo;
+	fHandle->nxsameID = NXSsameID;
+	fHandle->nxinitgroupdir = NXSinitgroupdir;
+	fHandle->nxinitattrdir = NXSinitattrdir;
+	fHandle->nxprintlink = NXSprintlink;
+	if (file->nxnativeinquirefile != NULL) {
+		fHandle->nxnativeinquirefile = NXSnativeinquirefile;
+	}
+	if (file->nxnativeisexternallink != NULL) {
+		fHandle->nxnativeisexternallink = NXSnativeisexternallink;
+	}
+}
+
+NXstatus NXsnapshotopen(NXhandle fid)
+{
+	pNexusFunction fHandle = peekFileOnStack((pFileStack) fid);
+	pNXsnapshot self;
+	NXstatus status;
+	char *index;
+	size_t length;
+
+	self = (pNXsnapshot) calloc(1, sizeof(NXsnapshot));
+	if (self == NULL) {
+		NXReportError("ERROR: no memory for the snapshot");
+		return NX_ERROR;
+	}
+	self->root = makeNode("", "NXroot");
+	if (self->root == NULL) {
+		free(self);
+		NXReportError("ERROR: no memory for the snapshot");
+		return NX_ERROR;
+	}
+	self->group[0] = self->fileGroup[0] = self->root;
+	self->status = NX_OK;
+
+	/* an index beside the file saves the walk, unless it is damaged */
+	status = NX_EOD;
+	index = readIndex(peekFilenameOnStack((pFileStack) fid), &length);
+	if (index != NULL) {
+		status = loadIndex(self, index, length);
+		free(index);
+		if (status == NX_EOD) {
+			killNode(self->root);
+			self->root = makeNode("", "NXroot");
+			if (self->root == NULL) {
+				free(self);
+				NXReportError("ERROR: no memory for the snapshot");
+				return NX_ERROR;
+			}
+			self->group[0] = self->fileGroup[0] = self->root;
+			self->depth = 0;
+		}
+	}
+	if (status == NX_EOD) {
+		status = NXvisit(fid, NXVISIT_WITH_ATTRIBUTES |
+				 NXVISIT_ATTRIBUTE_VALUES, addObject, self);
+	}
+	if (status != NX_OK || self->status != NX_OK) {
+		if (self->status != NX_OK) {
+			NXReportError("ERROR: no memory for the snapshot");
+		}
+		killNode(self->root);
+		free(self);
+		return NX_ERROR;
+	}
+	self->depth = 0;
+	self->last = NULL;
+
+	memcpy(&self->file, fHandle, sizeof(NexusFunction));
+	NXSassignFunctions(fHandle, self);
+	return NX_OK;
+}
@@ -0,0 +1,31 @@
+/*
+  A driver answering navigation and attribute calls from a snapshot of
+  the metadata of a file, for files opened with NXACC_SNAPSHOT.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  For further information, see <http://www.nexusformat.org>
+*/
+#ifndef NEXUSSNAPSHOT
+#define NEXUSSNAPSHOT
+
+/*
+  reads the metadata of the file just opened on top of the stack of fid,
+  which must be at its root, and puts the snapshot driver in front of the
+  driver of the file
+*/
+NXstatus NXsnapshotopen(NXhandle fid);
+
+#endif
@@ -45,6 +45,8 @@ typedef struct __fileStack {
   fileStackEntry fileStack[MAXEXTERNALDEPTH];
   int pathPointer;
   char pathStack[NXMAXSTACK][NX_MAXNAMELEN];
+  void *index;
+  indexFreeFunc freeIndex;
 }fileStack;
 /*---------------------------------------------------------------------*/
 pFileStack makeFileStack(){
@@ -62,6 +64,7 @@ pFileStack makeFileStack(){
 /*---------------------------------------------------------------------*/
 void killFileStack(pFileStack self){
   if(self != NULL){
+    dropIndexOnStack(self);
     free(self);
   }
 }
@@ -144,3 +147,21 @@ int buildPath(pFileStack self, char *path, int pathlen){
   free(totalPath);
   return 1;
 }
+/*----------------------------------------------------------------------*/
+void *peekIndexOnStack(pFileStack self){
+  return self->index;
+}
+/*----------------------------------------------------------------------*/
+void setIndexOnStack(pFileStack self, void *index, indexFreeFunc freeFunc){
+  dropIndexOnStack(self);
+  self->index = index;
+  self->freeIndex = freeFunc;
+}
+/*----------------------------------------------------------------------*/
+void dropIndexOnStack(pFileStack self){
+  if(self->index != NULL && self->freeIndex != NULL){
+    self->freeIndex(self->index);
+  }
+  self->index = NULL;
+  self->freeIndex = NULL;
+}
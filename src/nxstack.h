@@ -48,5 +48,15 @@ void pushPath(pFileStack self, const char *name);
 void popPath(pFileStack self);
 int buildPath(pFileStack self, char *path, int pathlen);
 
+/*
+  an opaque search index kept with the file handle, see napiu.c. It is
+  freed with freeFunc when dropped, which happens on every change to the
+  file made through this handle.
+*/
+typedef void (*indexFreeFunc)(void *index);
+void *peekIndexOnStack(pFileStack self);
+void setIndexOnStack(pFileStack self, void *index, indexFreeFunc freeFunc);
+void dropIndexOnStack(pFileStack self);
+
 #endif
 
@@ -84,7 +84,8 @@ typedef struct {
 /*---------------------------------------------------------------------*/
 typedef struct {
   mxml_node_t *root;           /* root node */
-  int readOnly;                /* read only flag */
+  int *rootRefs;               /* handles sharing root, see NXXreopen */
+  int readOnly;                /* not written back to the file */
   int tableStyle;              /**< whether to output data in XML table style */
   int stackPointer;            /* stack pointer */
   char filename[1024];         /* file name, for NXflush, NXclose */
@@ -93,30 +94,39 @@ typedef struct {
 /*===================== support functions ===============================*/
 extern char *stptok(char *s, char *tok, size_t toklen, char *brk);
 /*----------------------------------------------------------------------*/
-static mxml_node_t *getLinkTarget(pXMLNexus xmlHandle, const char *target){
-  mxml_node_t *node = NULL;
+static mxml_node_t *findPathNode(mxml_node_t *node, const char *path){
   mxml_node_t *testNode = NULL;
-  char path[132], *pPtr;
+  char element[132], *pPtr;
 
-  pPtr = (char *)target + 1;
-  node = xmlHandle->stack[0].current;
-  while((pPtr = stptok(pPtr,path,131,"/")) != NULL){
+  pPtr = (char *)path;
+  while((pPtr = stptok(pPtr,element,131,"/")) != NULL){
+    if(strlen(element) == 0){
+      continue;
+    }
     /*
       search for group node
     */
-    testNode = mxmlFindElement(node,node,NULL,"name",path,MXML_DESCEND_FIRST);
+    testNode = mxmlFindElement(node,node,NULL,"name",element,MXML_DESCEND_FIRST);
     if(testNode == NULL){
       /*
 	it can still be a data node
       */
-      testNode = mxmlFindElement(node,node,path,NULL,NULL,MXML_DESCEND_FIRST);
+      testNode = mxmlFindElement(node,node,element,NULL,NULL,MXML_DESCEND_FIRST);
     }
     if(testNode == NULL){
-      NXReportError("Cannot follow broken link");
       return NULL;
-    } else {
-      node = testNode;
     }
+    node = testNode;
+  }
+  return node;
+}
+/*----------------------------------------------------------------------*/
+static mxml_node_t *getLinkTarget(pXMLNexus xmlHandle, const char *target){
+  mxml_node_t *node = NULL;
+
+  node = findPathNode(xmlHandle->stack[0].current, target + 1);
+  if(node == NULL){
+    NXReportError("Cannot follow broken link");
   }
   return node;
 }
@@ -124,6 +134,40 @@ static mxml_node_t *getLinkTarget(pXMLNexus xmlHandle, const char *target){
 static void errorCallbackForMxml(const char *txt){
   NXReportError((char *)txt);
 }
+/*----------------------------------------------------------------------
+  Common end of NXXopen and NXXopenbuffer: the parsed tree must hold an
+  NXroot, which the navigation stack starts at.
+  -----------------------------------------------------------------------*/
+static NXstatus initXMLRoot(pXMLNexus xmlHandle, NXhandle* pHandle){
+  xmlHandle->stack[0].current = mxmlFindElement(xmlHandle->root,
+						xmlHandle->root,
+						"NXroot",
+						NULL,NULL,
+						MXML_DESCEND);
+  xmlHandle->stack[0].currentChild = NULL;
+  xmlHandle->stack[0].currentAttribute = 0;
+  xmlHandle->stack[0].options = 0;
+  if(xmlHandle->stack[0].current == NULL){
+      NXReportError(
+		     "No NXroot element in XML-file, no NeXus-XML file");
+      if(xmlHandle->root != NULL){
+	mxmlDelete(xmlHandle->root);
+      }
+      free(xmlHandle);
+      return NX_ERROR;
+  }
+  xmlHandle->rootRefs = (int *)malloc(sizeof(int));
+  if(xmlHandle->rootRefs == NULL){
+    NXReportError( "Out of memory allocating XML file handle");
+    mxmlDelete(xmlHandle->root);
+    free(xmlHandle);
+    return NX_ERROR;
+  }
+  *xmlHandle->rootRefs = 1;
+
+  *pHandle = xmlHandle;
+  return NX_OK;
+}
 /*-----------------------------------------------------------------------*/
 NXstatus  NXXopen(CONSTCHAR *filename, NXaccess am, 
 			       NXhandle* pHandle) {
@@ -166,14 +210,6 @@ NXstatus  NXXopen(CONSTCHAR *filename, NXaccess am,
       return NX_ERROR;
     }
     xmlHandle->root = mxmlLoadFile(NULL,fp,nexusTypeCallback);
-    xmlHandle->stack[0].current = mxmlFindElement(xmlHandle->root,
-						  xmlHandle->root,
-						  "NXroot",
-						  NULL,NULL,
-						  MXML_DESCEND);
-    xmlHandle->stack[0].currentChild = NULL;
-    xmlHandle->stack[0].currentAttribute = 0;
-    xmlHandle->stack[0].options = 0;
     fclose(fp);
     break;
   case NXACC_CREATEXML:
@@ -192,22 +228,89 @@ NXstatus  NXXopen(CONSTCHAR *filename, NXaccess am,
       mxmlElementSetAttr(current,"file_time",time_buffer);
       free(time_buffer);
     } 
-    xmlHandle->stack[0].current = current;
-    xmlHandle->stack[0].currentChild = NULL;
-    xmlHandle->stack[0].currentAttribute = 0;
-    xmlHandle->stack[0].options = 0;
     break;
   default:
     NXReportError("Bad access parameter specified in NXXopen");
+    free(xmlHandle);
     return NX_ERROR;
   }
-  if(xmlHandle->stack[0].current == NULL){
-      NXReportError(
-		     "No NXroot element in XML-file, no NeXus-XML file");
-      return NX_ERROR;
+  /*
+    the tree is kept in memory anyway, NXACC_CORE makes no difference
+  */
+  if(am & NXACC_CORE_NOSTORE){
+    xmlHandle->readOnly = 1;
+  }
+  return initXMLRoot(xmlHandle, pHandle);
+}
+/*----------------------------------------------------------------------
+  A buffer is parsed like a file, changes stay in memory
+  -----------------------------------------------------------------------*/
+NXstatus  NXXopenbuffer(const void* buffer, size_t size, NXaccess am,
+			NXhandle* pHandle){
+  pXMLNexus xmlHandle = NULL;
+  char *text = NULL;
+
+  *pHandle = NULL;
+  xmlHandle = (pXMLNexus)malloc(sizeof(XMLNexus));
+  if(!xmlHandle){
+    NXReportError( "Out of memory allocating XML file handle");
+    return NX_ERROR;
   }
+  memset(xmlHandle,0,sizeof(XMLNexus));
+  mxmlSetCustomHandlers(nexusLoadCallback, nexusWriteCallback);
+  initializeNumberFormats();
+  mxmlSetErrorCallback(errorCallbackForMxml);
 
-  *pHandle = xmlHandle;
+  /*
+    mxml wants a terminated string, the buffer need not be one
+  */
+  text = (char *)malloc(size + 1);
+  if(text == NULL){
+    NXReportError( "Out of memory copying XML buffer");
+    free(xmlHandle);
+    return NX_ERROR;
+  }
+  memcpy(text, buffer, size);
+  text[size] = '\0';
+  xmlHandle->root = mxmlLoadString(NULL,text,nexusTypeCallback);
+  free(text);
+  xmlHandle->readOnly = 1;
+  snprintf(xmlHandle->filename,sizeof(xmlHandle->filename),
+	   "memory:%p",buffer);
+  return initXMLRoot(xmlHandle, pHandle);
+}
+/*----------------------------------------------------------------------
+  A reopened handle shares the parsed tree of the original and gets a
+  navigation stack of its own, starting at NXroot. The tree is written
+  back and freed when the last handle sharing it is closed. The
+  reference count is only touched in NXXreopen and NXXclose, which run
+  under the NeXus API lock.
+  -----------------------------------------------------------------------*/
+NXstatus  NXXreopen(NXhandle pOrigHandle, NXhandle* pNewHandle){
+  pXMLNexus xmlHandle = NULL, origHandle = NULL;
+
+  *pNewHandle = NULL;
+  origHandle = (pXMLNexus)pOrigHandle;
+  assert(origHandle);
+
+  xmlHandle = (pXMLNexus)malloc(sizeof(XMLNexus));
+  if(!xmlHandle){
+    NXReportError( "Out of memory allocating XML file handle");
+    return NX_ERROR;
+  }
+  memset(xmlHandle,0,sizeof(XMLNexus));
+  xmlHandle->root = origHandle->root;
+  xmlHandle->rootRefs = origHandle->rootRefs;
+  xmlHandle->readOnly = origHandle->readOnly;
+  xmlHandle->tableStyle = origHandle->tableStyle;
+  strcpy(xmlHandle->filename,origHandle->filename);
+  xmlHandle->stack[0].current = origHandle->stack[0].current;
+  xmlHandle->stack[0].currentChild = NULL;
+  xmlHandle->stack[0].currentAttribute = 0;
+  xmlHandle->stack[0].options = 0;
+  (*xmlHandle->rootRefs)++;
+
+  *pNewHandle = xmlHandle;
   return NX_OK;
 }
 /*----------------------------------------------------------------------*/
@@ -218,16 +321,24 @@ NXstatus  NXXclose (NXhandle* fid){
   xmlHandle = (pXMLNexus)*fid;
   assert(xmlHandle);
   
-  if(xmlHandle->readOnly == 0) {
-    fp = fopen(xmlHandle->filename,"w");
-    if(fp == NULL){
-      NXReportError("Failed to open NeXus XML file for writing");
-      return NX_ERROR;
+  /*
+    only the last handle sharing the tree writes it back to the file
+  */
+  if(*xmlHandle->rootRefs == 1) {
+    if(xmlHandle->readOnly == 0) {
+      fp = fopen(xmlHandle->filename,"w");
+      if(fp == NULL){
+	NXReportError("Failed to open NeXus XML file for writing");
+	return NX_ERROR;
+      }
+      mxmlSaveFile(xmlHandle->root,fp,NXwhitespaceCallback);
+      fclose(fp);
     }
-    mxmlSaveFile(xmlHandle->root,fp,NXwhitespaceCallback);
-    fclose(fp);
+    mxmlDelete(xmlHandle->root);
+    free(xmlHandle->rootRefs);
+  } else {
+    (*xmlHandle->rootRefs)--;
   }
-  mxmlDelete(xmlHandle->root);
   free(xmlHandle);
   *fid = NULL;
   return NX_OK;
@@ -1199,6 +1310,127 @@ NXstatus  NXXgetslab64 (NXhandle fid, void *data,
   
   return NX_OK;
 }
+/*--------------------------------------------------------------------
+  Like getSlabData, but element i along dim comes from
+  start + (i / block) * stride + i % block
+----------------------------------------------------------------------*/
+static void getStridedSlabData(pNXDS dataset, pNXDS slabData, int dim,
+			const int64_t start[], const int64_t stride[],
+			const int64_t block[],
+			int64_t sourcePos[],int64_t targetPos[]){
+  int64_t i, rank, length, myStride, myBlock;
+
+  rank = getNXDatasetRank(slabData);
+  length = getNXDatasetDim(slabData,dim);
+  myStride = (stride == NULL) ? 1 : stride[dim];
+  myBlock = (block == NULL) ? 1 : block[dim];
+  for(i = 0; i < length; i++){
+    sourcePos[dim] = start[dim] + (i/myBlock)*myStride + i%myBlock;
+    targetPos[dim] = i;
+    if(dim != rank-1){
+      getStridedSlabData(dataset,slabData, dim+1,start,stride,block,
+		  sourcePos,targetPos);
+    } else {
+      putNXDatasetValue(slabData,targetPos,
+			getNXDatasetValue(dataset,sourcePos));
+    }
+  }
+}
+/*----------------------------------------------------------------------*/
+static pNXDS getOpenDataset(pXMLNexus xmlHandle){
+  mxml_node_t *userData = NULL;
+  mxml_node_t *current = NULL;
+
+  if(!isDataNode(xmlHandle->stack[xmlHandle->stackPointer].current)){
+    NXReportError("No dataset open");
+    return NULL;
+  }
+  current = xmlHandle->stack[xmlHandle->stackPointer].current;
+  userData = findData(current);
+  assert(userData != NULL);
+  if(userData->type == MXML_OPAQUE){
+    NXReportError("This API does not support slabs on text data");
+    return NULL;
+  }
+  return (pNXDS)userData->value.custom.data;
+}
+/*----------------------------------------------------------------------*/
+NXstatus  NXXgetslab64s (NXhandle fid, void *data,
+			 const int64_t iStart[], const int64_t iSize[],
+			 const int64_t iStride[], const int64_t iBlock[]){
+  pXMLNexus xmlHandle = NULL;
+  pNXDS dataset, slabData;
+  int64_t sourcePos[NX_MAXRANK], targetPos[NX_MAXRANK], mySize[NX_MAXRANK];
+  int i;
+
+  xmlHandle = (pXMLNexus)fid;
+  assert(xmlHandle);
+
+  dataset = getOpenDataset(xmlHandle);
+  if(dataset == NULL){
+    return NX_ERROR;
+  }
+  for(i = 0; i < getNXDatasetRank(dataset); i++){
+    mySize[i] = iSize[i] * ((iBlock == NULL) ? 1 : iBlock[i]);
+    if(mySize[i] == 0){
+      return NX_OK;
+    }
+  }
+  slabData = makeSlabData(dataset, data, mySize);
+  if(slabData == NULL){
+    NXReportError("Failed to allocate slab data");
+    return NX_ERROR;
+  }
+  getStridedSlabData(dataset,slabData,0,iStart,iStride,iBlock,
+		     sourcePos,targetPos);
+  free(slabData->dim);
+  free(slabData);
+  
+  return NX_OK;
+}
+/*----------------------------------------------------------------------*/
+NXstatus  NXXgetpoints64 (NXhandle fid, void *data,
+			  int64_t npoints, const int64_t coords[]){
+  pXMLNexus xmlHandle = NULL;
+  pNXDS dataset, pointData;
+  int64_t sourcePos[NX_MAXRANK], pointDim[NX_MAXRANK], p;
+  int i, rank;
+
+  xmlHandle = (pXMLNexus)fid;
+  assert(xmlHandle);
+
+  dataset = getOpenDataset(xmlHandle);
+  if(dataset == NULL){
+    return NX_ERROR;
+  }
+  rank = getNXDatasetRank(dataset);
+  for(i = 0; i < rank; i++){
+    pointDim[i] = 1;
+  }
+  pointDim[0] = npoints;
+  pointData = makeSlabData(dataset, data, pointDim);
+  if(pointData == NULL){
+    NXReportError("Failed to allocate point data");
+    return NX_ERROR;
+  }
+  pointData->rank = 1;
+  for(p = 0; p < npoints; p++){
+    for(i = 0; i < rank; i++){
+      sourcePos[i] = coords[p*rank + i];
+      if(sourcePos[i] < 0 || sourcePos[i] >= getNXDatasetDim(dataset,i)){
+	NXReportError("Point outside of dataset");
+	free(pointData->dim);
+	free(pointData);
+	return NX_ERROR;
+      }
+    }
+    putNXDatasetValueAt(pointData,p,getNXDatasetValue(dataset,sourcePos));
+  }
+  free(pointData->dim);
+  free(pointData);
+
+  return NX_OK;
+}
 /*----------------------------------------------------------------------*/
 static NXstatus  NXXsetnumberformat(NXhandle fid,
 						 int type, char *format){
@@ -1965,6 +2197,96 @@ int  NXXcompress(NXhandle fid, int comp){
   return NX_OK;
 }
 
+/*----------------------------------------------------------------------
+  Object handles are nodes of the tree. For the duration of a call the
+  node is pushed onto the stack, as NXXopendata would do, and the stack
+  is put back afterwards.
+  ----------------------------------------------------------------------*/
+typedef struct {
+  mxml_node_t *node;
+  int savedPointer;
+  xmlStack savedEntry;
+}XMLObject, *pXMLObject;
+/*----------------------------------------------------------------------*/
+NXstatus  NXXobjopen(NXhandle fid, CONSTCHAR *path, void **object){
+  pXMLNexus xmlHandle = NULL;
+  pXMLObject obj = NULL;
+  mxml_node_t *start = NULL, *node = NULL;
+  int stackPtr;
+  char error[1024];
+
+  xmlHandle = (pXMLNexus)fid;
+  assert(xmlHandle);
+
+  if(xmlHandle->tableStyle){
+    NXReportError("Object handles are not supported for table style files");
+    return NX_ERROR;
+  }
+  stackPtr = xmlHandle->stackPointer;
+  if(path[0] == '/'){
+    start = xmlHandle->stack[0].current;
+  } else {
+    if(isDataNode(xmlHandle->stack[stackPtr].current) && stackPtr > 0){
+      stackPtr--;
+    }
+    start = xmlHandle->stack[stackPtr].current;
+  }
+  node = findPathNode(start, path);
+  if(node == NULL){
+    snprintf(error,1023,"Object %s not found",path);
+    NXReportError(error);
+    return NX_ERROR;
+  }
+  obj = (pXMLObject)malloc(sizeof(XMLObject));
+  if(obj == NULL){
+    NXReportError("Out of memory allocating object");
+    return NX_ERROR;
+  }
+  memset(obj,0,sizeof(XMLObject));
+  obj->node = node;
+  *object = obj;
+  return NX_OK;
+}
+/*----------------------------------------------------------------------*/
+NXstatus  NXXobjclose(NXhandle fid, void *object){
+  free(object);
+  return NX_OK;
+}
+/*----------------------------------------------------------------------*/
+NXstatus  NXXobjenter(NXhandle fid, void *object){
+  pXMLNexus xmlHandle = NULL;
+  pXMLObject obj = (pXMLObject)object;
+  int stackPtr;
+
+  xmlHandle = (pXMLNexus)fid;
+  assert(xmlHandle);
+
+  stackPtr = xmlHandle->stackPointer + 1;
+  if(stackPtr >= NXMAXSTACK){
+    NXReportError("Stack overflow using object");
+    return NX_ERROR;
+  }
+  obj->savedPointer = xmlHandle->stackPointer;
+  obj->savedEntry = xmlHandle->stack[stackPtr];
+  xmlHandle->stackPointer = stackPtr;
+  xmlHandle->stack[stackPtr].current = obj->node;
+  xmlHandle->stack[stackPtr].currentChild = NULL;
+  xmlHandle->stack[stackPtr].currentAttribute = 0;
+  xmlHandle->stack[stackPtr].options = 0;
+  return NX_OK;
+}
+/*----------------------------------------------------------------------*/
+NXstatus  NXXobjleave(NXhandle fid, void *object){
+  pXMLNexus xmlHandle = NULL;
+  pXMLObject obj = (pXMLObject)object;
+
+  xmlHandle = (pXMLNexus)fid;
+  assert(xmlHandle);
+
+  xmlHandle->stack[obj->savedPointer + 1] = obj->savedEntry;
+  xmlHandle->stackPointer = obj->savedPointer;
+  return NX_OK;
+}
 /*--------------------------------------------------------------------*/
 NXstatus  NXXputattra(NXhandle handle, CONSTCHAR* name, const void* data, const int rank, const int dim[], const int iType) 
 {
@@ -1996,7 +2318,7 @@ NXstatus  NXXgetattrainfo(NXhandle handle, NXname pName, int *rank, int dim[], i
 /*----------------------------------------------------------------------*/
 void NXXassignFunctions(pNexusFunction fHandle){
       fHandle->nxclose=NXXclose;
-	  fHandle->nxreopen=NULL;
+	  fHandle->nxreopen=NXXreopen;
       fHandle->nxflush=NXXflush;
       fHandle->nxmakegroup=NXXmakegroup;
       fHandle->nxopengroup=NXXopengroup;
@@ -2016,6 +2338,12 @@ void NXXassignFunctions(pNexusFunction fHandle){
       fHandle->nxgetinfo64=NXXgetinfo64;
       fHandle->nxgetnextentry=NXXgetnextentry;
       fHandle->nxgetslab64=NXXgetslab64;
+      fHandle->nxgetslab64s=NXXgetslab64s;
+      fHandle->nxgetpoints64=NXXgetpoints64;
+      fHandle->nxobjopen=NXXobjopen;
+      fHandle->nxobjclose=NXXobjclose;
+      fHandle->nxobjenter=NXXobjenter;
+      fHandle->nxobjleave=NXXobjleave;
       fHandle->nxgetnextattr=NXXgetnextattr;
       fHandle->nxgetattr=NXXgetattr;
       fHandle->nxgetattrinfo=NXXgetattrinfo;
@@ -375,6 +375,28 @@ int readTest(const string & filename) {
 	if (doubles[1] != 21.0) return 1;
 	file.closeData();
 
+	// the rows of a character array as strings
+	vector<string> strings;
+	file.openData("c1_data");
+	file.getData(strings);
+	if (strings.size() != 5) return 1;
+	if (strings[0] != "abcd" || strings[4] != "qrst") return 1;
+	file.closeData();
+
+	// read rows 1 and 3 of r8_data in one call
+	vector<vector<double> > slabs;
+	vector<vector<int64_t> > slab_starts(2, vector<int64_t>(2, 0));
+	vector<vector<int64_t> > slab_sizes(2, vector<int64_t>(2, 1));
+	slab_starts[0][0] = 1;
+	slab_starts[1][0] = 3;
+	slab_sizes[0][1] = 4;
+	slab_sizes[1][1] = 4;
+	file.openData("r8_data");
+	file.getSlabs(slabs, slab_starts, slab_sizes);
+	file.closeData();
+	if (slabs.size() != 2 || slabs[0].size() != 4 || slabs[1].size() != 4) return 1;
+	if (slabs[0][0] != 24.0 || slabs[1][3] != 35.0) return 1;
+
 	// Throws when you coerce to int from a real/double source
 	bool didThrow = false;
 	try 
@@ -537,6 +559,69 @@ static int streamTest(const std::string& fname, NXaccess create_mode)
     return 0;
 }
 
+static int chunkTest(const std::string& fname)
+{
+	// comp_data is 100x20 ints stored as 20x20 deflated chunks
+	NeXus::File file(fname, NXACC_RDWR);
+	file.openPath("/entry/data/comp_data");
+	if (file.getChunkCount() != 5) return 1;
+	vector<char> first;
+	for (int64_t i = 0; i < 5; i++) {
+		NeXus::ChunkInfo chunk = file.getChunkInfo(i);
+		vector<char> stored;
+		if (file.getChunk(chunk.offset, stored) != chunk.filterMask) return 1;
+		if (static_cast<int64_t>(stored.size()) != chunk.size) return 1;
+		if (chunk.offset[0] % 20 != 0 || chunk.offset[1] != 0) return 1;
+		if (chunk.offset[0] == 0) first = stored;
+	}
+	// store the first chunk again, compressed as it is, in place of the second
+	vector<int64_t> offset(2, 0);
+	offset[0] = 20;
+	file.putChunk(offset, first);
+	vector<int> data;
+	file.getData(data);
+	if (data[20 * 20] != 0 || data[39 * 20 + 19] != 19 || data[40 * 20] != 40) return 1;
+	file.closeData();
+	return 0;
+}
+
+static int objectTest(const std::string& fname)
+{
+	NeXus::File file(fname, NXACC_RDWR);
+	file.openPath("/entry");
+	// both fields stay open while the file sits in /entry
+	NeXus::DatasetHandle r4(file, "r4_data");
+	NeXus::DatasetHandle r8(file, "/entry/r8_data");
+	NeXus::Info info = r8.getInfo();
+	if (info.type != NeXus::FLOAT64 || info.dims.size() != 2) return 1;
+	vector<int64_t> start(2, 0), size(2, 1);
+	size[1] = 4;
+	vector<float> floats;
+	vector<double> doubles;
+	for (int64_t row = 0; row < 5; row++) {
+		start[0] = row;
+		r4.getSlab(floats, start, size);
+		r8.getSlab(doubles, start, size);
+		if (floats.size() != 4 || floats[1] != static_cast<float>(row * 4 + 1)) return 1;
+		if (doubles.size() != 4 || doubles[1] != static_cast<double>(row * 4 + 21)) return 1;
+	}
+	r8.getData(doubles);
+	if (doubles.size() != 20 || doubles[19] != 39.0) return 1;
+	NeXus::GroupHandle entry(file, "/entry");
+	entry.putAttr("object_test", "passed");
+	r4.putAttr("scale", 2.5);
+	std::string text;
+	entry.getAttr("object_test", text);
+	double scale = 0;
+	r4.getAttr("scale", scale);
+	if (text != "passed" || scale != 2.5) return 1;
+	if (file.getPath() != "/entry") return 1;
+	r4.close();
+	r8.close();
+	entry.close();
+	return 0;
+}
+
 int testTypeMap(const std::string &fname)
 {
 	NeXus::File file(fname);
@@ -635,6 +720,24 @@ int main(int argc, char** argv)
 	  return result;
   }
 
+  // direct chunk access, HDF5 only
+  if (nx_creation_code == NXACC_CREATE5) {
+    result = chunkTest(filename);
+    if (result) {
+      cout << "chunkTest failed" << endl;
+      return result;
+    }
+  }
+
+  // object handles, not for HDF4 and XML tables
+  if (nx_creation_code == NXACC_CREATE5 || nx_creation_code == NXACC_CREATEXML) {
+    result = objectTest(filename);
+    if (result) {
+      cout << "objectTest failed" << endl;
+      return result;
+    }
+  }
+
   // everything went ok
   return 0;
 }
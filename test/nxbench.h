@@ -0,0 +1,61 @@
+/*---------------------------------------------------------------------------
+  NeXus - Neutron & X-ray Common Data Format
+
+  Timing for the tests that double as benchmarks. They check behaviour on
+  small files by default, and time larger ones when run with --benchmark;
+  ctest runs them without it.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  For further information, see <http://www.nexusformat.org>
+
+----------------------------------------------------------------------------*/
+#ifndef NXBENCH_H
+#define NXBENCH_H
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#ifndef _WIN32
+#include <sys/time.h>
+#endif
+
+/* set by nxbench_init when the test is asked for its timings */
+static int nxbench = 0;
+
+static int nxbench_init(int argc, char *argv[])
+{
+	int i;
+
+	for (i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--benchmark") == 0)
+			nxbench = 1;
+	}
+	return nxbench;
+}
+
+/* wall clock seconds, I/O time is not CPU time */
+static double nxbench_now(void)
+{
+#ifndef _WIN32
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec * 1e-6;
+#else
+	return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+#endif
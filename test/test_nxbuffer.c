@@ -0,0 +1,296 @@
+/*---------------------------------------------------------------------------
+  NeXus - Neutron & X-ray Common Data Format
+
+  Test and benchmark for files held in memory: opening a file image with
+  NXopenbuffer and the in-memory access flags
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  For further information, see <http://www.nexusformat.org>
+
+----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "napi.h"
+#include "napiconfig.h"
+#include "nxbench.h"
+
+#define NDATA 8
+#define NPOINT 2000
+#define NREPEAT 20		/* opens timed with --benchmark */
+
+static int nrepeat = 1;
+
+static int32_t value_at(int d, int i)
+{
+	return (int32_t) (d * NPOINT + i);
+}
+
+static int file_exists(const char *filename)
+{
+	FILE *fd = fopen(filename, "rb");
+
+	if (fd == NULL)
+		return 0;
+	fclose(fd);
+	return 1;
+}
+
+static char *read_whole_file(const char *filename, size_t * size)
+{
+	FILE *fd = fopen(filename, "rb");
+	char *buffer;
+	long length;
+
+	if (fd == NULL)
+		return NULL;
+	fseek(fd, 0, SEEK_END);
+	length = ftell(fd);
+	fseek(fd, 0, SEEK_SET);
+	buffer = (char *)malloc(length);
+	if (buffer != NULL && fread(buffer, 1, length, fd) != (size_t) length) {
+		free(buffer);
+		buffer = NULL;
+	}
+	fclose(fd);
+	*size = (size_t) length;
+	return buffer;
+}
+
+static int write_file(int file_type, const char *filename)
+{
+	static int32_t d[NPOINT];
+	int64_t dims[1] = { NPOINT };
+	char name[64];
+	int i, j;
+	NXhandle file_id = NULL;
+
+	remove(filename);
+	if (NXopen(filename, file_type, &file_id) != NX_OK)
+		return 1;
+	if (NXmakegroup(file_id, "entry1", "NXentry") != NX_OK)
+		return 1;
+	if (NXopengroup(file_id, "entry1", "NXentry") != NX_OK)
+		return 1;
+	for (i = 0; i < NDATA; i++) {
+		for (j = 0; j < NPOINT; j++)
+			d[j] = value_at(i, j);
+		sprintf(name, "data%d", i);
+		if (NXmakedata64(file_id, name, NX_INT32, 1, dims) != NX_OK)
+			return 1;
+		if (NXopendata(file_id, name) != NX_OK)
+			return 1;
+		if (NXputdata(file_id, d) != NX_OK)
+			return 1;
+		NXclosedata(file_id);
+	}
+	NXclosegroup(file_id);
+	NXclose(&file_id);
+	return 0;
+}
+
+/* reads every dataset and checks it */
+static int check_file(NXhandle file_id)
+{
+	static int32_t d[NPOINT];
+	char path[64];
+	int i, j;
+
+	for (i = 0; i < NDATA; i++) {
+		sprintf(path, "/entry1/data%d", i);
+		if (NXopenpath(file_id, path) != NX_OK
+		    || NXgetdata(file_id, d) != NX_OK) {
+			fprintf(stderr, "reading %s failed\n", path);
+			return 1;
+		}
+		for (j = 0; j < NPOINT; j++) {
+			if (d[j] != value_at(i, j)) {
+				fprintf(stderr, "%s[%d] is %d, expected %d\n",
+					path, j, (int)d[j], (int)value_at(i, j));
+				return 1;
+			}
+		}
+		NXclosedata(file_id);
+	}
+	return 0;
+}
+
+static int check_first_value(NXhandle file_id, int32_t expected)
+{
+	int32_t value;
+	int64_t start[1] = { 0 }, size[1] = { 1 };
+
+	if (NXopenpath(file_id, "/entry1/data0") != NX_OK
+	    || NXgetslab64(file_id, &value, start, size) != NX_OK)
+		return 1;
+	NXclosedata(file_id);
+	if (value != expected) {
+		fprintf(stderr, "data0[0] is %d, expected %d\n", (int)value,
+			(int)expected);
+		return 1;
+	}
+	return 0;
+}
+
+static int test_buffer(int file_type, const char *filename)
+{
+	NXhandle file_id = NULL;
+	char *buffer, *copy;
+	size_t size;
+	int32_t value = -1;
+	int64_t start[1] = { 0 }, count[1] = { 1 };
+	double tim;
+	int i;
+
+	if (write_file(file_type, filename) != 0) {
+		fprintf(stderr, "Failed to write %s\n", filename);
+		return 1;
+	}
+	buffer = read_whole_file(filename, &size);
+	if (buffer == NULL) {
+		fprintf(stderr, "Failed to read %s\n", filename);
+		return 1;
+	}
+
+	tim = nxbench_now();
+	for (i = 0; i < nrepeat; i++) {
+		if (NXopen(filename, NXACC_READ, &file_id) != NX_OK
+		    || check_file(file_id) != 0)
+			return 1;
+		NXclose(&file_id);
+	}
+	if (nxbench)
+		printf("  %d x NXopen and read: %.3f s\n", nrepeat,
+		       nxbench_now() - tim);
+
+	tim = nxbench_now();
+	for (i = 0; i < nrepeat; i++) {
+		if (NXopenbuffer(buffer, size, NXACC_READ, &file_id) != NX_OK) {
+			fprintf(stderr, "NXopenbuffer failed\n");
+			return 1;
+		}
+		if (check_file(file_id) != 0)
+			return 1;
+		NXclose(&file_id);
+	}
+	if (nxbench)
+		printf("  %d x NXopenbuffer and read: %.3f s\n", nrepeat,
+		       nxbench_now() - tim);
+
+	/* the contents are copied, the buffer can go right after opening */
+	copy = (char *)malloc(size);
+	memcpy(copy, buffer, size);
+	if (NXopenbuffer(copy, size, NXACC_RDWR, &file_id) != NX_OK)
+		return 1;
+	memset(copy, 0, size);
+	free(copy);
+	if (check_file(file_id) != 0)
+		return 1;
+
+	/* writes stay in memory and never reach the file */
+	if (NXopenpath(file_id, "/entry1/data0") != NX_OK
+	    || NXputslab64(file_id, &value, start, count) != NX_OK)
+		return 1;
+	NXclosedata(file_id);
+	if (check_first_value(file_id, -1) != 0)
+		return 1;
+	NXclose(&file_id);
+	if (NXopen(filename, NXACC_READ, &file_id) != NX_OK
+	    || check_first_value(file_id, value_at(0, 0)) != 0)
+		return 1;
+	NXclose(&file_id);
+
+	/* anything not a NeXus file image is refused */
+	memset(buffer, 'x', size);
+	if (NXopenbuffer(buffer, size, NXACC_READ, &file_id) == NX_OK) {
+		fprintf(stderr, "NXopenbuffer accepted garbage\n");
+		return 1;
+	}
+	if (NXopenbuffer(buffer, 0, NXACC_CREATE5, &file_id) == NX_OK) {
+		fprintf(stderr, "NXopenbuffer accepted a create mode\n");
+		return 1;
+	}
+	free(buffer);
+	return 0;
+}
+
+static int test_core(int file_type, const char *filename)
+{
+	NXhandle file_id = NULL;
+	double tim;
+
+	/* a scratch file never touches the disk */
+	remove(filename);
+	if (write_file(file_type | NXACC_CORE_NOSTORE, filename) != 0) {
+		fprintf(stderr, "Failed to write %s in memory\n", filename);
+		return 1;
+	}
+	if (file_exists(filename)) {
+		fprintf(stderr, "NXACC_CORE_NOSTORE wrote %s\n", filename);
+		return 1;
+	}
+
+	/* otherwise the file is written on close */
+	tim = nxbench_now();
+	if (write_file(file_type | NXACC_CORE, filename) != 0) {
+		fprintf(stderr, "Failed to write %s in memory\n", filename);
+		return 1;
+	}
+	if (nxbench)
+		printf("  writing through NXACC_CORE: %.3f s\n",
+		       nxbench_now() - tim);
+	if (NXopen(filename, NXACC_READ, &file_id) != NX_OK
+	    || check_file(file_id) != 0)
+		return 1;
+	NXclose(&file_id);
+
+	if (NXopen(filename, NXACC_READ | NXACC_CORE, &file_id) != NX_OK
+	    || check_file(file_id) != 0)
+		return 1;
+	NXclose(&file_id);
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	int ret = 0;
+
+	if (nxbench_init(argc, argv))
+		nrepeat = NREPEAT;
+#ifdef WITH_MXML
+	printf("Testing XML\n");
+	ret |= test_buffer(NXACC_CREATEXML, "test_buffer.xml");
+	ret |= test_core(NXACC_CREATEXML, "test_core.xml");
+#endif
+
+#ifdef WITH_HDF5
+	printf("Testing HDF5\n");
+	ret |= test_buffer(NXACC_CREATE5, "test_buffer.nx5");
+	ret |= test_core(NXACC_CREATE5, "test_core.nx5");
+#endif
+
+#ifdef WITH_HDF4
+	{
+		NXhandle file_id = NULL;
+		if (NXopen("test_core.nx4", NXACC_CREATE4 | NXACC_CORE,
+			   &file_id) == NX_OK) {
+			fprintf(stderr, "HDF4 accepted NXACC_CORE\n");
+			ret = 1;
+		}
+	}
+#endif
+	return ret;
+}
@@ -0,0 +1,201 @@
+/*---------------------------------------------------------------------------
+  NeXus - Neutron & X-ray Common Data Format
+
+  Test and benchmark for uninitialized, aligned and pooled data buffers:
+  NXmalloc64ex and the NXbufpool functions
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  For further information, see <http://www.nexusformat.org>
+
+----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "napi.h"
+#include "napiconfig.h"
+#include "nxbench.h"
+
+#define NDATA 16
+#define NPOINT (256 * 1024)
+#define NREPEAT 4		/* reads timed with --benchmark */
+
+static int nrepeat = 1;
+
+static int write_file(int file_type, const char *filename)
+{
+	static double d[NPOINT];
+	int64_t dims[1] = { NPOINT };
+	char name[64];
+	int i, j;
+	NXhandle file_id = NULL;
+
+	remove(filename);
+	if (NXopen(filename, file_type, &file_id) != NX_OK)
+		return 1;
+	if (NXmakegroup(file_id, "entry1", "NXentry") != NX_OK
+	    || NXopengroup(file_id, "entry1", "NXentry") != NX_OK)
+		return 1;
+	for (i = 0; i < NDATA; i++) {
+		for (j = 0; j < NPOINT; j++)
+			d[j] = i + j * 0.5;
+		sprintf(name, "data%d", i);
+		if (NXmakedata64(file_id, name, NX_FLOAT64, 1, dims) != NX_OK
+		    || NXopendata(file_id, name) != NX_OK
+		    || NXputdata(file_id, d) != NX_OK)
+			return 1;
+		NXclosedata(file_id);
+	}
+	NXclosegroup(file_id);
+	NXclose(&file_id);
+	return 0;
+}
+
+/* reads every dataset into a buffer of its own, in one of three ways */
+static int read_all(NXhandle file_id, int how, NXbufpool pool)
+{
+	int64_t dims[NX_MAXRANK];
+	double *d;
+	char path[64];
+	int i, rank, type, status;
+
+	for (i = 0; i < NDATA; i++) {
+		sprintf(path, "/entry1/data%d", i);
+		if (NXopenpath(file_id, path) != NX_OK
+		    || NXgetinfo64(file_id, &rank, dims, &type) != NX_OK)
+			return 1;
+		if (how == 0)
+			status = NXmalloc64((void **)&d, rank, dims, type);
+		else if (how == 1)
+			status = NXmalloc64ex((void **)&d, rank, dims, type,
+					      NXMALLOC_NOINIT);
+		else
+			status = NXbufpoolget(pool, (void **)&d, rank, dims,
+					      type);
+		if (status != NX_OK || NXgetdata(file_id, d) != NX_OK)
+			return 1;
+		if (d[0] != i || d[NPOINT - 1] != i + (NPOINT - 1) * 0.5) {
+			fprintf(stderr, "%s read wrongly\n", path);
+			return 1;
+		}
+		if (how == 2)
+			NXbufpoolrelease(pool, d);
+		else
+			NXfree((void **)&d);
+		NXclosedata(file_id);
+	}
+	return 0;
+}
+
+static int test_read(int file_type, const char *filename)
+{
+	static const char *title[3] =
+	    { "NXmalloc64", "NXmalloc64ex, NXMALLOC_NOINIT", "NXbufpool" };
+	NXhandle file_id = NULL;
+	NXbufpool pool = NULL;
+	double tim;
+	int how, r;
+
+	if (write_file(file_type, filename) != 0) {
+		fprintf(stderr, "Failed to write %s\n", filename);
+		return 1;
+	}
+	if (NXopen(filename, NXACC_READ, &file_id) != NX_OK
+	    || NXbufpoolcreate(&pool, NXMALLOC_NOINIT) != NX_OK)
+		return 1;
+	for (how = 0; how < 3; how++) {
+		tim = nxbench_now();
+		for (r = 0; r < nrepeat; r++) {
+			if (read_all(file_id, how, pool) != 0)
+				return 1;
+		}
+		if (nxbench)
+			printf("  %d x %d datasets with %-30s %.3f s\n",
+			       nrepeat, NDATA, title[how],
+			       nxbench_now() - tim);
+	}
+	NXbufpooldestroy(&pool);
+	NXclose(&file_id);
+	return 0;
+}
+
+static int test_buffers(void)
+{
+	int64_t dims[2] = { 100, 7 }, small[1] = { 10 };
+	NXbufpool pool = NULL;
+	void *a, *b, *c;
+	char *text;
+
+	/* aligned, where released memory allows it */
+	if (NXmalloc64ex(&a, 2, dims, NX_FLOAT32, NXMALLOC_NOINIT) != NX_OK)
+		return 1;
+#ifndef _WIN32
+	if ((size_t) a % 64 != 0) {
+		fprintf(stderr, "NXmalloc64ex returned %p\n", a);
+		return 1;
+	}
+#endif
+	NXfree(&a);
+	if (NXmalloc64ex(&a, 2, dims, NX_FLOAT64, NXMALLOC_HUGEPAGES) != NX_OK
+	    || ((double *)a)[699] != 0.)
+		return 1;
+	NXfree(&a);
+
+	/* character data ends in NUL whatever the options */
+	if (NXmalloc64ex((void **)&text, 1, small, NX_CHAR, NXMALLOC_NOINIT)
+	    != NX_OK || strlen(text) != 0)
+		return 1;
+	NXfree((void **)&text);
+
+	/* a pool hands out free buffers again */
+	if (NXbufpoolcreate(&pool, 0) != NX_OK
+	    || NXbufpoolget(pool, &a, 2, dims, NX_INT32) != NX_OK
+	    || NXbufpoolget(pool, &b, 2, dims, NX_INT32) != NX_OK)
+		return 1;
+	if (a == b)
+		return 1;
+	memset(a, 1, 700 * 4);
+	if (NXbufpoolrelease(pool, a) != NX_OK
+	    || NXbufpoolget(pool, &c, 1, small, NX_INT32) != NX_OK)
+		return 1;
+	if (c != a || ((int32_t *) c)[9] != 0) {
+		fprintf(stderr, "the pool did not reuse a cleared buffer\n");
+		return 1;
+	}
+	if (NXbufpoolrelease(pool, c) != NX_OK)
+		return 1;
+	if (NXbufpoolrelease(pool, c) == NX_OK) {
+		fprintf(stderr, "NXbufpoolrelease released a buffer twice\n");
+		return 1;
+	}
+	/* b is still handed out and goes with the pool */
+	if (NXbufpooldestroy(&pool) != NX_OK || pool != NULL)
+		return 1;
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	int ret = 0;
+
+	if (nxbench_init(argc, argv))
+		nrepeat = NREPEAT;
+	ret |= test_buffers();
+#ifdef WITH_HDF5
+	printf("Testing HDF5\n");
+	ret |= test_read(NXACC_CREATE5, "test_bufpool.nx5");
+#endif
+	return ret;
+}
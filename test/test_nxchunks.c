@@ -0,0 +1,225 @@
+/*---------------------------------------------------------------------------
+  NeXus - Neutron & X-ray Common Data Format
+
+  Test for direct chunk reads and writes
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  For further information, see <http://www.nexusformat.org>
+
+----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "napi.h"
+#include "napiconfig.h"
+
+#define NFRAME 8
+#define NY 64
+#define NX 64
+
+static int32_t value_at(int64_t f, int64_t y, int64_t x)
+{
+	return (int32_t) ((f * 7 + y * 3 + x) % 1000);
+}
+
+static int write_file(const char *filename)
+{
+	static int32_t frame[NY][NX];
+	int64_t dims[3] = { NFRAME, NY, NX };
+	int64_t chunk[3] = { 1, NY, NX };
+	int64_t start[3] = { 0, 0, 0 }, size[3] = { 1, NY, NX };
+	int64_t f, y, x;
+	NXhandle file_id = NULL;
+
+	remove(filename);
+	if (NXopen(filename, NXACC_CREATE5, &file_id) != NX_OK)
+		return 1;
+	if (NXmakegroup(file_id, "entry1", "NXentry") != NX_OK)
+		return 1;
+	if (NXopengroup(file_id, "entry1", "NXentry") != NX_OK)
+		return 1;
+	if (NXcompmakedata64(file_id, "data", NX_INT32, 3, dims, NX_COMP_LZW,
+			     chunk) != NX_OK)
+		return 1;
+	if (NXopendata(file_id, "data") != NX_OK)
+		return 1;
+	for (f = 0; f < NFRAME; f++) {
+		for (y = 0; y < NY; y++)
+			for (x = 0; x < NX; x++)
+				frame[y][x] = value_at(f, y, x);
+		start[0] = f;
+		if (NXputslab64(file_id, frame, start, size) != NX_OK)
+			return 1;
+	}
+	NXclosedata(file_id);
+	/* the same layout, growing along the first dimension */
+	dims[0] = NX_UNLIMITED;
+	if (NXcompmakedata64(file_id, "copy", NX_INT32, 3, dims, NX_COMP_LZW,
+			     chunk) != NX_OK)
+		return 1;
+	dims[0] = NFRAME;
+	if (NXmakedata64(file_id, "contiguous", NX_INT32, 3, dims) != NX_OK)
+		return 1;
+	NXclosegroup(file_id);
+	NXclose(&file_id);
+	return 0;
+}
+
+static int test_chunks(const char *filename)
+{
+	static int32_t frame[NY][NX];
+	static int32_t orig[NFRAME][NY][NX], copy[NFRAME][NY][NX];
+	static char stored[NFRAME][NY * NX * 8];
+	int64_t stored_size[NFRAME];
+	int64_t offset[3], nchunks, nbytes, i, dims[3], chunk[NX_MAXRANK];
+	int64_t start[3] = { NFRAME, 0, 0 }, size[3] = { 1, NY, NX };
+	unsigned int mask;
+	int rank, type;
+	NXhandle file_id = NULL;
+
+	if (write_file(filename) != 0) {
+		fprintf(stderr, "Failed to write %s\n", filename);
+		return 1;
+	}
+	if (NXopen(filename, NXACC_RDWR, &file_id) != NX_OK)
+		return 1;
+
+	/* list the compressed chunks and read them without decompressing */
+	if (NXopenpath(file_id, "/entry1/data") != NX_OK)
+		return 1;
+	if (NXgetchunkcount64(file_id, &nchunks) != NX_OK || nchunks != NFRAME) {
+		fprintf(stderr, "NXgetchunkcount64 failed\n");
+		return 1;
+	}
+	if (NXgetchunkdims64(file_id, &rank, chunk) != NX_OK || rank != 3
+	    || chunk[0] != 1 || chunk[1] != NY || chunk[2] != NX) {
+		fprintf(stderr, "NXgetchunkdims64 failed\n");
+		return 1;
+	}
+	for (i = 0; i < nchunks; i++) {
+		if (NXgetchunkinfo64(file_id, i, offset, &mask, &nbytes) !=
+		    NX_OK || offset[1] != 0 || offset[2] != 0 || mask != 0) {
+			fprintf(stderr, "NXgetchunkinfo64 failed\n");
+			return 1;
+		}
+		/* deflate must have shrunk the chunk */
+		if (nbytes <= 0 || nbytes >= NY * NX * 4) {
+			fprintf(stderr, "chunk %d has unexpected size %d\n",
+				(int)i, (int)nbytes);
+			return 1;
+		}
+		stored_size[offset[0]] = 0;
+		if (NXgetchunk64(file_id, offset, NULL, NULL,
+				 &stored_size[offset[0]]) != NX_OK
+		    || stored_size[offset[0]] != nbytes) {
+			fprintf(stderr, "NXgetchunk64 size query failed\n");
+			return 1;
+		}
+		nbytes = 1;
+		if (NXgetchunk64(file_id, offset, &mask, stored[offset[0]],
+				 &nbytes) == NX_OK) {
+			fprintf(stderr, "NXgetchunk64 overran its buffer\n");
+			return 1;
+		}
+		nbytes = sizeof(stored[0]);
+		if (NXgetchunk64(file_id, offset, &mask, stored[offset[0]],
+				 &nbytes) != NX_OK
+		    || nbytes != stored_size[offset[0]] || mask != 0) {
+			fprintf(stderr, "NXgetchunk64 failed\n");
+			return 1;
+		}
+	}
+	offset[0] = 0;
+	offset[1] = 1;
+	offset[2] = 0;
+	nbytes = sizeof(stored[0]);
+	if (NXgetchunk64(file_id, offset, &mask, stored[0], &nbytes) == NX_OK) {
+		fprintf(stderr, "NXgetchunk64 accepted an unaligned offset\n");
+		return 1;
+	}
+	if (NXgetdata(file_id, orig) != NX_OK)
+		return 1;
+	NXclosedata(file_id);
+
+	/* store the compressed chunks as they are, in reverse order */
+	if (NXopenpath(file_id, "/entry1/copy") != NX_OK)
+		return 1;
+	offset[1] = 0;
+	for (i = NFRAME - 1; i >= 0; i--) {
+		offset[0] = i;
+		if (NXputchunk64(file_id, offset, 0, stored[i],
+				 stored_size[i]) != NX_OK) {
+			fprintf(stderr, "NXputchunk64 failed\n");
+			return 1;
+		}
+	}
+	if (NXgetinfo64(file_id, &rank, dims, &type) != NX_OK ||
+	    dims[0] != NFRAME) {
+		fprintf(stderr, "NXputchunk64 did not extend the dataset\n");
+		return 1;
+	}
+	if (NXgetslab64(file_id, copy, offset, dims) != NX_OK ||
+	    memcmp(orig, copy, sizeof(orig)) != 0) {
+		fprintf(stderr, "copied chunks differ from the original\n");
+		return 1;
+	}
+
+	/* a chunk which skips shuffle (filter 0) and deflate (filter 1) */
+	memcpy(frame, orig[3], sizeof(frame));
+	offset[0] = NFRAME;
+	if (NXputchunk64(file_id, offset, 0x3, frame, sizeof(frame)) != NX_OK) {
+		fprintf(stderr, "NXputchunk64 of an unfiltered chunk failed\n");
+		return 1;
+	}
+	memset(frame, 0, sizeof(frame));
+	if (NXgetslab64(file_id, frame, start, size) != NX_OK ||
+	    memcmp(frame, orig[3], sizeof(frame)) != 0) {
+		fprintf(stderr, "unfiltered chunk reads back wrong\n");
+		return 1;
+	}
+	nbytes = sizeof(stored[0]);
+	if (NXgetchunk64(file_id, offset, &mask, stored[0], &nbytes) != NX_OK
+	    || mask != 0x3 || nbytes != sizeof(frame)) {
+		fprintf(stderr, "unfiltered chunk has wrong mask or size\n");
+		return 1;
+	}
+	NXclosedata(file_id);
+
+	/* contiguous datasets have no chunks */
+	if (NXopenpath(file_id, "/entry1/contiguous") != NX_OK)
+		return 1;
+	if (NXgetchunkcount64(file_id, &nchunks) == NX_OK) {
+		fprintf(stderr, "contiguous dataset reported chunks\n");
+		return 1;
+	}
+	if (NXgetchunkdims64(file_id, &rank, chunk) != NX_OK || rank != 0) {
+		fprintf(stderr, "contiguous dataset reported chunk dimensions\n");
+		return 1;
+	}
+	NXclosedata(file_id);
+	NXclose(&file_id);
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	int ret = 0;
+#ifdef WITH_HDF5
+	printf("Testing HDF5\n");
+	ret |= test_chunks("test_chunks.nx5");
+#endif
+	return ret;
+}
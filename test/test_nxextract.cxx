@@ -0,0 +1,625 @@
+/*---------------------------------------------------------------------------
+  NeXus - Neutron & X-ray Common Data Format
+
+  Test and benchmark for NeXus::Extract, reading the same values out of
+  many files
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  For further information, see <http://www.nexusformat.org>
+
+----------------------------------------------------------------------------*/
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#ifndef _WIN32
+#include <sys/time.h>
+#endif
+#include "napiconfig.h"
+#include "NeXusExtract.hpp"
+
+using std::cerr;
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+using namespace NeXus::Extract;
+
+static const int NFILES = 100;
+static const int NGROUP = 20;
+static const int NDATA = 10;
+static const int64_t NPIXEL = 128;
+static const int64_t NWIDE = 40000;
+
+static double now()
+{
+#ifndef _WIN32
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec * 1.e-6;
+#else
+  return static_cast<double>(clock()) / CLOCKS_PER_SEC;
+#endif
+}
+
+static int writeFile(int file_type, const string& filename, int run)
+{
+  int64_t dims[1] = { 100 };
+  int32_t counts[100];
+  float offsets[3] = { 0.5f, 1.5f, 2.5f };
+  int adims[1] = { 3 };
+  NXhandle file_id = NULL;
+  char name[64];
+
+  for (int i = 0; i < 100; i++)
+    {
+      counts[i] = i + run;
+    }
+  std::remove(filename.c_str());
+  if (NXopen(filename.c_str(), static_cast<NXaccess>(file_type), &file_id)
+      != NX_OK)
+    {
+      return 1;
+    }
+  if (NXmakegroup(file_id, "entry", "NXentry") != NX_OK
+      || NXopengroup(file_id, "entry", "NXentry") != NX_OK
+      || NXmakedata64(file_id, "title", NX_CHAR, 1, dims) != NX_OK
+      || NXopendata(file_id, "title") != NX_OK)
+    {
+      return 1;
+    }
+  char title[100];
+  std::memset(title, 0, sizeof(title));
+  std::sprintf(title, "run %d", run);
+  if (NXputdata(file_id, title) != NX_OK)
+    {
+      return 1;
+    }
+  NXclosedata(file_id);
+  for (int u = 0; u < 2; u++)
+    {
+      std::sprintf(name, "user%d", u);
+      dims[0] = 5;
+      if (NXmakegroup(file_id, name, "NXuser") != NX_OK
+          || NXopengroup(file_id, name, "NXuser") != NX_OK
+          || NXmakedata64(file_id, "name", NX_CHAR, 1, dims) != NX_OK
+          || NXopendata(file_id, "name") != NX_OK
+          || NXputdata(file_id, u == 0 ? (void *)"alice" : (void *)"bobby")
+          != NX_OK)
+        {
+          return 1;
+        }
+      NXclosedata(file_id);
+      NXclosegroup(file_id);
+    }
+  dims[0] = 100;
+  for (int g = 0; g < NGROUP; g++)
+    {
+      std::sprintf(name, "data%d", g);
+      if (NXmakegroup(file_id, name, "NXdata") != NX_OK
+          || NXopengroup(file_id, name, "NXdata") != NX_OK)
+        {
+          return 1;
+        }
+      for (int d = 0; d < NDATA; d++)
+        {
+          std::sprintf(name, "d%d", d);
+          if (NXmakedata64(file_id, name, NX_INT32, 1, dims) != NX_OK
+              || NXopendata(file_id, name) != NX_OK
+              || NXputdata(file_id, counts) != NX_OK
+              || NXputattr(file_id, "units", "counts", 6, NX_CHAR) != NX_OK
+              || NXputattra(file_id, "offsets", offsets, 1, adims,
+                            NX_FLOAT32) != NX_OK)
+            {
+              return 1;
+            }
+          NXclosedata(file_id);
+        }
+      NXclosegroup(file_id);
+    }
+  NXclosegroup(file_id);
+  return NXclose(&file_id) != NX_OK;
+}
+
+/* the requests of a catalog: a few values from a few groups */
+static void catalogRequests(Extractor& extractor)
+{
+  extractor.add("/entry/title");
+  for (int g = 0; g < NGROUP; g += 4)
+    {
+      std::ostringstream path;
+      path << "/entry/data" << g << "/d3";
+      extractor.add(path.str(), "", SUM);
+      extractor.add(path.str(), "", MAX);
+      extractor.add(path.str(), "units");
+    }
+}
+
+/* the same, one NXopenpath from the root at a time as before */
+static int catalogByPath(const string& filename)
+{
+  NXhandle file_id = NULL;
+  int rank, type, dim[NX_MAXRANK];
+  void *data;
+  vector<string> paths;
+
+  paths.push_back("/entry/title");
+  for (int g = 0; g < NGROUP; g += 4)
+    {
+      std::ostringstream path;
+      path << "/entry/data" << g << "/d3";
+      paths.push_back(path.str());
+      paths.push_back(path.str());
+      paths.push_back(path.str());
+    }
+  if (NXopen(filename.c_str(), NXACC_READ, &file_id) != NX_OK)
+    {
+      return 1;
+    }
+  for (size_t i = 0; i < paths.size(); i++)
+    {
+      if (NXopenpath(file_id, paths[i].c_str()) != NX_OK
+          || NXgetinfo(file_id, &rank, dim, &type) != NX_OK
+          || NXmalloc(&data, rank, dim, type) != NX_OK)
+        {
+          return 1;
+        }
+      if (NXgetdata(file_id, data) != NX_OK)
+        {
+          return 1;
+        }
+      NXfree(&data);
+    }
+  return NXclose(&file_id) != NX_OK;
+}
+
+class Checker : public Handler
+{
+public:
+  Checker(const Extractor& extractor) : m_extractor(extractor), m_next(0),
+                                         m_failed(false)
+  {
+  }
+
+  void process(const Result& result)
+  {
+    /* run numbers are the index of the file */
+    if (result.index != m_next++ || !result.ok)
+      {
+        m_failed = true;
+        return;
+      }
+    const vector<Request>& requests = m_extractor.getRequests();
+    for (size_t i = 0; i < requests.size(); i++)
+      {
+        const Value& value = result.values[i][0];
+        if (!value.ok)
+          {
+            m_failed = true;
+          }
+        else if (requests[i].operation == SUM
+                 && value.number != 4950. + 100. * result.index)
+          {
+            m_failed = true;
+          }
+        else if (requests[i].operation == MAX
+                 && value.number != 99. + result.index)
+          {
+            m_failed = true;
+          }
+      }
+  }
+
+  bool failed() const
+  {
+    return m_failed || m_next != static_cast<size_t>(NFILES);
+  }
+
+private:
+  const Extractor& m_extractor;
+  size_t m_next;
+  bool m_failed;
+};
+
+static int testRequests(const string& filename)
+{
+  Extractor extractor;
+  size_t title = extractor.add("/entry/title");
+  size_t again = extractor.add("/entry/title");
+  size_t users = extractor.add("/{NXentry}/{NXuser}/name");
+  size_t sum = extractor.add("/entry/data2/d1", "", SUM);
+  size_t mean = extractor.add("/entry/data2/d1", "", MEAN);
+  size_t min = extractor.add("/entry/data2/d1", "", MIN);
+  size_t element = extractor.add("/entry/data2/d1", "", ELEMENT, 7);
+  size_t dims = extractor.add("/entry/data2/d1", "", DIMS);
+  size_t units = extractor.add("/entry/data2/d1", "units");
+  size_t offsets = extractor.add("/entry/data2/d1", "offsets", MAX);
+  size_t count = extractor.add("/{NXentry}", "", COUNT);
+  size_t missing = extractor.add("/entry/data99/d1");
+  size_t noattr = extractor.add("/entry/data2/d1", "missing");
+  size_t inside = extractor.add("/entry/title/below");
+
+  if (again != title || extractor.size() != 13)
+    {
+      cerr << "requests were not merged" << endl;
+      return 1;
+    }
+
+  Result result = extractor.extract(filename);
+  if (!result.ok || result.values.size() != 13)
+    {
+      cerr << "cannot extract from " << filename << endl;
+      return 1;
+    }
+  const vector<vector<Value> >& v = result.values;
+  if (!v[title][0].ok || string(&v[title][0].data[0]) != "run 3")
+    {
+      cerr << "wrong title" << endl;
+      return 1;
+    }
+  if (v[users].size() != 2 || string(&v[users][0].data[0]) != "alice"
+      || string(&v[users][1].data[0]) != "bobby"
+      || v[users][1].path != "/entry/user1/name")
+    {
+      cerr << "users not found" << endl;
+      return 1;
+    }
+  int32_t seventh;
+  std::memcpy(&seventh, &v[element][0].data[0], sizeof(seventh));
+  if (v[sum][0].number != 5250. || v[mean][0].number != 52.5
+      || v[min][0].number != 3. || seventh != 10
+      || v[dims][0].dims.size() != 1 || v[dims][0].dims[0] != 100
+      || v[dims][0].type != NeXus::INT32 || !v[dims][0].data.empty())
+    {
+      cerr << "wrong operations on /entry/data2/d1" << endl;
+      return 1;
+    }
+  if (string(&v[units][0].data[0]) != "counts"
+      || v[offsets][0].number != 2.5 || v[count][0].number != 1 + 2 + NGROUP)
+    {
+      cerr << "wrong attributes" << endl;
+      return 1;
+    }
+  if (v[missing][0].ok || v[noattr][0].ok || v[inside][0].ok
+      || v[missing][0].error.empty())
+    {
+      cerr << "missing objects were found" << endl;
+      return 1;
+    }
+  return 0;
+}
+
+/* a detector array, with runs of zeros as detectors have */
+static int32_t countAt(int64_t k)
+{
+  return k % 5 == 0 ? 0 : static_cast<int32_t>((k * 7919) % 1000) - 200;
+}
+
+static int writeLarge(int file_type, const string& filename, int64_t frames,
+                      int compression)
+{
+  /* chunks without compression need an unlimited dimension */
+  int64_t dims[3] = { compression == NX_COMP_NONE ? NX_UNLIMITED : frames,
+                      NPIXEL, NPIXEL };
+  int64_t chunk[3] = { 4, NPIXEL, NPIXEL };
+  int64_t wide[2] = { 2, NWIDE };
+  int64_t start[3] = { 0, 0, 0 }, size[3] = { 1, NPIXEL, NPIXEL };
+  vector<int32_t> frame(NPIXEL * NPIXEL);
+  vector<double> row(2 * NWIDE);
+  NXhandle file_id = NULL;
+
+  std::remove(filename.c_str());
+  if (NXopen(filename.c_str(), static_cast<NXaccess>(file_type),
+             &file_id) != NX_OK
+      || NXmakegroup(file_id, "entry", "NXentry") != NX_OK
+      || NXopengroup(file_id, "entry", "NXentry") != NX_OK
+      || NXcompmakedata64(file_id, "counts", NX_INT32, 3, dims,
+                          compression, chunk) != NX_OK
+      || NXopendata(file_id, "counts") != NX_OK)
+    {
+      return 1;
+    }
+  for (start[0] = 0; start[0] < frames; start[0]++)
+    {
+      for (int64_t i = 0; i < NPIXEL * NPIXEL; i++)
+        {
+          frame[i] = countAt(start[0] * NPIXEL * NPIXEL + i);
+        }
+      if (NXputslab64(file_id, &frame[0], start, size) != NX_OK)
+        {
+          return 1;
+        }
+    }
+  NXclosedata(file_id);
+  for (int64_t i = 0; i < 2 * NWIDE; i++)
+    {
+      row[i] = 0.001 * static_cast<double>((i * 31) % 997) + 1.e6;
+    }
+  if (NXmakedata64(file_id, "wide", NX_FLOAT64, 2, wide) != NX_OK
+      || NXopendata(file_id, "wide") != NX_OK
+      || NXputdata(file_id, &row[0]) != NX_OK)
+    {
+      return 1;
+    }
+  NXclosedata(file_id);
+  NXclosegroup(file_id);
+  return NXclose(&file_id) != NX_OK;
+}
+
+static bool nearly(double a, double b, double tolerance)
+{
+  double scale = std::fabs(a) > std::fabs(b) ? std::fabs(a) : std::fabs(b);
+  return std::fabs(a - b) <= tolerance * (scale > 1. ? scale : 1.);
+}
+
+/* the reductions of blocks must match those of the whole field */
+static int testReductions(const string& filename)
+{
+  const int64_t frames = 16;
+  const int64_t n = frames * NPIXEL * NPIXEL;
+  double sum = 0., squares = 0.;
+  int32_t low = countAt(0), high = countAt(0);
+  int64_t nonzero = 0;
+  vector<int64_t> bins(10, 0);
+  for (int64_t k = 0; k < n; k++)
+    {
+      int32_t c = countAt(k);
+      sum += c;
+      low = c < low ? c : low;
+      high = c > high ? c : high;
+      nonzero += c != 0;
+      if (c >= -100 && c <= 400)
+        {
+          size_t bin = static_cast<size_t>((c + 100) * (10. / 500.));
+          bins[bin < 9 ? bin : 9]++;
+        }
+    }
+  double mean = sum / n;
+  for (int64_t k = 0; k < n; k++)
+    {
+      squares += (countAt(k) - mean) * (countAt(k) - mean);
+    }
+  double wideSum = 0.;
+  for (int64_t i = 0; i < 2 * NWIDE; i++)
+    {
+      wideSum += 0.001 * static_cast<double>((i * 31) % 997) + 1.e6;
+    }
+
+  if (writeLarge(NXACC_CREATE5, filename, frames, NX_COMP_LZW_LVL1) != 0)
+    {
+      cerr << "Failed to write " << filename << endl;
+      return 1;
+    }
+
+  /* whole, in blocks of chunks, in blocks smaller than a chunk, overlapped */
+  size_t blocks[] = { 64 << 20, 256 << 10, 1000, 256 << 10 };
+  int threads[] = { 1, 1, 1, 2 };
+  for (int run = 0; run < 4; run++)
+    {
+      Extractor extractor;
+      const string counts("/entry/counts");
+      size_t s = extractor.add(counts, "", SUM);
+      size_t lo = extractor.add(counts, "", MIN);
+      size_t hi = extractor.add(counts, "", MAX);
+      size_t m = extractor.add(counts, "", MEAN);
+      size_t sd = extractor.add(counts, "", STDDEV);
+      size_t nz = extractor.add(counts, "", NONZERO);
+      size_t h = extractor.add(counts, "", HISTOGRAM, 10, -100., 400.);
+      size_t bad = extractor.add(counts, "", HISTOGRAM, 10, 1., 1.);
+      size_t e = extractor.add(counts, "", ELEMENT, n - 3);
+      size_t ws = extractor.add("/entry/wide", "", SUM);
+      size_t wm = extractor.add("/entry/wide", "", MAX);
+      extractor.setBlockSize(blocks[run]);
+      extractor.setThreads(threads[run]);
+
+      Result result = extractor.extract(filename);
+      const vector<vector<Value> >& v = result.values;
+      int32_t element = 0;
+      if (v[e][0].ok)
+        {
+          std::memcpy(&element, &v[e][0].data[0], sizeof(element));
+        }
+      bool histogram = v[h][0].ok && v[h][0].type == NeXus::INT64
+        && v[h][0].dims.size() == 1 && v[h][0].dims[0] == 10
+        && std::memcmp(&v[h][0].data[0], &bins[0],
+                       10 * sizeof(int64_t)) == 0;
+      if (!result.ok || v[s][0].number != sum || v[lo][0].number != low
+          || v[hi][0].number != high || !nearly(v[m][0].number, mean, 1.e-12)
+          || !nearly(v[sd][0].number, std::sqrt(squares / n), 1.e-9)
+          || v[nz][0].number != nonzero || !histogram || v[bad][0].ok
+          || element != countAt(n - 3)
+          || !nearly(v[ws][0].number, wideSum, 1.e-12)
+          || !nearly(v[wm][0].number, 1.e6 + 0.996, 1.e-12))
+        {
+          cerr << "wrong reductions with blocks of " << blocks[run]
+               << " bytes on " << threads[run] << " threads" << endl;
+          return 1;
+        }
+    }
+  return 0;
+}
+
+static int timeReductions(const string& filename)
+{
+  const int64_t frames = 512;
+  if (writeLarge(NXACC_CREATE5, filename, frames, NX_COMP_NONE) != 0)
+    {
+      cerr << "Failed to write " << filename << endl;
+      return 1;
+    }
+  double mb = frames * NPIXEL * NPIXEL * 4. / (1 << 20);
+  size_t blocks[] = { 1024 << 20, 8 << 20, 8 << 20 };
+  int threads[] = { 1, 1, 2 };
+  const char *titles[] = { "whole field", "8 MiB blocks", "8 MiB blocks, overlapped" };
+  for (int run = 0; run < 3; run++)
+    {
+      Extractor extractor;
+      extractor.add("/entry/counts", "", SUM);
+      extractor.add("/entry/counts", "", STDDEV);
+      extractor.add("/entry/counts", "", MAX);
+      extractor.add("/entry/counts", "", NONZERO);
+      extractor.add("/entry/counts", "", HISTOGRAM, 100, -200., 800.);
+      extractor.setBlockSize(blocks[run]);
+      extractor.setThreads(threads[run]);
+      double start = now();
+      Result result = extractor.extract(filename);
+      double elapsed = now() - start;
+      if (!result.ok || !result.values[0][0].ok)
+        {
+          cerr << "cannot reduce " << filename << endl;
+          return 1;
+        }
+      std::printf("  %.0f MiB, %-28s %7.1f MiB/s\n", mb, titles[run],
+                  mb / elapsed);
+    }
+  std::remove(filename.c_str());
+  return 0;
+}
+
+static int timeRun(const vector<string>& files, int threads,
+                   const char *title)
+{
+  Extractor extractor;
+  catalogRequests(extractor);
+  extractor.setThreads(threads);
+  Checker checker(extractor);
+  double start = now();
+  extractor.run(files, checker);
+  double elapsed = now() - start;
+  if (checker.failed())
+    {
+      cerr << "wrong values " << title << endl;
+      return 1;
+    }
+  std::printf("  %d files, %-28s %7.1f files/s\n", NFILES, title,
+              NFILES / elapsed);
+  return 0;
+}
+
+static int benchmark(const vector<string>& files)
+{
+  double start = now();
+  for (size_t i = 0; i < files.size(); i++)
+    {
+      if (catalogByPath(files[i]) != 0)
+        {
+          cerr << "cannot read " << files[i] << endl;
+          return 1;
+        }
+    }
+  double elapsed = now() - start;
+  std::printf("  %d files, %-28s %7.1f files/s\n", NFILES,
+              "one path at a time", NFILES / elapsed);
+
+  if (timeRun(files, 1, "extracted on 1 thread") != 0
+      || timeRun(files, 2, "extracted on 2 threads") != 0
+      || timeRun(files, 4, "extracted on 4 threads") != 0)
+    {
+      return 1;
+    }
+
+  /* files with an index are read from their snapshot */
+  for (size_t i = 0; i < files.size(); i++)
+    {
+      if (NXmakeindex(files[i].c_str()) != NX_OK)
+        {
+          return 1;
+        }
+    }
+  int ret = timeRun(files, 2, "with an index, 2 threads");
+  for (size_t i = 0; i < files.size(); i++)
+    {
+      std::remove((files[i] + ".nxindex").c_str());
+    }
+  return ret;
+}
+
+static int testExtract(int file_type, const char *extension)
+{
+  vector<string> files;
+  for (int i = 0; i < NFILES; i++)
+    {
+      std::ostringstream name;
+      name << "test_extract" << i << extension;
+      if (writeFile(file_type, name.str(), i) != 0)
+        {
+          cerr << "Failed to write " << name.str() << endl;
+          return 1;
+        }
+      files.push_back(name.str());
+    }
+  if (testRequests(files[3]) != 0)
+    {
+      return 1;
+    }
+
+  /* a file that cannot be opened is reported in its place */
+  {
+    Extractor extractor;
+    extractor.add("/entry/title");
+    vector<string> some;
+    some.push_back(files[0]);
+    some.push_back("test_extract_missing.nxs");
+    some.push_back(files[1]);
+    struct Order : public Handler {
+      int n;
+      bool failed;
+      Order() : n(0), failed(false) {}
+      void process(const Result& result)
+      {
+        failed |= (result.index != static_cast<size_t>(n))
+          || (result.ok != (n != 1));
+        n++;
+      }
+    } order;
+    extractor.setThreads(2);
+    extractor.run(some, order);
+    if (order.failed || order.n != 3)
+      {
+        cerr << "a missing file was not reported" << endl;
+        return 1;
+      }
+  }
+
+  return benchmark(files);
+}
+
+int main(int argc, char *argv[])
+{
+  int ret = 0;
+#ifdef WITH_MXML
+  cout << "Testing XML" << endl;
+  ret |= testExtract(NXACC_CREATEXML, ".xml");
+#endif
+
+#ifdef WITH_HDF5
+  cout << "Testing HDF5" << endl;
+  ret |= testExtract(NXACC_CREATE5, ".nx5");
+  if (ret == 0)
+    {
+      ret |= testReductions("test_extract_large.nx5");
+    }
+  if (ret == 0)
+    {
+      ret |= timeReductions("test_extract_large.nx5");
+    }
+#endif
+  return ret;
+}
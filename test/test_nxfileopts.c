@@ -0,0 +1,219 @@
+/*---------------------------------------------------------------------------
+  NeXus - Neutron & X-ray Common Data Format
+
+  Test and benchmark for the HDF-5 file format options, on a file with
+  many groups and many attributes
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  For further information, see <http://www.nexusformat.org>
+
+----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "napi.h"
+#include "napiconfig.h"
+#include "nxbench.h"
+
+/* the sizes timed with --benchmark, the checks use a tenth */
+#define NLOG 1000
+#define NATTR 24
+#define NLOOKUP 2000
+
+static int nlog = NLOG / 10, nlookup = NLOOKUP / 10;
+
+static long file_size(const char *filename)
+{
+	FILE *fd = fopen(filename, "rb");
+	long size;
+
+	if (fd == NULL)
+		return -1;
+	fseek(fd, 0, SEEK_END);
+	size = ftell(fd);
+	fclose(fd);
+	return size;
+}
+
+/* an NXlog per sample environment channel, with an attribute per setting */
+static int write_file(const char *filename)
+{
+	double value[4] = { 1., 2., 3., 4. };
+	int64_t dims[1] = { 4 };
+	char name[64];
+	int i, j, ival;
+	NXhandle file_id = NULL;
+
+	remove(filename);
+	if (NXopen(filename, NXACC_CREATE5, &file_id) != NX_OK)
+		return 1;
+	if (NXmakegroup(file_id, "entry1", "NXentry") != NX_OK)
+		return 1;
+	if (NXopengroup(file_id, "entry1", "NXentry") != NX_OK)
+		return 1;
+	for (i = 0; i < nlog; i++) {
+		sprintf(name, "log%d", i);
+		if (NXmakegroup(file_id, name, "NXlog") != NX_OK
+		    || NXopengroup(file_id, name, "NXlog") != NX_OK)
+			return 1;
+		if (NXmakedata64(file_id, "value", NX_FLOAT64, 1, dims) != NX_OK
+		    || NXopendata(file_id, "value") != NX_OK
+		    || NXputdata(file_id, value) != NX_OK)
+			return 1;
+		for (j = 0; j < NATTR; j++) {
+			sprintf(name, "setting%d", j);
+			ival = i * NATTR + j;
+			if (NXputattr(file_id, name, &ival, 1, NX_INT32) !=
+			    NX_OK)
+				return 1;
+		}
+		NXclosedata(file_id);
+		NXclosegroup(file_id);
+	}
+	NXclosegroup(file_id);
+	NXclose(&file_id);
+	return 0;
+}
+
+static int read_file(const char *filename, int creation_order)
+{
+	NXhandle file_id = NULL;
+	NXname name, nxclass;
+	char path[128], attr[64];
+	int i, n, type, len, ival, rank, dim[NX_MAXRANK];
+	double tim;
+
+	if (NXopen(filename, NXACC_READ, &file_id) != NX_OK)
+		return 1;
+
+	/* random channels, one setting each */
+	if (NXopengroup(file_id, "entry1", "NXentry") != NX_OK)
+		return 1;
+	srand(4321);
+	tim = nxbench_now();
+	for (n = 0; n < nlookup; n++) {
+		i = rand() % nlog;
+		sprintf(path, "log%d", i);
+		sprintf(attr, "setting%d", NATTR - 1 - n % NATTR);
+		len = 1;
+		type = NX_INT32;
+		if (NXopengroup(file_id, path, "NXlog") != NX_OK
+		    || NXopendata(file_id, "value") != NX_OK
+		    || NXgetattr(file_id, attr, &ival, &len, &type) != NX_OK
+		    || ival != i * NATTR + NATTR - 1 - n % NATTR) {
+			fprintf(stderr, "reading %s/value@%s failed\n", path,
+				attr);
+			return 1;
+		}
+		NXclosedata(file_id);
+		NXclosegroup(file_id);
+	}
+	if (nxbench)
+		printf("    %d group and attribute lookups: %.3f s\n",
+		       nlookup, nxbench_now() - tim);
+	NXclosegroup(file_id);
+
+	/* the whole entry, in creation order where it is tracked */
+	if (NXopenpath(file_id, "/entry1") != NX_OK
+	    || NXinitgroupdir(file_id) != NX_OK)
+		return 1;
+	tim = nxbench_now();
+	n = 0;
+	while (NXgetnextentry(file_id, name, nxclass, &type) == NX_OK) {
+		if (strcmp(nxclass, "NXlog") != 0)
+			return 1;
+		sprintf(path, "log%d", n);
+		if (creation_order && strcmp(name, path) != 0) {
+			fprintf(stderr, "entry %d is %s, not in creation "
+				"order\n", n, name);
+			return 1;
+		}
+		n++;
+	}
+	if (nxbench)
+		printf("    listing %d groups: %.3f s\n", n,
+		       nxbench_now() - tim);
+	if (n != nlog) {
+		fprintf(stderr, "listed %d groups instead of %d\n", n, nlog);
+		return 1;
+	}
+
+	/* all attributes are still listed, whatever their storage */
+	if (NXopenpath(file_id, "/entry1/log7/value") != NX_OK
+	    || NXinitattrdir(file_id) != NX_OK)
+		return 1;
+	n = 0;
+	while (NXgetnextattra(file_id, name, &rank, dim, &type) == NX_OK) {
+		sprintf(attr, "setting%d", n);
+		if (creation_order && strcmp(name, attr) != 0) {
+			fprintf(stderr, "attribute %d is %s\n", n, name);
+			return 1;
+		}
+		n++;
+	}
+	if (n != NATTR) {
+		fprintf(stderr, "listed %d attributes instead of %d\n", n,
+			NATTR);
+		return 1;
+	}
+	NXclose(&file_id);
+	return 0;
+}
+
+static int test_options(const char *title, int options, const char *filename)
+{
+	double tim;
+
+	printf("  %s\n", title);
+	if (NXsetfileoptions(options, 4, 0) != NX_OK)
+		return 1;
+	tim = nxbench_now();
+	if (write_file(filename) != 0) {
+		fprintf(stderr, "Failed to write %s\n", filename);
+		return 1;
+	}
+	if (nxbench)
+		printf("    writing %d logs x %d attributes: %.3f s, "
+		       "%ld bytes\n", nlog, NATTR, nxbench_now() - tim,
+		       file_size(filename));
+	return read_file(filename, (options & NXFILE_CREATION_ORDER) != 0);
+}
+
+int main(int argc, char *argv[])
+{
+	int ret = 0;
+
+	if (nxbench_init(argc, argv)) {
+		nlog = NLOG;
+		nlookup = NLOOKUP;
+	}
+#ifdef WITH_HDF5
+	printf("Testing HDF5\n");
+	ret |= test_options("default format", 0, "test_fileopts0.nx5");
+	ret |= test_options("all options",
+			    NXFILE_LATEST_FORMAT | NXFILE_CREATION_ORDER |
+			    NXFILE_DENSE_ATTRIBUTES |
+			    NXFILE_AGGREGATE_METADATA, "test_fileopts1.nx5");
+	ret |= test_options("dense attributes only", NXFILE_DENSE_ATTRIBUTES,
+			    "test_fileopts2.nx5");
+	if (NXsetfileoptions(-1, 0, 0) == NX_OK) {
+		fprintf(stderr, "NXsetfileoptions accepted unknown options\n");
+		ret = 1;
+	}
+	NXsetfileoptions(0, 8, 0);
+#endif
+	return ret;
+}
@@ -0,0 +1,208 @@
+/*---------------------------------------------------------------------------
+  NeXus - Neutron & X-ray Common Data Format
+
+  Test and benchmark for frame by frame reading with read-ahead
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  For further information, see <http://www.nexusformat.org>
+
+----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifndef _WIN32
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+#include "napi.h"
+#include "napiconfig.h"
+
+#define NFRAME 48
+#define NY 256
+#define NX 256
+#define WORK 2
+
+typedef struct {
+	int64_t next;
+	int64_t stop_at;
+	double total;
+	int bad;
+} FrameState;
+
+static double now(void)
+{
+#ifndef _WIN32
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec * 1e-6;
+#else
+	return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+static int32_t value_at(int64_t f, int64_t y, int64_t x)
+{
+	return (int32_t) ((f * 7 + y * 3 + x) % 1000);
+}
+
+static int write_file(int file_type, const char *filename)
+{
+	static int32_t frame[NY][NX];
+	int64_t dims[3] = { NFRAME, NY, NX };
+	int64_t chunk[3] = { 1, NY, NX };
+	int64_t start[3] = { 0, 0, 0 }, size[3] = { 1, NY, NX };
+	int64_t f, y, x;
+	NXhandle file_id = NULL;
+
+	remove(filename);
+	if (NXopen(filename, file_type, &file_id) != NX_OK)
+		return 1;
+	if (NXmakegroup(file_id, "entry1", "NXentry") != NX_OK)
+		return 1;
+	if (NXopengroup(file_id, "entry1", "NXentry") != NX_OK)
+		return 1;
+	if (NXcompmakedata64(file_id, "data", NX_INT32, 3, dims, NX_COMP_LZW,
+			     chunk) != NX_OK)
+		return 1;
+	if (NXopendata(file_id, "data") != NX_OK)
+		return 1;
+	for (f = 0; f < NFRAME; f++) {
+		for (y = 0; y < NY; y++)
+			for (x = 0; x < NX; x++)
+				frame[y][x] = value_at(f, y, x);
+		start[0] = f;
+		if (NXputslab64(file_id, frame, start, size) != NX_OK)
+			return 1;
+	}
+	NXclosedata(file_id);
+	NXclosegroup(file_id);
+	NXclose(&file_id);
+	return 0;
+}
+
+/*
+ * stands in for per frame analysis, e.g. peak finding, followed by
+ * waiting on whatever consumes the result (display, network)
+ */
+static int process_frame(void *frame, int64_t index, void *userdata)
+{
+	FrameState *state = (FrameState *) userdata;
+	const int32_t *data = (const int32_t *)frame;
+	int64_t i;
+	int w;
+	double sum = 0;
+
+	if (index != state->next++ || data[NX + 1] != value_at(index, 1, 1)) {
+		state->bad = 1;
+		return 1;
+	}
+	for (w = 0; w < WORK; w++)
+		for (i = 0; i < NY * NX; i++)
+			sum += data[i] * (w + 1);
+	state->total += sum;
+#ifndef _WIN32
+	usleep(2000);
+#endif
+	return index == state->stop_at;
+}
+
+static int skip_frame(void *frame, int64_t index, void *userdata)
+{
+	return 0;
+}
+
+static int test_frames(int file_type, const char *filename)
+{
+	NXhandle file_id = NULL;
+	FrameState sync, async, cancel;
+	double t;
+
+	if (write_file(file_type, filename) != 0) {
+		fprintf(stderr, "Failed to write %s\n", filename);
+		return 1;
+	}
+	if (NXopen(filename, NXACC_READ, &file_id) != NX_OK)
+		return 1;
+	if (NXopenpath(file_id, "/entry1/data") != NX_OK)
+		return 1;
+
+	t = now();
+	if (NXgetframes64(file_id, 0, NFRAME, 0, skip_frame, NULL) != NX_OK) {
+		fprintf(stderr, "NXgetframes64 failed\n");
+		return 1;
+	}
+	printf("  %d frames, reading only: %.3f s\n", NFRAME, now() - t);
+
+	memset(&sync, 0, sizeof(FrameState));
+	sync.stop_at = -1;
+	t = now();
+	if (NXgetframes64(file_id, 0, NFRAME, 0, process_frame, &sync) != NX_OK
+	    || sync.bad || sync.next != NFRAME) {
+		fprintf(stderr, "synchronous NXgetframes64 failed\n");
+		return 1;
+	}
+	printf("  %d frames, no read-ahead: %.3f s\n", NFRAME, now() - t);
+
+	memset(&async, 0, sizeof(FrameState));
+	async.stop_at = -1;
+	t = now();
+	if (NXgetframes64(file_id, 0, NFRAME, 4, process_frame, &async) !=
+	    NX_OK || async.bad || async.next != NFRAME) {
+		fprintf(stderr, "NXgetframes64 with read-ahead failed\n");
+		return 1;
+	}
+	printf("  %d frames, read-ahead 4: %.3f s\n", NFRAME, now() - t);
+	if (async.total != sync.total) {
+		fprintf(stderr, "read-ahead returned different data\n");
+		return 1;
+	}
+
+	/* cancel half way, starting at an offset */
+	memset(&cancel, 0, sizeof(FrameState));
+	cancel.next = 5;
+	cancel.stop_at = 20;
+	if (NXgetframes64(file_id, 5, NFRAME - 5, 4, process_frame, &cancel) !=
+	    NX_OK || cancel.bad || cancel.next != 21) {
+		fprintf(stderr, "cancelling NXgetframes64 failed\n");
+		return 1;
+	}
+
+	if (NXgetframes64(file_id, 1, NFRAME, 4, process_frame, &cancel) ==
+	    NX_OK) {
+		fprintf(stderr, "NXgetframes64 accepted frames past the end\n");
+		return 1;
+	}
+
+	NXclosedata(file_id);
+	NXclose(&file_id);
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	int ret = 0;
+#ifdef WITH_HDF4
+	printf("Testing HDF4\n");
+	ret |= test_frames(NXACC_CREATE4, "test_frames.nx4");
+#endif
+
+#ifdef WITH_HDF5
+	printf("Testing HDF5\n");
+	ret |= test_frames(NXACC_CREATE5, "test_frames.nx5");
+#endif
+	return ret;
+}
@@ -0,0 +1,276 @@
+/*---------------------------------------------------------------------------
+  NeXus - Neutron & X-ray Common Data Format
+
+  Test and benchmark for the multi-slab, strided and point reads
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  For further information, see <http://www.nexusformat.org>
+
+----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "napi.h"
+#include "napiconfig.h"
+
+#define NFRAME 16
+#define NY 128
+#define NX 128
+#define NROI 2000
+#define ROI_SIZE 5
+
+static int64_t roi_start[NROI][3];
+static int64_t roi_size[NROI][3];
+
+static int write_file(int file_type, const char *filename)
+{
+	static int32_t d[NFRAME][NY][NX];
+	int64_t dims[3] = { NFRAME, NY, NX };
+	int i, j, k;
+	NXhandle file_id = NULL;
+
+	for (i = 0; i < NFRAME; i++)
+		for (j = 0; j < NY; j++)
+			for (k = 0; k < NX; k++)
+				d[i][j][k] = (i * NY + j) * NX + k;
+
+	remove(filename);
+	if (NXopen(filename, file_type, &file_id) != NX_OK)
+		return 1;
+	if (NXmakegroup(file_id, "entry1", "NXentry") != NX_OK)
+		return 1;
+	if (NXopengroup(file_id, "entry1", "NXentry") != NX_OK)
+		return 1;
+	if (NXmakedata64(file_id, "data", NX_INT32, 3, dims) != NX_OK)
+		return 1;
+	if (NXopendata(file_id, "data") != NX_OK)
+		return 1;
+	if (NXputdata(file_id, d) != NX_OK)
+		return 1;
+	NXclosedata(file_id);
+	NXclosegroup(file_id);
+	NXclose(&file_id);
+	return 0;
+}
+
+static int check_roi(const int32_t * buf, int n)
+{
+	int64_t i, j, k;
+	const int32_t *p = buf;
+	for (i = 0; i < roi_size[n][0]; i++)
+		for (j = 0; j < roi_size[n][1]; j++)
+			for (k = 0; k < roi_size[n][2]; k++) {
+				int32_t expect = (int32_t)
+				    (((roi_start[n][0] + i) * NY +
+				      roi_start[n][1] + j) * NX +
+				     roi_start[n][2] + k);
+				if (*p++ != expect) {
+					fprintf(stderr,
+						"ROI %d mismatch: got %d expected %d\n",
+						n, (int)p[-1], (int)expect);
+					return 1;
+				}
+			}
+	return 0;
+}
+
+static int test_getslabs(int file_type, const char *filename)
+{
+	static int32_t loop_buf[NROI][ROI_SIZE * ROI_SIZE];
+	static int32_t multi_buf[NROI][ROI_SIZE * ROI_SIZE];
+	const int64_t *starts[NROI], *sizes[NROI];
+	void *buffers[NROI];
+	NXhandle file_id = NULL;
+	clock_t tim;
+	int i;
+
+	if (write_file(file_type, filename) != 0) {
+		fprintf(stderr, "Failed to write %s\n", filename);
+		return 1;
+	}
+
+	/* single frame boxes, some of them overlapping */
+	srand(1234);
+	for (i = 0; i < NROI; i++) {
+		roi_start[i][0] = rand() % NFRAME;
+		roi_start[i][1] = rand() % (NY - ROI_SIZE);
+		roi_start[i][2] = rand() % (NX - ROI_SIZE);
+		roi_size[i][0] = 1;
+		roi_size[i][1] = ROI_SIZE;
+		roi_size[i][2] = ROI_SIZE;
+		starts[i] = roi_start[i];
+		sizes[i] = roi_size[i];
+		buffers[i] = multi_buf[i];
+	}
+	/* an empty slab must be accepted and leave its buffer alone */
+	roi_size[NROI - 1][1] = 0;
+
+	if (NXopen(filename, NXACC_READ, &file_id) != NX_OK)
+		return 1;
+	if (NXopenpath(file_id, "/entry1/data") != NX_OK)
+		return 1;
+
+	tim = clock();
+	for (i = 0; i < NROI; i++) {
+		if (NXgetslab64(file_id, loop_buf[i], roi_start[i],
+				roi_size[i]) != NX_OK) {
+			fprintf(stderr, "NXgetslab64 failed for ROI %d\n", i);
+			return 1;
+		}
+	}
+	printf("  %d x NXgetslab64: %.3f s\n", NROI,
+	       (double)(clock() - tim) / CLOCKS_PER_SEC);
+
+	tim = clock();
+	if (NXgetslabs64(file_id, NROI, starts, sizes, buffers) != NX_OK) {
+		fprintf(stderr, "NXgetslabs64 failed\n");
+		return 1;
+	}
+	printf("  1 x NXgetslabs64: %.3f s\n",
+	       (double)(clock() - tim) / CLOCKS_PER_SEC);
+
+	for (i = 0; i < NROI; i++) {
+		if (check_roi(multi_buf[i], i) != 0)
+			return 1;
+		if (memcmp(loop_buf[i], multi_buf[i],
+			   sizeof(int32_t) * roi_size[i][1] * roi_size[i][2])
+		    != 0) {
+			fprintf(stderr, "ROI %d differs from NXgetslab64\n", i);
+			return 1;
+		}
+	}
+
+	/* far apart slabs take the slab by slab path */
+	roi_start[0][0] = 0;
+	roi_start[0][1] = 0;
+	roi_start[0][2] = 0;
+	roi_start[1][0] = NFRAME - 1;
+	roi_start[1][1] = NY - ROI_SIZE;
+	roi_start[1][2] = NX - ROI_SIZE;
+	roi_size[1][0] = 1;
+	roi_size[1][1] = 2;
+	if (NXgetslabs64(file_id, 2, starts, sizes, buffers) != NX_OK) {
+		fprintf(stderr, "NXgetslabs64 failed on sparse slabs\n");
+		return 1;
+	}
+	if (check_roi(multi_buf[0], 0) != 0 || check_roi(multi_buf[1], 1) != 0)
+		return 1;
+
+	/* out of range slabs must be rejected */
+	roi_start[0][2] = NX;
+	if (file_type == NXACC_CREATE5 &&
+	    NXgetslabs64(file_id, 1, starts, sizes, buffers) == NX_OK) {
+		fprintf(stderr, "NXgetslabs64 accepted an out of range slab\n");
+		return 1;
+	}
+
+	NXclosedata(file_id);
+	NXclose(&file_id);
+	return 0;
+}
+
+static int32_t value_at(int64_t f, int64_t y, int64_t x)
+{
+	return (int32_t) ((f * NY + y) * NX + x);
+}
+
+static int test_strided(int file_type, const char *filename)
+{
+	static int32_t buf[NFRAME * NY * NX];
+	int64_t start[3] = { 1, 2, 3 };
+	int64_t size[3] = { 3, 4, 5 };
+	int64_t stride[3] = { 5, 10, 7 };
+	int64_t block[3] = { 1, 2, 3 };
+	int64_t coords[4 * 3] = { 15, 127, 127, 0, 0, 0, 7, 3, 9, 7, 3, 9 };
+	int64_t f, y, x;
+	NXhandle file_id = NULL;
+	int32_t *p;
+
+	if (NXopen(filename, NXACC_READ, &file_id) != NX_OK)
+		return 1;
+	if (NXopenpath(file_id, "/entry1/data") != NX_OK)
+		return 1;
+
+	/* every 5th frame, 2x3 pixel blocks on a 10x7 raster */
+	if (NXgetslab64s(file_id, buf, start, size, stride, block) != NX_OK) {
+		fprintf(stderr, "NXgetslab64s failed\n");
+		return 1;
+	}
+	p = buf;
+	for (f = 0; f < size[0] * block[0]; f++)
+		for (y = 0; y < size[1] * block[1]; y++)
+			for (x = 0; x < size[2] * block[2]; x++) {
+				int32_t expect =
+				    value_at(start[0] + f / block[0] * stride[0] +
+					     f % block[0],
+					     start[1] + y / block[1] * stride[1] +
+					     y % block[1],
+					     start[2] + x / block[2] * stride[2] +
+					     x % block[2]);
+				if (*p++ != expect) {
+					fprintf(stderr,
+						"NXgetslab64s mismatch at %d %d %d\n",
+						(int)f, (int)y, (int)x);
+					return 1;
+				}
+			}
+
+	/* NULL stride and block is a plain slab */
+	if (NXgetslab64s(file_id, buf, start, size, NULL, NULL) != NX_OK ||
+	    buf[0] != value_at(1, 2, 3) || buf[59] != value_at(3, 5, 7)) {
+		fprintf(stderr, "NXgetslab64s without stride failed\n");
+		return 1;
+	}
+
+	/* points come back in list order, duplicates included */
+	if (NXgetpoints64(file_id, buf, 4, coords) != NX_OK) {
+		fprintf(stderr, "NXgetpoints64 failed\n");
+		return 1;
+	}
+	if (buf[0] != value_at(15, 127, 127) || buf[1] != value_at(0, 0, 0) ||
+	    buf[2] != value_at(7, 3, 9) || buf[3] != value_at(7, 3, 9)) {
+		fprintf(stderr, "NXgetpoints64 returned wrong values\n");
+		return 1;
+	}
+
+	NXclosedata(file_id);
+	NXclose(&file_id);
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	int ret = 0;
+#ifdef WITH_HDF4
+	printf("Testing HDF4\n");
+	ret |= test_getslabs(NXACC_CREATE4, "test_getslabs.nx4");
+	ret |= test_strided(NXACC_CREATE4, "test_getslabs.nx4");
+#endif
+
+#ifdef WITH_MXML
+	printf("Testing XML\n");
+	ret |= test_getslabs(NXACC_CREATEXML, "test_getslabs.xml");
+	ret |= test_strided(NXACC_CREATEXML, "test_getslabs.xml");
+#endif
+
+#ifdef WITH_HDF5
+	printf("Testing HDF5\n");
+	ret |= test_getslabs(NXACC_CREATE5, "test_getslabs.nx5");
+	ret |= test_strided(NXACC_CREATE5, "test_getslabs.nx5");
+#endif
+	return ret;
+}
@@ -0,0 +1,258 @@
+/*---------------------------------------------------------------------------
+  NeXus - Neutron & X-ray Common Data Format
+
+  Test and benchmark for the index written beside a file, and read by
+  NXopen with NXACC_SNAPSHOT instead of walking the file
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  For further information, see <http://www.nexusformat.org>
+
+----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "napi.h"
+#include "napiconfig.h"
+#include "nxbench.h"
+
+#define NGROUP 100		/* groups timed with --benchmark */
+#define NDATA 20
+#define NOPEN 20
+
+static int ngroup = NOPEN;	/* a group for each catalog query */
+
+static int write_file(int file_type, const char *filename)
+{
+	int64_t dims[2] = { 5, 2 };
+	int32_t values[10];
+	double wavelength = 1.5;
+	char name[64];
+	int i, j;
+	NXhandle file_id = NULL;
+
+	for (i = 0; i < 10; i++)
+		values[i] = i;
+	remove(filename);
+	if (NXopen(filename, file_type | NXACC_INDEX, &file_id) != NX_OK)
+		return 1;
+	if (NXmakegroup(file_id, "entry", "NXentry") != NX_OK
+	    || NXopengroup(file_id, "entry", "NXentry") != NX_OK
+	    || NXputattr(file_id, "start_time", "2026-10-19T14:00:00", 19,
+			 NX_CHAR) != NX_OK
+	    || NXputattr(file_id, "wavelength", &wavelength, 1,
+			 NX_FLOAT64) != NX_OK)
+		return 1;
+	for (i = 0; i < ngroup; i++) {
+		sprintf(name, "data%d", i);
+		if (NXmakegroup(file_id, name, "NXdata") != NX_OK
+		    || NXopengroup(file_id, name, "NXdata") != NX_OK)
+			return 1;
+		for (j = 0; j < NDATA; j++) {
+			sprintf(name, "d%d", j);
+			values[0] = i * 100 + j;
+			if (NXmakedata64(file_id, name, NX_INT32, 2, dims) != NX_OK
+			    || NXopendata(file_id, name) != NX_OK
+			    || NXputdata(file_id, values) != NX_OK
+			    || NXputattr(file_id, "units", "counts", 6,
+					 NX_CHAR) != NX_OK)
+				return 1;
+			NXclosedata(file_id);
+		}
+		NXclosegroup(file_id);
+	}
+	NXclosegroup(file_id);
+	return NXclose(&file_id) != NX_OK;
+}
+
+/* what a catalog asks of every file */
+static int catalog(const char *filename, int group)
+{
+	NXhandle file_id = NULL;
+	char path[128], start[64];
+	int64_t dims[NX_MAXRANK];
+	int32_t values[10];
+	int rank, type, len;
+
+	if (NXopen(filename, NXACC_READ | NXACC_SNAPSHOT, &file_id) != NX_OK
+	    || NXopenpath(file_id, "/entry") != NX_OK)
+		return 1;
+	len = sizeof(start);
+	type = NX_CHAR;
+	if (NXgetattr(file_id, "start_time", start, &len, &type) != NX_OK
+	    || strcmp(start, "2026-10-19T14:00:00") != 0)
+		return 1;
+	sprintf(path, "/entry/data%d/d3", group);
+	if (NXopenpath(file_id, path) != NX_OK
+	    || NXgetinfo64(file_id, &rank, dims, &type) != NX_OK
+	    || rank != 2 || dims[0] != 5 || dims[1] != 2 || type != NX_INT32)
+		return 1;
+	if (NXgetdata(file_id, values) != NX_OK
+	    || values[0] != group * 100 + 3 || values[9] != 9)
+		return 1;
+	return NXclose(&file_id) != NX_OK;
+}
+
+static int time_catalog(const char *filename, const char *title)
+{
+	double tim;
+	int i;
+
+	tim = nxbench_now();
+	for (i = 0; i < NOPEN; i++) {
+		if (catalog(filename, i) != 0) {
+			fprintf(stderr, "catalog of %s failed\n", filename);
+			return 1;
+		}
+	}
+	if (nxbench)
+		printf("  %d catalog queries, %-18s %.3f s\n", NOPEN, title,
+		       nxbench_now() - tim);
+	return 0;
+}
+
+/* writes the first half of the index back, keeping the file unchanged */
+static int damage_index(const char *indexname)
+{
+	char buffer[4096];
+	size_t n;
+	FILE *fd;
+
+	fd = fopen(indexname, "rb");
+	if (fd == NULL)
+		return 1;
+	n = fread(buffer, 1, sizeof(buffer), fd);
+	fclose(fd);
+	fd = fopen(indexname, "wb");
+	if (fd == NULL)
+		return 1;
+	fwrite(buffer, 1, n / 2, fd);
+	fclose(fd);
+	return 0;
+}
+
+static int test_index(int file_type, const char *filename)
+{
+	NXhandle file_id = NULL;
+	char indexname[256];
+	double wavelength = 0;
+	int len, type, n;
+	NXname name, nxclass;
+
+	sprintf(indexname, "%s.nxindex", filename);
+	remove(indexname);
+	if (write_file(file_type, filename) != 0) {
+		fprintf(stderr, "Failed to write %s\n", filename);
+		return 1;
+	}
+
+	/* NXclose wrote the index */
+	if (NXcheckindex(filename) != NX_OK) {
+		fprintf(stderr, "no index for %s\n", filename);
+		return 1;
+	}
+	if (time_catalog(filename, "from the index") != 0)
+		return 1;
+
+	/* numbers in attributes are kept as they are */
+	if (NXopen(filename, NXACC_READ | NXACC_SNAPSHOT, &file_id) != NX_OK
+	    || NXopenpath(file_id, "/entry") != NX_OK)
+		return 1;
+	len = 1;
+	type = NX_FLOAT64;
+	if (NXgetattr(file_id, "wavelength", &wavelength, &len, &type) != NX_OK
+	    || wavelength != 1.5)
+		return 1;
+	if (NXgetgroupinfo(file_id, &n, name, nxclass) != NX_OK
+	    || n != ngroup || strcmp(nxclass, "NXentry") != 0)
+		return 1;
+	NXclose(&file_id);
+
+	/* without the index the file is walked */
+	remove(indexname);
+	if (NXcheckindex(filename) != NX_EOD)
+		return 1;
+	if (time_catalog(filename, "walking the file") != 0)
+		return 1;
+
+	/* NXmakeindex, as nxindex uses it, writes the same index */
+	if (NXmakeindex(filename) != NX_OK || NXcheckindex(filename) != NX_OK)
+		return 1;
+
+	/* a damaged index is not used */
+	if (damage_index(indexname) != 0 || catalog(filename, 7) != 0) {
+		fprintf(stderr, "a damaged index was used\n");
+		return 1;
+	}
+
+	/* nor is the index of a file changed since */
+	if (NXmakeindex(filename) != NX_OK
+	    || NXopen(filename, NXACC_RDWR, &file_id) != NX_OK
+	    || NXmakegroup(file_id, "extra", "NXnote") != NX_OK
+	    || NXclose(&file_id) != NX_OK)
+		return 1;
+	if (NXcheckindex(filename) != NX_EOD) {
+		fprintf(stderr, "a stale index was not noticed\n");
+		return 1;
+	}
+	if (NXopen(filename, NXACC_READ | NXACC_SNAPSHOT, &file_id) != NX_OK
+	    || NXopengroup(file_id, "extra", "NXnote") != NX_OK)
+		return 1;
+	NXclose(&file_id);
+
+	/* even when values are rewritten in place within the same second */
+	wavelength = 2.5;
+	if (NXmakeindex(filename) != NX_OK
+	    || NXopen(filename, NXACC_RDWR, &file_id) != NX_OK
+	    || NXopenpath(file_id, "/entry") != NX_OK
+	    || NXputattr(file_id, "wavelength", &wavelength, 1,
+			 NX_FLOAT64) != NX_OK || NXclose(&file_id) != NX_OK)
+		return 1;
+	if (NXcheckindex(filename) != NX_EOD) {
+		fprintf(stderr, "an index of rewritten values was used\n");
+		return 1;
+	}
+	len = 1;
+	type = NX_FLOAT64;
+	if (NXopen(filename, NXACC_READ | NXACC_SNAPSHOT, &file_id) != NX_OK
+	    || NXopenpath(file_id, "/entry") != NX_OK
+	    || NXgetattr(file_id, "wavelength", &wavelength, &len,
+			 &type) != NX_OK || wavelength != 2.5)
+		return 1;
+	NXclose(&file_id);
+
+	/* an index is only written for files being written */
+	if (NXopen(filename, NXACC_READ | NXACC_INDEX, &file_id) == NX_OK)
+		return 1;
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	int ret = 0;
+
+	if (nxbench_init(argc, argv))
+		ngroup = NGROUP;
+#ifdef WITH_MXML
+	printf("Testing XML\n");
+	ret |= test_index(NXACC_CREATEXML, "test_index.xml");
+#endif
+
+#ifdef WITH_HDF5
+	printf("Testing HDF5\n");
+	ret |= test_index(NXACC_CREATE5, "test_index.nx5");
+#endif
+	return ret;
+}
@@ -0,0 +1,137 @@
+/*---------------------------------------------------------------------------
+  NeXus - Neutron & X-ray Common Data Format
+
+  Test for parallel access through MPI-IO, every process writing and
+  reading its own rows of one dataset. Run with mpirun -np <n>.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  For further information, see <http://www.nexusformat.org>
+
+----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <mpi.h>
+#include "napi.h"
+#include "napiconfig.h"
+
+#define NROW 64
+#define NCOL 256
+
+static const char *filename = "test_mpi.nx5";
+
+static int32_t value_at(int64_t row, int64_t col)
+{
+	return (int32_t) (row * NCOL + col);
+}
+
+/* rows rank*NROW ... (rank+1)*NROW-1 belong to process rank */
+static int write_file(int rank, int nproc, int collective)
+{
+	static int32_t rows[NROW][NCOL];
+	int64_t dims[2] = { 0, NCOL };
+	int64_t start[2] = { 0, 0 }, size[2] = { NROW, NCOL };
+	int64_t r, k;
+	NXhandle file_id = NULL;
+
+	dims[0] = (int64_t) nproc * NROW;
+	for (r = 0; r < NROW; r++)
+		for (k = 0; k < NCOL; k++)
+			rows[r][k] = value_at(rank * NROW + r, k);
+
+	/* the layout is made by all processes together */
+	if (NXopenmpi(filename, NXACC_CREATE5, MPI_COMM_WORLD, MPI_INFO_NULL,
+		      &file_id) != NX_OK)
+		return 1;
+	if (NXmakegroup(file_id, "entry1", "NXentry") != NX_OK
+	    || NXopengroup(file_id, "entry1", "NXentry") != NX_OK
+	    || NXmakedata64(file_id, "counts", NX_INT32, 2, dims) != NX_OK
+	    || NXopendata(file_id, "counts") != NX_OK
+	    || NXputattr(file_id, "units", "counts", 6, NX_CHAR) != NX_OK)
+		return 1;
+	if (NXsetcollective(file_id, collective) != NX_OK)
+		return 1;
+
+	/* the data by each process on its own */
+	start[0] = (int64_t) rank *NROW;
+	if (NXputslab64(file_id, rows, start, size) != NX_OK) {
+		fprintf(stderr, "process %d: NXputslab64 failed\n", rank);
+		return 1;
+	}
+	NXclosedata(file_id);
+	NXclosegroup(file_id);
+	NXclose(&file_id);
+	return 0;
+}
+
+/* every process reads the rows of the next one */
+static int read_file(int rank, int nproc, int collective)
+{
+	static int32_t rows[NROW][NCOL];
+	int64_t start[2] = { 0, 0 }, size[2] = { NROW, NCOL };
+	int64_t r, k, first;
+	NXhandle file_id = NULL;
+
+	if (NXopenmpi(filename, NXACC_READ, MPI_COMM_WORLD, MPI_INFO_NULL,
+		      &file_id) != NX_OK)
+		return 1;
+	if (NXopenpath(file_id, "/entry1/counts") != NX_OK
+	    || NXsetcollective(file_id, collective) != NX_OK)
+		return 1;
+	first = (int64_t) ((rank + 1) % nproc) * NROW;
+	start[0] = first;
+	if (NXgetslab64(file_id, rows, start, size) != NX_OK) {
+		fprintf(stderr, "process %d: NXgetslab64 failed\n", rank);
+		return 1;
+	}
+	for (r = 0; r < NROW; r++) {
+		for (k = 0; k < NCOL; k++) {
+			if (rows[r][k] != value_at(first + r, k)) {
+				fprintf(stderr, "process %d: row %d is wrong\n",
+					rank, (int)(first + r));
+				return 1;
+			}
+		}
+	}
+	NXclosedata(file_id);
+	NXclose(&file_id);
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	int rank, nproc, collective, ret = 0, all = 0;
+	double t;
+
+	MPI_Init(&argc, &argv);
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &nproc);
+	for (collective = 0; collective <= 1 && ret == 0; collective++) {
+		MPI_Barrier(MPI_COMM_WORLD);
+		t = MPI_Wtime();
+		ret |= write_file(rank, nproc, collective);
+		ret |= read_file(rank, nproc, collective);
+		MPI_Barrier(MPI_COMM_WORLD);
+		if (rank == 0) {
+			printf("%d processes, %s transfers: %.3f s\n", nproc,
+			       collective ? "collective" : "independent",
+			       MPI_Wtime() - t);
+		}
+	}
+	MPI_Allreduce(&ret, &all, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+	MPI_Finalize();
+	return all;
+}
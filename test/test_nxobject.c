@@ -0,0 +1,260 @@
+/*---------------------------------------------------------------------------
+  NeXus - Neutron & X-ray Common Data Format
+
+  Test and benchmark for object handles, several datasets open at once
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  For further information, see <http://www.nexusformat.org>
+
+----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "napi.h"
+#include "napiconfig.h"
+
+#define NDATA 4
+#define NROW 500
+#define NCOL 16
+
+static const char *names[NDATA] = { "x", "y", "z", "t" };
+
+static int32_t value_at(int d, int64_t row, int64_t col)
+{
+	return (int32_t) ((d * NROW + row) * NCOL + col);
+}
+
+static int write_file(int file_type, const char *filename)
+{
+	static int32_t d[NROW][NCOL];
+	int64_t dims[2] = { NROW, NCOL };
+	int64_t unlimited[1] = { NX_UNLIMITED };
+	int i, j, k;
+	NXhandle file_id = NULL;
+
+	remove(filename);
+	if (NXopen(filename, file_type, &file_id) != NX_OK)
+		return 1;
+	if (NXmakegroup(file_id, "entry1", "NXentry") != NX_OK)
+		return 1;
+	if (NXopengroup(file_id, "entry1", "NXentry") != NX_OK)
+		return 1;
+	for (i = 0; i < NDATA; i++) {
+		for (j = 0; j < NROW; j++)
+			for (k = 0; k < NCOL; k++)
+				d[j][k] = value_at(i, j, k);
+		if (NXmakedata64(file_id, names[i], NX_INT32, 2, dims) != NX_OK)
+			return 1;
+		if (NXopendata(file_id, names[i]) != NX_OK)
+			return 1;
+		if (NXputdata(file_id, d) != NX_OK)
+			return 1;
+		NXclosedata(file_id);
+	}
+	if (NXmakedata64(file_id, "log", NX_FLOAT64, 1, unlimited) != NX_OK)
+		return 1;
+	NXclosegroup(file_id);
+	NXclose(&file_id);
+	return 0;
+}
+
+static int check_row(const int32_t * row, int d, int64_t r)
+{
+	int64_t k;
+	for (k = 0; k < NCOL; k++) {
+		if (row[k] != value_at(d, r, k)) {
+			fprintf(stderr, "%s row %d mismatch: got %d expected %d\n",
+				names[d], (int)r, (int)row[k],
+				(int)value_at(d, r, k));
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static int test_objects(int file_type, const char *filename)
+{
+	NXhandle file_id = NULL;
+	NXobject obj[NDATA], group = NULL, log = NULL;
+	int32_t row[NCOL], ival;
+	int64_t start[2] = { 0, 0 }, size[2] = { 1, NCOL };
+	int64_t dims[2], lstart[1], lsize[1] = { 1 };
+	double value;
+	char path[256], text[64];
+	int i, rank, type, len;
+	int64_t r;
+	clock_t tim;
+
+	if (write_file(file_type, filename) != 0) {
+		fprintf(stderr, "Failed to write %s\n", filename);
+		return 1;
+	}
+	if (NXopen(filename, NXACC_RDWR, &file_id) != NX_OK)
+		return 1;
+
+	/* row by row over all datasets, reopening each one every time */
+	tim = clock();
+	for (r = 0; r < NROW; r++) {
+		start[0] = r;
+		for (i = 0; i < NDATA; i++) {
+			sprintf(path, "/entry1/%s", names[i]);
+			if (NXopenpath(file_id, path) != NX_OK ||
+			    NXgetslab64(file_id, row, start, size) != NX_OK)
+				return 1;
+			if (check_row(row, i, r) != 0)
+				return 1;
+			NXclosedata(file_id);
+		}
+	}
+	printf("  %d rows x %d datasets, NXopenpath: %.3f s\n", NROW, NDATA,
+	       (double)(clock() - tim) / CLOCKS_PER_SEC);
+
+	/* the same with the datasets kept open, the first relative to entry1 */
+	if (NXopenpath(file_id, "/entry1") != NX_OK)
+		return 1;
+	for (i = 0; i < NDATA; i++) {
+		if (i == 0) {
+			strcpy(path, names[i]);
+		} else {
+			sprintf(path, "/entry1/%s", names[i]);
+		}
+		if (NXobjopen(file_id, path, &obj[i]) != NX_OK) {
+			fprintf(stderr, "NXobjopen(%s) failed\n", path);
+			return 1;
+		}
+	}
+	if (NXobjgetinfo64(obj[1], &rank, dims, &type) != NX_OK ||
+	    rank != 2 || dims[0] != NROW || dims[1] != NCOL
+	    || type != NX_INT32) {
+		fprintf(stderr, "NXobjgetinfo64 returned wrong info\n");
+		return 1;
+	}
+	tim = clock();
+	for (r = 0; r < NROW; r++) {
+		start[0] = r;
+		for (i = 0; i < NDATA; i++) {
+			if (NXobjgetslab64(obj[i], row, start, size) != NX_OK) {
+				fprintf(stderr, "NXobjgetslab64 failed\n");
+				return 1;
+			}
+			if (check_row(row, i, r) != 0)
+				return 1;
+		}
+	}
+	printf("  %d rows x %d datasets, NXobjgetslab64: %.3f s\n", NROW,
+	       NDATA, (double)(clock() - tim) / CLOCKS_PER_SEC);
+
+	/* the position of the handle is not touched by objects */
+	if (NXopendata(file_id, "y") != NX_OK)
+		return 1;
+	start[0] = 7;
+	if (NXobjgetslab64(obj[0], row, start, size) != NX_OK
+	    || check_row(row, 0, 7) != 0)
+		return 1;
+	if (NXgetslab64(file_id, row, start, size) != NX_OK
+	    || check_row(row, 1, 7) != 0)
+		return 1;
+	if (NXgetpath(file_id, path, sizeof(path)) != NX_OK
+	    || strcmp(path, "/entry1/y") != 0) {
+		fprintf(stderr, "objects moved the handle to %s\n", path);
+		return 1;
+	}
+
+	/* writes and attributes through objects */
+	for (i = 0; i < NCOL; i++)
+		row[i] = -i;
+	start[0] = 3;
+	if (NXobjputslab64(obj[2], row, start, size) != NX_OK)
+		return 1;
+	ival = 42;
+	if (NXobjputattr(obj[2], "units", "mm", 2, NX_CHAR) != NX_OK ||
+	    NXobjputattr(obj[2], "offset", &ival, 1, NX_INT32) != NX_OK)
+		return 1;
+	if (NXobjopen(file_id, "/entry1", &group) != NX_OK ||
+	    NXobjputattr(group, "title", "objects", 7, NX_CHAR) != NX_OK)
+		return 1;
+	if (NXobjopen(file_id, "/entry1/log", &log) != NX_OK)
+		return 1;
+	for (r = 0; r < 5; r++) {
+		value = r * 0.5;
+		lstart[0] = r;
+		if (NXobjputslab64(log, &value, lstart, lsize) != NX_OK) {
+			fprintf(stderr, "NXobjputslab64 failed to extend\n");
+			return 1;
+		}
+	}
+	if (NXobjgetinfo64(log, &rank, dims, &type) != NX_OK || dims[0] != 5) {
+		fprintf(stderr, "extended dataset has wrong size\n");
+		return 1;
+	}
+
+	len = sizeof(text);
+	type = NX_CHAR;
+	memset(text, 0, sizeof(text));
+	if (NXobjgetattr(obj[2], "units", text, &len, &type) != NX_OK
+	    || strcmp(text, "mm") != 0)
+		return 1;
+	len = 1;
+	type = NX_INT32;
+	ival = 0;
+	if (NXobjgetattr(obj[2], "offset", &ival, &len, &type) != NX_OK
+	    || ival != 42)
+		return 1;
+
+	if (NXobjopen(file_id, "/entry1/missing", &obj[0]) == NX_OK) {
+		fprintf(stderr, "NXobjopen accepted a missing path\n");
+		return 1;
+	}
+	for (i = 1; i < NDATA; i++)
+		NXobjclose(&obj[i]);
+	NXobjclose(&group);
+	NXobjclose(&log);
+	if (obj[1] != NULL || NXobjclose(&obj[1]) != NX_OK)
+		return 1;
+	NXclosedata(file_id);
+
+	/* what went through the objects is visible through the handle */
+	if (NXopenpath(file_id, "/entry1/z") != NX_OK)
+		return 1;
+	start[0] = 3;
+	if (NXgetslab64(file_id, row, start, size) != NX_OK || row[5] != -5)
+		return 1;
+	memset(text, 0, sizeof(text));
+	len = sizeof(text);
+	type = NX_CHAR;
+	if (NXgetattr(file_id, "units", text, &len, &type) != NX_OK
+	    || strcmp(text, "mm") != 0)
+		return 1;
+	NXclosedata(file_id);
+	NXclose(&file_id);
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	int ret = 0;
+#ifdef WITH_MXML
+	printf("Testing XML\n");
+	ret |= test_objects(NXACC_CREATEXML, "test_object.xml");
+#endif
+
+#ifdef WITH_HDF5
+	printf("Testing HDF5\n");
+	ret |= test_objects(NXACC_CREATE5, "test_object.nx5");
+#endif
+	return ret;
+}
@@ -0,0 +1,188 @@
+/*---------------------------------------------------------------------------
+  NeXus - Neutron & X-ray Common Data Format
+
+  Benchmark for opening and closing many small files, with and without
+  a file format hint
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  For further information, see <http://www.nexusformat.org>
+
+----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifndef _WIN32
+#include <sys/time.h>
+#endif
+#include "napi.h"
+#include "napiconfig.h"
+
+#define NFILE 50
+#define NREPEAT 10
+
+static double now(void)
+{
+#ifndef _WIN32
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec * 1e-6;
+#else
+	return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+static long file_size(const char *filename)
+{
+	FILE *fd = fopen(filename, "rb");
+	long size;
+
+	if (fd == NULL)
+		return -1;
+	fseek(fd, 0, SEEK_END);
+	size = ftell(fd);
+	fclose(fd);
+	return size;
+}
+
+static void file_name(char *name, const char *ext, int i)
+{
+	sprintf(name, "test_open%d.%s", i, ext);
+}
+
+/* a small file, as from a single detector readout */
+static int write_file(int file_type, const char *filename, int i)
+{
+	int32_t counts[16];
+	int64_t dims[1] = { 16 };
+	int j;
+	NXhandle file_id = NULL;
+
+	for (j = 0; j < 16; j++)
+		counts[j] = i + j;
+	remove(filename);
+	if (NXopen(filename, file_type, &file_id) != NX_OK)
+		return 1;
+	if (NXmakegroup(file_id, "entry1", "NXentry") != NX_OK
+	    || NXopengroup(file_id, "entry1", "NXentry") != NX_OK
+	    || NXmakedata64(file_id, "counts", NX_INT32, 1, dims) != NX_OK
+	    || NXopendata(file_id, "counts") != NX_OK
+	    || NXputdata(file_id, counts) != NX_OK)
+		return 1;
+	NXclosedata(file_id);
+	NXclosegroup(file_id);
+	NXclose(&file_id);
+	return 0;
+}
+
+/* opens and closes every file NREPEAT times, reading one value */
+static int open_all(const char *ext, NXaccess am, const char *title)
+{
+	NXhandle file_id = NULL;
+	char name[64];
+	int32_t value;
+	int64_t start[1] = { 3 }, size[1] = { 1 };
+	double t;
+	int i, r;
+
+	t = now();
+	for (r = 0; r < NREPEAT; r++) {
+		for (i = 0; i < NFILE; i++) {
+			file_name(name, ext, i);
+			if (NXopen(name, am, &file_id) != NX_OK) {
+				fprintf(stderr, "opening %s failed\n", name);
+				return 1;
+			}
+			if (NXopenpath(file_id, "/entry1/counts") != NX_OK
+			    || NXgetslab64(file_id, &value, start, size) != NX_OK
+			    || value != i + 3) {
+				fprintf(stderr, "reading %s failed\n", name);
+				return 1;
+			}
+			NXclose(&file_id);
+		}
+	}
+	t = now() - t;
+	printf("  %-28s %8.1f us per file\n", title,
+	       1e6 * t / (NFILE * NREPEAT));
+	return 0;
+}
+
+static int test_open(int file_type, NXaccess hint, const char *ext)
+{
+	NXhandle file_id = NULL;
+	char name[64];
+	long size;
+	int i;
+
+	for (i = 0; i < NFILE; i++) {
+		file_name(name, ext, i);
+		if (write_file(file_type, name, i) != 0) {
+			fprintf(stderr, "Failed to write %s\n", name);
+			return 1;
+		}
+	}
+	if (open_all(ext, NXACC_READ, "NXACC_READ") != 0
+	    || open_all(ext, NXACC_READ | hint, "NXACC_READ with hint") != 0
+	    || open_all(ext, NXACC_RDWR, "NXACC_RDWR") != 0
+	    || open_all(ext, NXACC_RDWR | hint, "NXACC_RDWR with hint") != 0)
+		return 1;
+
+	/* opening for writing without writing leaves the file alone */
+	file_name(name, ext, 0);
+	size = file_size(name);
+	if (NXopen(name, NXACC_RDWR, &file_id) != NX_OK)
+		return 1;
+	NXclose(&file_id);
+	if (file_size(name) != size) {
+		fprintf(stderr, "NXACC_RDWR changed %s\n", name);
+		return 1;
+	}
+
+	/* a wrong or ambiguous hint is an error, not a guess */
+	if (NXopen(name, NXACC_READ | NXACC_HINT_HDF5 | NXACC_HINT_XML,
+		   &file_id) == NX_OK) {
+		fprintf(stderr, "NXopen accepted two format hints\n");
+		return 1;
+	}
+	if (NXopen(name, NXACC_READ | (hint == NXACC_HINT_HDF5 ?
+				       NXACC_HINT_XML : NXACC_HINT_HDF5),
+		   &file_id) == NX_OK) {
+		fprintf(stderr, "NXopen accepted the wrong format hint\n");
+		return 1;
+	}
+
+	for (i = 0; i < NFILE; i++) {
+		file_name(name, ext, i);
+		remove(name);
+	}
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	int ret = 0;
+#ifdef WITH_MXML
+	printf("Testing XML\n");
+	ret |= test_open(NXACC_CREATEXML, NXACC_HINT_XML, "xml");
+#endif
+
+#ifdef WITH_HDF5
+	printf("Testing HDF5\n");
+	ret |= test_open(NXACC_CREATE5, NXACC_HINT_HDF5, "nx5");
+#endif
+	return ret;
+}
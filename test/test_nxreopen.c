@@ -0,0 +1,165 @@
+/*---------------------------------------------------------------------------
+  NeXus - Neutron & X-ray Common Data Format
+
+  Test and benchmark for NXreopen against opening the file again
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  For further information, see <http://www.nexusformat.org>
+
+----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "napi.h"
+#include "napiconfig.h"
+
+#define NHANDLE 8
+#define NDATA 16
+#define NPOINT 5000
+
+static int32_t value_at(int d, int i)
+{
+	return (int32_t) (d * NPOINT + i);
+}
+
+static int write_file(int file_type, const char *filename)
+{
+	static int32_t d[NPOINT];
+	int64_t dims[1] = { NPOINT };
+	char name[64];
+	int i, j;
+	NXhandle file_id = NULL;
+
+	remove(filename);
+	if (NXopen(filename, file_type, &file_id) != NX_OK)
+		return 1;
+	if (NXmakegroup(file_id, "entry1", "NXentry") != NX_OK)
+		return 1;
+	if (NXopengroup(file_id, "entry1", "NXentry") != NX_OK)
+		return 1;
+	for (i = 0; i < NDATA; i++) {
+		for (j = 0; j < NPOINT; j++)
+			d[j] = value_at(i, j);
+		sprintf(name, "data%d", i);
+		if (NXmakedata64(file_id, name, NX_INT32, 1, dims) != NX_OK)
+			return 1;
+		if (NXopendata(file_id, name) != NX_OK)
+			return 1;
+		if (NXputdata(file_id, d) != NX_OK)
+			return 1;
+		NXclosedata(file_id);
+	}
+	NXclosegroup(file_id);
+	NXclose(&file_id);
+	return 0;
+}
+
+static int check_value(NXhandle handle, int d, int i)
+{
+	int32_t value;
+	int64_t start[1], size[1] = { 1 };
+	char path[64];
+
+	sprintf(path, "/entry1/data%d", d);
+	start[0] = i;
+	if (NXopenpath(handle, path) != NX_OK ||
+	    NXgetslab64(handle, &value, start, size) != NX_OK) {
+		fprintf(stderr, "reading %s failed\n", path);
+		return 1;
+	}
+	if (value != value_at(d, i)) {
+		fprintf(stderr, "%s[%d] is %d, expected %d\n", path, i,
+			(int)value, (int)value_at(d, i));
+		return 1;
+	}
+	return 0;
+}
+
+static int test_reopen(int file_type, const char *filename)
+{
+	NXhandle handles[NHANDLE];
+	char path[256];
+	clock_t tim;
+	int i;
+
+	if (write_file(file_type, filename) != 0) {
+		fprintf(stderr, "Failed to write %s\n", filename);
+		return 1;
+	}
+
+	tim = clock();
+	for (i = 0; i < NHANDLE; i++) {
+		if (NXopen(filename, NXACC_READ, &handles[i]) != NX_OK)
+			return 1;
+	}
+	printf("  %d x NXopen: %.3f s\n", NHANDLE,
+	       (double)(clock() - tim) / CLOCKS_PER_SEC);
+	for (i = 0; i < NHANDLE; i++)
+		NXclose(&handles[i]);
+
+	tim = clock();
+	if (NXopen(filename, NXACC_READ, &handles[0]) != NX_OK)
+		return 1;
+	for (i = 1; i < NHANDLE; i++) {
+		if (NXreopen(handles[0], &handles[i]) != NX_OK) {
+			fprintf(stderr, "NXreopen failed\n");
+			return 1;
+		}
+	}
+	printf("  NXopen + %d x NXreopen: %.3f s\n", NHANDLE - 1,
+	       (double)(clock() - tim) / CLOCKS_PER_SEC);
+
+	/* every handle navigates on its own */
+	for (i = 0; i < NHANDLE; i++) {
+		if (check_value(handles[i], i, i * 7) != 0)
+			return 1;
+	}
+	for (i = 0; i < NHANDLE; i++) {
+		if (NXgetpath(handles[i], path, sizeof(path)) != NX_OK)
+			return 1;
+		if (strncmp(path, "/entry1/data", 12) != 0
+		    || atoi(path + 12) != i) {
+			fprintf(stderr, "handle %d ended up at %s\n", i, path);
+			return 1;
+		}
+	}
+
+	/* the others keep working when the original is closed first */
+	NXclose(&handles[0]);
+	for (i = 1; i < NHANDLE; i++) {
+		NXclosedata(handles[i]);
+		if (check_value(handles[i], NDATA - 1, NPOINT - 1) != 0)
+			return 1;
+		NXclose(&handles[i]);
+	}
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	int ret = 0;
+#ifdef WITH_MXML
+	printf("Testing XML\n");
+	ret |= test_reopen(NXACC_CREATEXML, "test_reopen.xml");
+#endif
+
+#ifdef WITH_HDF5
+	printf("Testing HDF5\n");
+	ret |= test_reopen(NXACC_CREATE5, "test_reopen.nx5");
+#endif
+	return ret;
+}
@@ -0,0 +1,291 @@
+/*---------------------------------------------------------------------------
+  NeXus - Neutron & X-ray Common Data Format
+
+  Test and benchmark for files opened with NXACC_SNAPSHOT, answering
+  navigation and attribute calls from memory
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  For further information, see <http://www.nexusformat.org>
+
+----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "napi.h"
+#include "napiconfig.h"
+#include "nxbench.h"
+
+#define NGROUP 200		/* groups timed with --benchmark */
+#define NDATA 20
+#define NREPEAT 5
+
+static int ngroup = 20;
+
+static int write_file(int file_type, const char *filename)
+{
+	int64_t dims[2] = { 4, 3 };
+	int32_t values[12], one = 1;
+	float offsets[3] = { 0.5f, 1.5f, 2.5f };
+	int adims[1] = { 3 };
+	char name[64];
+	int i, j;
+	NXhandle file_id = NULL;
+
+	for (i = 0; i < 12; i++)
+		values[i] = i * i;
+	remove(filename);
+	if (NXopen(filename, file_type, &file_id) != NX_OK)
+		return 1;
+	if (NXputattr(file_id, "creator", "test_nxsnapshot", 15, NX_CHAR)
+	    != NX_OK
+	    || NXmakegroup(file_id, "entry1", "NXentry") != NX_OK
+	    || NXopengroup(file_id, "entry1", "NXentry") != NX_OK
+	    || NXputattr(file_id, "title", "snapshot", 8, NX_CHAR) != NX_OK)
+		return 1;
+	for (i = 0; i < ngroup; i++) {
+		sprintf(name, "data%d", i);
+		if (NXmakegroup(file_id, name, "NXdata") != NX_OK
+		    || NXopengroup(file_id, name, "NXdata") != NX_OK)
+			return 1;
+		for (j = 0; j < NDATA; j++) {
+			sprintf(name, "d%d", j);
+			values[0] = i * 1000 + j;
+			if (NXmakedata64(file_id, name, NX_INT32, 2, dims) != NX_OK
+			    || NXopendata(file_id, name) != NX_OK
+			    || NXputdata(file_id, values) != NX_OK
+			    || NXputattr(file_id, "units", "counts", 6,
+					 NX_CHAR) != NX_OK)
+				return 1;
+			if (j == 0
+			    && (NXputattr(file_id, "signal", &one, 1, NX_INT32)
+				!= NX_OK
+				|| NXputattra(file_id, "offsets", offsets, 1,
+					      adims, NX_FLOAT32) != NX_OK))
+				return 1;
+			NXclosedata(file_id);
+		}
+		NXclosegroup(file_id);
+	}
+	NXclosegroup(file_id);
+	NXclose(&file_id);
+	return 0;
+}
+
+/* what a reader does first: list every group and every attribute */
+static int browse(NXhandle file_id, int *nattr)
+{
+	NXname name, nxclass, group, gclass, aname;
+	char path[128], units[32];
+	int i, n, type, rank, len, dim[NX_MAXRANK];
+	int64_t dims[NX_MAXRANK];
+
+	*nattr = 0;
+	for (i = 0; i < ngroup; i++) {
+		sprintf(path, "/entry1/data%d", i);
+		if (NXopenpath(file_id, path) != NX_OK
+		    || NXgetgroupinfo(file_id, &n, group, gclass) != NX_OK
+		    || n != NDATA || strcmp(gclass, "NXdata") != 0)
+			return 1;
+		NXinitgroupdir(file_id);
+		while (NXgetnextentry(file_id, name, nxclass, &type) == NX_OK) {
+			if (strcmp(nxclass, "SDS") != 0
+			    || NXopendata(file_id, name) != NX_OK
+			    || NXgetinfo64(file_id, &rank, dims, &type) != NX_OK
+			    || rank != 2 || dims[0] != 4 || type != NX_INT32)
+				return 1;
+			len = sizeof(units);
+			type = NX_CHAR;
+			if (NXgetattr(file_id, "units", units, &len, &type)
+			    != NX_OK || strcmp(units, "counts") != 0)
+				return 1;
+			NXinitattrdir(file_id);
+			while (NXgetnextattra(file_id, aname, &rank, dim, &type)
+			       == NX_OK)
+				(*nattr)++;
+			NXclosedata(file_id);
+		}
+	}
+	return 0;
+}
+
+static int compare(const char *filename)
+{
+	NXhandle plain = NULL, snap = NULL;
+	NXname name, nxclass, aname;
+	int32_t values[12], signal;
+	float offsets[3];
+	double dsignal;
+	char title[64], path[NX_MAXPATHLEN];
+	int64_t start[2] = { 1, 0 }, size[2] = { 2, 3 };
+	int len, type, rank, dim[NX_MAXRANK], n, nattr[2];
+	NXlink a, b;
+
+	if (NXopen(filename, NXACC_READ, &plain) != NX_OK
+	    || NXopen(filename, NXACC_READ | NXACC_SNAPSHOT, &snap) != NX_OK)
+		return 1;
+
+	/* the same listing and attributes either way */
+	if (browse(plain, &nattr[0]) != 0 || browse(snap, &nattr[1]) != 0) {
+		fprintf(stderr, "browsing failed\n");
+		return 1;
+	}
+	if (nattr[0] != nattr[1] || nattr[1] != ngroup * (NDATA + 2)) {
+		fprintf(stderr, "%d attributes, %d in the snapshot\n",
+			nattr[0], nattr[1]);
+		return 1;
+	}
+
+	/* the root, and its attributes */
+	NXopenpath(snap, "/");
+	if (NXgetgroupinfo(snap, &n, name, nxclass) != NX_OK
+	    || strcmp(name, "root") != 0 || strcmp(nxclass, "NXroot") != 0)
+		return 1;
+	len = sizeof(title);
+	type = NX_CHAR;
+	if (NXgetattr(snap, "creator", title, &len, &type) != NX_OK
+	    || strcmp(title, "test_nxsnapshot") != 0)
+		return 1;
+
+	/* attributes of groups and datasets, converted as HDF5 does */
+	if (NXopenpath(snap, "/entry1") != NX_OK)
+		return 1;
+	len = sizeof(title);
+	type = NX_CHAR;
+	if (NXgetattr(snap, "title", title, &len, &type) != NX_OK
+	    || strcmp(title, "snapshot") != 0 || len != 8)
+		return 1;
+	if (NXopenpath(snap, "/entry1/data7/d0") != NX_OK)
+		return 1;
+	len = 1;
+	type = NX_FLOAT64;
+	if (NXgetattr(snap, "signal", &dsignal, &len, &type) != NX_OK
+	    || dsignal != 1.0)
+		return 1;
+	/* a number is not read as text */
+	len = sizeof(title);
+	type = NX_CHAR;
+	if (NXgetattr(snap, "signal", title, &len, &type) == NX_OK) {
+		fprintf(stderr, "numeric attribute read as text\n");
+		return 1;
+	}
+	strcpy(aname, "offsets");
+	if (NXgetattrainfo(snap, aname, &rank, dim, &type) != NX_OK
+	    || rank != 1 || dim[0] != 3 || type != NX_FLOAT32
+	    || NXgetattra(snap, "offsets", offsets) != NX_OK
+	    || offsets[2] != 2.5f)
+		return 1;
+	len = 1;
+	type = NX_INT32;
+	if (NXgetattr(snap, "missing", &signal, &len, &type) == NX_OK
+	    || NXopengroup(snap, "data0", "NXdata") == NX_OK)
+		return 1;
+
+	/* data is read from the file, wherever the snapshot is */
+	if (NXgetdata(snap, values) != NX_OK || values[0] != 7000
+	    || values[11] != 121) {
+		fprintf(stderr, "/entry1/data7/d0 read wrongly\n");
+		return 1;
+	}
+	NXclosedata(snap);
+	NXclosegroup(snap);
+	if (NXopenpath(snap, "/entry1/data15/d12") != NX_OK
+	    || NXgetslab64(snap, values, start, size) != NX_OK
+	    || values[0] != 9 || values[5] != 64)
+		return 1;
+	if (NXgetpath(snap, path, sizeof(path)) != NX_OK
+	    || strcmp(path, "/entry1/data15/d12") != 0)
+		return 1;
+	if (NXopenpath(snap, "/entry1/data3/d1") != NX_OK
+	    || NXgetdata(snap, values) != NX_OK || values[0] != 3001)
+		return 1;
+
+	/* links are those of the file */
+	if (NXgetdataID(snap, &a) != NX_OK
+	    || NXopenpath(plain, "/entry1/data3/d1") != NX_OK
+	    || NXgetdataID(plain, &b) != NX_OK
+	    || strcmp(a.targetPath, b.targetPath) != 0)
+		return 1;
+
+	/* nothing is written */
+	if (NXputattr(snap, "units", "other", 5, NX_CHAR) == NX_OK
+	    || NXclosedata(snap) != NX_OK
+	    || NXmakegroup(snap, "extra", "NXnote") == NX_OK) {
+		fprintf(stderr, "a snapshot was written to\n");
+		return 1;
+	}
+
+	NXclose(&plain);
+	NXclose(&snap);
+
+	/* and only reading takes a snapshot */
+	if (NXopen(filename, NXACC_RDWR | NXACC_SNAPSHOT, &snap) == NX_OK)
+		return 1;
+	return 0;
+}
+
+static int benchmark(const char *filename)
+{
+	static const int modes[2] = { NXACC_READ, NXACC_READ | NXACC_SNAPSHOT };
+	static const char *title[2] = { "plain", "snapshot" };
+	NXhandle file_id = NULL;
+	double tim;
+	int i, r, nattr;
+
+	for (i = 0; i < 2; i++) {
+		tim = nxbench_now();
+		if (NXopen(filename, modes[i], &file_id) != NX_OK)
+			return 1;
+		for (r = 0; r < NREPEAT; r++) {
+			if (browse(file_id, &nattr) != 0)
+				return 1;
+		}
+		NXclose(&file_id);
+		printf("  open and browse %d x %d datasets, %-8s %.3f s\n",
+		       NREPEAT, ngroup * NDATA, title[i], nxbench_now() - tim);
+	}
+	return 0;
+}
+
+static int test_snapshot(int file_type, const char *filename)
+{
+	if (write_file(file_type, filename) != 0) {
+		fprintf(stderr, "Failed to write %s\n", filename);
+		return 1;
+	}
+	if (compare(filename) != 0) {
+		fprintf(stderr, "%s differs in the snapshot\n", filename);
+		return 1;
+	}
+	return nxbench ? benchmark(filename) : 0;
+}
+
+int main(int argc, char *argv[])
+{
+	int ret = 0;
+
+	if (nxbench_init(argc, argv))
+		ngroup = NGROUP;
+#ifdef WITH_MXML
+	printf("Testing XML\n");
+	ret |= test_snapshot(NXACC_CREATEXML, "test_snapshot.xml");
+#endif
+
+#ifdef WITH_HDF5
+	printf("Testing HDF5\n");
+	ret |= test_snapshot(NXACC_CREATE5, "test_snapshot.nx5");
+#endif
+	return ret;
+}
@@ -0,0 +1,251 @@
+/*---------------------------------------------------------------------------
+  NeXus - Neutron & X-ray Common Data Format
+
+  Test and benchmark for reading string arrays with NXgetstrings, on a log
+  of many variable length messages
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  For further information, see <http://www.nexusformat.org>
+
+----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "napi.h"
+#include "napiconfig.h"
+#include "nxbench.h"
+#ifdef WITH_HDF5
+#include <hdf5.h>
+#endif
+
+#define NMESSAGE 20000
+#define NROW 6
+#define WIDTH 12
+
+/* message i, of a length between 0 and 60 */
+static void message(char *text, int i)
+{
+	int len = (i * 7) % 61, j;
+
+	for (j = 0; j < len; j++)
+		text[j] = (char)('a' + (i + j) % 26);
+	text[len] = '\0';
+}
+
+static int check_strings(int64_t count, const int64_t offsets[],
+			 const char *buffer, int64_t expected,
+			 void (*make) (char *, int))
+{
+	char text[128];
+	int64_t i;
+
+	if (count != expected) {
+		fprintf(stderr, "read %d strings instead of %d\n", (int)count,
+			(int)expected);
+		return 1;
+	}
+	for (i = 0; i < count; i++) {
+		make(text, (int)i);
+		if (strcmp(buffer + offsets[i], text) != 0
+		    || offsets[i + 1] - offsets[i] - 1 != (int64_t) strlen(text)) {
+			fprintf(stderr, "string %d is \"%s\", expected \"%s\"\n",
+				(int)i, buffer + offsets[i], text);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/* row i of the character array */
+static void row(char *text, int i)
+{
+	sprintf(text, "row %d", i * i);
+}
+
+/* rows of a two dimensional NX_CHAR dataset, shorter than its width */
+static int test_rows(int file_type, const char *filename)
+{
+	char rows[NROW][WIDTH];
+	int64_t dims[2] = { NROW, WIDTH }, count, *offsets;
+	char *buffer;
+	int i;
+	NXhandle file_id = NULL;
+
+	memset(rows, 0, sizeof(rows));
+	for (i = 0; i < NROW; i++)
+		row(rows[i], i);
+	remove(filename);
+	if (NXopen(filename, file_type, &file_id) != NX_OK)
+		return 1;
+	if (NXmakegroup(file_id, "entry1", "NXentry") != NX_OK
+	    || NXopengroup(file_id, "entry1", "NXentry") != NX_OK
+	    || NXmakedata64(file_id, "rows", NX_CHAR, 2, dims) != NX_OK
+	    || NXopendata(file_id, "rows") != NX_OK
+	    || NXputdata(file_id, rows) != NX_OK)
+		return 1;
+	NXclosedata(file_id);
+	NXclosegroup(file_id);
+	NXclose(&file_id);
+
+	if (NXopen(filename, NXACC_READ, &file_id) != NX_OK
+	    || NXopenpath(file_id, "/entry1/rows") != NX_OK)
+		return 1;
+	if (NXgetstrings(file_id, &count, &offsets, &buffer) != NX_OK)
+		return 1;
+	if (check_strings(count, offsets, buffer, NROW, row) != 0)
+		return 1;
+	NXfree((void **)&offsets);
+	NXfree((void **)&buffer);
+	NXclose(&file_id);
+	return 0;
+}
+
+#ifdef WITH_HDF5
+/* NeXus writes no variable length strings, so HDF5 is used directly */
+static int write_messages(const char *filename)
+{
+	static char text[NMESSAGE][64];
+	static char *messages[NMESSAGE];
+	const char *two_d[2][3] = { {"a", "bb", ""}, {"dddd", "eeeee", "f"} };
+	const char *single = "a single message";
+	hsize_t dims[1] = { NMESSAGE }, dims2[2] = { 2, 3 };
+	hid_t fid, gid, type, space, dset;
+	int i;
+
+	for (i = 0; i < NMESSAGE; i++) {
+		message(text[i], i);
+		messages[i] = text[i];
+	}
+	fid = H5Fcreate(filename, H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+	if (fid < 0)
+		return 1;
+	gid = H5Gcreate(fid, "entry1", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+	type = H5Tcopy(H5T_C_S1);
+	H5Tset_size(type, H5T_VARIABLE);
+
+	space = H5Screate_simple(1, dims, NULL);
+	dset = H5Dcreate(gid, "messages", type, space, H5P_DEFAULT,
+			 H5P_DEFAULT, H5P_DEFAULT);
+	H5Dwrite(dset, type, H5S_ALL, H5S_ALL, H5P_DEFAULT, messages);
+	H5Dclose(dset);
+	H5Sclose(space);
+
+	space = H5Screate_simple(2, dims2, NULL);
+	dset = H5Dcreate(gid, "table", type, space, H5P_DEFAULT, H5P_DEFAULT,
+			 H5P_DEFAULT);
+	H5Dwrite(dset, type, H5S_ALL, H5S_ALL, H5P_DEFAULT, two_d);
+	H5Dclose(dset);
+	H5Sclose(space);
+
+	space = H5Screate(H5S_SCALAR);
+	dset = H5Dcreate(gid, "single", type, space, H5P_DEFAULT, H5P_DEFAULT,
+			 H5P_DEFAULT);
+	H5Dwrite(dset, type, H5S_ALL, H5S_ALL, H5P_DEFAULT, &single);
+	H5Dclose(dset);
+	H5Sclose(space);
+
+	H5Tclose(type);
+	H5Gclose(gid);
+	H5Fclose(fid);
+	return 0;
+}
+
+static int test_messages(const char *filename)
+{
+	NXhandle file_id = NULL;
+	int64_t count, *offsets, dims[NX_MAXRANK];
+	char *buffer, text[32];
+	int rank, type;
+	double tim;
+
+	if (write_messages(filename) != 0) {
+		fprintf(stderr, "Failed to write %s\n", filename);
+		return 1;
+	}
+	if (NXopen(filename, NXACC_READ, &file_id) != NX_OK
+	    || NXopenpath(file_id, "/entry1/messages") != NX_OK)
+		return 1;
+
+	tim = nxbench_now();
+	if (NXgetstrings(file_id, &count, &offsets, &buffer) != NX_OK)
+		return 1;
+	if (nxbench)
+		printf("  NXgetstrings of %d messages: %.3f s\n", NMESSAGE,
+		       nxbench_now() - tim);
+	if (check_strings(count, offsets, buffer, NMESSAGE, message) != 0)
+		return 1;
+	NXfree((void **)&offsets);
+	NXfree((void **)&buffer);
+	NXclosedata(file_id);
+
+	/* any rank, one string per element */
+	if (NXopenpath(file_id, "/entry1/table") != NX_OK
+	    || NXgetstrings(file_id, &count, &offsets, &buffer) != NX_OK)
+		return 1;
+	if (count != 6 || strcmp(buffer + offsets[1], "bb") != 0
+	    || strcmp(buffer + offsets[2], "") != 0
+	    || strcmp(buffer + offsets[4], "eeeee") != 0) {
+		fprintf(stderr, "table read wrongly\n");
+		return 1;
+	}
+	NXfree((void **)&offsets);
+	NXfree((void **)&buffer);
+	NXclosedata(file_id);
+
+	if (NXopenpath(file_id, "/entry1/single") != NX_OK
+	    || NXgetstrings(file_id, &count, &offsets, &buffer) != NX_OK)
+		return 1;
+	if (count != 1 || strcmp(buffer, "a single message") != 0) {
+		fprintf(stderr, "single read wrongly\n");
+		return 1;
+	}
+	NXfree((void **)&offsets);
+	NXfree((void **)&buffer);
+
+	/* a single string is still measured by NXgetinfo64 for NXgetdata */
+	if (NXgetinfo64(file_id, &rank, dims, &type) != NX_OK
+	    || rank != 1 || dims[0] != 16 || type != NX_CHAR)
+		return 1;
+	memset(text, 0, sizeof(text));
+	if (NXgetdata(file_id, text) != NX_OK
+	    || strcmp(text, "a single message") != 0) {
+		fprintf(stderr, "NXgetdata read single wrongly\n");
+		return 1;
+	}
+	NXclosedata(file_id);
+
+	NXclose(&file_id);
+	return 0;
+}
+#endif
+
+int main(int argc, char *argv[])
+{
+	int ret = 0;
+
+	nxbench_init(argc, argv);
+#ifdef WITH_MXML
+	printf("Testing XML\n");
+	ret |= test_rows(NXACC_CREATEXML, "test_strings.xml");
+#endif
+
+#ifdef WITH_HDF5
+	printf("Testing HDF5\n");
+	ret |= test_rows(NXACC_CREATE5, "test_strings.nx5");
+	ret |= test_messages("test_messages.nx5");
+#endif
+	return ret;
+}
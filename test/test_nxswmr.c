@@ -0,0 +1,229 @@
+/*---------------------------------------------------------------------------
+  NeXus - Neutron & X-ray Common Data Format
+
+  Test for SWMR access, a reader process following a writer process
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  For further information, see <http://www.nexusformat.org>
+
+----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifndef _WIN32
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+#include "napi.h"
+#include "napiconfig.h"
+
+#define NROW 200
+#define NCOL 8
+#define TIMEOUT 30
+
+static const char *filename = "test_swmr.nx5";
+
+static int32_t value_at(int64_t row, int64_t col)
+{
+	return (int32_t) (row * NCOL + col);
+}
+
+#if defined(WITH_HDF5) && !defined(_WIN32)
+/*
+ * follows the dataset until it holds last rows, all with the right values;
+ * ready is signalled when the file is open, go waited for before that
+ */
+static int reader(int go, int ready, int64_t last)
+{
+	NXhandle file_id = NULL;
+	int32_t row[NCOL];
+	int64_t dims[2], start[2] = { 0, 0 }, size[2] = { 1, NCOL };
+	int64_t seen = 0, opened_at, k;
+	int rank, type, grew = 0;
+	time_t deadline;
+	char c;
+
+	if (read(go, &c, 1) != 1)
+		return 1;
+	if (NXopen(filename, NXACC_READ | NXACC_SWMR_READ, &file_id) != NX_OK)
+		return 1;
+	if (NXopenpath(file_id, "/entry1/counts") != NX_OK)
+		return 1;
+	if (NXgetinfo64(file_id, &rank, dims, &type) != NX_OK)
+		return 1;
+	opened_at = dims[0];
+	if (write(ready, &c, 1) != 1)
+		return 1;
+
+	deadline = time(NULL) + TIMEOUT;
+	while (seen < last) {
+		if (time(NULL) > deadline) {
+			fprintf(stderr, "reader timed out at row %d, %d rows "
+				"in the dataset\n", (int)seen, (int)dims[0]);
+			return 1;
+		}
+		if (NXrefresh(file_id) != NX_OK
+		    || NXgetinfo64(file_id, &rank, dims, &type) != NX_OK) {
+			fprintf(stderr, "NXrefresh failed\n");
+			return 1;
+		}
+		if (dims[0] > opened_at)
+			grew = 1;
+		/*
+		 * the extent can be ahead of the data until the writer
+		 * flushed; such rows read as fill values and are tried again
+		 */
+		for (; seen < dims[0]; seen++) {
+			start[0] = seen;
+			if (NXgetslab64(file_id, row, start, size) != NX_OK)
+				return 1;
+			for (k = 0; k < NCOL; k++) {
+				if (row[k] != value_at(seen, k))
+					break;
+			}
+			if (k < NCOL)
+				break;
+		}
+		usleep(500);
+	}
+	if (!grew) {
+		fprintf(stderr, "reader never saw the dataset grow\n");
+		return 1;
+	}
+	NXclosedata(file_id);
+	NXclose(&file_id);
+	return 0;
+}
+
+/*
+ * appends rows first ... first + NROW - 1 while a reader process follows;
+ * the file is created when first is 0 and reopened otherwise
+ */
+static int writer_reader_pair(int64_t first)
+{
+	NXhandle file_id = NULL;
+	int32_t row[NCOL];
+	int64_t dims[2] = { NX_UNLIMITED, NCOL };
+	int64_t start[2] = { 0, 0 }, size[2] = { 1, NCOL };
+	int64_t r, k;
+	int go[2], ready[2], status, ret = 0;
+	pid_t pid;
+	char c = 'x';
+
+	/* fork before HDF5 is touched, the reader gets a library of its own */
+	if (pipe(go) != 0 || pipe(ready) != 0)
+		return 1;
+	pid = fork();
+	if (pid < 0)
+		return 1;
+	if (pid == 0) {
+		_exit(reader(go[0], ready[1], first + NROW));
+	}
+
+	if (first == 0) {
+		remove(filename);
+		if (NXopen(filename, NXACC_CREATE5 | NXACC_SWMR_WRITE,
+			   &file_id) != NX_OK)
+			ret = 1;
+		if (ret == 0
+		    && (NXmakegroup(file_id, "entry1", "NXentry") != NX_OK
+			|| NXopengroup(file_id, "entry1", "NXentry") != NX_OK
+			|| NXmakedata64(file_id, "counts", NX_INT32, 2,
+					dims) != NX_OK
+			|| NXopendata(file_id, "counts") != NX_OK))
+			ret = 1;
+		/* the layout is complete, from now on only data is written */
+		if (ret == 0 && NXstartswmr(file_id) != NX_OK)
+			ret = 1;
+	} else {
+		if (NXopen(filename, NXACC_RDWR | NXACC_SWMR_WRITE,
+			   &file_id) != NX_OK
+		    || NXopenpath(file_id, "/entry1/counts") != NX_OK)
+			ret = 1;
+	}
+
+	/* let the reader open the file, then start appending */
+	if (write(go[1], &c, 1) != 1)
+		ret = 1;
+	if (ret == 0 && read(ready[0], &c, 1) != 1)
+		ret = 1;
+	for (r = first; ret == 0 && r < first + NROW; r++) {
+		for (k = 0; k < NCOL; k++)
+			row[k] = value_at(r, k);
+		start[0] = r;
+		if (NXputslab64(file_id, row, start, size) != NX_OK
+		    || NXflush(&file_id) != NX_OK) {
+			fprintf(stderr, "appending row %d failed\n", (int)r);
+			ret = 1;
+		}
+		usleep(1000);
+	}
+	if (file_id != NULL) {
+		NXclosedata(file_id);
+		NXclose(&file_id);
+	}
+
+	close(go[1]);
+	close(ready[0]);
+	if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status)
+	    || WEXITSTATUS(status) != 0) {
+		fprintf(stderr, "reader process failed\n");
+		ret = 1;
+	}
+	close(go[0]);
+	close(ready[1]);
+	return ret;
+}
+
+static int test_swmr(void)
+{
+	NXhandle file_id = NULL;
+	int ret;
+
+	printf("  writer creating the file\n");
+	ret = writer_reader_pair(0);
+	printf("  writer reopening the file\n");
+	ret |= writer_reader_pair(NROW);
+	if (ret != 0)
+		return ret;
+
+	/* wrong combinations and calls are refused */
+	if (NXopen(filename, NXACC_READ | NXACC_SWMR_WRITE, &file_id) == NX_OK) {
+		fprintf(stderr, "NXopen accepted SWMR writing read only\n");
+		return 1;
+	}
+	if (NXopen(filename, NXACC_READ | NXACC_SWMR_READ, &file_id) != NX_OK)
+		return 1;
+	if (NXrefresh(file_id) == NX_OK) {
+		fprintf(stderr, "NXrefresh accepted no open dataset\n");
+		return 1;
+	}
+	NXclose(&file_id);
+	return 0;
+}
+#endif
+
+int main(int argc, char *argv[])
+{
+	int ret = 0;
+#if defined(WITH_HDF5) && !defined(_WIN32)
+	printf("Testing HDF5\n");
+	ret |= test_swmr();
+#endif
+	return ret;
+}
@@ -0,0 +1,260 @@
+/*---------------------------------------------------------------------------
+  NeXus - Neutron & X-ray Common Data Format
+
+  Test for the indexed NXU search functions
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  For further information, see <http://www.nexusformat.org>
+
+----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "napi.h"
+#include "napiu.h"
+#include "napiconfig.h"
+
+#define NY 4
+#define NX 6
+#define NLOOKUP 10000
+
+static int write_data(NXhandle file_id, const char *name, int rank,
+		      int dims[], const char *attr, int value)
+{
+	static float data[NY * NX];
+
+	if (NXmakedata(file_id, name, NX_FLOAT32, rank, dims) != NX_OK)
+		return 1;
+	if (NXopendata(file_id, name) != NX_OK)
+		return 1;
+	if (NXputdata(file_id, data) != NX_OK)
+		return 1;
+	if (attr != NULL &&
+	    NXputattr(file_id, attr, &value, 1, NX_INT32) != NX_OK)
+		return 1;
+	return NXclosedata(file_id) != NX_OK;
+}
+
+static int write_file(int file_type, const char *filename)
+{
+	int dims[2] = { NY, NX }, one = 1, two = 2;
+	NXhandle file_id = NULL;
+	NXlink link;
+
+	remove(filename);
+	if (NXopen(filename, file_type, &file_id) != NX_OK)
+		return 1;
+	if (NXUwritegroup(file_id, "entry", "NXentry") != NX_OK)
+		return 1;
+	if (NXUwritegroup(file_id, "monitor", "NXmonitor") != NX_OK)
+		return 1;
+	if (NXclosegroup(file_id) != NX_OK)
+		return 1;
+
+	/* old style: signal, axes, axis and primary on the data items */
+	if (NXUwritegroup(file_id, "data", "NXdata") != NX_OK)
+		return 1;
+	if (write_data(file_id, "counts", 2, dims, "signal", 1) != 0)
+		return 1;
+	if (NXopendata(file_id, "counts") != NX_OK ||
+	    NXputattr(file_id, "axes", "[y,x]", 5, NX_CHAR) != NX_OK ||
+	    NXgetdataID(file_id, &link) != NX_OK ||
+	    NXclosedata(file_id) != NX_OK)
+		return 1;
+	if (write_data(file_id, "y", 1, &dims[0], "axis", 1) != 0 ||
+	    write_data(file_id, "x", 1, &dims[1], "axis", 2) != 0 ||
+	    write_data(file_id, "x2", 1, &dims[1], "axis", 2) != 0 ||
+	    write_data(file_id, "errors", 2, dims, "signal", 2) != 0)
+		return 1;
+	if (NXopendata(file_id, "x2") != NX_OK ||
+	    NXputattr(file_id, "primary", &two, 1, NX_INT32) != NX_OK ||
+	    NXclosedata(file_id) != NX_OK)
+		return 1;
+	if (NXclosegroup(file_id) != NX_OK)
+		return 1;
+
+	/* NeXus 2014 style: the group names signal and axes */
+	if (NXUwritegroup(file_id, "data2", "NXdata") != NX_OK)
+		return 1;
+	if (NXputattr(file_id, "signal", "I", 1, NX_CHAR) != NX_OK ||
+	    NXputattr(file_id, "axes", "q", 1, NX_CHAR) != NX_OK)
+		return 1;
+	if (write_data(file_id, "q", 1, &dims[1], NULL, 0) != 0 ||
+	    write_data(file_id, "I", 1, &dims[1], NULL, 0) != 0)
+		return 1;
+	if (NXclosegroup(file_id) != NX_OK)
+		return 1;
+
+	/* counts linked into the monitor */
+	if (NXopengroup(file_id, "monitor", "NXmonitor") != NX_OK ||
+	    NXmakelink(file_id, &link) != NX_OK ||
+	    write_data(file_id, "mode", 1, &one, NULL, 0) != 0 ||
+	    NXclosegroup(file_id) != NX_OK)
+		return 1;
+	NXclosegroup(file_id);
+	NXclose(&file_id);
+	return 0;
+}
+
+static int test_find(int file_type, const char *filename)
+{
+	NXhandle file_id = NULL;
+	NXname name, nxclass;
+	NXlink group_id;
+	int rank, type, dims[NX_MAXRANK], i;
+	char path[NX_MAXPATHLEN];
+	clock_t tim;
+
+	if (write_file(file_type, filename) != 0) {
+		fprintf(stderr, "Failed to write %s\n", filename);
+		return 1;
+	}
+	if (NXopen(filename, NXACC_RDWR, &file_id) != NX_OK)
+		return 1;
+	if (NXopengroup(file_id, "entry", "NXentry") != NX_OK)
+		return 1;
+
+	if (NXUfindclass(file_id, "NXdata", name, 1) != NX_OK ||
+	    NXUfindclass(file_id, "NXdata", nxclass, 2) != NX_OK ||
+	    NXUfindclass(file_id, "NXdata", nxclass, 3) != NX_EOD ||
+	    NXUfindclass(file_id, "NXsample", nxclass, 1) != NX_EOD) {
+		fprintf(stderr, "NXUfindclass failed\n");
+		return 1;
+	}
+	if (NXUfindgroup(file_id, "monitor", nxclass) != NX_OK ||
+	    strcmp(nxclass, "NXmonitor") != 0 ||
+	    NXUfindgroup(file_id, "nothere", nxclass) != NX_EOD) {
+		fprintf(stderr, "NXUfindgroup failed\n");
+		return 1;
+	}
+
+	/* "find the first NXdata signal in entry" */
+	if (NXopengroup(file_id, "data", "NXdata") != NX_OK)
+		return 1;
+	tim = clock();
+	for (i = 0; i < NLOOKUP; i++) {
+		if (NXUfindsignal(file_id, 1, name, &rank, &type, dims) !=
+		    NX_OK) {
+			fprintf(stderr, "NXUfindsignal failed\n");
+			return 1;
+		}
+	}
+	printf("  %d x NXUfindsignal: %.3f s\n", NLOOKUP,
+	       (double)(clock() - tim) / CLOCKS_PER_SEC);
+	if (strcmp(name, "counts") != 0 || rank != 2 || type != NX_FLOAT32
+	    || dims[0] != NY || dims[1] != NX) {
+		fprintf(stderr, "NXUfindsignal found the wrong data\n");
+		return 1;
+	}
+	if (NXUfindsignal(file_id, 2, name, &rank, &type, dims) != NX_OK ||
+	    strcmp(name, "errors") != 0) {
+		fprintf(stderr, "NXUfindsignal 2 failed\n");
+		return 1;
+	}
+	if (NXUfindsignal(file_id, 3, name, &rank, &type, dims) != NX_EOD) {
+		fprintf(stderr, "NXUfindsignal 3 found\n");
+		return 1;
+	}
+	if (NXUfinddata(file_id, "x") != NX_OK ||
+	    NXUfinddata(file_id, "z") != NX_EOD) {
+		fprintf(stderr, "NXUfinddata failed\n");
+		return 1;
+	}
+	/* axes in C order */
+	if (NXUfindaxis(file_id, 1, 1, name, &rank, &type, dims) != NX_OK ||
+	    strcmp(name, "y") != 0 || dims[0] != NY ||
+	    NXUfindaxis(file_id, 2, 1, name, &rank, &type, dims) != NX_OK ||
+	    strcmp(name, "x") != 0 || dims[0] != NX) {
+		fprintf(stderr, "NXUfindaxis failed\n");
+		return 1;
+	}
+	if (NXUfindaxis(file_id, 3, 1, name, &rank, &type, dims) != NX_ERROR) {
+		fprintf(stderr, "NXUfindaxis beyond the rank not refused\n");
+		return 1;
+	}
+
+	/* the index follows changes made through the handle */
+	if (NXUfinddata(file_id, "late") != NX_EOD ||
+	    write_data(file_id, "late", 1, dims, NULL, 0) != 0 ||
+	    NXUfinddata(file_id, "late") != NX_OK) {
+		fprintf(stderr, "NXUfinddata missed a new data item\n");
+		return 1;
+	}
+
+	/* find where counts is linked to, and come back */
+	if (NXopendata(file_id, "counts") != NX_OK ||
+	    NXUfindattr(file_id, "signal") != NX_OK ||
+	    NXUfindattr(file_id, "units") != NX_EOD) {
+		fprintf(stderr, "NXUfindattr failed\n");
+		return 1;
+	}
+	if (NXUfindlink(file_id, &group_id, "NXmonitor") != NX_OK) {
+		fprintf(stderr, "NXUfindlink failed\n");
+		return 1;
+	}
+	memset(path, 0, sizeof(path));
+	NXgetpath(file_id, path, sizeof(path));
+	if (strcmp(path, "/entry/monitor/counts") != 0) {
+		fprintf(stderr, "NXUfindlink went to %s\n", path);
+		return 1;
+	}
+	if (NXUresumelink(file_id, group_id) != NX_OK) {
+		fprintf(stderr, "NXUresumelink failed\n");
+		return 1;
+	}
+	memset(path, 0, sizeof(path));
+	NXgetpath(file_id, path, sizeof(path));
+	if (strcmp(path, "/entry/data") != 0) {
+		fprintf(stderr, "NXUresumelink went to %s\n", path);
+		return 1;
+	}
+	NXclosegroup(file_id);
+
+	if (NXopengroup(file_id, "data2", "NXdata") != NX_OK)
+		return 1;
+	if (NXUfindsignal(file_id, 1, name, &rank, &type, dims) != NX_OK ||
+	    strcmp(name, "I") != 0 ||
+	    NXUfindaxis(file_id, 1, 1, name, &rank, &type, dims) != NX_OK ||
+	    strcmp(name, "q") != 0) {
+		fprintf(stderr, "group signal and axes attributes not used\n");
+		return 1;
+	}
+	NXclosegroup(file_id);
+	NXclosegroup(file_id);
+	NXclose(&file_id);
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	int ret = 0;
+#ifdef WITH_HDF4
+	printf("Testing HDF4\n");
+	ret |= test_find(NXACC_CREATE4, "test_nxuindex.nx4");
+#endif
+
+#ifdef WITH_MXML
+	printf("Testing XML\n");
+	ret |= test_find(NXACC_CREATEXML, "test_nxuindex.xml");
+#endif
+
+#ifdef WITH_HDF5
+	printf("Testing HDF5\n");
+	ret |= test_find(NXACC_CREATE5, "test_nxuindex.nx5");
+#endif
+	return ret;
+}
@@ -0,0 +1,249 @@
+/*---------------------------------------------------------------------------
+  NeXus - Neutron & X-ray Common Data Format
+
+  Test for virtual datasets, stitching the frames of detector modules
+  written to one file each
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  For further information, see <http://www.nexusformat.org>
+
+----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "napi.h"
+#include "napiconfig.h"
+
+#define NMOD 4
+#define NY 16
+#define NX 32
+
+static const char *filename = "test_virtual.nx5";
+
+static int32_t value_at(int m, int y, int x)
+{
+	return (int32_t) ((m * NY + y) * NX + x + 1);
+}
+
+static void module_name(char *name, int m)
+{
+	sprintf(name, "test_virtual_mod%d.nx5", m);
+}
+
+/* one module, one frame */
+static int write_module(int m)
+{
+	static int32_t frame[NY][NX];
+	int64_t dims[2] = { NY, NX };
+	char name[64];
+	int y, x;
+	NXhandle file_id = NULL;
+
+	for (y = 0; y < NY; y++)
+		for (x = 0; x < NX; x++)
+			frame[y][x] = value_at(m, y, x);
+	module_name(name, m);
+	remove(name);
+	if (NXopen(name, NXACC_CREATE5, &file_id) != NX_OK)
+		return 1;
+	if (NXmakegroup(file_id, "entry1", "NXentry") != NX_OK
+	    || NXopengroup(file_id, "entry1", "NXentry") != NX_OK
+	    || NXmakedata64(file_id, "frame", NX_INT32, 2, dims) != NX_OK
+	    || NXopendata(file_id, "frame") != NX_OK
+	    || NXputdata(file_id, frame) != NX_OK)
+		return 1;
+	NXclosedata(file_id);
+	NXclosegroup(file_id);
+	NXclose(&file_id);
+	return 0;
+}
+
+static int write_file(void)
+{
+	NXvirtualsource source[NMOD];
+	int64_t stacked[3] = { NMOD + 1, NY, NX }, tiled[2] = { NY, NMOD * NX };
+	int64_t local[1] = { 2 * NY * NX };
+	char names[NMOD][64];
+	int m;
+	NXhandle file_id = NULL;
+
+	remove(filename);
+	if (NXopen(filename, NXACC_CREATE5, &file_id) != NX_OK)
+		return 1;
+	if (NXmakegroup(file_id, "entry1", "NXentry") != NX_OK
+	    || NXopengroup(file_id, "entry1", "NXentry") != NX_OK)
+		return 1;
+
+	/* the modules as frames, with room for one more */
+	memset(source, 0, sizeof(source));
+	for (m = 0; m < NMOD; m++) {
+		module_name(names[m], m);
+		source[m].filename = names[m];
+		source[m].path = "/entry1/frame";
+		source[m].start[0] = m;
+		source[m].size[0] = 1;
+		source[m].size[1] = NY;
+		source[m].size[2] = NX;
+	}
+	if (NXmakevirtual64(file_id, "stacked", NX_INT32, 3, stacked, NMOD,
+			    source) != NX_OK)
+		return 1;
+
+	/* the modules side by side */
+	for (m = 0; m < NMOD; m++) {
+		source[m].start[0] = 0;
+		source[m].start[1] = m * NX;
+		source[m].size[0] = NY;
+		source[m].size[1] = NX;
+	}
+	if (NXmakevirtual64(file_id, "tiled", NX_INT32, 2, tiled, NMOD,
+			    source) != NX_OK)
+		return 1;
+
+	/* two frames of this file, flattened */
+	source[0].filename = ".";
+	source[0].path = "/entry1/stacked";
+	source[0].start[0] = 0;
+	source[0].size[0] = 2 * NY * NX;
+	if (NXmakevirtual64(file_id, "flat", NX_INT32, 1, local, 1,
+			    source) != NX_OK)
+		return 1;
+
+	/* wrong requests are refused */
+	if (NXmakevirtual64(file_id, "text", NX_CHAR, 1, local, 1,
+			    source) == NX_OK) {
+		fprintf(stderr, "NXmakevirtual64 accepted NX_CHAR\n");
+		return 1;
+	}
+	source[0].start[0] = 1;
+	if (NXmakevirtual64(file_id, "outside", NX_INT32, 1, local, 1,
+			    source) == NX_OK) {
+		fprintf(stderr, "NXmakevirtual64 accepted a region outside\n");
+		return 1;
+	}
+	NXclosegroup(file_id);
+	NXclose(&file_id);
+	return 0;
+}
+
+static int check_stacked(NXhandle file_id)
+{
+	static int32_t data[NMOD + 1][NY][NX];
+	int64_t dims[NX_MAXRANK];
+	int rank, type, m, y, x;
+
+	if (NXopenpath(file_id, "/entry1/stacked") != NX_OK
+	    || NXgetinfo64(file_id, &rank, dims, &type) != NX_OK)
+		return 1;
+	if (rank != 3 || dims[0] != NMOD + 1 || dims[1] != NY
+	    || dims[2] != NX || type != NX_INT32) {
+		fprintf(stderr, "stacked has the wrong shape\n");
+		return 1;
+	}
+	if (NXgetdata(file_id, data) != NX_OK)
+		return 1;
+	NXclosedata(file_id);
+	for (m = 0; m <= NMOD; m++) {
+		for (y = 0; y < NY; y++) {
+			for (x = 0; x < NX; x++) {
+				if (data[m][y][x] !=
+				    (m < NMOD ? value_at(m, y, x) : 0)) {
+					fprintf(stderr, "stacked[%d][%d][%d] "
+						"is %d\n", m, y, x,
+						(int)data[m][y][x]);
+					return 1;
+				}
+			}
+		}
+	}
+	return 0;
+}
+
+static int check_tiled(NXhandle file_id)
+{
+	static int32_t row[NMOD * NX];
+	int64_t start[2] = { 0, 0 }, size[2] = { 1, NMOD * NX };
+	int y, x;
+
+	if (NXopenpath(file_id, "/entry1/tiled") != NX_OK)
+		return 1;
+	for (y = 0; y < NY; y++) {
+		start[0] = y;
+		if (NXgetslab64(file_id, row, start, size) != NX_OK)
+			return 1;
+		for (x = 0; x < NMOD * NX; x++) {
+			if (row[x] != value_at(x / NX, y, x % NX)) {
+				fprintf(stderr, "tiled[%d][%d] is %d\n", y, x,
+					(int)row[x]);
+				return 1;
+			}
+		}
+	}
+	NXclosedata(file_id);
+	return 0;
+}
+
+static int check_flat(NXhandle file_id)
+{
+	int32_t value;
+	int64_t start[1], size[1] = { 1 };
+
+	if (NXopenpath(file_id, "/entry1/flat") != NX_OK)
+		return 1;
+	start[0] = NY * NX + 3 * NX + 5;
+	if (NXgetslab64(file_id, &value, start, size) != NX_OK)
+		return 1;
+	NXclosedata(file_id);
+	if (value != value_at(1, 3, 5)) {
+		fprintf(stderr, "flat[%d] is %d\n", (int)start[0], (int)value);
+		return 1;
+	}
+	return 0;
+}
+
+static int test_virtual(void)
+{
+	NXhandle file_id = NULL;
+	int m;
+
+	for (m = 0; m < NMOD; m++) {
+		if (write_module(m) != 0) {
+			fprintf(stderr, "Failed to write module %d\n", m);
+			return 1;
+		}
+	}
+	if (write_file() != 0) {
+		fprintf(stderr, "Failed to write %s\n", filename);
+		return 1;
+	}
+	if (NXopen(filename, NXACC_READ, &file_id) != NX_OK)
+		return 1;
+	if (check_stacked(file_id) != 0 || check_tiled(file_id) != 0
+	    || check_flat(file_id) != 0)
+		return 1;
+	NXclose(&file_id);
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	int ret = 0;
+#ifdef WITH_HDF5
+	printf("Testing HDF5\n");
+	ret |= test_virtual();
+#endif
+	return ret;
+}
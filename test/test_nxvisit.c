@@ -0,0 +1,253 @@
+/*---------------------------------------------------------------------------
+  NeXus - Neutron & X-ray Common Data Format
+
+  Test and benchmark for NXvisit, listing a tree of many groups and
+  datasets against a recursive walk with NXgetnextentry
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  For further information, see <http://www.nexusformat.org>
+
+----------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "napi.h"
+#include "napiconfig.h"
+#include "nxbench.h"
+
+#define NDATA 100
+
+typedef struct {
+	int groups;
+	int datasets;
+	int attributes;
+	int stop;		/* stop after this many objects, 0 for never */
+	int errors;
+} counts;
+
+/* ngroup NXdata groups in one NXentry, each with NDATA small datasets */
+static int write_file(int file_type, const char *filename, int ngroup)
+{
+	int64_t dims[2];
+	int32_t one = 1;
+	char name[64];
+	int i, j;
+	NXhandle file_id = NULL;
+
+	remove(filename);
+	if (NXopen(filename, file_type, &file_id) != NX_OK)
+		return 1;
+	if (NXmakegroup(file_id, "entry1", "NXentry") != NX_OK
+	    || NXopengroup(file_id, "entry1", "NXentry") != NX_OK
+	    || NXputattr(file_id, "title", "visit", 5, NX_CHAR) != NX_OK)
+		return 1;
+	for (i = 0; i < ngroup; i++) {
+		sprintf(name, "data%d", i);
+		if (NXmakegroup(file_id, name, "NXdata") != NX_OK
+		    || NXopengroup(file_id, name, "NXdata") != NX_OK)
+			return 1;
+		for (j = 0; j < NDATA; j++) {
+			sprintf(name, "d%d", j);
+			dims[0] = j % 4 + 1;
+			dims[1] = 3;
+			if (NXmakedata64(file_id, name, j % 2 ? NX_FLOAT64 :
+					 NX_INT32, j % 3 ? 1 : 2, dims) != NX_OK)
+				return 1;
+			if (j == 0) {
+				if (NXopendata(file_id, name) != NX_OK
+				    || NXputattr(file_id, "signal", &one, 1,
+						 NX_INT32) != NX_OK
+				    || NXputattr(file_id, "units", "counts",
+						 6, NX_CHAR) != NX_OK)
+					return 1;
+				NXclosedata(file_id);
+			}
+		}
+		NXclosegroup(file_id);
+	}
+	NXclosegroup(file_id);
+	NXclose(&file_id);
+	return 0;
+}
+
+static int count_object(const NXvisitinfo * info, void *userdata)
+{
+	counts *c = (counts *) userdata;
+
+	if (info->kind == NXVISIT_GROUP) {
+		c->groups++;
+		if (strcmp(info->nxclass, strcmp(info->name, "entry1") == 0 ?
+			   "NXentry" : "NXdata") != 0)
+			c->errors++;
+	} else if (info->kind == NXVISIT_DATASET) {
+		c->datasets++;
+		if (strcmp(info->nxclass, "SDS") != 0)
+			c->errors++;
+		/* /entry1/data7/d5 is a float array of 2 by 3 */
+		if (strcmp(info->path, "/entry1/data7/d5") == 0
+		    && (info->type != NX_FLOAT64 || info->rank != 1
+			|| info->dims[0] != 2 || strcmp(info->name, "d5") != 0))
+			c->errors++;
+		if (strcmp(info->path, "/entry1/data7/d6") == 0
+		    && (info->type != NX_INT32 || info->rank != 2
+			|| info->dims[0] != 3 || info->dims[1] != 3))
+			c->errors++;
+	} else {
+		c->attributes++;
+		/* units is a string of 6 characters */
+		if (strcmp(info->name, "units") == 0
+		    && (info->type != NX_CHAR || info->rank != 1
+			|| info->dims[0] != 6
+			|| strstr(info->path, "/d0") == NULL))
+			c->errors++;
+	}
+	return c->stop > 0
+	    && c->groups + c->datasets + c->attributes >= c->stop;
+}
+
+/* what NXvisit replaces: a recursive walk opening every group and dataset */
+static int walk(NXhandle file_id, counts * c)
+{
+	NXname *names, *classes, group, nxclass;
+	int64_t dims[NX_MAXRANK];
+	int i, n, type, rank, ret = 0;
+
+	/* opening an entry ends the group directory, so it is listed first */
+	if (NXgetgroupinfo(file_id, &n, group, nxclass) != NX_OK)
+		return 1;
+	names = (NXname *) malloc((n + 1) * 2 * sizeof(NXname));
+	classes = names + n + 1;
+	NXinitgroupdir(file_id);
+	for (i = 0; i < n; i++) {
+		if (NXgetnextentry(file_id, names[i], classes[i], &type)
+		    != NX_OK)
+			n = i;
+	}
+	for (i = 0; i < n && ret == 0; i++) {
+		if (strcmp(classes[i], "SDS") == 0) {
+			if (NXopendata(file_id, names[i]) != NX_OK
+			    || NXgetinfo64(file_id, &rank, dims,
+					   &type) != NX_OK)
+				ret = 1;
+			NXclosedata(file_id);
+			c->datasets++;
+		} else if (strcmp(classes[i], "CDF0.0") != 0) {
+			if (NXopengroup(file_id, names[i], classes[i]) != NX_OK)
+				ret = 1;
+			else
+				ret = walk(file_id, c);
+			NXclosegroup(file_id);
+			c->groups++;
+		}
+	}
+	free(names);
+	return ret;
+}
+
+static int test_visit(int file_type, const char *filename, int ngroup)
+{
+	NXhandle file_id = NULL;
+	counts c;
+	char path[NX_MAXPATHLEN];
+	double tim;
+
+	if (write_file(file_type, filename, ngroup) != 0) {
+		fprintf(stderr, "Failed to write %s\n", filename);
+		return 1;
+	}
+	if (NXopen(filename, NXACC_READ, &file_id) != NX_OK)
+		return 1;
+
+	memset(&c, 0, sizeof(c));
+	tim = nxbench_now();
+	if (NXvisit(file_id, 0, count_object, &c) != NX_OK)
+		return 1;
+	if (nxbench)
+		printf("  NXvisit of %d objects:          %.3f s\n",
+		       c.groups + c.datasets, nxbench_now() - tim);
+	if (c.groups != ngroup + 1 || c.datasets != ngroup * NDATA
+	    || c.attributes != 0 || c.errors != 0) {
+		fprintf(stderr, "NXvisit found %d groups, %d datasets, %d "
+			"attributes, %d errors\n", c.groups, c.datasets,
+			c.attributes, c.errors);
+		return 1;
+	}
+
+	memset(&c, 0, sizeof(c));
+	tim = nxbench_now();
+	if (walk(file_id, &c) != 0)
+		return 1;
+	if (nxbench)
+		printf("  NXgetnextentry walk of %d objects: %.3f s\n",
+		       c.groups + c.datasets, nxbench_now() - tim);
+	if (c.groups != ngroup + 1 || c.datasets != ngroup * NDATA) {
+		fprintf(stderr, "the walk found %d groups, %d datasets\n",
+			c.groups, c.datasets);
+		return 1;
+	}
+
+	/* the attributes, but not NX_class */
+	memset(&c, 0, sizeof(c));
+	if (NXvisit(file_id, NXVISIT_WITH_ATTRIBUTES, count_object, &c)
+	    != NX_OK || c.errors != 0)
+		return 1;
+	if (c.attributes < 2 * ngroup + 1) {
+		fprintf(stderr, "NXvisit found %d attributes\n", c.attributes);
+		return 1;
+	}
+
+	/* the callback stops the visit */
+	memset(&c, 0, sizeof(c));
+	c.stop = 10;
+	if (NXvisit(file_id, 0, count_object, &c) != NX_EOD
+	    || c.groups + c.datasets != 10) {
+		fprintf(stderr, "NXvisit did not stop\n");
+		return 1;
+	}
+
+	/* from a group below the root, which stays the current group */
+	if (NXopenpath(file_id, "/entry1/data3") != NX_OK)
+		return 1;
+	memset(&c, 0, sizeof(c));
+	if (NXvisit(file_id, 0, count_object, &c) != NX_OK
+	    || c.groups != 0 || c.datasets != NDATA)
+		return 1;
+	if (NXgetpath(file_id, path, sizeof(path)) != NX_OK
+	    || strcmp(path, "/entry1/data3") != 0) {
+		fprintf(stderr, "NXvisit left the group for %s\n", path);
+		return 1;
+	}
+	NXclose(&file_id);
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	int ret = 0, ngroup;
+
+	/* ten groups are enough for the checks, a thousand are timed */
+	ngroup = nxbench_init(argc, argv) ? 1000 : 10;
+#ifdef WITH_MXML
+	printf("Testing XML\n");
+	ret |= test_visit(NXACC_CREATEXML, "test_visit.xml", 10);
+#endif
+
+#ifdef WITH_HDF5
+	printf("Testing HDF5\n");
+	ret |= test_visit(NXACC_CREATE5, "test_visit.nx5", ngroup);
+#endif
+	return ret;
+}